@@ -0,0 +1,114 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 单次处理用的线性分配器实现
+ */
+
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "iot_arena.h"
+
+#define ARENA_ALIGN     8
+
+// 已初始化的arena，钩子据此查找当前任务的arena和判断指针归属
+static iot_arena_t *arenas[IOT_ARENA_MAX];
+static int arena_count = 0;
+static portMUX_TYPE arena_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool arena_owns(const iot_arena_t *a, const void *p)
+{
+    const uint8_t *b = p;
+    return b >= a->buf && b < a->buf + a->cap;
+}
+
+bool iot_arena_init(iot_arena_t *a, void *buf, size_t cap)
+{
+    if (!a || !buf || cap == 0) {
+        return false;
+    }
+    a->buf = buf;
+    a->cap = cap;
+    a->used = 0;
+    a->peak = 0;
+    a->overflows = 0;
+    a->owner = NULL;
+
+    portENTER_CRITICAL(&arena_mux);
+    bool ok = arena_count < IOT_ARENA_MAX;
+    if (ok) {
+        arenas[arena_count++] = a;
+    }
+    portEXIT_CRITICAL(&arena_mux);
+    return ok;
+}
+
+void *iot_arena_alloc(iot_arena_t *a, size_t size)
+{
+    size_t start = (a->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size > a->cap || start > a->cap - size) {
+        a->overflows++;
+        return NULL;
+    }
+    a->used = start + size;
+    return a->buf + start;
+}
+
+void iot_arena_enter(iot_arena_t *a)
+{
+    a->used = 0;
+    a->owner = xTaskGetCurrentTaskHandle();
+}
+
+void iot_arena_leave(iot_arena_t *a)
+{
+    a->owner = NULL;
+    if (a->used > a->peak) {
+        a->peak = a->used;
+    }
+    a->used = 0;
+}
+
+// 当前任务进入的arena（只有进入arena的任务自己会修改owner为自己）
+static iot_arena_t *arena_current(void)
+{
+    void *task = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < arena_count; i++) {
+        if (arenas[i]->owner == task) {
+            return arenas[i];
+        }
+    }
+    return NULL;
+}
+
+void *iot_arena_hook_malloc(size_t size)
+{
+    iot_arena_t *a = arena_current();
+    if (a) {
+        void *p = iot_arena_alloc(a, size);
+        if (p) {
+            return p;
+        }
+    }
+    return malloc(size);
+}
+
+void iot_arena_hook_free(void *p)
+{
+    if (!p) {
+        return;
+    }
+    for (int i = 0; i < arena_count; i++) {
+        if (arena_owns(arenas[i], p)) {
+            return;
+        }
+    }
+    free(p);
+}
+
+void iot_arena_get_stats(const iot_arena_t *a, iot_arena_stats_t *stats)
+{
+    stats->cap = a->cap;
+    stats->peak = a->peak;
+    stats->overflows = a->overflows;
+}
@@ -0,0 +1,102 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 单次处理用的线性分配器
+ *
+ * 处理一条消息或一个请求时，从固定缓冲区顺序分配、不单独释放，处理结束时整体重置，
+ * 短生命周期的小块内存（例如cJSON树和打印结果）不进入通用堆。
+ *
+ * iot_arena_enter() 后，当前任务经由 iot_arena_hook_malloc()/iot_arena_hook_free()
+ * 的分配落在arena中，可直接作为cJSON的内存钩子:
+ *     cJSON_Hooks hooks = { iot_arena_hook_malloc, iot_arena_hook_free };
+ *     cJSON_InitHooks(&hooks);
+ * 没有进入arena的任务、以及arena用完时回退到malloc/free，其他任务使用cJSON不受影响。
+ * 离开arena后其中分配的内存全部失效，不能再使用。
+ */
+
+#ifndef IOT_ARENA_H
+#define IOT_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_ARENA_MAX       4           ///< 最多arena数
+
+/**
+ * @brief 线性分配器
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t used;
+    size_t peak;
+    uint32_t overflows;
+    void *owner;                        ///< 进入arena的任务
+} iot_arena_t;
+
+/**
+ * @brief 线性分配器统计
+ */
+typedef struct {
+    size_t cap;                         ///< 缓冲区大小
+    size_t peak;                        ///< 单次处理的最大用量
+    uint32_t overflows;                 ///< 缓冲区不足回退到堆的次数
+} iot_arena_stats_t;
+
+/**
+ * @brief 初始化arena
+ *
+ * @param a arena（需在整个运行期间有效）
+ * @param buf 缓冲区
+ * @param cap 缓冲区大小
+ * @return true 成功
+ * @return false 参数错误或arena数已达 IOT_ARENA_MAX
+ */
+bool iot_arena_init(iot_arena_t *a, void *buf, size_t cap);
+
+/**
+ * @brief 从arena分配（8字节对齐）
+ *
+ * @return void* 内存，缓冲区不足返回NULL
+ */
+void *iot_arena_alloc(iot_arena_t *a, size_t size);
+
+/**
+ * @brief 当前任务开始使用arena，钩子分配落在arena中
+ *
+ * 同一arena同一时间只能由一个任务进入
+ */
+void iot_arena_enter(iot_arena_t *a);
+
+/**
+ * @brief 当前任务结束使用arena，记录用量峰值并重置
+ */
+void iot_arena_leave(iot_arena_t *a);
+
+/**
+ * @brief 内存分配钩子：当前任务进入了arena时从arena分配，否则（或arena已满）调用malloc
+ */
+void *iot_arena_hook_malloc(size_t size);
+
+/**
+ * @brief 内存释放钩子：arena中的内存忽略，其他调用free
+ */
+void iot_arena_hook_free(void *p);
+
+/**
+ * @brief 获取统计
+ */
+void iot_arena_get_stats(const iot_arena_t *a, iot_arena_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_ARENA_H
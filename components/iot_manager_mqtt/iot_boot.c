@@ -0,0 +1,96 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 启动阶段计时实现
+ */
+
+#include <string.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_app_desc.h"
+#endif
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "iot_boot.h"
+
+static const char *TAG = "IOT_BOOT";
+
+static iot_boot_stage_t stages[IOT_BOOT_MAX_STAGES];
+static size_t stage_count = 0;
+static bool boot_complete = false;
+static portMUX_TYPE boot_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void iot_boot_mark(const char *stage)
+{
+    if (!stage) {
+        return;
+    }
+
+    // 在临界区内读时间，多个任务同时记录时列表顺序和时间顺序一致
+    portENTER_CRITICAL(&boot_mux);
+    uint32_t ms = (uint32_t)(esp_timer_get_time() / 1000);
+    bool found = boot_complete;
+    for (size_t i = 0; i < stage_count && !found; i++) {
+        found = stages[i].name == stage || strcmp(stages[i].name, stage) == 0;
+    }
+    if (!found && stage_count < IOT_BOOT_MAX_STAGES) {
+        stages[stage_count].name = stage;
+        stages[stage_count].ms = ms;
+        stage_count++;
+    }
+    portEXIT_CRITICAL(&boot_mux);
+}
+
+void iot_boot_complete(void)
+{
+    iot_boot_stage_t list[IOT_BOOT_MAX_STAGES];
+
+    portENTER_CRITICAL(&boot_mux);
+    bool was_complete = boot_complete;
+    boot_complete = true;
+    size_t count = stage_count;
+    memcpy(list, stages, count * sizeof(list[0]));
+    portEXIT_CRITICAL(&boot_mux);
+
+    if (was_complete) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "启动阶段耗时（固件 %s）:", iot_boot_firmware_version());
+    uint32_t prev = 0;
+    for (size_t i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "  %-14s %6lums  +%lums", list[i].name,
+                 (unsigned long)list[i].ms, (unsigned long)(list[i].ms - prev));
+        prev = list[i].ms;
+    }
+}
+
+bool iot_boot_is_complete(void)
+{
+    portENTER_CRITICAL(&boot_mux);
+    bool complete = boot_complete;
+    portEXIT_CRITICAL(&boot_mux);
+    return complete;
+}
+
+size_t iot_boot_get(iot_boot_stage_t *list, size_t max)
+{
+    if (!list) {
+        return 0;
+    }
+    portENTER_CRITICAL(&boot_mux);
+    size_t count = stage_count < max ? stage_count : max;
+    memcpy(list, stages, count * sizeof(list[0]));
+    portEXIT_CRITICAL(&boot_mux);
+    return count;
+}
+
+const char *iot_boot_firmware_version(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    // linux目标没有应用描述
+    return "linux";
+#else
+    return esp_app_get_description()->version;
+#endif
+}
@@ -0,0 +1,74 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 启动阶段计时
+ *
+ * 在启动路径的各个阶段结束时调用 iot_boot_mark() 记录 esp_timer 时间戳
+ * （从芯片启动算起）。组件自身记录 mqtt_start、mqtt_connack 和 first_publish，
+ * 首次连接时上线消息带上已记录的阶段，首次发布完成后打印完整分解并停止记录，
+ * 之后的重连不会改变结果。
+ *
+ * 示例:
+ *     nvs_flash_init();
+ *     iot_boot_mark("nvs");
+ */
+
+#ifndef IOT_BOOT_H
+#define IOT_BOOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_BOOT_MAX_STAGES     16      ///< 最多记录的阶段数
+
+/**
+ * @brief 启动阶段
+ */
+typedef struct {
+    const char *name;                   ///< 阶段名
+    uint32_t ms;                        ///< 阶段结束时间（启动后毫秒）
+} iot_boot_stage_t;
+
+/**
+ * @brief 记录阶段结束时间
+ *
+ * 每个阶段只记录第一次，启动完成后的调用被忽略。可在任意任务中调用。
+ *
+ * @param stage 阶段名，只保存指针，必须是字符串常量
+ */
+void iot_boot_mark(const char *stage);
+
+/**
+ * @brief 标记启动完成（首次发布成功），打印各阶段耗时，之后不再记录
+ */
+void iot_boot_complete(void);
+
+/**
+ * @brief 启动是否已完成
+ */
+bool iot_boot_is_complete(void);
+
+/**
+ * @brief 获取已记录的阶段（按记录顺序）
+ *
+ * @param stages 输出数组
+ * @param max 数组容量
+ * @return size_t 阶段数
+ */
+size_t iot_boot_get(iot_boot_stage_t *stages, size_t max);
+
+/**
+ * @brief 固件版本（应用描述中的version），用于对比不同版本的启动时间
+ */
+const char *iot_boot_firmware_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_BOOT_H
@@ -0,0 +1,234 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - CBOR转JSON实现
+ *
+ * 逐个读取数据项，调用 iot_json_writer 的对应接口输出，因此数值格式、转义和溢出处理
+ * 都与直接编码JSON相同。容器按嵌套深度递归，深度受 IOT_CBOR_MAX_DEPTH 限制。
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "iot_cbor_json.h"
+#include "iot_cbor_writer.h"
+#include "iot_json_writer.h"
+
+#define CBOR_MAJOR_UINT     0
+#define CBOR_MAJOR_NINT     1
+#define CBOR_MAJOR_TEXT     3
+#define CBOR_MAJOR_ARRAY    4
+#define CBOR_MAJOR_MAP      5
+#define CBOR_MAJOR_SIMPLE   7
+
+#define CBOR_INDEFINITE     31
+#define CBOR_SIMPLE_FALSE   20
+#define CBOR_SIMPLE_TRUE    21
+#define CBOR_SIMPLE_NULL    22
+#define CBOR_SIMPLE_HALF    25
+#define CBOR_SIMPLE_FLOAT   26
+#define CBOR_SIMPLE_DOUBLE  27
+#define CBOR_BREAK          0xFF
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} cbor_in_t;
+
+/**
+ * @brief 读取数据项首部
+ *
+ * @param info 附加信息，CBOR_INDEFINITE表示不定长（arg为0）
+ * @param arg 参数：整数值、长度、元素个数或浮点数的位
+ */
+static bool read_head(cbor_in_t *in, uint8_t *major, uint8_t *info, uint64_t *arg)
+{
+    if (in->p >= in->end) {
+        return false;
+    }
+    uint8_t b = *in->p++;
+    *major = b >> 5;
+    *info = b & 0x1F;
+    *arg = 0;
+    if (*info < 24) {
+        *arg = *info;
+        return true;
+    }
+    if (*info == CBOR_INDEFINITE) {
+        return true;
+    }
+    if (*info > 27) {
+        return false;
+    }
+    size_t n = (size_t)1 << (*info - 24);
+    if ((size_t)(in->end - in->p) < n) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        *arg = (*arg << 8) | *in->p++;
+    }
+    return true;
+}
+
+/**
+ * @brief 读取定长文本（首部已读取）
+ */
+static bool read_text(cbor_in_t *in, uint8_t info, uint64_t len, const char **text)
+{
+    if (info == CBOR_INDEFINITE || len > (uint64_t)(in->end - in->p)) {
+        return false;
+    }
+    *text = (const char *)in->p;
+    in->p += len;
+    return true;
+}
+
+/**
+ * @brief 半精度转双精度（RFC 8949 附录D）
+ */
+static double half_to_double(uint16_t half)
+{
+    int exp = (half >> 10) & 0x1F;
+    int mant = half & 0x3FF;
+    double value;
+    if (exp == 0) {
+        value = ldexp(mant, -24);
+    } else if (exp != 31) {
+        value = ldexp(mant + 1024, exp - 25);
+    } else {
+        value = mant == 0 ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+static bool convert_simple(iot_json_writer_t *w, uint8_t info, uint64_t bits)
+{
+    switch (info) {
+    case CBOR_SIMPLE_FALSE:
+        iot_json_bool(w, false);
+        return true;
+    case CBOR_SIMPLE_TRUE:
+        iot_json_bool(w, true);
+        return true;
+    case CBOR_SIMPLE_NULL:
+        iot_json_null(w);
+        return true;
+    case CBOR_SIMPLE_HALF:
+        iot_json_double(w, half_to_double((uint16_t)bits));
+        return true;
+    case CBOR_SIMPLE_FLOAT: {
+        uint32_t b32 = (uint32_t)bits;
+        float f;
+        memcpy(&f, &b32, sizeof(f));
+        iot_json_double(w, f);
+        return true;
+    }
+    case CBOR_SIMPLE_DOUBLE: {
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        iot_json_double(w, d);
+        return true;
+    }
+    default:
+        // undefined、其他简单值和容器外的结束符
+        return false;
+    }
+}
+
+static bool convert_item(cbor_in_t *in, iot_json_writer_t *w, int depth);
+
+static bool convert_container(cbor_in_t *in, iot_json_writer_t *w, bool is_object,
+                              uint8_t info, uint64_t count, int depth)
+{
+    // 与编码器相同：最多嵌套 IOT_CBOR_MAX_DEPTH - 1 层
+    if (depth + 1 >= IOT_CBOR_MAX_DEPTH) {
+        return false;
+    }
+    if (is_object) {
+        iot_json_object_begin(w);
+    } else {
+        iot_json_array_begin(w);
+    }
+
+    for (uint64_t i = 0; info == CBOR_INDEFINITE || i < count; i++) {
+        if (info == CBOR_INDEFINITE && in->p < in->end && *in->p == CBOR_BREAK) {
+            in->p++;
+            break;
+        }
+        if (is_object) {
+            uint8_t major, key_info;
+            uint64_t len;
+            const char *key;
+            if (!read_head(in, &major, &key_info, &len) || major != CBOR_MAJOR_TEXT ||
+                    !read_text(in, key_info, len, &key)) {
+                return false;
+            }
+            iot_json_key_n(w, key, (size_t)len);
+        }
+        if (!convert_item(in, w, depth + 1)) {
+            return false;
+        }
+    }
+
+    if (is_object) {
+        iot_json_object_end(w);
+    } else {
+        iot_json_array_end(w);
+    }
+    return true;
+}
+
+static bool convert_item(cbor_in_t *in, iot_json_writer_t *w, int depth)
+{
+    uint8_t major, info;
+    uint64_t arg;
+    if (!read_head(in, &major, &info, &arg)) {
+        return false;
+    }
+
+    switch (major) {
+    case CBOR_MAJOR_UINT:
+        if (info == CBOR_INDEFINITE) {
+            return false;
+        }
+        iot_json_uint(w, arg);
+        return true;
+    case CBOR_MAJOR_NINT:
+        if (info == CBOR_INDEFINITE || arg > INT64_MAX) {
+            return false;
+        }
+        iot_json_int(w, -1 - (int64_t)arg);
+        return true;
+    case CBOR_MAJOR_TEXT: {
+        const char *text;
+        if (!read_text(in, info, arg, &text)) {
+            return false;
+        }
+        iot_json_str_n(w, text, (size_t)arg);
+        return true;
+    }
+    case CBOR_MAJOR_ARRAY:
+    case CBOR_MAJOR_MAP:
+        return convert_container(in, w, major == CBOR_MAJOR_MAP, info, arg, depth);
+    case CBOR_MAJOR_SIMPLE:
+        return convert_simple(w, info, arg);
+    default:
+        // 字节串和标签没有对应的JSON
+        return false;
+    }
+}
+
+int iot_cbor_to_json(const void *cbor, size_t len, char *buf, size_t size)
+{
+    if (!cbor || !buf) {
+        return -1;
+    }
+    cbor_in_t in = { cbor, (const uint8_t *)cbor + len };
+    iot_json_writer_t w;
+    iot_json_init(&w, buf, size);
+    if (!convert_item(&in, &w, 0) || in.p != in.end) {
+        return -1;
+    }
+    return iot_json_finish(&w);
+}
@@ -0,0 +1,40 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - CBOR转JSON
+ *
+ * 把 iot_cbor_writer 编码的数据转换为JSON，输出与用 iot_json_writer 直接编码相同。
+ * 用于负载格式为CBOR时仍需要JSON的场合（例如HTTP接口），编码代码只需按 iot_payload_* 写一份。
+ *
+ * 示例:
+ *     int len = iot_cbor_to_json(cbor, cbor_len, json, sizeof(json));
+ */
+
+#ifndef IOT_CBOR_JSON_H
+#define IOT_CBOR_JSON_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 把一个CBOR数据项转换为JSON
+ *
+ * 支持整数、浮点数（半/单/双精度）、文本、true/false/null、定长和不定长的数组和对象，
+ * 对象的键必须是文本。字节串、标签等没有对应JSON的类型按无效数据处理。
+ *
+ * @param cbor CBOR数据，必须恰好是一个完整的数据项
+ * @param len CBOR数据长度
+ * @param buf 输出缓冲区，结尾写入'\0'
+ * @param size 缓冲区大小
+ * @return int JSON长度（不含'\0'），数据无效、嵌套超过编码器的限制或缓冲区不足返回-1
+ */
+int iot_cbor_to_json(const void *cbor, size_t len, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_CBOR_JSON_H
@@ -0,0 +1,353 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 流式CBOR编码器实现
+ *
+ * 每个数据项 = 首字节(主类型<<5 | 附加信息) + 0/1/2/4/8字节大端参数。
+ * 参数小于24时直接放在首字节中，因此小整数、短字符串和小容器头都只占1字节。
+ */
+
+#include <math.h>
+#include <string.h>
+#include "iot_cbor_writer.h"
+
+#define CBOR_MAJOR_UINT     0
+#define CBOR_MAJOR_NINT     1
+#define CBOR_MAJOR_BYTES    2
+#define CBOR_MAJOR_TEXT     3
+#define CBOR_MAJOR_ARRAY    4
+#define CBOR_MAJOR_MAP      5
+
+#define CBOR_INDEFINITE     31
+#define CBOR_FALSE          0xF4
+#define CBOR_TRUE           0xF5
+#define CBOR_NULL           0xF6
+#define CBOR_HALF           0xF9
+#define CBOR_FLOAT          0xFA
+#define CBOR_DOUBLE         0xFB
+#define CBOR_BREAK          0xFF
+
+// 可精确表示为整数的浮点数范围（2^53）
+#define CBOR_INT_EXACT_MAX  9007199254740992.0
+
+static void put(iot_cbor_writer_t *w, const void *s, size_t n)
+{
+    if (w->error) {
+        return;
+    }
+    if (w->len + n > w->cap) {
+        w->error = true;
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static void put_byte(iot_cbor_writer_t *w, uint8_t b)
+{
+    put(w, &b, 1);
+}
+
+/**
+ * @brief 写入首字节和最短的参数编码
+ */
+static void put_head(iot_cbor_writer_t *w, uint8_t major, uint64_t arg)
+{
+    if (arg < 24) {
+        put_byte(w, (uint8_t)(major << 5) | (uint8_t)arg);
+        return;
+    }
+
+    uint8_t info;
+    size_t extra;
+    if (arg <= 0xFF) {
+        info = 24;
+        extra = 1;
+    } else if (arg <= 0xFFFF) {
+        info = 25;
+        extra = 2;
+    } else if (arg <= 0xFFFFFFFFu) {
+        info = 26;
+        extra = 4;
+    } else {
+        info = 27;
+        extra = 8;
+    }
+
+    // 参数按大端存放
+    uint8_t tmp[9];
+    tmp[0] = (uint8_t)(major << 5) | info;
+    for (size_t i = extra; i > 0; i--) {
+        tmp[i] = (uint8_t)arg;
+        arg >>= 8;
+    }
+    put(w, tmp, extra + 1);
+}
+
+/**
+ * @brief 写入值之前检查调用顺序：对象中的值前面必须有键名
+ */
+static void before_value(iot_cbor_writer_t *w)
+{
+    uint32_t bit = 1u << w->depth;
+    if (w->is_object & bit) {
+        if (!(w->expect_value & bit)) {
+            w->error = true;
+        }
+        w->expect_value &= ~bit;
+    }
+}
+
+void iot_cbor_init(iot_cbor_writer_t *w, void *buf, size_t cap)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+}
+
+int iot_cbor_finish(iot_cbor_writer_t *w)
+{
+    if (w->error || w->depth != 0) {
+        return -1;
+    }
+    return (int)w->len;
+}
+
+static void container_begin(iot_cbor_writer_t *w, uint8_t major, bool is_object)
+{
+    before_value(w);
+    if (w->depth + 1 >= IOT_CBOR_MAX_DEPTH) {
+        w->error = true;
+        return;
+    }
+    put_byte(w, (uint8_t)(major << 5) | CBOR_INDEFINITE);
+    w->depth++;
+    uint32_t bit = 1u << w->depth;
+    if (is_object) {
+        w->is_object |= bit;
+    } else {
+        w->is_object &= ~bit;
+    }
+    w->expect_value &= ~bit;
+}
+
+static void container_end(iot_cbor_writer_t *w, bool is_object)
+{
+    uint32_t bit = 1u << w->depth;
+    if (w->depth == 0 || ((w->is_object & bit) != 0) != is_object || (w->expect_value & bit)) {
+        w->error = true;
+        return;
+    }
+    put_byte(w, CBOR_BREAK);
+    w->depth--;
+}
+
+void iot_cbor_object_begin(iot_cbor_writer_t *w)
+{
+    container_begin(w, CBOR_MAJOR_MAP, true);
+}
+
+void iot_cbor_object_end(iot_cbor_writer_t *w)
+{
+    container_end(w, true);
+}
+
+void iot_cbor_array_begin(iot_cbor_writer_t *w)
+{
+    container_begin(w, CBOR_MAJOR_ARRAY, false);
+}
+
+void iot_cbor_array_end(iot_cbor_writer_t *w)
+{
+    container_end(w, false);
+}
+
+void iot_cbor_key(iot_cbor_writer_t *w, const char *key)
+{
+    uint32_t bit = 1u << w->depth;
+    if (!(w->is_object & bit) || (w->expect_value & bit)) {
+        w->error = true;
+        return;
+    }
+    size_t len = strlen(key);
+    put_head(w, CBOR_MAJOR_TEXT, len);
+    put(w, key, len);
+    w->expect_value |= bit;
+}
+
+void iot_cbor_str(iot_cbor_writer_t *w, const char *value)
+{
+    if (!value) {
+        iot_cbor_null(w);
+        return;
+    }
+    iot_cbor_str_n(w, value, strlen(value));
+}
+
+void iot_cbor_str_n(iot_cbor_writer_t *w, const char *value, size_t len)
+{
+    before_value(w);
+    put_head(w, CBOR_MAJOR_TEXT, len);
+    put(w, value, len);
+}
+
+void iot_cbor_bytes(iot_cbor_writer_t *w, const void *data, size_t len)
+{
+    before_value(w);
+    put_head(w, CBOR_MAJOR_BYTES, len);
+    put(w, data, len);
+}
+
+void iot_cbor_int(iot_cbor_writer_t *w, int64_t value)
+{
+    before_value(w);
+    if (value >= 0) {
+        put_head(w, CBOR_MAJOR_UINT, (uint64_t)value);
+    } else {
+        // 负数编码为 -1-n，不会溢出
+        put_head(w, CBOR_MAJOR_NINT, ~(uint64_t)value);
+    }
+}
+
+void iot_cbor_uint(iot_cbor_writer_t *w, uint64_t value)
+{
+    before_value(w);
+    put_head(w, CBOR_MAJOR_UINT, value);
+}
+
+/**
+ * @brief 单精度转半精度，不能无损转换时返回false
+ */
+static bool float_to_half(float f, uint16_t *half)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    int exp = (int)((bits >> 23) & 0xFF) - 127;
+    uint32_t mant = bits & 0x7FFFFF;
+
+    if ((bits & 0x7FFFFFFF) == 0) {
+        *half = sign;
+        return true;
+    }
+    if (exp == 128) {
+        // 无穷大，NaN统一为0x7E00
+        *half = mant ? 0x7E00 : (sign | 0x7C00);
+        return true;
+    }
+    if (exp >= -14 && exp <= 15) {
+        if (mant & 0x1FFF) {
+            return false;
+        }
+        *half = sign | (uint16_t)((exp + 15) << 10) | (uint16_t)(mant >> 13);
+        return true;
+    }
+    if (exp >= -24 && exp < -14) {
+        // 半精度非规格化数：值 = m * 2^-24
+        uint32_t full = mant | 0x800000;
+        int shift = -(exp + 1);
+        if (full & ((1u << shift) - 1)) {
+            return false;
+        }
+        *half = sign | (uint16_t)(full >> shift);
+        return true;
+    }
+    return false;
+}
+
+static void put_float(iot_cbor_writer_t *w, float value)
+{
+    uint16_t half;
+    if (float_to_half(value, &half)) {
+        uint8_t tmp[3] = { CBOR_HALF, (uint8_t)(half >> 8), (uint8_t)half };
+        put(w, tmp, sizeof(tmp));
+        return;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t tmp[5] = { CBOR_FLOAT, (uint8_t)(bits >> 24), (uint8_t)(bits >> 16),
+                       (uint8_t)(bits >> 8), (uint8_t)bits };
+    put(w, tmp, sizeof(tmp));
+}
+
+void iot_cbor_double(iot_cbor_writer_t *w, double value)
+{
+    if (value == floor(value) && fabs(value) < CBOR_INT_EXACT_MAX) {
+        iot_cbor_int(w, (int64_t)value);
+        return;
+    }
+
+    before_value(w);
+    float f = (float)value;
+    if ((double)f == value || isnan(value)) {
+        put_float(w, f);
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t tmp[9];
+    tmp[0] = CBOR_DOUBLE;
+    for (int i = 8; i >= 1; i--) {
+        tmp[i] = (uint8_t)bits;
+        bits >>= 8;
+    }
+    put(w, tmp, sizeof(tmp));
+}
+
+void iot_cbor_float(iot_cbor_writer_t *w, float value)
+{
+    if (value == floorf(value) && fabsf(value) < 16777216.0f) {
+        iot_cbor_int(w, (int64_t)value);
+        return;
+    }
+    before_value(w);
+    put_float(w, value);
+}
+
+void iot_cbor_bool(iot_cbor_writer_t *w, bool value)
+{
+    before_value(w);
+    put_byte(w, value ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void iot_cbor_null(iot_cbor_writer_t *w)
+{
+    before_value(w);
+    put_byte(w, CBOR_NULL);
+}
+
+void iot_cbor_kv_str(iot_cbor_writer_t *w, const char *key, const char *value)
+{
+    iot_cbor_key(w, key);
+    iot_cbor_str(w, value);
+}
+
+void iot_cbor_kv_int(iot_cbor_writer_t *w, const char *key, int64_t value)
+{
+    iot_cbor_key(w, key);
+    iot_cbor_int(w, value);
+}
+
+void iot_cbor_kv_uint(iot_cbor_writer_t *w, const char *key, uint64_t value)
+{
+    iot_cbor_key(w, key);
+    iot_cbor_uint(w, value);
+}
+
+void iot_cbor_kv_double(iot_cbor_writer_t *w, const char *key, double value)
+{
+    iot_cbor_key(w, key);
+    iot_cbor_double(w, value);
+}
+
+void iot_cbor_kv_float(iot_cbor_writer_t *w, const char *key, float value)
+{
+    iot_cbor_key(w, key);
+    iot_cbor_float(w, value);
+}
+
+void iot_cbor_kv_bool(iot_cbor_writer_t *w, const char *key, bool value)
+{
+    iot_cbor_key(w, key);
+    iot_cbor_bool(w, value);
+}
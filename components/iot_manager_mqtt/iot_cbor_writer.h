@@ -0,0 +1,118 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 流式CBOR编码器（RFC 8949）
+ *
+ * 接口与 iot_json_writer.h 一一对应，直接写入调用者提供的缓冲区，不分配堆内存。
+ * 对象和数组使用不定长编码（0xBF/0x9F ... 0xFF），无需预先知道元素个数；
+ * 整数使用最短编码，浮点数在不损失精度时使用半精度或单精度。
+ * 缓冲区不足时置溢出标志，后续写入全部忽略，由 iot_cbor_finish() 统一报告。
+ *
+ * 示例:
+ *     uint8_t buf[64];
+ *     iot_cbor_writer_t w;
+ *     iot_cbor_init(&w, buf, sizeof(buf));
+ *     iot_cbor_object_begin(&w);
+ *     iot_cbor_kv_str(&w, "device_id", "ESP32_001");
+ *     iot_cbor_kv_int(&w, "uptime", 3600);
+ *     iot_cbor_object_end(&w);
+ *     int len = iot_cbor_finish(&w);   // 32字节，同样内容的JSON为39字节
+ */
+
+#ifndef IOT_CBOR_WRITER_H
+#define IOT_CBOR_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 最大嵌套深度
+#define IOT_CBOR_MAX_DEPTH  16
+
+/**
+ * @brief CBOR编码器状态
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    uint8_t *buf;               ///< 输出缓冲区
+    size_t cap;                 ///< 缓冲区大小
+    size_t len;                 ///< 已写入长度
+    uint32_t is_object;         ///< 每层是否为对象
+    uint32_t expect_value;      ///< 每层对象是否刚写完键名
+    uint8_t depth;              ///< 当前嵌套深度
+    bool error;                 ///< 缓冲区溢出或调用顺序错误
+} iot_cbor_writer_t;
+
+/**
+ * @brief 初始化编码器
+ *
+ * @param w 编码器
+ * @param buf 输出缓冲区
+ * @param cap 缓冲区大小
+ */
+void iot_cbor_init(iot_cbor_writer_t *w, void *buf, size_t cap);
+
+/**
+ * @brief 结束编码
+ *
+ * 与JSON编码器不同，输出为二进制数据，不以'\0'结尾
+ *
+ * @return int 输出长度，溢出或对象/数组未闭合返回-1
+ */
+int iot_cbor_finish(iot_cbor_writer_t *w);
+
+void iot_cbor_object_begin(iot_cbor_writer_t *w);
+void iot_cbor_object_end(iot_cbor_writer_t *w);
+void iot_cbor_array_begin(iot_cbor_writer_t *w);
+void iot_cbor_array_end(iot_cbor_writer_t *w);
+
+/**
+ * @brief 写入对象键名
+ */
+void iot_cbor_key(iot_cbor_writer_t *w, const char *key);
+
+void iot_cbor_str(iot_cbor_writer_t *w, const char *value);
+void iot_cbor_str_n(iot_cbor_writer_t *w, const char *value, size_t len);
+void iot_cbor_int(iot_cbor_writer_t *w, int64_t value);
+void iot_cbor_uint(iot_cbor_writer_t *w, uint64_t value);
+
+/**
+ * @brief 写入浮点数
+ *
+ * 整数值按整数编码（与JSON输出一致），能无损表示为半精度/单精度时使用较短的编码，
+ * 否则按双精度编码（9字节）。
+ */
+void iot_cbor_double(iot_cbor_writer_t *w, double value);
+
+/**
+ * @brief 按单精度写入浮点数（约7位有效数字，最多5字节）
+ *
+ * 传感器读数通常不需要双精度，使用此函数可明显缩小负载
+ */
+void iot_cbor_float(iot_cbor_writer_t *w, float value);
+void iot_cbor_bool(iot_cbor_writer_t *w, bool value);
+void iot_cbor_null(iot_cbor_writer_t *w);
+
+/**
+ * @brief 写入字节串（CBOR主类型2，JSON没有对应类型）
+ */
+void iot_cbor_bytes(iot_cbor_writer_t *w, const void *data, size_t len);
+
+// 键值对便捷函数
+void iot_cbor_kv_str(iot_cbor_writer_t *w, const char *key, const char *value);
+void iot_cbor_kv_int(iot_cbor_writer_t *w, const char *key, int64_t value);
+void iot_cbor_kv_uint(iot_cbor_writer_t *w, const char *key, uint64_t value);
+void iot_cbor_kv_double(iot_cbor_writer_t *w, const char *key, double value);
+void iot_cbor_kv_float(iot_cbor_writer_t *w, const char *key, float value);
+void iot_cbor_kv_bool(iot_cbor_writer_t *w, const char *key, bool value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_CBOR_WRITER_H
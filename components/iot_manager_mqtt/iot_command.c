@@ -0,0 +1,416 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 命令注册表与工作任务池实现
+ *
+ * 命令表为开放寻址哈希表（FNV-1a），MQTT任务中只用增量解析器逐片解析命令消息并查表，
+ * 命令处理函数在固定数量的工作任务中执行。每个工作任务带一个单次定时器，
+ * 超时后由定时器回调回复超时结果。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "iot_manager.h"
+#include "iot_command.h"
+#include "iot_json_reader.h"
+
+static const char *TAG = "IOT_COMMAND";
+
+// 哈希表大小（命令数的2倍，保证查找链短）
+#define CMD_TABLE_SIZE      (CONFIG_IOT_CMD_MAX_COMMANDS * 2)
+
+// 命令ID最大长度（含结尾'\0'）
+#define CMD_ID_MAX_LEN      48
+
+// 回复消息最大长度
+#define CMD_MESSAGE_MAX_LEN 128
+
+/**
+ * @brief 命令表项
+ */
+typedef struct {
+    char name[IOT_CMD_NAME_MAX_LEN];
+    iot_command_handler_t handler;      ///< NULL表示已注销（表项保留，不影响探测链）
+    uint32_t flags;
+} cmd_entry_t;
+
+/**
+ * @brief 待执行的命令
+ */
+typedef struct {
+    cmd_entry_t *entry;
+    char id[CMD_ID_MAX_LEN];
+    int params_len;
+    char params[CONFIG_IOT_CMD_PARAMS_MAX_LEN + 1];
+} cmd_job_t;
+
+/**
+ * @brief 工作任务状态
+ */
+enum {
+    WORKER_IDLE = 0,
+    WORKER_RUNNING,                     ///< 处理函数执行中
+    WORKER_TIMED_OUT,                   ///< 定时器已判定超时，正在回复
+    WORKER_TIMEOUT_REPLIED,             ///< 超时结果已回复
+};
+
+typedef struct {
+    TaskHandle_t task;
+    esp_timer_handle_t timer;
+    atomic_int state;
+    cmd_job_t job;                      ///< 当前命令（定时器回调读取其中的ID）
+} cmd_worker_t;
+
+static cmd_entry_t cmd_table[CMD_TABLE_SIZE];
+static int cmd_count = 0;
+static portMUX_TYPE cmd_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static QueueHandle_t cmd_queue = NULL;
+static cmd_worker_t cmd_workers[CONFIG_IOT_CMD_WORKERS];
+
+// 分发只在MQTT任务中进行，使用静态缓冲区避免占用MQTT任务栈
+static cmd_job_t dispatch_job;
+
+static uint32_t cmd_hash(const char *name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 查找表项（调用者需持有cmd_mux）
+ *
+ * @return cmd_entry_t* 名称匹配的表项；不存在时返回探测链上的第一个空位，表满返回NULL
+ */
+static cmd_entry_t *cmd_lookup_locked(const char *name, size_t len)
+{
+    uint32_t idx = cmd_hash(name, len) % CMD_TABLE_SIZE;
+    for (int i = 0; i < CMD_TABLE_SIZE; i++) {
+        cmd_entry_t *e = &cmd_table[idx];
+        if (e->name[0] == '\0') {
+            return e;
+        }
+        if (strncmp(e->name, name, len) == 0 && e->name[len] == '\0') {
+            return e;
+        }
+        idx = (idx + 1) % CMD_TABLE_SIZE;
+    }
+    return NULL;
+}
+
+esp_err_t iot_manager_register_command(const char *name, iot_command_handler_t handler, uint32_t flags)
+{
+    if (!name) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t len = strlen(name);
+    if (len == 0 || len >= IOT_CMD_NAME_MAX_LEN) {
+        ESP_LOGE(TAG, "命令名无效: %s", name);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&cmd_mux);
+    cmd_entry_t *e = cmd_lookup_locked(name, len);
+    if (e && e->name[0] == '\0') {
+        if (cmd_count >= CONFIG_IOT_CMD_MAX_COMMANDS) {
+            e = NULL;
+        } else {
+            memcpy(e->name, name, len + 1);
+            cmd_count++;
+        }
+    }
+    if (e) {
+        e->flags = flags;
+        e->handler = handler;
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+    portEXIT_CRITICAL(&cmd_mux);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "命令表已满(%d)，无法注册: %s", CONFIG_IOT_CMD_MAX_COMMANDS, name);
+    } else {
+        ESP_LOGD(TAG, "注册命令: %s", name);
+    }
+    return ret;
+}
+
+static void cmd_reply(const char *id, uint32_t flags, int result, const char *message)
+{
+    if (!(flags & IOT_CMD_FLAG_NO_REPLY)) {
+        iot_manager_reply_command(id, result, message);
+    }
+}
+
+/**
+ * @brief 命令超时定时器回调（在esp_timer任务中执行）
+ */
+static void cmd_timeout_cb(void *arg)
+{
+    cmd_worker_t *w = arg;
+    int expected = WORKER_RUNNING;
+    if (!atomic_compare_exchange_strong(&w->state, &expected, WORKER_TIMED_OUT)) {
+        return;
+    }
+    ESP_LOGW(TAG, "命令执行超时: %s", w->job.entry->name);
+    cmd_reply(w->job.id, w->job.entry->flags, IOT_CMD_RESULT_TIMEOUT, "timeout");
+    atomic_store(&w->state, WORKER_TIMEOUT_REPLIED);
+}
+
+/**
+ * @brief 命令工作任务
+ */
+static void cmd_worker_task(void *pvParameters)
+{
+    cmd_worker_t *w = pvParameters;
+
+    while (1) {
+        if (xQueueReceive(cmd_queue, &w->job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        const cmd_entry_t *entry = w->job.entry;
+        iot_command_handler_t handler = entry->handler;
+        uint32_t flags = entry->flags;
+        if (!handler) {
+            // 入队后被注销
+            continue;
+        }
+
+        iot_command_t cmd = {
+            .name = entry->name,
+            .id = w->job.id,
+            .params = w->job.params_len ? w->job.params : NULL,
+            .params_len = w->job.params_len,
+        };
+        char message[CMD_MESSAGE_MAX_LEN] = "";
+
+        uint32_t timeout_sec = flags >> 16;
+        if (timeout_sec == 0) {
+            timeout_sec = CONFIG_IOT_CMD_DEFAULT_TIMEOUT_SEC;
+        }
+
+        ESP_LOGI(TAG, "执行命令: %s (id=%s)", cmd.name, cmd.id);
+        atomic_store(&w->state, WORKER_RUNNING);
+        esp_timer_start_once(w->timer, timeout_sec * 1000000ULL);
+
+        int result = handler(&cmd, message, sizeof(message));
+
+        esp_timer_stop(w->timer);
+        int expected = WORKER_RUNNING;
+        if (atomic_compare_exchange_strong(&w->state, &expected, WORKER_IDLE)) {
+            if (message[0] == '\0') {
+                strcpy(message, result == 0 ? "ok" : "failed");
+            }
+            cmd_reply(cmd.id, flags, result, message);
+        } else {
+            // 已按超时回复，等定时器回调用完job再接收下一条命令
+            ESP_LOGW(TAG, "命令%s超时后才返回(%d)，结果丢弃", cmd.name, result);
+            while (atomic_load(&w->state) != WORKER_TIMEOUT_REPLIED) {
+                vTaskDelay(1);
+            }
+            atomic_store(&w->state, WORKER_IDLE);
+        }
+    }
+}
+
+esp_err_t iot_command_init(void)
+{
+    if (cmd_queue) {
+        return ESP_OK;
+    }
+
+    cmd_queue = xQueueCreate(CONFIG_IOT_CMD_QUEUE_LEN, sizeof(cmd_job_t));
+    if (!cmd_queue) {
+        ESP_LOGE(TAG, "命令队列创建失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < CONFIG_IOT_CMD_WORKERS; i++) {
+        cmd_worker_t *w = &cmd_workers[i];
+        atomic_init(&w->state, WORKER_IDLE);
+
+        esp_timer_create_args_t timer_args = {
+            .callback = cmd_timeout_cb,
+            .arg = w,
+            .name = "iot_cmd_timeout",
+        };
+        if (esp_timer_create(&timer_args, &w->timer) != ESP_OK ||
+            xTaskCreate(cmd_worker_task, "iot_cmd", CONFIG_IOT_CMD_WORKER_STACK, w, 5,
+                        &w->task) != pdPASS) {
+            ESP_LOGE(TAG, "命令工作任务%d创建失败", i);
+            if (i > 0) {
+                // 已创建的工作任务继续使用
+                return ESP_OK;
+            }
+            vQueueDelete(cmd_queue);
+            cmd_queue = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "命令工作任务已创建: %d个, 队列%d", CONFIG_IOT_CMD_WORKERS,
+             CONFIG_IOT_CMD_QUEUE_LEN);
+    return ESP_OK;
+}
+
+/**
+ * @brief 命令消息字段
+ */
+typedef enum {
+    FIELD_NONE = 0,
+    FIELD_COMMAND,
+    FIELD_ID,
+    FIELD_PARAMS,
+} cmd_field_t;
+
+/**
+ * @brief 命令消息接收状态（只在MQTT任务中访问）
+ */
+static struct {
+    iot_json_reader_t reader;
+    char tok[CMD_ID_MAX_LEN];           ///< 记号缓冲区，能放下命令名和命令ID即可
+    cmd_field_t field;                  ///< 当前顶层键对应的字段
+    bool active;                        ///< 正在接收命令消息
+    bool is_object;                     ///< 顶层是对象
+    bool has_command_id;                ///< 已有command_id字段（优先于id）
+    bool params_overflow;               ///< params超过缓冲区
+    char name[IOT_CMD_NAME_MAX_LEN];
+} rx;
+
+/**
+ * @brief 命令消息解析回调
+ *
+ * 只关心顶层对象的command、command_id/id和params字段，
+ * params的原始文本直接捕获到dispatch_job中
+ */
+static bool cmd_rx_event(iot_json_reader_t *r, iot_json_event_t ev,
+                         const char *text, size_t len, void *ctx)
+{
+    int depth = iot_json_reader_depth(r);
+
+    if (ev == IOT_JSON_EV_OBJECT_BEGIN && depth == 1) {
+        rx.is_object = true;
+        return true;
+    }
+    if (!rx.is_object) {
+        // 顶层不是对象，不是命令消息
+        return false;
+    }
+    if (depth != 1) {
+        return true;
+    }
+
+    cmd_field_t field = rx.field;
+    rx.field = FIELD_NONE;
+
+    switch (ev) {
+    case IOT_JSON_EV_KEY:
+        if (strcmp(text, "command") == 0) {
+            rx.field = FIELD_COMMAND;
+        } else if (strcmp(text, "command_id") == 0) {
+            rx.field = FIELD_ID;
+            rx.has_command_id = true;
+        } else if (strcmp(text, "id") == 0 && !rx.has_command_id) {
+            rx.field = FIELD_ID;
+        } else if (strcmp(text, "params") == 0) {
+            rx.field = FIELD_PARAMS;
+            iot_json_reader_capture(r, dispatch_job.params, sizeof(dispatch_job.params));
+        }
+        break;
+
+    case IOT_JSON_EV_STRING:
+        if (field == FIELD_COMMAND) {
+            // 截断的命令名不可能匹配已注册的命令
+            if (!iot_json_reader_truncated(r) && len > 0 && len < sizeof(rx.name)) {
+                memcpy(rx.name, text, len + 1);
+            }
+            break;
+        }
+        /* fall through */
+    case IOT_JSON_EV_NUMBER:
+        if (field == FIELD_ID) {
+            strncpy(dispatch_job.id, text, sizeof(dispatch_job.id) - 1);
+            dispatch_job.id[sizeof(dispatch_job.id) - 1] = '\0';
+        }
+        break;
+
+    case IOT_JSON_EV_RAW:
+        if (text) {
+            dispatch_job.params_len = len;
+        } else {
+            rx.params_overflow = true;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return true;
+}
+
+void iot_command_rx_begin(void)
+{
+    memset(&rx, 0, sizeof(rx));
+    if (!cmd_queue) {
+        return;
+    }
+    rx.active = true;
+    dispatch_job.entry = NULL;
+    dispatch_job.id[0] = '\0';
+    dispatch_job.params_len = 0;
+    iot_json_reader_init(&rx.reader, rx.tok, sizeof(rx.tok), cmd_rx_event, NULL);
+}
+
+void iot_command_rx_feed(const char *data, int len)
+{
+    if (rx.active && data && len > 0) {
+        rx.active = iot_json_reader_feed(&rx.reader, data, len);
+    }
+}
+
+bool iot_command_rx_end(void)
+{
+    if (!rx.active || !iot_json_reader_finish(&rx.reader) || rx.name[0] == '\0') {
+        rx.active = false;
+        return false;
+    }
+    rx.active = false;
+
+    cmd_entry_t *entry;
+    portENTER_CRITICAL(&cmd_mux);
+    entry = cmd_lookup_locked(rx.name, strlen(rx.name));
+    if (entry && !entry->handler) {
+        entry = NULL;
+    }
+    portEXIT_CRITICAL(&cmd_mux);
+    if (!entry) {
+        return false;
+    }
+
+    cmd_job_t *job = &dispatch_job;
+    job->entry = entry;
+
+    if (rx.params_overflow) {
+        ESP_LOGW(TAG, "命令参数超过%d字节: %s", CONFIG_IOT_CMD_PARAMS_MAX_LEN, rx.name);
+        cmd_reply(job->id, entry->flags, IOT_CMD_RESULT_BAD_REQUEST, "params too long");
+        return true;
+    }
+
+    if (xQueueSend(cmd_queue, job, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "命令队列已满，拒绝命令: %s", rx.name);
+        cmd_reply(job->id, entry->flags, IOT_CMD_RESULT_BUSY, "busy");
+    }
+    return true;
+}
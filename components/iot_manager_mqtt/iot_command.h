@@ -0,0 +1,46 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 命令注册表与工作任务池（组件内部接口）
+ *
+ * 公共类型和 iot_manager_register_command() 声明在 iot_manager.h 中。
+ */
+
+#ifndef IOT_COMMAND_H
+#define IOT_COMMAND_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 创建命令队列和工作任务（只创建一次）
+ */
+esp_err_t iot_command_init(void);
+
+/**
+ * @brief 开始接收命令主题上的一条消息（在MQTT任务中调用）
+ */
+void iot_command_rx_begin(void);
+
+/**
+ * @brief 送入消息的一个分片，原地增量解析，不拷贝整条消息
+ */
+void iot_command_rx_feed(const char *data, int len);
+
+/**
+ * @brief 消息接收完毕，已注册的命令放入命令队列
+ *
+ * @return true 已注册的命令，已放入命令队列或已回复错误
+ * @return false 未注册的命令或无法识别的消息
+ */
+bool iot_command_rx_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_COMMAND_H
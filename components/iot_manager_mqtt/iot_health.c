@@ -0,0 +1,172 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 运行健康数据采样实现
+ */
+
+#include <string.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "iot_cbor_json.h"
+#include "iot_health.h"
+#include "iot_payload.h"
+
+// linux目标没有heap_caps，不输出堆信息
+#define HEALTH_HEAP_CAPS    (!CONFIG_IDF_TARGET_LINUX)
+
+#if HEALTH_HEAP_CAPS
+typedef struct {
+    const char *name;
+    uint32_t caps;
+} heap_kind_t;
+
+static const heap_kind_t heap_kinds[] = {
+    { "internal", MALLOC_CAP_INTERNAL },
+    { "dma",      MALLOC_CAP_DMA },
+#if CONFIG_SPIRAM
+    { "spiram",   MALLOC_CAP_SPIRAM },
+#endif
+};
+
+#define HEAP_KIND_COUNT     (sizeof(heap_kinds) / sizeof(heap_kinds[0]))
+#endif
+
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t stack_free;                ///< 栈剩余最小值（字节）
+} task_sample_t;
+
+typedef struct {
+#if HEALTH_HEAP_CAPS
+    multi_heap_info_t heap[HEAP_KIND_COUNT];
+#endif
+    task_sample_t tasks[IOT_HEALTH_MAX_TASKS];
+    int task_count;
+} health_sample_t;
+
+// 采样缓冲区较大，放在静态区，由health_lock保护
+static health_sample_t sample;
+#if configUSE_TRACE_FACILITY
+static TaskStatus_t task_status[IOT_HEALTH_MAX_TASKS];
+#endif
+static SemaphoreHandle_t health_lock = NULL;
+
+/**
+ * @brief 获取采样锁（首次使用时创建）
+ */
+static SemaphoreHandle_t health_lock_get(void)
+{
+    static StaticSemaphore_t lock_buf;
+    static portMUX_TYPE lock_mux = portMUX_INITIALIZER_UNLOCKED;
+
+    portENTER_CRITICAL(&lock_mux);
+    if (!health_lock) {
+        health_lock = xSemaphoreCreateMutexStatic(&lock_buf);
+    }
+    portEXIT_CRITICAL(&lock_mux);
+    return health_lock;
+}
+
+/**
+ * @brief 采样（持有health_lock时调用）
+ */
+static void health_sample(void)
+{
+#if HEALTH_HEAP_CAPS
+    for (size_t i = 0; i < HEAP_KIND_COUNT; i++) {
+        heap_caps_get_info(&sample.heap[i], heap_kinds[i].caps);
+    }
+#endif
+
+    sample.task_count = 0;
+#if configUSE_TRACE_FACILITY
+    // 任务数超过数组大小时uxTaskGetSystemState返回0，此时不输出任务列表
+    UBaseType_t n = uxTaskGetSystemState(task_status, IOT_HEALTH_MAX_TASKS, NULL);
+    for (UBaseType_t i = 0; i < n; i++) {
+        // 按栈剩余从小到大插入
+        uint32_t stack_free = task_status[i].usStackHighWaterMark;
+        int pos = sample.task_count;
+        while (pos > 0 && sample.tasks[pos - 1].stack_free > stack_free) {
+            sample.tasks[pos] = sample.tasks[pos - 1];
+            pos--;
+        }
+        strlcpy(sample.tasks[pos].name, task_status[i].pcTaskName, sizeof(sample.tasks[pos].name));
+        sample.tasks[pos].stack_free = stack_free;
+        sample.task_count++;
+    }
+#endif
+}
+
+/**
+ * @brief 采样并按 IOT_PAYLOAD_FORMAT 编码（持有health_lock时调用）
+ */
+static int health_encode(void *buf, size_t size)
+{
+    health_sample();
+
+    iot_payload_writer_t w;
+    iot_payload_init(&w, buf, size);
+    iot_payload_object_begin(&w);
+    iot_payload_kv_str(&w, "event", "health");
+    iot_payload_kv_int(&w, "timestamp", esp_timer_get_time() / 1000);
+    iot_payload_kv_uint(&w, "uptime", esp_timer_get_time() / 1000000);
+#if HEALTH_HEAP_CAPS
+    iot_payload_key(&w, "heap");
+    iot_payload_object_begin(&w);
+    for (size_t i = 0; i < HEAP_KIND_COUNT; i++) {
+        iot_payload_key(&w, heap_kinds[i].name);
+        iot_payload_array_begin(&w);
+        iot_payload_uint(&w, sample.heap[i].total_free_bytes);
+        iot_payload_uint(&w, sample.heap[i].minimum_free_bytes);
+        iot_payload_uint(&w, sample.heap[i].largest_free_block);
+        iot_payload_array_end(&w);
+    }
+    iot_payload_object_end(&w);
+#endif
+    iot_payload_key(&w, "stack");
+    iot_payload_object_begin(&w);
+    for (int i = 0; i < sample.task_count; i++) {
+        iot_payload_kv_uint(&w, sample.tasks[i].name, sample.tasks[i].stack_free);
+    }
+    iot_payload_object_end(&w);
+    iot_payload_object_end(&w);
+    return iot_payload_finish(&w);
+}
+
+int iot_health_encode(void *buf, size_t size)
+{
+    if (!buf) {
+        return -1;
+    }
+    xSemaphoreTake(health_lock_get(), portMAX_DELAY);
+    int len = health_encode(buf, size);
+    xSemaphoreGive(health_lock);
+    return len;
+}
+
+int iot_health_to_json(char *buf, size_t size)
+{
+#if CONFIG_IOT_PAYLOAD_FORMAT_CBOR
+    // 按CBOR编码后转换为JSON；CBOR不会比JSON长，缓冲区放在静态区，由health_lock保护
+    static uint8_t cbor[IOT_HEALTH_MSG_SIZE];
+
+    if (!buf) {
+        return -1;
+    }
+    xSemaphoreTake(health_lock_get(), portMAX_DELAY);
+    int len = health_encode(cbor, sizeof(cbor));
+    if (len >= 0) {
+        len = iot_cbor_to_json(cbor, len, buf, size);
+    }
+    xSemaphoreGive(health_lock);
+    return len;
+#else
+    // JSON格式时与 iot_health_encode() 相同
+    return iot_health_encode(buf, size);
+#endif
+}
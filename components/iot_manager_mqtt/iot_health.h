@@ -0,0 +1,51 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 运行健康数据采样
+ *
+ * 采集每个任务的栈剩余最小值（uxTaskGetStackHighWaterMark，字节）以及各类内存的
+ * 空闲、历史最低空闲和最大空闲块，用于根据实际运行数据调整任务栈和缓冲区大小，
+ * 最大空闲块远小于空闲总量说明堆已碎片化。
+ *
+ * 任务列表需要 CONFIG_FREERTOS_USE_TRACE_FACILITY，未开启时只有内存数据。
+ *
+ * 输出格式:
+ *     {"event":"health","timestamp":123456,"uptime":123,
+ *      "heap":{"internal":[空闲,历史最低,最大空闲块],"dma":[...]},
+ *      "stack":{"iot_pub":1220,"main":2100,...}}
+ * stack按剩余从小到大排列。
+ */
+
+#ifndef IOT_HEALTH_H
+#define IOT_HEALTH_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_HEALTH_MAX_TASKS    32      ///< 最多采集的任务数
+#define IOT_HEALTH_MSG_SIZE     (160 + IOT_HEALTH_MAX_TASKS * 28)  ///< 编码结果最大长度
+
+/**
+ * @brief 采样并按 IOT_PAYLOAD_FORMAT 编码（用于MQTT上报）
+ *
+ * @return int 长度，缓冲区不足返回-1
+ */
+int iot_health_encode(void *buf, size_t size);
+
+/**
+ * @brief 采样并编码为JSON（用于HTTP等固定使用JSON的场合）
+ *
+ * 与 iot_health_encode() 使用同一份编码，负载格式为CBOR时编码后由 iot_cbor_to_json() 转换
+ *
+ * @return int 长度（不含结尾'\0'），缓冲区不足返回-1
+ */
+int iot_health_to_json(char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_HEALTH_H
@@ -0,0 +1,520 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 增量式JSON解析器实现
+ *
+ * 逐字节的状态机，所有状态保存在解析器结构体中，因此数据可以在任意位置切分
+ * （包括字符串转义序列、数字和true/false/null的中间）。
+ */
+
+#include <string.h>
+#include "iot_json_reader.h"
+
+/**
+ * @brief 语法状态
+ */
+enum {
+    S_VALUE = 0,        ///< 等待值
+    S_VALUE_OR_END,     ///< '['之后：值或']'
+    S_KEY_OR_END,       ///< '{'之后：键名或'}'
+    S_KEY,              ///< 对象中','之后：键名
+    S_COLON,            ///< 键名之后：':'
+    S_COMMA_OR_END,     ///< 容器中的值之后：','或结束符
+    S_DONE,             ///< 顶层值已结束，只允许空白
+    S_STRING,           ///< 字符串内
+    S_ESCAPE,           ///< '\'之后
+    S_UNICODE,          ///< '\u'之后的4位十六进制
+    S_NUMBER,           ///< 数字内（sub为数字语法子状态）
+    S_LITERAL,          ///< true/false/null内（sub为已匹配字符数）
+};
+
+static const char *const literals[] = { "true", "false", "null" };
+static const iot_json_event_t literal_events[] = {
+    IOT_JSON_EV_TRUE, IOT_JSON_EV_FALSE, IOT_JSON_EV_NULL,
+};
+
+// \u转义中待配对的高代理项保存在code的高16位
+#define HI_SURROGATE(r)     ((r)->code >> 16)
+
+static void fail(iot_json_reader_t *r)
+{
+    r->error = true;
+}
+
+static void emit(iot_json_reader_t *r, iot_json_event_t ev, const char *text, size_t len)
+{
+    if (r->capturing || !r->cb) {
+        return;
+    }
+    if (!r->cb(r, ev, text, len, r->ctx)) {
+        r->stopped = true;
+    }
+}
+
+/**
+ * @brief 值中的字符写入捕获缓冲区
+ */
+static void accept(iot_json_reader_t *r, char c)
+{
+    if (!r->capturing) {
+        return;
+    }
+    if (r->cap_len + 1 >= r->cap_cap) {
+        r->cap_overflow = true;
+        return;
+    }
+    r->cap_buf[r->cap_len++] = c;
+}
+
+static void tok_reset(iot_json_reader_t *r)
+{
+    r->tok_len = 0;
+    r->tok_truncated = false;
+}
+
+static void tok_put(iot_json_reader_t *r, char c)
+{
+    if (r->capturing) {
+        return;
+    }
+    if (r->tok_len + 1 >= r->tok_cap) {
+        r->tok_truncated = true;
+        return;
+    }
+    r->tok[r->tok_len++] = c;
+}
+
+static void tok_put_utf8(iot_json_reader_t *r, uint32_t cp)
+{
+    if (cp < 0x80) {
+        tok_put(r, (char)cp);
+    } else if (cp < 0x800) {
+        tok_put(r, (char)(0xc0 | (cp >> 6)));
+        tok_put(r, (char)(0x80 | (cp & 0x3f)));
+    } else if (cp < 0x10000) {
+        tok_put(r, (char)(0xe0 | (cp >> 12)));
+        tok_put(r, (char)(0x80 | ((cp >> 6) & 0x3f)));
+        tok_put(r, (char)(0x80 | (cp & 0x3f)));
+    } else {
+        tok_put(r, (char)(0xf0 | (cp >> 18)));
+        tok_put(r, (char)(0x80 | ((cp >> 12) & 0x3f)));
+        tok_put(r, (char)(0x80 | ((cp >> 6) & 0x3f)));
+        tok_put(r, (char)(0x80 | (cp & 0x3f)));
+    }
+}
+
+/**
+ * @brief 未配对的高代理项输出为U+FFFD
+ */
+static void flush_surrogate(iot_json_reader_t *r)
+{
+    if (HI_SURROGATE(r)) {
+        tok_put_utf8(r, 0xfffd);
+        r->code = 0;
+    }
+}
+
+static const char *tok_str(iot_json_reader_t *r)
+{
+    if (r->capturing) {
+        return NULL;
+    }
+    r->tok[r->tok_len] = '\0';
+    return r->tok;
+}
+
+/**
+ * @brief 一个值开始
+ */
+static void value_begin(iot_json_reader_t *r)
+{
+    if (r->cap_pending) {
+        r->cap_pending = false;
+        r->capturing = true;
+        r->cap_depth = r->depth;
+        r->cap_len = 0;
+        r->cap_overflow = false;
+    }
+}
+
+/**
+ * @brief 一个值结束
+ */
+static void value_end(iot_json_reader_t *r)
+{
+    r->state = r->depth ? S_COMMA_OR_END : S_DONE;
+
+    if (r->capturing && r->depth == r->cap_depth) {
+        r->capturing = false;
+        r->cap_buf[r->cap_len] = '\0';
+        if (r->cap_overflow) {
+            emit(r, IOT_JSON_EV_RAW, NULL, 0);
+        } else {
+            emit(r, IOT_JSON_EV_RAW, r->cap_buf, r->cap_len);
+        }
+    }
+}
+
+static bool in_array(const iot_json_reader_t *r)
+{
+    return r->depth && (r->stack & (1u << (r->depth - 1)));
+}
+
+static void container_begin(iot_json_reader_t *r, bool array)
+{
+    if (r->depth >= IOT_JSON_READER_MAX_DEPTH) {
+        fail(r);
+        return;
+    }
+    value_begin(r);
+    accept(r, array ? '[' : '{');
+    if (array) {
+        r->stack |= 1u << r->depth;
+    } else {
+        r->stack &= ~(1u << r->depth);
+    }
+    r->depth++;
+    r->state = array ? S_VALUE_OR_END : S_KEY_OR_END;
+    emit(r, array ? IOT_JSON_EV_ARRAY_BEGIN : IOT_JSON_EV_OBJECT_BEGIN, NULL, 0);
+}
+
+static void container_end(iot_json_reader_t *r, bool array)
+{
+    if (!r->depth || in_array(r) != array) {
+        fail(r);
+        return;
+    }
+    accept(r, array ? ']' : '}');
+    r->depth--;
+    emit(r, array ? IOT_JSON_EV_ARRAY_END : IOT_JSON_EV_OBJECT_END, NULL, 0);
+    value_end(r);
+}
+
+static void string_begin(iot_json_reader_t *r, bool is_key)
+{
+    if (!is_key) {
+        value_begin(r);
+    }
+    accept(r, '"');
+    tok_reset(r);
+    r->is_key = is_key;
+    r->code = 0;
+    r->state = S_STRING;
+}
+
+/**
+ * @brief 数字语法子状态转移，返回-1表示非法
+ *
+ * 0:开始 1:'-'后 2:整数0 3:整数 4:'.'后 5:小数 6:'e'后 7:指数符号后 8:指数
+ */
+static int number_next(int s, char c)
+{
+    bool digit = (c >= '0' && c <= '9');
+    switch (s) {
+    case 0:
+        if (c == '-') return 1;
+        /* fall through */
+    case 1:
+        if (c == '0') return 2;
+        if (digit) return 3;
+        return -1;
+    case 2:
+    case 3:
+        if (s == 3 && digit) return 3;
+        if (c == '.') return 4;
+        if (c == 'e' || c == 'E') return 6;
+        return -1;
+    case 4:
+    case 5:
+        if (digit) return 5;
+        if (s == 5 && (c == 'e' || c == 'E')) return 6;
+        return -1;
+    case 6:
+        if (c == '+' || c == '-') return 7;
+        /* fall through */
+    case 7:
+    case 8:
+        if (digit) return 8;
+        return -1;
+    default:
+        return -1;
+    }
+}
+
+static bool number_complete(int s)
+{
+    return s == 2 || s == 3 || s == 5 || s == 8;
+}
+
+static bool is_number_char(char c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static void number_end(iot_json_reader_t *r)
+{
+    if (!number_complete(r->sub)) {
+        fail(r);
+        return;
+    }
+    const char *text = tok_str(r);
+    emit(r, IOT_JSON_EV_NUMBER, text, r->tok_len);
+    value_end(r);
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief 完成一个\uXXXX转义
+ */
+static void unicode_end(iot_json_reader_t *r)
+{
+    uint32_t u = r->code & 0xffff;
+    uint32_t hi = HI_SURROGATE(r);
+    r->code = 0;
+
+    if (u >= 0xd800 && u <= 0xdbff) {
+        if (hi) {
+            tok_put_utf8(r, 0xfffd);
+        }
+        r->code = u << 16;
+    } else if (u >= 0xdc00 && u <= 0xdfff) {
+        tok_put_utf8(r, hi ? 0x10000 + ((hi - 0xd800) << 10) + (u - 0xdc00) : 0xfffd);
+    } else {
+        if (hi) {
+            tok_put_utf8(r, 0xfffd);
+        }
+        tok_put_utf8(r, u);
+    }
+}
+
+/**
+ * @brief 处理一个字符
+ *
+ * @return true 字符已消费
+ * @return false 字符需要在新状态下重新处理（数字结束）
+ */
+static bool step(iot_json_reader_t *r, char c)
+{
+    bool ws = (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+
+    switch (r->state) {
+    case S_STRING:
+        if (c == '"') {
+            flush_surrogate(r);
+            accept(r, c);
+            const char *text = tok_str(r);
+            if (r->is_key) {
+                emit(r, IOT_JSON_EV_KEY, text, r->tok_len);
+                r->state = S_COLON;
+            } else {
+                emit(r, IOT_JSON_EV_STRING, text, r->tok_len);
+                value_end(r);
+            }
+        } else if (c == '\\') {
+            accept(r, c);
+            r->state = S_ESCAPE;
+        } else if ((unsigned char)c < 0x20) {
+            fail(r);
+        } else {
+            flush_surrogate(r);
+            accept(r, c);
+            tok_put(r, c);
+        }
+        return true;
+
+    case S_ESCAPE: {
+        accept(r, c);
+        if (c == 'u') {
+            r->sub = 0;
+            r->code &= 0xffff0000u;
+            r->state = S_UNICODE;
+            return true;
+        }
+        static const char from[] = "\"\\/bfnrt";
+        static const char to[] = "\"\\/\b\f\n\r\t";
+        const char *p = memchr(from, c, sizeof(from) - 1);
+        if (!p) {
+            fail(r);
+            return true;
+        }
+        flush_surrogate(r);
+        tok_put(r, to[p - from]);
+        r->state = S_STRING;
+        return true;
+    }
+
+    case S_UNICODE: {
+        int v = hex_value(c);
+        if (v < 0) {
+            fail(r);
+            return true;
+        }
+        accept(r, c);
+        r->code = (r->code & 0xffff0000u) | (((r->code & 0xffff) << 4) | (uint32_t)v);
+        if (++r->sub == 4) {
+            unicode_end(r);
+            r->state = S_STRING;
+        }
+        return true;
+    }
+
+    case S_NUMBER: {
+        if (!is_number_char(c)) {
+            number_end(r);
+            return false;
+        }
+        int next = number_next(r->sub, c);
+        if (next < 0) {
+            fail(r);
+            return true;
+        }
+        r->sub = (uint8_t)next;
+        accept(r, c);
+        tok_put(r, c);
+        return true;
+    }
+
+    case S_LITERAL: {
+        const char *lit = literals[r->code];
+        if (c != lit[r->sub]) {
+            fail(r);
+            return true;
+        }
+        accept(r, c);
+        if (lit[++r->sub] == '\0') {
+            emit(r, literal_events[r->code], NULL, 0);
+            value_end(r);
+        }
+        return true;
+    }
+
+    default:
+        break;
+    }
+
+    if (ws) {
+        return true;
+    }
+
+    switch (r->state) {
+    case S_VALUE_OR_END:
+        if (c == ']') {
+            container_end(r, true);
+            return true;
+        }
+        /* fall through */
+    case S_VALUE:
+        if (c == '{' || c == '[') {
+            container_begin(r, c == '[');
+        } else if (c == '"') {
+            string_begin(r, false);
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            value_begin(r);
+            tok_reset(r);
+            r->sub = 0;
+            r->state = S_NUMBER;
+            return false;
+        } else if (c == 't' || c == 'f' || c == 'n') {
+            value_begin(r);
+            r->code = (c == 't') ? 0 : (c == 'f') ? 1 : 2;
+            r->sub = 0;
+            r->state = S_LITERAL;
+            return false;
+        } else {
+            fail(r);
+        }
+        return true;
+
+    case S_KEY_OR_END:
+        if (c == '}') {
+            container_end(r, false);
+            return true;
+        }
+        /* fall through */
+    case S_KEY:
+        if (c == '"') {
+            string_begin(r, true);
+        } else {
+            fail(r);
+        }
+        return true;
+
+    case S_COLON:
+        if (c == ':') {
+            accept(r, c);
+            r->state = S_VALUE;
+        } else {
+            fail(r);
+        }
+        return true;
+
+    case S_COMMA_OR_END:
+        if (c == ',') {
+            accept(r, c);
+            r->state = in_array(r) ? S_VALUE : S_KEY;
+        } else if (c == ']' || c == '}') {
+            container_end(r, c == ']');
+        } else {
+            fail(r);
+        }
+        return true;
+
+    default:
+        // S_DONE：顶层值之后只允许空白
+        fail(r);
+        return true;
+    }
+}
+
+void iot_json_reader_init(iot_json_reader_t *r, char *tok, size_t tok_cap,
+                          iot_json_reader_cb_t cb, void *ctx)
+{
+    memset(r, 0, sizeof(*r));
+    r->tok = tok;
+    r->tok_cap = tok_cap;
+    r->cb = cb;
+    r->ctx = ctx;
+    r->state = S_VALUE;
+    if (!tok || tok_cap == 0) {
+        r->error = true;
+    }
+}
+
+bool iot_json_reader_feed(iot_json_reader_t *r, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len && !r->error && !r->stopped; i++) {
+        // 数字和字面量的第一个字符、数字的结束符需要在新状态下再处理一次
+        while (!step(r, data[i]) && !r->error && !r->stopped) {
+        }
+    }
+    return !r->error && !r->stopped;
+}
+
+bool iot_json_reader_finish(iot_json_reader_t *r)
+{
+    if (r->error || r->stopped) {
+        return false;
+    }
+    // 顶层为数字时，没有结束符
+    if (r->state == S_NUMBER) {
+        number_end(r);
+    }
+    return !r->error && !r->stopped && r->state == S_DONE;
+}
+
+void iot_json_reader_capture(iot_json_reader_t *r, char *buf, size_t cap)
+{
+    if (!buf || cap == 0) {
+        return;
+    }
+    r->cap_buf = buf;
+    r->cap_cap = cap;
+    r->cap_pending = true;
+}
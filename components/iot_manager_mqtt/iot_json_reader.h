@@ -0,0 +1,161 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 增量式JSON解析器（SAX风格）
+ *
+ * 数据可以分多次、在任意位置切分后送入，解析器逐字节处理，不缓存整条消息，
+ * 适合直接解析MQTT分片消息。字符串和数字通过调用者提供的小缓冲区回调，
+ * 也可以把某个值的原始JSON文本整体拷贝到指定缓冲区（见 iot_json_reader_capture()）。
+ *
+ * 只依赖C标准库，可以在主机上编译测试。
+ *
+ * 示例:
+ *     static bool on_event(iot_json_reader_t *r, iot_json_event_t ev,
+ *                          const char *text, size_t len, void *ctx)
+ *     {
+ *         if (ev == IOT_JSON_EV_KEY && iot_json_reader_depth(r) == 1) { ... }
+ *         return true;     // 返回false停止解析
+ *     }
+ *
+ *     char tok[64];
+ *     iot_json_reader_t r;
+ *     iot_json_reader_init(&r, tok, sizeof(tok), on_event, NULL);
+ *     iot_json_reader_feed(&r, part1, len1);
+ *     iot_json_reader_feed(&r, part2, len2);
+ *     bool ok = iot_json_reader_finish(&r);
+ */
+
+#ifndef IOT_JSON_READER_H
+#define IOT_JSON_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 最大嵌套深度
+#define IOT_JSON_READER_MAX_DEPTH   32
+
+/**
+ * @brief 解析事件
+ */
+typedef enum {
+    IOT_JSON_EV_OBJECT_BEGIN = 0,
+    IOT_JSON_EV_OBJECT_END,
+    IOT_JSON_EV_ARRAY_BEGIN,
+    IOT_JSON_EV_ARRAY_END,
+    IOT_JSON_EV_KEY,                ///< 对象键名（text为解码后的字符串）
+    IOT_JSON_EV_STRING,             ///< 字符串值（text为解码后的字符串）
+    IOT_JSON_EV_NUMBER,             ///< 数字（text为原始文本，可用strtod转换）
+    IOT_JSON_EV_TRUE,
+    IOT_JSON_EV_FALSE,
+    IOT_JSON_EV_NULL,
+    IOT_JSON_EV_RAW,                ///< iot_json_reader_capture() 捕获的原始文本，溢出时text为NULL
+} iot_json_event_t;
+
+typedef struct iot_json_reader iot_json_reader_t;
+
+/**
+ * @brief 事件回调
+ *
+ * KEY/STRING/NUMBER的text以'\0'结尾，超过记号缓冲区时被截断
+ * （可通过 iot_json_reader_truncated() 判断）。
+ *
+ * @return true 继续解析
+ * @return false 停止解析
+ */
+typedef bool (*iot_json_reader_cb_t)(iot_json_reader_t *r, iot_json_event_t ev,
+                                     const char *text, size_t len, void *ctx);
+
+/**
+ * @brief 解析器状态
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+struct iot_json_reader {
+    iot_json_reader_cb_t cb;        ///< 事件回调
+    void *ctx;                      ///< 回调参数
+    char *tok;                      ///< 记号缓冲区
+    size_t tok_cap;                 ///< 记号缓冲区大小（含结尾'\0'）
+    size_t tok_len;                 ///< 记号长度
+    bool tok_truncated;             ///< 记号被截断
+    uint32_t stack;                 ///< 每层容器类型（1: 数组）
+    uint8_t depth;                  ///< 当前嵌套深度
+    uint8_t state;                  ///< 语法状态
+    uint8_t sub;                    ///< 字面量已匹配字符数 / \u已读十六进制位数
+    bool is_key;                    ///< 当前字符串是键名
+    uint32_t code;                  ///< \u转义码点（含高代理项）
+    char *cap_buf;                  ///< 捕获缓冲区
+    size_t cap_cap;                 ///< 捕获缓冲区大小（含结尾'\0'）
+    size_t cap_len;                 ///< 已捕获长度
+    uint8_t cap_depth;              ///< 开始捕获时的深度
+    bool cap_pending;               ///< 下一个值需要捕获
+    bool capturing;                 ///< 正在捕获
+    bool cap_overflow;              ///< 捕获缓冲区溢出
+    bool error;                     ///< 语法错误
+    bool stopped;                   ///< 回调要求停止
+};
+
+/**
+ * @brief 初始化解析器
+ *
+ * @param r 解析器
+ * @param tok 记号缓冲区（存放键名、字符串、数字）
+ * @param tok_cap 记号缓冲区大小
+ * @param cb 事件回调
+ * @param ctx 回调参数
+ */
+void iot_json_reader_init(iot_json_reader_t *r, char *tok, size_t tok_cap,
+                          iot_json_reader_cb_t cb, void *ctx);
+
+/**
+ * @brief 送入一段数据
+ *
+ * @return true 成功
+ * @return false 语法错误或回调要求停止（之后的数据被忽略）
+ */
+bool iot_json_reader_feed(iot_json_reader_t *r, const char *data, size_t len);
+
+/**
+ * @brief 数据送入完毕
+ *
+ * @return true 解析出一个完整的JSON值
+ * @return false 数据不完整、语法错误或被回调停止
+ */
+bool iot_json_reader_finish(iot_json_reader_t *r);
+
+/**
+ * @brief 捕获下一个值的原始JSON文本
+ *
+ * 在KEY事件回调中调用。该值（包括其中嵌套的内容）不再产生事件，
+ * 结束时以IOT_JSON_EV_RAW事件返回，空白字符被去掉。
+ *
+ * @param buf 捕获缓冲区
+ * @param cap 缓冲区大小（含结尾'\0'）
+ */
+void iot_json_reader_capture(iot_json_reader_t *r, char *buf, size_t cap);
+
+/**
+ * @brief 获取当前嵌套深度（顶层对象内的键值为1）
+ */
+static inline int iot_json_reader_depth(const iot_json_reader_t *r)
+{
+    return r->depth;
+}
+
+/**
+ * @brief 当前事件的文本是否被截断
+ */
+static inline bool iot_json_reader_truncated(const iot_json_reader_t *r)
+{
+    return r->tok_truncated;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_JSON_READER_H
@@ -0,0 +1,407 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 流式JSON编码器实现
+ *
+ * 数字格式化不使用printf系列函数（newlib的浮点格式化会在内部申请内存），
+ * 浮点数保留10位有效数字，整数部分更长（1e10 ~ 1e15）时保留全部整数位。
+ */
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include "iot_json_writer.h"
+
+// 浮点数输出的有效数字位数，以及该位数的有效数字范围 [SIG_MIN, SIG_MAX)
+#define JSON_DOUBLE_DIGITS  10
+#define SIG_MIN             1000000000ULL
+#define SIG_MAX             10000000000ULL
+
+// 不超过DBL_MAX（1.7976931348623157e308）的最大有效数字
+#define SIG_DBL_MAX         1797693134ULL
+
+// 可以精确表示的10的整数次幂，常见数量级的缩放不调用pow()
+static const double pow10_exact[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+#define POW10_EXACT_MAX     22
+
+static void put(iot_json_writer_t *w, const char *s, size_t n)
+{
+    if (w->error) {
+        return;
+    }
+    // 始终为结尾'\0'保留一个字节
+    if (w->len + n >= w->cap) {
+        w->error = true;
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static void put_char(iot_json_writer_t *w, char c)
+{
+    put(w, &c, 1);
+}
+
+/**
+ * @brief 写入值之前的分隔符处理
+ */
+static void before_value(iot_json_writer_t *w)
+{
+    if (w->after_key) {
+        w->after_key = false;
+        return;
+    }
+    uint32_t bit = 1u << w->depth;
+    if (w->has_items & bit) {
+        put_char(w, ',');
+    }
+    w->has_items |= bit;
+}
+
+/**
+ * @brief 无符号整数转十进制，返回位数（逆序写入tmp尾部）
+ */
+static size_t format_u64(uint64_t v, char *end)
+{
+    char *p = end;
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    return (size_t)(end - p);
+}
+
+static void put_u64(iot_json_writer_t *w, uint64_t v)
+{
+    char tmp[20];
+    size_t n = format_u64(v, tmp + sizeof(tmp));
+    put(w, tmp + sizeof(tmp) - n, n);
+}
+
+/**
+ * @brief 把正数v舍入为 JSON_DOUBLE_DIGITS 位有效数字
+ *
+ * @param[out] exp10 最高位的十进制指数
+ * @return uint64_t 有效数字m，v ≈ m * 10^(exp10 - JSON_DOUBLE_DIGITS + 1)，m在 [SIG_MIN, SIG_MAX)
+ */
+static uint64_t round_significand(double v, int *exp10)
+{
+    int e = (int)floor(log10(v));
+    int k = JSON_DOUBLE_DIGITS - 1 - e;
+    double scaled;
+    if (k >= 0 && k <= POW10_EXACT_MAX) {
+        scaled = v * pow10_exact[k];
+    } else if (k < 0 && k >= -POW10_EXACT_MAX) {
+        scaled = v / pow10_exact[-k];
+    } else if (k > 300) {
+        // 分两步缩放，避免非规格化数时 10^k 上溢为无穷大
+        scaled = v * 1e300 * pow(10, k - 300);
+    } else {
+        scaled = v * pow(10, k);
+    }
+    // log10() 在10的整数次幂附近可能差1
+    if (scaled >= (double)SIG_MAX) {
+        scaled /= 10;
+        e++;
+    } else if (scaled < (double)SIG_MIN) {
+        scaled *= 10;
+        e--;
+    }
+
+    uint64_t m = (uint64_t)(scaled + 0.5);
+    if (e == DBL_MAX_10_EXP && m > SIG_DBL_MAX) {
+        // 接近DBL_MAX时向上舍入会超出范围（解析为无穷大），改为向零舍入
+        m = SIG_DBL_MAX;
+    } else if (m >= SIG_MAX) {
+        // 9.9999999995 舍入为 10.00000000，重新归一化为 1.000000000 并进位指数
+        m /= 10;
+        e++;
+    }
+    *exp10 = e;
+    return m;
+}
+
+void iot_json_init(iot_json_writer_t *w, char *buf, size_t cap)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+    if (!buf || cap == 0) {
+        w->error = true;
+    }
+}
+
+int iot_json_finish(iot_json_writer_t *w)
+{
+    if (w->error || w->depth != 0 || w->after_key) {
+        if (w->buf && w->cap) {
+            w->buf[0] = '\0';
+        }
+        return -1;
+    }
+    w->buf[w->len] = '\0';
+    return (int)w->len;
+}
+
+static void container_begin(iot_json_writer_t *w, char c)
+{
+    before_value(w);
+    if (w->depth + 1 >= IOT_JSON_MAX_DEPTH) {
+        w->error = true;
+        return;
+    }
+    put_char(w, c);
+    w->depth++;
+    w->has_items &= ~(1u << w->depth);
+}
+
+static void container_end(iot_json_writer_t *w, char c)
+{
+    if (w->depth == 0 || w->after_key) {
+        w->error = true;
+        return;
+    }
+    put_char(w, c);
+    w->depth--;
+}
+
+void iot_json_object_begin(iot_json_writer_t *w)
+{
+    container_begin(w, '{');
+}
+
+void iot_json_object_end(iot_json_writer_t *w)
+{
+    container_end(w, '}');
+}
+
+void iot_json_array_begin(iot_json_writer_t *w)
+{
+    container_begin(w, '[');
+}
+
+void iot_json_array_end(iot_json_writer_t *w)
+{
+    container_end(w, ']');
+}
+
+/**
+ * @brief 写入带引号并转义的字符串
+ */
+static void put_escaped(iot_json_writer_t *w, const char *s, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    put_char(w, '"');
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        // 先整段拷贝无需转义的部分
+        put(w, s + start, i - start);
+        start = i + 1;
+
+        char esc[6] = { '\\', 0 };
+        size_t n = 2;
+        switch (c) {
+        case '"':  esc[1] = '"';  break;
+        case '\\': esc[1] = '\\'; break;
+        case '\b': esc[1] = 'b';  break;
+        case '\f': esc[1] = 'f';  break;
+        case '\n': esc[1] = 'n';  break;
+        case '\r': esc[1] = 'r';  break;
+        case '\t': esc[1] = 't';  break;
+        default:
+            esc[1] = 'u';
+            esc[2] = '0';
+            esc[3] = '0';
+            esc[4] = hex[c >> 4];
+            esc[5] = hex[c & 0x0f];
+            n = 6;
+            break;
+        }
+        put(w, esc, n);
+    }
+    put(w, s + start, len - start);
+    put_char(w, '"');
+}
+
+void iot_json_key(iot_json_writer_t *w, const char *key)
+{
+    iot_json_key_n(w, key, strlen(key));
+}
+
+void iot_json_key_n(iot_json_writer_t *w, const char *key, size_t len)
+{
+    if (w->depth == 0 || w->after_key) {
+        w->error = true;
+        return;
+    }
+    before_value(w);
+    put_escaped(w, key, len);
+    put_char(w, ':');
+    w->after_key = true;
+}
+
+void iot_json_str(iot_json_writer_t *w, const char *value)
+{
+    if (!value) {
+        iot_json_null(w);
+        return;
+    }
+    iot_json_str_n(w, value, strlen(value));
+}
+
+void iot_json_str_n(iot_json_writer_t *w, const char *value, size_t len)
+{
+    before_value(w);
+    put_escaped(w, value, len);
+}
+
+void iot_json_int(iot_json_writer_t *w, int64_t value)
+{
+    before_value(w);
+    if (value < 0) {
+        put_char(w, '-');
+        put_u64(w, (uint64_t)0 - (uint64_t)value);
+    } else {
+        put_u64(w, (uint64_t)value);
+    }
+}
+
+void iot_json_uint(iot_json_writer_t *w, uint64_t value)
+{
+    before_value(w);
+    put_u64(w, value);
+}
+
+void iot_json_double(iot_json_writer_t *w, double value)
+{
+    // JSON不支持NaN和无穷大
+    if (isnan(value) || isinf(value)) {
+        iot_json_null(w);
+        return;
+    }
+
+    before_value(w);
+    if (value < 0) {
+        put_char(w, '-');
+        value = -value;
+    }
+    if (value == 0) {
+        put_char(w, '0');
+        return;
+    }
+
+    int exp10;
+    uint64_t m = round_significand(value, &exp10);
+
+    // 整数部分超过有效数字位数时按整数输出，不丢失整数位（如毫秒时间戳）
+    if (exp10 >= JSON_DOUBLE_DIGITS && exp10 < 15) {
+        put_u64(w, (uint64_t)(value + 0.5));
+        return;
+    }
+
+    char digits[JSON_DOUBLE_DIGITS];
+    format_u64(m, digits + JSON_DOUBLE_DIGITS);
+    int nd = JSON_DOUBLE_DIGITS;
+    while (nd > 1 && digits[nd - 1] == '0') {
+        nd--;
+    }
+
+    if (exp10 >= -4 && exp10 < 15) {
+        if (exp10 < 0) {
+            // 0.000ddd
+            put(w, "0.", 2);
+            for (int i = exp10 + 1; i < 0; i++) {
+                put_char(w, '0');
+            }
+            put(w, digits, nd);
+            return;
+        }
+        int int_digits = exp10 + 1;
+        if (nd <= int_digits) {
+            put(w, digits, nd);
+            for (int i = nd; i < int_digits; i++) {
+                put_char(w, '0');
+            }
+        } else {
+            put(w, digits, int_digits);
+            put_char(w, '.');
+            put(w, digits + int_digits, nd - int_digits);
+        }
+        return;
+    }
+
+    // 科学计数法 d.ddde[-]x
+    put_char(w, digits[0]);
+    if (nd > 1) {
+        put_char(w, '.');
+        put(w, digits + 1, nd - 1);
+    }
+    put_char(w, 'e');
+    if (exp10 < 0) {
+        put_char(w, '-');
+        exp10 = -exp10;
+    }
+    put_u64(w, (uint64_t)exp10);
+}
+
+void iot_json_bool(iot_json_writer_t *w, bool value)
+{
+    before_value(w);
+    if (value) {
+        put(w, "true", 4);
+    } else {
+        put(w, "false", 5);
+    }
+}
+
+void iot_json_null(iot_json_writer_t *w)
+{
+    before_value(w);
+    put(w, "null", 4);
+}
+
+void iot_json_raw(iot_json_writer_t *w, const char *json, size_t len)
+{
+    before_value(w);
+    put(w, json, len);
+}
+
+void iot_json_kv_str(iot_json_writer_t *w, const char *key, const char *value)
+{
+    iot_json_key(w, key);
+    iot_json_str(w, value);
+}
+
+void iot_json_kv_int(iot_json_writer_t *w, const char *key, int64_t value)
+{
+    iot_json_key(w, key);
+    iot_json_int(w, value);
+}
+
+void iot_json_kv_uint(iot_json_writer_t *w, const char *key, uint64_t value)
+{
+    iot_json_key(w, key);
+    iot_json_uint(w, value);
+}
+
+void iot_json_kv_double(iot_json_writer_t *w, const char *key, double value)
+{
+    iot_json_key(w, key);
+    iot_json_double(w, value);
+}
+
+void iot_json_kv_bool(iot_json_writer_t *w, const char *key, bool value)
+{
+    iot_json_key(w, key);
+    iot_json_bool(w, value);
+}
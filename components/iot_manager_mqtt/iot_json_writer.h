@@ -0,0 +1,100 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 流式JSON编码器
+ *
+ * 直接把JSON写入调用者提供的缓冲区，不分配堆内存，正确转义字符串。
+ * 缓冲区不足时置溢出标志，后续写入全部忽略，由 iot_json_finish() 统一报告。
+ *
+ * 示例:
+ *     char buf[128];
+ *     iot_json_writer_t w;
+ *     iot_json_init(&w, buf, sizeof(buf));
+ *     iot_json_object_begin(&w);
+ *     iot_json_kv_str(&w, "device_id", "ESP32_001");
+ *     iot_json_kv_int(&w, "uptime", 3600);
+ *     iot_json_object_end(&w);
+ *     int len = iot_json_finish(&w);   // buf: {"device_id":"ESP32_001","uptime":3600}
+ */
+
+#ifndef IOT_JSON_WRITER_H
+#define IOT_JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 最大嵌套深度
+#define IOT_JSON_MAX_DEPTH  16
+
+/**
+ * @brief JSON编码器状态
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    char *buf;                  ///< 输出缓冲区
+    size_t cap;                 ///< 缓冲区大小（含结尾'\0'）
+    size_t len;                 ///< 已写入长度
+    uint32_t has_items;         ///< 每层是否已有元素（需要先写','）
+    uint8_t depth;              ///< 当前嵌套深度
+    bool after_key;             ///< 刚写完键名，等待值
+    bool error;                 ///< 缓冲区溢出或调用顺序错误
+} iot_json_writer_t;
+
+/**
+ * @brief 初始化编码器
+ *
+ * @param w 编码器
+ * @param buf 输出缓冲区
+ * @param cap 缓冲区大小
+ */
+void iot_json_init(iot_json_writer_t *w, char *buf, size_t cap);
+
+/**
+ * @brief 结束编码
+ *
+ * @return int 输出长度（不含'\0'），溢出或对象/数组未闭合返回-1
+ */
+int iot_json_finish(iot_json_writer_t *w);
+
+void iot_json_object_begin(iot_json_writer_t *w);
+void iot_json_object_end(iot_json_writer_t *w);
+void iot_json_array_begin(iot_json_writer_t *w);
+void iot_json_array_end(iot_json_writer_t *w);
+
+/**
+ * @brief 写入对象键名
+ */
+void iot_json_key(iot_json_writer_t *w, const char *key);
+void iot_json_key_n(iot_json_writer_t *w, const char *key, size_t len);
+
+void iot_json_str(iot_json_writer_t *w, const char *value);
+void iot_json_str_n(iot_json_writer_t *w, const char *value, size_t len);
+void iot_json_int(iot_json_writer_t *w, int64_t value);
+void iot_json_uint(iot_json_writer_t *w, uint64_t value);
+void iot_json_double(iot_json_writer_t *w, double value);
+void iot_json_bool(iot_json_writer_t *w, bool value);
+void iot_json_null(iot_json_writer_t *w);
+
+/**
+ * @brief 写入一段已编码好的JSON值（原样拷贝，不做校验）
+ */
+void iot_json_raw(iot_json_writer_t *w, const char *json, size_t len);
+
+// 键值对便捷函数
+void iot_json_kv_str(iot_json_writer_t *w, const char *key, const char *value);
+void iot_json_kv_int(iot_json_writer_t *w, const char *key, int64_t value);
+void iot_json_kv_uint(iot_json_writer_t *w, const char *key, uint64_t value);
+void iot_json_kv_double(iot_json_writer_t *w, const char *key, double value);
+void iot_json_kv_bool(iot_json_writer_t *w, const char *key, bool value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_JSON_WRITER_H
@@ -2,71 +2,1310 @@
  * @Author: xingnian j_xingnian@163.com
  * @Date: 2025-11-10
  * @Description: IoT管理组件实现 - MQTT通信模块
+ *
+ * 发送路径：各任务调用发布接口时只把消息写入无锁MPSC发送队列，
+ * 由唯一的发布任务取出后发布。离线缓存和批量缓冲只在发布任务中访问，无需加锁。
  */
 
 #include <stdio.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "esp_system.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "mqtt_client.h"
 #include "iot_manager.h"
+#include "iot_offline_queue.h"
+#include "iot_payload.h"
+#include "iot_mpsc_queue.h"
+#include "iot_command.h"
+#include "iot_topic_router.h"
+#include "iot_stats.h"
+#include "iot_reconnect.h"
+#include "iot_boot.h"
+#include "iot_slab.h"
+#include "iot_health.h"
 
 static const char *TAG = "IOT_MANAGER";
 
+ESP_EVENT_DEFINE_BASE(IOT_MANAGER_EVENT);
+
+// 主题最大长度
+#define IOT_TOPIC_MAX_LEN   128
+
 // MQTT客户端句柄
 static esp_mqtt_client_handle_t mqtt_client = NULL;
 
-// 配置信息
-static iot_manager_config_t manager_config = {0};
+// 保护mqtt_client的创建和销毁，发布任务使用客户端期间持有
+static SemaphoreHandle_t client_lock = NULL;
+
+// 配置信息
+static iot_manager_config_t manager_config = {0};
+
+// 连接状态
+static bool is_connected = false;
+
+// 上线消息大小，首次连接时包含启动阶段时间
+#define ONLINE_MSG_SIZE     (160 + IOT_BOOT_MAX_STAGES * 28)
+
+// 用户数据回调函数
+static iot_mqtt_data_callback_t user_data_callback = NULL;
+
+// 正在接收的消息（可能分片）是否为命令消息
+static bool rx_is_command = false;
+
+// 一条消息最多交给几个订阅处理函数
+#define IOT_ROUTE_MAX_MATCHES   8
+
+// 订阅处理函数，连接成功后按route_list重新订阅
+typedef struct iot_route {
+    struct iot_route *next;
+    iot_topic_handler_t handler;
+    void *ctx;
+    int qos;
+    char filter[];
+} iot_route_t;
+
+// route_lock保护topic_router和route_list
+static SemaphoreHandle_t route_lock = NULL;
+static iot_topic_router_t *topic_router = NULL;
+static iot_route_t *route_list = NULL;
+
+// 正在接收的消息匹配到的处理函数（MQTT任务专用，拷贝后不再持锁调用）
+typedef struct {
+    iot_topic_handler_t handler;
+    void *ctx;
+} rx_route_t;
+static rx_route_t rx_routes[IOT_ROUTE_MAX_MATCHES];
+static int rx_route_count = 0;
+
+// 初始化时生成的主题（之后只读，可在任意任务中使用）
+static char class_topics[IOT_MSG_CLASS_MAX][IOT_TOPIC_MAX_LEN];
+static char command_topic[IOT_TOPIC_MAX_LEN];
+
+// 发送队列：任意任务写入，发布任务读取
+static iot_mpsc_queue_t tx_queue;
+static bool tx_queue_ready = false;
+
+// 发布任务
+static TaskHandle_t publisher_task_handle = NULL;
+
+// 已完成首次发布（只在发布任务中访问）
+static bool first_published = false;
+
+// 发布任务即将休眠，生产者提交后需要通知
+static atomic_bool publisher_waiting = false;
+
+// 等待发布任务处理完同步消息
+static SemaphoreHandle_t tx_sync_sem = NULL;
+
+#if CONFIG_IOT_TX_LARGE_BLOCKS > 0
+// 放不进槽位的消息使用的固定内存块，避免短生命周期的大块分配造成堆碎片
+static iot_slab_t tx_large;
+static bool tx_large_ready = false;
+#endif
+static atomic_uint tx_large_heap = 0;   ///< 回退到堆的次数
+
+// 发布任务通知位
+#define TX_NOTIFY_QUEUE     (1 << 0)   ///< 发送队列有新消息
+#define TX_NOTIFY_DRAIN     (1 << 1)   ///< 补发离线缓存
+#define TX_NOTIFY_STATS     (1 << 2)   ///< 立即上报统计
+#define TX_NOTIFY_LINK      (1 << 3)   ///< MQTT断开或WiFi恢复，安排重连
+#define TX_NOTIFY_RECONNECT (1 << 4)   ///< 退避时间到，重新连接
+#define TX_NOTIFY_HEALTH    (1 << 5)   ///< 立即上报健康数据
+
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+/*
+ * MQTT断开后由发布任务停止客户端，按iot_reconnect的退避时间重新启动；
+ * WiFi断开期间不尝试，WiFi恢复后重新安排。esp-mqtt自带的固定间隔重连只作后备。
+ */
+static esp_timer_handle_t reconnect_timer = NULL;
+static atomic_bool mqtt_dropped = false;        ///< 收到DISCONNECTED，客户端尚未停止
+static atomic_bool reconnect_waiting = false;   ///< 客户端已停止，等待重连（持有client_lock时修改）
+#endif
+
+/*
+ * 发送队列消息标记（slot->tag）：
+ *   [0..3]   消息类别
+ *   [4..5]   负载格式（TX_FMT_*）
+ *   [8..9]   QoS
+ *   [10]     retain
+ *   [11]     数据在堆上，槽位中只存指针
+ *   [12]     批量上报样本
+ *   [13]     刷新批量缓冲
+ *   [14]     处理完成后释放tx_sync_sem
+ *   [15]     已取消（编码失败），直接丢弃
+ *   [16..31] 自定义主题长度，0表示使用类别主题
+ *
+ * 数据布局：[主题'\0'] 数据'\0'，slot->len为整段长度
+ */
+#define TX_TAG_CLASS(tag)   ((tag) & 0x0f)
+#define TX_TAG_FMT(tag)     (((tag) >> 4) & 0x03)
+#define TX_TAG_FMT_SET(f)   (((uint32_t)(f) & 0x03) << 4)
+#define TX_TAG_QOS(tag)     (((tag) >> 8) & 0x03)
+#define TX_TAG_QOS_SET(q)   (((uint32_t)(q) & 0x03) << 8)
+#define TX_FLAG_RETAIN      (1u << 10)
+#define TX_FLAG_HEAP        (1u << 11)
+#define TX_FLAG_SAMPLE      (1u << 12)
+#define TX_FLAG_FLUSH       (1u << 13)
+#define TX_FLAG_SYNC        (1u << 14)
+#define TX_FLAG_CANCEL      (1u << 15)
+#define TX_TAG_TOPIC_SHIFT  16
+#define TX_TOPIC_LEN_MAX    0xffff
+
+// 负载格式，MQTT5下决定content-type属性
+#define TX_FMT_NONE         0   ///< 未知（自定义发布），不设置content-type
+#define TX_FMT_JSON         1
+#define TX_FMT_CBOR         2
+#define TX_FMT_TSZ          3   ///< 压缩时间序列（iot_tsz.h），不参与批量合并
+
+// 组件自身消息（上线状态、命令响应）的格式
+#if CONFIG_IOT_PAYLOAD_FORMAT_CBOR
+#define TX_FMT_DEFAULT      TX_FMT_CBOR
+#else
+#define TX_FMT_DEFAULT      TX_FMT_JSON
+#endif
+
+// CBOR不定长数组的开始和结束字节（批量上报）
+#define CBOR_ARRAY_BEGIN    0x9F
+#define CBOR_BREAK          0xFF
+
+// 每轮最多补发的离线消息数，避免补发期间新消息等待过久
+#define OFFLINE_DRAIN_BURST 8
+
+// 连接正常但补发失败（如esp-mqtt发件箱已满）时的重试间隔
+#define OFFLINE_DRAIN_RETRY_MS  500
+
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+// 离线缓存（断线期间暂存消息，重连后按顺序补发）
+static iot_offline_queue_t offline_queue;
+static bool offline_ready = false;
+
+// 离线缓存待补发，以及补发失败后下次重试的时间（只在发布任务中访问）
+static bool drain_pending = false;
+static int64_t drain_retry_us = 0;
+
+// 各类消息的离线缓存策略
+static iot_offline_policy_t offline_policy[IOT_MSG_CLASS_MAX] = {
+    [IOT_MSG_CLASS_CUSTOM]   = IOT_OFFLINE_DROP_OLDEST,
+    [IOT_MSG_CLASS_STATUS]   = IOT_OFFLINE_NO_BUFFER,
+    [IOT_MSG_CLASS_PROPERTY] = IOT_OFFLINE_DROP_OLDEST,
+    [IOT_MSG_CLASS_REPLY]    = IOT_OFFLINE_DROP_OLDEST,
+    [IOT_MSG_CLASS_EVENT]    = IOT_OFFLINE_DROP_OLDEST,
+};
+#endif
+
+#if CONFIG_IOT_BATCH_ENABLE
+// 属性批量缓冲：多个样本合并为一个数组上报（JSON: [{...},{...}]，CBOR: 0x9F ... 0xFF）
+static char *batch_buf = NULL;
+static size_t batch_len = 0;
+static int batch_count = 0;
+static int64_t batch_deadline_us = 0;
+static uint8_t batch_format = TX_FMT_JSON;
+#endif
+
+/**
+ * @brief 记录错误信息
+ */
+static void log_error_if_nonzero(const char *message, int error_code)
+{
+    if (error_code != 0) {
+        ESP_LOGE(TAG, "Last error %s: 0x%x", message, error_code);
+    }
+}
+
+#if CONFIG_IOT_MQTT_PROTOCOL_V5
+#define USER_PROPERTY_MAX   8
+
+/**
+ * @brief 打印MQTT5用户属性
+ */
+static void print_user_property(mqtt5_user_property_handle_t user_property)
+{
+    if (user_property) {
+        uint8_t count = esp_mqtt5_client_get_user_property_count(user_property);
+        if (count) {
+            // 只打印前USER_PROPERTY_MAX个，数组放在栈上
+            esp_mqtt5_user_property_item_t item[USER_PROPERTY_MAX];
+            if (count > USER_PROPERTY_MAX) {
+                count = USER_PROPERTY_MAX;
+            }
+            if (esp_mqtt5_client_get_user_property(user_property, item, &count) == ESP_OK) {
+                for (int i = 0; i < count; i++) {
+                    esp_mqtt5_user_property_item_t *t = &item[i];
+                    ESP_LOGI(TAG, "User property: %s = %s", t->key, t->value);
+                    // 键值由esp-mqtt复制，需要释放
+                    free((char *)t->key);
+                    free((char *)t->value);
+                }
+            }
+        }
+    }
+}
+#endif
+
+#if CONFIG_IOT_MQTT_PROTOCOL_V5
+static const char *const content_types[] = {
+    [TX_FMT_NONE] = NULL,
+    [TX_FMT_JSON] = "application/json",
+    [TX_FMT_CBOR] = "application/cbor",
+    [TX_FMT_TSZ]  = "application/x-iot-tsz",
+};
+
+#if CONFIG_IOT_MQTT5_TOPIC_ALIAS
+/*
+ * 主题别名：类别主题直接以类别值（1~4）作为别名。
+ * 每个连接上第一次发布带完整主题和别名以建立映射，之后的QoS0消息主题为空、只带别名。
+ * QoS1/2消息始终带完整主题：esp-mqtt重连后会重发outbox中未确认的消息，
+ * 而别名映射只在一个网络连接内有效。
+ * 以下状态只在发布任务中访问，连接序号变化时清空。
+ */
+static atomic_uint conn_seq;                ///< 每次连接成功加1（MQTT任务写）
+static unsigned alias_conn_seq = 0;         ///< 别名状态所属的连接
+static uint8_t alias_mapped = 0;            ///< 已建立映射的类别（位图）
+static uint8_t alias_rejected = 0;          ///< 超过服务器Topic Alias Maximum的类别
+static uint32_t alias_saved_bytes = 0;      ///< 本连接省去的主题字节数
+
+/**
+ * @brief 连接变化后清空别名状态
+ */
+static void alias_sync(void)
+{
+    unsigned seq = atomic_load(&conn_seq);
+    if (seq == alias_conn_seq) {
+        return;
+    }
+    if (alias_saved_bytes) {
+        ESP_LOGI(TAG, "上次连接主题别名共节省%lu字节", (unsigned long)alias_saved_bytes);
+    }
+    alias_conn_seq = seq;
+    alias_mapped = 0;
+    alias_rejected = 0;
+    alias_saved_bytes = 0;
+}
+
+/**
+ * @brief 发布成功后记录别名映射（持有client_lock时调用）
+ *
+ * @param topic 类别主题
+ * @param sent 实际发布的主题，为空表示只发送了别名
+ */
+static void alias_published(iot_msg_class_t msg_class, const char *topic, const char *sent)
+{
+    uint8_t bit = 1u << msg_class;
+    if (msg_class == IOT_MSG_CLASS_CUSTOM || (alias_rejected & bit)) {
+        return;
+    }
+    if (sent[0] == '\0') {
+        alias_saved_bytes += strlen(topic);
+    } else {
+        alias_mapped |= bit;
+    }
+}
+#endif
+
+/**
+ * @brief 设置下一条发布消息的MQTT5属性（只对下一次发布有效，持有client_lock时调用）
+ *
+ * @param msg_class 消息类别，类别主题使用主题别名
+ * @param topic 主题
+ * @param qos QoS级别
+ * @param format 负载格式，服务器据content-type识别JSON/CBOR
+ * @param expiry_sec 消息过期时间，0表示不过期
+ * @return const char* 实际发布的主题（别名已建立时为空字符串）
+ */
+static const char *set_publish_property(iot_msg_class_t msg_class, const char *topic, int qos,
+                                        uint8_t format, uint32_t expiry_sec)
+{
+    esp_mqtt5_publish_property_config_t property = {
+        .payload_format_indicator = (format == TX_FMT_JSON),
+        .message_expiry_interval = expiry_sec,
+        .content_type = content_types[format],
+    };
+
+#if CONFIG_IOT_MQTT5_TOPIC_ALIAS
+    uint8_t bit = 1u << msg_class;
+    alias_sync();
+    if (msg_class != IOT_MSG_CLASS_CUSTOM && !(alias_rejected & bit)) {
+        property.topic_alias = msg_class;
+        if (esp_mqtt5_client_set_publish_property(mqtt_client, &property) == ESP_OK) {
+            return (qos == 0 && (alias_mapped & bit)) ? "" : topic;
+        }
+        // esp-mqtt按CONNACK中的Topic Alias Maximum检查，超出的别名本连接内不再使用
+        ESP_LOGI(TAG, "服务器不支持主题别名%d，%s使用完整主题", msg_class, topic);
+        alias_rejected |= bit;
+        property.topic_alias = 0;
+    }
+#else
+    (void)msg_class;
+    (void)qos;
+#endif
+
+    if (format != TX_FMT_NONE || expiry_sec != 0) {
+        esp_mqtt5_client_set_publish_property(mqtt_client, &property);
+    }
+    return topic;
+}
+#endif
+
+/* ==================== 生产者（任意任务） ==================== */
+
+/**
+ * @brief 唤醒发布任务
+ *
+ * 发布任务在休眠前置位publisher_waiting并再次检查队列，
+ * 因此只有它真正准备休眠时才需要通知，连续发布时不产生额外开销。
+ */
+static void tx_wake(void)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_exchange(&publisher_waiting, false)) {
+        xTaskNotify(publisher_task_handle, TX_NOTIFY_QUEUE, eSetBits);
+    }
+}
+
+/**
+ * @brief 为放不进槽位的消息分配内存，优先使用固定内存块
+ */
+static void *tx_large_alloc(size_t size)
+{
+#if CONFIG_IOT_TX_LARGE_BLOCKS > 0
+    if (tx_large_ready && size <= iot_slab_block_size(&tx_large)) {
+        void *p = iot_slab_alloc(&tx_large);
+        if (p) {
+            return p;
+        }
+    }
+#endif
+    atomic_fetch_add(&tx_large_heap, 1);
+    return malloc(size);
+}
+
+static void tx_large_free(void *p)
+{
+#if CONFIG_IOT_TX_LARGE_BLOCKS > 0
+    if (tx_large_ready && iot_slab_owns(&tx_large, p)) {
+        iot_slab_free(&tx_large, p);
+        return;
+    }
+#endif
+    free(p);
+}
+
+/**
+ * @brief 预留发送队列槽位
+ */
+static iot_mpsc_slot_t *tx_reserve(void)
+{
+    if (!tx_queue_ready) {
+        ESP_LOGW(TAG, "IoT管理器未初始化，无法发布消息");
+        return NULL;
+    }
+    iot_mpsc_slot_t *slot = iot_mpsc_reserve(&tx_queue);
+    if (!slot) {
+        ESP_LOGW(TAG, "发送队列已满，丢弃消息");
+        iot_stats_dropped();
+    }
+    return slot;
+}
+
+/**
+ * @brief 提交槽位并唤醒发布任务
+ */
+static void tx_commit(iot_mpsc_slot_t *slot, uint32_t len, uint32_t tag)
+{
+    iot_mpsc_commit(&tx_queue, slot, len, tag);
+    tx_wake();
+}
+
+/**
+ * @brief 消息写入发送队列
+ *
+ * @param topic 自定义主题，NULL表示使用类别主题
+ * @param flags TX_FLAG_*
+ * @return int 0已入队，-1失败
+ */
+static int tx_enqueue(iot_msg_class_t msg_class, const char *topic,
+                      const char *data, int len, int qos, int retain, uint32_t flags)
+{
+    if (len <= 0) {
+        len = data ? strlen(data) : 0;
+    }
+
+    size_t topic_len = 0;
+    if (topic) {
+        topic_len = strlen(topic);
+        if (topic_len == 0 || topic_len > TX_TOPIC_LEN_MAX) {
+            ESP_LOGE(TAG, "主题无效");
+            return -1;
+        }
+    }
+
+    size_t need = (topic ? topic_len + 1 : 0) + (size_t)len + 1;
+    uint8_t *dst = NULL;
+
+    // 放不进槽位的消息先在大块内存（或堆）上组装，槽位中只存指针
+    if (tx_queue_ready && need > iot_mpsc_slot_size(&tx_queue)) {
+        dst = tx_large_alloc(need);
+        if (!dst) {
+            ESP_LOGE(TAG, "内存不足，丢弃消息(%d字节)", (int)need);
+            iot_stats_dropped();
+            return -1;
+        }
+        flags |= TX_FLAG_HEAP;
+    }
+
+    iot_mpsc_slot_t *slot = tx_reserve();
+    if (!slot) {
+        tx_large_free(dst);
+        return -1;
+    }
+    if (!dst) {
+        dst = slot->data;
+    } else {
+        memcpy(slot->data, &dst, sizeof(dst));
+    }
+
+    uint8_t *p = dst;
+    if (topic) {
+        memcpy(p, topic, topic_len + 1);
+        p += topic_len + 1;
+    }
+    if (len > 0) {
+        memcpy(p, data, len);
+    }
+    p[len] = '\0';
+
+    uint32_t tag = (uint32_t)msg_class | TX_TAG_QOS_SET(qos) | flags |
+                   ((uint32_t)topic_len << TX_TAG_TOPIC_SHIFT);
+    if (retain) {
+        tag |= TX_FLAG_RETAIN;
+    }
+    tx_commit(slot, need, tag);
+    return 0;
+}
+
+/* ==================== 发布任务 ==================== */
+
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+/**
+ * @brief 消息写入离线缓存
+ */
+static void offline_enqueue(iot_msg_class_t msg_class, const char *topic,
+                            const char *data, int len, int qos, int retain, uint8_t format)
+{
+    iot_oq_err_t err = iot_offline_queue_push(&offline_queue, msg_class, topic, data, len,
+                                              qos, retain, format, esp_timer_get_time() / 1000,
+                                              offline_policy[msg_class] == IOT_OFFLINE_DROP_OLDEST);
+    if (err != IOT_OQ_OK) {
+        ESP_LOGW(TAG, "离线缓存写入失败(%d)，丢弃消息: %s", err, topic);
+        return;
+    }
+    ESP_LOGD(TAG, "消息已离线缓存: %s (共%lu条)", topic,
+             (unsigned long)iot_offline_queue_count(&offline_queue));
+}
+
+/**
+ * @brief 连接正常但发送失败，稍后重试补发
+ *
+ * 缓存非空时新消息都排在缓存末尾，不能等到下次连接才补发
+ */
+static void offline_retry_later(void)
+{
+    drain_pending = true;
+    drain_retry_us = esp_timer_get_time() + OFFLINE_DRAIN_RETRY_MS * 1000LL;
+}
+
+/**
+ * @brief 按顺序补发离线缓存中的消息
+ *
+ * @return true 还有消息待补发，需要继续（发送失败时在 drain_retry_us 之后）
+ * @return false 已补发完或连接已断开，等待下次连接
+ */
+static bool offline_drain(void)
+{
+    int sent = 0;
+    int expired = 0;
+    bool more = false;
+
+    drain_retry_us = 0;
+    xSemaphoreTake(client_lock, portMAX_DELAY);
+    while (is_connected && mqtt_client) {
+        iot_oq_record_t rec;
+        if (!iot_offline_queue_peek(&offline_queue, &rec)) {
+            break;
+        }
+        if (sent >= OFFLINE_DRAIN_BURST) {
+            more = true;
+            break;
+        }
+
+        uint32_t expiry_sec __attribute__((unused)) = 0;
+#if CONFIG_IOT_OFFLINE_MSG_EXPIRY_SEC > 0
+        int64_t age_ms = esp_timer_get_time() / 1000 - rec.enqueue_ms;
+        if (age_ms >= CONFIG_IOT_OFFLINE_MSG_EXPIRY_SEC * 1000LL) {
+            iot_offline_queue_pop(&offline_queue);
+            iot_stats_dropped();
+            expired++;
+            continue;
+        }
+        expiry_sec = CONFIG_IOT_OFFLINE_MSG_EXPIRY_SEC - age_ms / 1000;
+#endif
+#if CONFIG_IOT_MQTT_PROTOCOL_V5
+        // 剩余有效期通过MQTT5消息过期属性告知服务器
+        const char *topic = set_publish_property(rec.msg_class, rec.topic, rec.qos,
+                                                 rec.format, expiry_sec);
+#else
+        const char *topic = rec.topic;
+#endif
+
+        int64_t start_us = esp_timer_get_time();
+        int msg_id = esp_mqtt_client_publish(mqtt_client, topic, rec.data,
+                                             rec.data_len, rec.qos, rec.retain);
+        if (msg_id < 0) {
+            // 保留在缓存中；连接仍在时稍后重试，否则等待下次连接
+            if (is_connected) {
+                ESP_LOGW(TAG, "离线消息补发失败，%dms后重试", OFFLINE_DRAIN_RETRY_MS);
+                drain_retry_us = esp_timer_get_time() + OFFLINE_DRAIN_RETRY_MS * 1000LL;
+                more = true;
+            } else {
+                ESP_LOGW(TAG, "离线消息补发失败，等待下次连接");
+            }
+            break;
+        }
+#if CONFIG_IOT_MQTT5_TOPIC_ALIAS
+        alias_published(rec.msg_class, rec.topic, topic);
+#endif
+        iot_stats_published(rec.msg_class, strlen(topic) + rec.data_len, msg_id, start_us);
+        iot_stats_retried();
+        iot_offline_queue_pop(&offline_queue);
+        sent++;
+    }
+    xSemaphoreGive(client_lock);
+
+    if (sent || expired) {
+        ESP_LOGI(TAG, "离线消息补发: 发送%d条, 过期%d条, 剩余%lu条", sent, expired,
+                 (unsigned long)iot_offline_queue_count(&offline_queue));
+    }
+    return more;
+}
+#endif
+
+/**
+ * @brief 按类别发布消息（仅在发布任务中调用）
+ */
+static void publish_classed(iot_msg_class_t msg_class, const char *topic,
+                            const char *data, int len, int qos, int retain, uint8_t format)
+{
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+    bool buffered = offline_ready && offline_policy[msg_class] != IOT_OFFLINE_NO_BUFFER;
+
+    // 断线或仍有离线消息未补发时，新消息排在缓存末尾以保证顺序
+    if (buffered && (!is_connected || iot_offline_queue_count(&offline_queue) > 0)) {
+        offline_enqueue(msg_class, topic, data, len, qos, retain, format);
+        return;
+    }
+#endif
+
+    xSemaphoreTake(client_lock, portMAX_DELAY);
+    int msg_id = -1;
+    if (mqtt_client && is_connected) {
+#if CONFIG_IOT_MQTT_PROTOCOL_V5
+        const char *pub_topic = set_publish_property(msg_class, topic, qos, format, 0);
+#else
+        const char *pub_topic = topic;
+#endif
+        int64_t start_us = esp_timer_get_time();
+        msg_id = esp_mqtt_client_publish(mqtt_client, pub_topic, data, len, qos, retain);
+        if (msg_id >= 0) {
+#if CONFIG_IOT_MQTT5_TOPIC_ALIAS
+            alias_published(msg_class, topic, pub_topic);
+#endif
+            iot_stats_published(msg_class, strlen(pub_topic) + len, msg_id, start_us);
+        }
+    }
+    xSemaphoreGive(client_lock);
+
+    if (msg_id >= 0) {
+        ESP_LOGD(TAG, "发布消息到 %s, msg_id=%d", topic, msg_id);
+        if (!first_published) {
+            first_published = true;
+            iot_boot_mark("first_publish");
+            iot_boot_complete();
+        }
+        return;
+    }
+
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+    // 发布时恰好断线或发送失败，转入离线缓存
+    if (buffered) {
+        offline_enqueue(msg_class, topic, data, len, qos, retain, format);
+        if (is_connected) {
+            offline_retry_later();
+        }
+        return;
+    }
+#endif
+    ESP_LOGW(TAG, "MQTT未连接或发布失败，丢弃消息: %s", topic);
+    iot_stats_dropped();
+}
+
+#if CONFIG_IOT_BATCH_ENABLE
+/**
+ * @brief 发送批量缓冲中的样本
+ */
+static void batch_flush(void)
+{
+    if (batch_count == 0) {
+        return;
+    }
+
+    batch_buf[batch_len++] = batch_format == TX_FMT_CBOR ? (char)CBOR_BREAK : ']';
+    ESP_LOGD(TAG, "批量上报%d个样本, %d字节", batch_count, (int)batch_len);
+    publish_classed(IOT_MSG_CLASS_PROPERTY, class_topics[IOT_MSG_CLASS_PROPERTY],
+                    batch_buf, batch_len, CONFIG_IOT_PROPERTY_QOS, 0, batch_format);
+
+    batch_len = 0;
+    batch_count = 0;
+    batch_deadline_us = 0;
+}
+
+/**
+ * @brief 样本加入批量缓冲
+ */
+static void batch_add(const char *data, size_t len, uint8_t format)
+{
+    // 单个样本放不进批量缓冲（含数组开始和结束），直接单独上报
+    if (len + 2 > CONFIG_IOT_BATCH_MAX_BYTES) {
+        ESP_LOGW(TAG, "样本过大(%d字节)，直接上报", (int)len);
+        publish_classed(IOT_MSG_CLASS_PROPERTY, class_topics[IOT_MSG_CLASS_PROPERTY],
+                        data, len, CONFIG_IOT_PROPERTY_QOS, 0, format);
+        return;
+    }
+
+    // 格式变化或加入后超过大小阈值，先把已有样本发出去（预留','和']'）
+    if (batch_count && (format != batch_format ||
+                        batch_len + 1 + len + 1 > CONFIG_IOT_BATCH_MAX_BYTES)) {
+        batch_flush();
+    }
+
+    if (batch_count == 0) {
+        batch_deadline_us = esp_timer_get_time() + CONFIG_IOT_BATCH_MAX_LATENCY_MS * 1000LL;
+        batch_format = format;
+        batch_buf[batch_len++] = format == TX_FMT_CBOR ? (char)CBOR_ARRAY_BEGIN : '[';
+    } else if (format != TX_FMT_CBOR) {
+        batch_buf[batch_len++] = ',';
+    }
+    memcpy(batch_buf + batch_len, data, len);
+    batch_len += len;
+    batch_count++;
+
+    if (batch_count >= CONFIG_IOT_BATCH_MAX_SAMPLES) {
+        batch_flush();
+    }
+}
+
+/**
+ * @brief 超过最大延迟时刷新批量缓冲
+ */
+static void batch_flush_if_due(void)
+{
+    if (batch_count && esp_timer_get_time() >= batch_deadline_us) {
+        batch_flush();
+    }
+}
+#endif
+
+/**
+ * @brief 写入uint32数组
+ */
+static void stats_put_array(iot_payload_writer_t *w, const char *key,
+                            const uint32_t *values, size_t count, size_t stride)
+{
+    iot_payload_key(w, key);
+    iot_payload_array_begin(w);
+    for (size_t i = 0; i < count; i++) {
+        iot_payload_uint(w, *(const uint32_t *)((const uint8_t *)values + i * stride));
+    }
+    iot_payload_array_end(w);
+}
+
+/**
+ * @brief 写入链路重连统计 [断开次数, 恢复次数, 最近恢复用时ms, 最长ms, 总和ms]
+ */
+static void stats_put_reconnect(iot_payload_writer_t *w, const char *key, iot_link_t link)
+{
+    iot_reconnect_stats_t rs;
+    iot_reconnect_get_stats(link, &rs);
+    iot_payload_key(w, key);
+    iot_payload_array_begin(w);
+    iot_payload_uint(w, rs.outages);
+    iot_payload_uint(w, rs.recoveries);
+    iot_payload_uint(w, rs.last_ms);
+    iot_payload_uint(w, rs.max_ms);
+    iot_payload_uint(w, rs.total_ms);
+    iot_payload_array_end(w);
+}
+
+/**
+ * @brief 在事件主题上报发布统计
+ *
+ * 计数均为启动以来的累计值，由后台按timestamp计算速率。数组按消息类别
+ * （自定义/状态/属性/响应/事件）和延迟直方图桶排列。
+ */
+static void stats_report(void)
+{
+    // 断线期间的统计没有时效性，不进入离线缓存
+    if (!is_connected) {
+        return;
+    }
+    int64_t now_us = esp_timer_get_time();
+
+    iot_manager_stats_t stats;
+    iot_manager_get_stats(&stats);
+
+    uint64_t bytes[IOT_MSG_CLASS_MAX];
+    for (int i = 0; i < IOT_MSG_CLASS_MAX; i++) {
+        bytes[i] = stats.traffic[i].bytes;
+    }
+
+    // 只在发布任务中使用，避免占用发布任务的栈
+    static char buf[640];
+    iot_payload_writer_t w;
+    iot_payload_init(&w, buf, sizeof(buf));
+    iot_payload_object_begin(&w);
+    iot_payload_kv_str(&w, "event", "metrics");
+    iot_payload_kv_int(&w, "timestamp", now_us / 1000);
+    stats_put_array(&w, "msgs", &stats.traffic[0].messages, IOT_MSG_CLASS_MAX,
+                    sizeof(stats.traffic[0]));
+    iot_payload_key(&w, "bytes");
+    iot_payload_array_begin(&w);
+    for (int i = 0; i < IOT_MSG_CLASS_MAX; i++) {
+        iot_payload_uint(&w, bytes[i]);
+    }
+    iot_payload_array_end(&w);
+    stats_put_array(&w, "lat", stats.ack_latency_hist, IOT_STATS_LATENCY_BUCKETS,
+                    sizeof(uint32_t));
+    iot_payload_kv_uint(&w, "lat_sum", stats.ack_latency_sum_ms);
+    iot_payload_kv_uint(&w, "lat_max", stats.ack_latency_max_ms);
+    iot_payload_kv_uint(&w, "inflight", stats.in_flight);
+    iot_payload_kv_uint(&w, "inflight_peak", stats.in_flight_peak);
+    iot_payload_kv_uint(&w, "untracked", stats.untracked);
+    iot_payload_kv_uint(&w, "retry", stats.retried);
+    iot_payload_kv_uint(&w, "drop", stats.dropped);
+    iot_payload_kv_uint(&w, "heap", esp_get_free_heap_size());
+    iot_payload_kv_uint(&w, "heap_min", esp_get_minimum_free_heap_size());
+    stats_put_reconnect(&w, "wifi_reconn", IOT_LINK_WIFI);
+    stats_put_reconnect(&w, "mqtt_reconn", IOT_LINK_MQTT);
+    iot_payload_key(&w, "tx_large");
+    iot_payload_array_begin(&w);
+#if CONFIG_IOT_TX_LARGE_BLOCKS > 0
+    iot_slab_stats_t ss;
+    iot_slab_get_stats(&tx_large, &ss);
+    iot_payload_uint(&w, ss.peak);
+    iot_payload_uint(&w, ss.count);
+#else
+    iot_payload_uint(&w, 0);
+    iot_payload_uint(&w, 0);
+#endif
+    iot_payload_uint(&w, atomic_load(&tx_large_heap));
+    iot_payload_array_end(&w);
+    iot_payload_object_end(&w);
+
+    int len = iot_payload_finish(&w);
+    if (len < 0) {
+        ESP_LOGE(TAG, "统计消息编码失败");
+        return;
+    }
+    publish_classed(IOT_MSG_CLASS_EVENT, class_topics[IOT_MSG_CLASS_EVENT],
+                    buf, len, 0, 0, TX_FMT_DEFAULT);
+}
+
+/**
+ * @brief 在事件主题上报健康数据（任务栈剩余、各类内存）
+ */
+static void health_report(void)
+{
+    if (!is_connected) {
+        return;
+    }
+
+    // 只在发布任务中使用
+    static char buf[IOT_HEALTH_MSG_SIZE];
+    int len = iot_health_encode(buf, sizeof(buf));
+    if (len < 0) {
+        ESP_LOGE(TAG, "健康数据超过%d字节", (int)sizeof(buf));
+        return;
+    }
+    publish_classed(IOT_MSG_CLASS_EVENT, class_topics[IOT_MSG_CLASS_EVENT],
+                    buf, len, 0, 0, TX_FMT_DEFAULT);
+}
+
+#if CONFIG_IOT_HEALTH_REPORT_INTERVAL_SEC > 0
+// 下次上报健康数据的时间
+static int64_t health_deadline_us = 0;
+
+/**
+ * @brief 到期时上报健康数据
+ */
+static void health_report_if_due(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    if (now_us < health_deadline_us) {
+        return;
+    }
+    health_deadline_us = now_us + CONFIG_IOT_HEALTH_REPORT_INTERVAL_SEC * 1000000LL;
+    health_report();
+}
+#endif
+
+#if CONFIG_IOT_STATS_REPORT_INTERVAL_SEC > 0
+// 下次上报统计的时间
+static int64_t stats_deadline_us = 0;
+
+/**
+ * @brief 到期时上报发布统计
+ */
+static void stats_report_if_due(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    if (now_us < stats_deadline_us) {
+        return;
+    }
+    stats_deadline_us = now_us + CONFIG_IOT_STATS_REPORT_INTERVAL_SEC * 1000000LL;
+    stats_report();
+}
+#endif
+
+/**
+ * @brief 处理发送队列中的一条消息
+ */
+static void tx_handle(const iot_mpsc_slot_t *slot)
+{
+    uint32_t tag = slot->tag;
+    const char *buf = (const char *)slot->data;
+    if (tag & TX_FLAG_HEAP) {
+        memcpy(&buf, slot->data, sizeof(buf));
+    }
+
+    iot_msg_class_t msg_class = TX_TAG_CLASS(tag);
+    uint8_t format = TX_TAG_FMT(tag);
+    size_t topic_len = tag >> TX_TAG_TOPIC_SHIFT;
+    const char *topic = topic_len ? buf : class_topics[msg_class];
+    const char *data = topic_len ? buf + topic_len + 1 : buf;
+    int len = (int)slot->len - (topic_len ? (int)topic_len + 1 : 0) - 1;
+
+    if (tag & TX_FLAG_CANCEL) {
+        // 生产者编码失败，丢弃
+    } else if (tag & TX_FLAG_FLUSH) {
+#if CONFIG_IOT_BATCH_ENABLE
+        batch_flush();
+#endif
+    } else if (tag & TX_FLAG_SAMPLE) {
+#if CONFIG_IOT_BATCH_ENABLE
+        batch_add(data, len, format);
+#endif
+    } else {
+        publish_classed(msg_class, topic, data, len, TX_TAG_QOS(tag),
+                        (tag & TX_FLAG_RETAIN) != 0, format);
+    }
+
+    if (tag & TX_FLAG_HEAP) {
+        tx_large_free((void *)buf);
+    }
+    if (tag & TX_FLAG_SYNC) {
+        xSemaphoreGive(tx_sync_sem);
+    }
+}
+
+/**
+ * @brief 计算发布任务下次需要醒来的等待时长
+ */
+static TickType_t publisher_wait_ticks(void)
+{
+    int64_t deadline_us = INT64_MAX;
+#if CONFIG_IOT_BATCH_ENABLE
+    if (batch_count) {
+        deadline_us = batch_deadline_us;
+    }
+#endif
+#if CONFIG_IOT_STATS_REPORT_INTERVAL_SEC > 0
+    if (stats_deadline_us < deadline_us) {
+        deadline_us = stats_deadline_us;
+    }
+#endif
+#if CONFIG_IOT_HEALTH_REPORT_INTERVAL_SEC > 0
+    if (health_deadline_us < deadline_us) {
+        deadline_us = health_deadline_us;
+    }
+#endif
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+    if (drain_pending && drain_retry_us < deadline_us) {
+        deadline_us = drain_retry_us;
+    }
+#endif
+    if (deadline_us == INT64_MAX) {
+        return portMAX_DELAY;
+    }
+
+    int64_t remain_us = deadline_us - esp_timer_get_time();
+    if (remain_us <= 0) {
+        return 0;
+    }
+    return pdMS_TO_TICKS(remain_us / 1000) + 1;
+}
+
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+/**
+ * @brief 退避时间到（esp_timer任务中调用）
+ */
+static void reconnect_timer_cb(void *arg)
+{
+    xTaskNotify(publisher_task_handle, TX_NOTIFY_RECONNECT, eSetBits);
+}
+
+/**
+ * @brief WiFi恢复（在报告WiFi状态的任务中调用）
+ */
+static void reconnect_link_up_cb(iot_link_t link)
+{
+    if (link == IOT_LINK_WIFI) {
+        xTaskNotify(publisher_task_handle, TX_NOTIFY_LINK, eSetBits);
+    }
+}
+
+/**
+ * @brief MQTT断开后停止客户端，WiFi可用时按退避时间安排重连（发布任务中调用）
+ *
+ * WiFi恢复时退避已被重置，重新计时可以更早重连
+ */
+static void reconnect_schedule(void)
+{
+    xSemaphoreTake(client_lock, portMAX_DELAY);
+    if (mqtt_client && atomic_exchange(&mqtt_dropped, false)) {
+        // 停止esp-mqtt内部的固定间隔重连，由退避定时器重新启动
+        esp_mqtt_client_stop(mqtt_client);
+        atomic_store(&reconnect_waiting, true);
+    }
+    bool waiting = mqtt_client && atomic_load(&reconnect_waiting);
+    xSemaphoreGive(client_lock);
+
+    if (!waiting || !iot_reconnect_link_is_up(IOT_LINK_WIFI)) {
+        return;
+    }
+    esp_timer_stop(reconnect_timer);
+    uint32_t delay_ms = iot_reconnect_next_delay_ms(IOT_LINK_MQTT);
+    ESP_LOGI(TAG, "%lums后重连MQTT服务器", (unsigned long)delay_ms);
+    esp_timer_start_once(reconnect_timer, (uint64_t)delay_ms * 1000);
+}
+
+/**
+ * @brief 重新启动客户端（发布任务中调用）
+ */
+static void reconnect_start(void)
+{
+    // WiFi断开时不尝试，WiFi恢复后会重新安排
+    if (!iot_reconnect_link_is_up(IOT_LINK_WIFI)) {
+        return;
+    }
+
+    xSemaphoreTake(client_lock, portMAX_DELAY);
+    bool retry = false;
+    if (mqtt_client && atomic_load(&reconnect_waiting)) {
+        ESP_LOGI(TAG, "重新连接MQTT服务器...");
+        if (esp_mqtt_client_start(mqtt_client) == ESP_OK) {
+            atomic_store(&reconnect_waiting, false);
+        } else {
+            retry = true;
+        }
+    }
+    xSemaphoreGive(client_lock);
+
+    if (retry) {
+        reconnect_schedule();
+    }
+}
+#endif
+
+/**
+ * @brief 发布任务
+ *
+ * 唯一调用esp_mqtt_client_publish()的地方：依次处理发送队列中的新消息、
+ * 补发离线缓存、按最大延迟刷新批量缓冲。离线缓存和批量缓冲只在本任务中访问。
+ */
+static void iot_publisher_task(void *pvParameters)
+{
+    while (1) {
+        iot_mpsc_slot_t *slot;
+        while ((slot = iot_mpsc_peek(&tx_queue)) != NULL) {
+            tx_handle(slot);
+            iot_mpsc_release(&tx_queue, slot);
+        }
+
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+        if (drain_pending && esp_timer_get_time() >= drain_retry_us) {
+            drain_pending = offline_drain();
+        }
+#endif
+#if CONFIG_IOT_BATCH_ENABLE
+        batch_flush_if_due();
+#endif
+#if CONFIG_IOT_STATS_REPORT_INTERVAL_SEC > 0
+        stats_report_if_due();
+#endif
+#if CONFIG_IOT_HEALTH_REPORT_INTERVAL_SEC > 0
+        health_report_if_due();
+#endif
+
+        TickType_t wait = publisher_wait_ticks();
+        if (wait == 0) {
+            continue;
+        }
+
+        // 先声明即将休眠再检查队列，避免错过休眠前刚提交的消息
+        atomic_store(&publisher_waiting, true);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (iot_mpsc_peek(&tx_queue)) {
+            atomic_store(&publisher_waiting, false);
+            continue;
+        }
+
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, wait);
+        atomic_store(&publisher_waiting, false);
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+        if (bits & TX_NOTIFY_DRAIN) {
+            drain_pending = true;
+            drain_retry_us = 0;
+        }
+#endif
+        if (bits & TX_NOTIFY_STATS) {
+            stats_report();
+        }
+        if (bits & TX_NOTIFY_HEALTH) {
+            health_report();
+        }
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+        if (bits & TX_NOTIFY_LINK) {
+            reconnect_schedule();
+        }
+        if (bits & TX_NOTIFY_RECONNECT) {
+            reconnect_start();
+        }
+#endif
+    }
+}
+
+/**
+ * @brief 生成各类消息的主题
+ */
+static esp_err_t render_topics(const char *device_id)
+{
+    static const struct {
+        iot_msg_class_t msg_class;
+        const char *tmpl;
+    } templates[] = {
+        { IOT_MSG_CLASS_STATUS,   CONFIG_IOT_STATUS_TOPIC_TEMPLATE },
+        { IOT_MSG_CLASS_PROPERTY, CONFIG_IOT_PROPERTY_TOPIC_TEMPLATE },
+        { IOT_MSG_CLASS_REPLY,    CONFIG_IOT_REPLY_TOPIC_TEMPLATE },
+        { IOT_MSG_CLASS_EVENT,    CONFIG_IOT_EVENT_TOPIC_TEMPLATE },
+    };
 
-// 连接状态
-static bool is_connected = false;
+    for (size_t i = 0; i < sizeof(templates) / sizeof(templates[0]); i++) {
+        char *topic = class_topics[templates[i].msg_class];
+        int n = snprintf(topic, IOT_TOPIC_MAX_LEN, templates[i].tmpl, device_id);
+        if (n < 0 || n >= IOT_TOPIC_MAX_LEN) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
 
-// 用户数据回调函数
-static iot_mqtt_data_callback_t user_data_callback = NULL;
+    int n = snprintf(command_topic, sizeof(command_topic),
+                     CONFIG_IOT_COMMAND_TOPIC_TEMPLATE, device_id);
+    if (n < 0 || n >= (int)sizeof(command_topic)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
 
 /**
- * @brief 记录错误信息
+ * @brief 创建发送队列、离线缓存、批量缓冲和发布任务（只创建一次）
  */
-static void log_error_if_nonzero(const char *message, int error_code)
+static esp_err_t publisher_init(void)
 {
-    if (error_code != 0) {
-        ESP_LOGE(TAG, "Last error %s: 0x%x", message, error_code);
+    if (publisher_task_handle) {
+        return ESP_OK;
+    }
+
+    // 槽位数向上取整为2的幂
+    uint32_t capacity = 2;
+    while (capacity < CONFIG_IOT_TX_QUEUE_LEN) {
+        capacity <<= 1;
     }
+
+    void *tx_mem = malloc(iot_mpsc_mem_size(capacity, CONFIG_IOT_TX_SLOT_SIZE));
+    client_lock = xSemaphoreCreateMutex();
+    tx_sync_sem = xSemaphoreCreateBinary();
+    if (!tx_mem || !client_lock || !tx_sync_sem) {
+        goto fail;
+    }
+    iot_mpsc_init(&tx_queue, tx_mem, capacity, CONFIG_IOT_TX_SLOT_SIZE);
+
+#if CONFIG_IOT_TX_LARGE_BLOCKS > 0
+    void *large_mem = malloc(iot_slab_mem_size(CONFIG_IOT_TX_LARGE_BLOCK_SIZE,
+                                               CONFIG_IOT_TX_LARGE_BLOCKS));
+    if (!large_mem) {
+        goto fail;
+    }
+    iot_slab_init(&tx_large, large_mem, CONFIG_IOT_TX_LARGE_BLOCK_SIZE, CONFIG_IOT_TX_LARGE_BLOCKS);
+    tx_large_ready = true;
+#endif
+
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+    void *offline_buf = malloc(CONFIG_IOT_OFFLINE_QUEUE_SIZE);
+    if (!offline_buf) {
+        goto fail;
+    }
+    iot_offline_queue_init(&offline_queue, offline_buf, CONFIG_IOT_OFFLINE_QUEUE_SIZE);
+    offline_ready = true;
+    ESP_LOGI(TAG, "离线缓存已启用: %d字节", CONFIG_IOT_OFFLINE_QUEUE_SIZE);
+#endif
+
+#if CONFIG_IOT_BATCH_ENABLE
+    // 预留结尾']'
+    batch_buf = malloc(CONFIG_IOT_BATCH_MAX_BYTES + 1);
+    if (!batch_buf) {
+        goto fail;
+    }
+    ESP_LOGI(TAG, "批量上报已启用: %d字节/%d个样本/%dms",
+             CONFIG_IOT_BATCH_MAX_BYTES, CONFIG_IOT_BATCH_MAX_SAMPLES,
+             CONFIG_IOT_BATCH_MAX_LATENCY_MS);
+#endif
+
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+    const esp_timer_create_args_t reconnect_timer_args = {
+        .callback = reconnect_timer_cb,
+        .name = "iot_reconnect",
+    };
+    if (esp_timer_create(&reconnect_timer_args, &reconnect_timer) != ESP_OK) {
+        goto fail;
+    }
+#endif
+
+    if (xTaskCreate(iot_publisher_task, "iot_pub", 3072, NULL, 5,
+                    &publisher_task_handle) != pdPASS) {
+        goto fail;
+    }
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+    iot_reconnect_set_callback(reconnect_link_up_cb);
+#endif
+
+    tx_queue_ready = true;
+    ESP_LOGI(TAG, "发送队列已创建: %lu个槽位 x %d字节",
+             (unsigned long)capacity, CONFIG_IOT_TX_SLOT_SIZE);
+    return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "发布任务创建失败");
+    free(tx_mem);
+#if CONFIG_IOT_TX_LARGE_BLOCKS > 0
+    if (tx_large_ready) {
+        free(tx_large.blocks);
+        tx_large_ready = false;
+    }
+#endif
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+    if (offline_ready) {
+        free(offline_queue.buf);
+        offline_ready = false;
+    }
+#endif
+#if CONFIG_IOT_BATCH_ENABLE
+    free(batch_buf);
+    batch_buf = NULL;
+#endif
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+    if (reconnect_timer) {
+        esp_timer_delete(reconnect_timer);
+        reconnect_timer = NULL;
+    }
+#endif
+    if (client_lock) {
+        vSemaphoreDelete(client_lock);
+        client_lock = NULL;
+    }
+    if (tx_sync_sem) {
+        vSemaphoreDelete(tx_sync_sem);
+        tx_sync_sem = NULL;
+    }
+    return ESP_ERR_NO_MEM;
 }
 
-#if CONFIG_IOT_MQTT_PROTOCOL_V5
 /**
- * @brief 打印MQTT5用户属性
+ * @brief 获取订阅路由锁（首次使用时创建，可在初始化前注册处理函数）
  */
-static void print_user_property(mqtt5_user_property_handle_t user_property)
+static SemaphoreHandle_t route_lock_get(void)
 {
-    if (user_property) {
-        uint8_t count = esp_mqtt5_client_get_user_property_count(user_property);
-        if (count) {
-            esp_mqtt5_user_property_item_t *item = malloc(count * sizeof(esp_mqtt5_user_property_item_t));
-            if (item && esp_mqtt5_client_get_user_property(user_property, item, &count) == ESP_OK) {
-                for (int i = 0; i < count; i++) {
-                    esp_mqtt5_user_property_item_t *t = &item[i];
-                    ESP_LOGI(TAG, "User property: %s = %s", t->key, t->value);
-                    free((char *)t->key);
-                    free((char *)t->value);
-                }
-            }
-            free(item);
-        }
+    static StaticSemaphore_t lock_buf;
+    static portMUX_TYPE lock_mux = portMUX_INITIALIZER_UNLOCKED;
+
+    portENTER_CRITICAL(&lock_mux);
+    if (!route_lock) {
+        route_lock = xSemaphoreCreateMutexStatic(&lock_buf);
+    }
+    portEXIT_CRITICAL(&lock_mux);
+    return route_lock;
+}
+
+/**
+ * @brief 重新订阅所有处理函数的过滤器（连接成功后调用）
+ */
+static void route_resubscribe(void)
+{
+    xSemaphoreTake(route_lock_get(), portMAX_DELAY);
+    for (iot_route_t *r = route_list; r; r = r->next) {
+        esp_mqtt_client_subscribe(mqtt_client, r->filter, r->qos);
+    }
+    xSemaphoreGive(route_lock);
+}
+
+static void route_collect(void *value, void *arg)
+{
+    const iot_route_t *route = value;
+    if (rx_route_count < IOT_ROUTE_MAX_MATCHES) {
+        rx_routes[rx_route_count].handler = route->handler;
+        rx_routes[rx_route_count].ctx = route->ctx;
+        rx_route_count++;
+    }
+}
+
+/**
+ * @brief 按主题查找订阅处理函数，结果存入rx_routes
+ */
+static void route_match(const char *topic, int topic_len)
+{
+    rx_route_count = 0;
+    if (!topic_router) {
+        return;
+    }
+    xSemaphoreTake(route_lock_get(), portMAX_DELAY);
+    size_t n = iot_topic_router_match(topic_router, topic, topic_len, route_collect, NULL);
+    xSemaphoreGive(route_lock);
+    if (n > IOT_ROUTE_MAX_MATCHES) {
+        ESP_LOGW(TAG, "主题匹配到%d个处理函数，只调用前%d个", (int)n, IOT_ROUTE_MAX_MATCHES);
     }
 }
-#endif
 
 /**
  * @brief MQTT事件处理函数
  */
-static void mqtt_event_handler(void *handler_args, esp_event_base_t base, 
+static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
                                int32_t event_id, void *event_data)
 {
     ESP_LOGD(TAG, "Event: base=%s, event_id=%d", base, event_id);
@@ -77,31 +1316,63 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
     case MQTT_EVENT_CONNECTED:
         ESP_LOGI(TAG, "MQTT已连接到服务器");
         is_connected = true;
-        
-        // 自动订阅命令主题（使用动态内存）
-        char *command_topic = malloc(128);
-        if (command_topic) {
-            snprintf(command_topic, 128, 
-                    CONFIG_IOT_COMMAND_TOPIC_TEMPLATE, manager_config.device_id);
-            iot_manager_subscribe(command_topic, 1);
-            ESP_LOGI(TAG, "已订阅命令主题: %s", command_topic);
-            free(command_topic);
-        }
-        
-        // 上报设备上线消息（使用动态内存）
-        char *online_msg = malloc(256);
-        if (online_msg) {
-            snprintf(online_msg, 256, 
-                    "{\"device_id\":\"%s\",\"status\":\"online\",\"timestamp\":%lld}",
-                    manager_config.device_id, esp_timer_get_time() / 1000);
-            iot_manager_report_status(online_msg);
-            free(online_msg);
+#if CONFIG_IOT_MQTT5_TOPIC_ALIAS
+        // 别名映射只在一个连接内有效，发布任务看到新的连接序号后重新建立
+        atomic_fetch_add(&conn_seq, 1);
+#endif
+
+        // 自动订阅命令主题
+        iot_manager_subscribe(command_topic, 1);
+        ESP_LOGI(TAG, "已订阅命令主题: %s", command_topic);
+
+        // 重新订阅处理函数的过滤器
+        route_resubscribe();
+
+        // 上报设备上线消息，启动后首次连接时带上各启动阶段的时间
+        iot_boot_mark("mqtt_connack");
+        bool with_boot = !iot_boot_is_complete();
+        char online_msg[ONLINE_MSG_SIZE];
+        iot_payload_writer_t w;
+        iot_payload_init(&w, online_msg, sizeof(online_msg));
+        iot_payload_object_begin(&w);
+        iot_payload_kv_str(&w, "device_id", manager_config.device_id);
+        iot_payload_kv_str(&w, "status", "online");
+        iot_payload_kv_int(&w, "timestamp", esp_timer_get_time() / 1000);
+        if (with_boot) {
+            iot_boot_stage_t stages[IOT_BOOT_MAX_STAGES];
+            size_t count = iot_boot_get(stages, IOT_BOOT_MAX_STAGES);
+            iot_payload_kv_str(&w, "fw", iot_boot_firmware_version());
+            iot_payload_key(&w, "boot");
+            iot_payload_object_begin(&w);
+            for (size_t i = 0; i < count; i++) {
+                iot_payload_kv_uint(&w, stages[i].name, stages[i].ms);
+            }
+            iot_payload_object_end(&w);
         }
+        iot_payload_object_end(&w);
+        int online_len = iot_payload_finish(&w);
+        if (online_len > 0) {
+            iot_manager_report(IOT_MSG_CLASS_STATUS, online_msg, online_len,
+                               IOT_PAYLOAD_REPORT_FLAGS);
+        }
+
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+        // 通知发布任务补发离线缓存
+        xTaskNotify(publisher_task_handle, TX_NOTIFY_DRAIN, eSetBits);
+#endif
+        iot_reconnect_link_up(IOT_LINK_MQTT);
+        esp_event_post(IOT_MANAGER_EVENT, IOT_MANAGER_EVENT_CONNECTED, NULL, 0, 0);
         break;
 
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGW(TAG, "MQTT连接断开");
         is_connected = false;
+        iot_reconnect_link_down(IOT_LINK_MQTT);
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+        atomic_store(&mqtt_dropped, true);
+        xTaskNotify(publisher_task_handle, TX_NOTIFY_LINK, eSetBits);
+#endif
+        esp_event_post(IOT_MANAGER_EVENT, IOT_MANAGER_EVENT_DISCONNECTED, NULL, 0, 0);
 #if CONFIG_IOT_MQTT_PROTOCOL_V5
         print_user_property(event->property->user_property);
 #endif
@@ -120,16 +1391,53 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
 
     case MQTT_EVENT_PUBLISHED:
         ESP_LOGD(TAG, "消息发布成功, msg_id=%d", event->msg_id);
+        iot_stats_acked(event->msg_id);
+        break;
+
+    case MQTT_EVENT_DELETED:
+        // 超过outbox过期时间仍未确认的消息被esp-mqtt删除
+        ESP_LOGW(TAG, "消息未确认已过期, msg_id=%d", event->msg_id);
+        iot_stats_deleted(event->msg_id);
         break;
 
     case MQTT_EVENT_DATA:
         ESP_LOGI(TAG, "收到MQTT消息");
         ESP_LOGI(TAG, "主题: %.*s", event->topic_len, event->topic);
         ESP_LOGD(TAG, "数据: %.*s", event->data_len, event->data);
-        
-        // 调用用户回调函数
-        if (user_data_callback) {
-            user_data_callback(event->topic, event->topic_len, 
+
+        // 超过MQTT缓冲区的消息分多次到达，只有第一片带主题
+        if (event->current_data_offset == 0) {
+            rx_is_command = (event->topic_len == (int)strlen(command_topic) &&
+                             strncmp(event->topic, command_topic, event->topic_len) == 0);
+            if (rx_is_command) {
+                iot_command_rx_begin();
+            }
+            route_match(event->topic, event->topic_len);
+        }
+
+        // 命令主题上的消息逐片增量解析，已注册的命令交给命令工作任务执行
+        if (rx_is_command) {
+            iot_command_rx_feed(event->data, event->data_len);
+            if (event->current_data_offset + event->data_len < event->total_data_len) {
+                break;
+            }
+            if (iot_command_rx_end()) {
+                break;
+            }
+            if (event->data_len != event->total_data_len) {
+                ESP_LOGW(TAG, "分片的命令消息未注册处理函数，丢弃");
+                break;
+            }
+        }
+
+        // 交给匹配到的订阅处理函数，没有匹配时调用用户回调函数
+        if (rx_route_count > 0) {
+            for (int i = 0; i < rx_route_count; i++) {
+                rx_routes[i].handler(event->topic, event->topic_len,
+                                     event->data, event->data_len, rx_routes[i].ctx);
+            }
+        } else if (user_data_callback) {
+            user_data_callback(event->topic, event->topic_len,
                              event->data, event->data_len);
         }
         break;
@@ -170,6 +1478,12 @@ esp_err_t iot_manager_init(const iot_manager_config_t *config)
     ESP_LOGI(TAG, "设备名称: %s", manager_config.device_name);
     ESP_LOGI(TAG, "设备类型: %s", manager_config.device_type);
 
+    // 主题只在初始化时生成一次，发布路径上不再格式化
+    if (render_topics(manager_config.device_id) != ESP_OK) {
+        ESP_LOGE(TAG, "设备ID过长，主题超过%d字节", IOT_TOPIC_MAX_LEN);
+        return ESP_ERR_INVALID_ARG;
+    }
+
     // 配置MQTT客户端
     esp_mqtt_client_config_t mqtt_cfg = {
         .broker.address.uri = CONFIG_IOT_BROKER_URL,
@@ -179,6 +1493,12 @@ esp_err_t iot_manager_init(const iot_manager_config_t *config)
         .session.protocol_ver = MQTT_PROTOCOL_V_3_1_1,
 #endif
         .credentials.client_id = manager_config.device_id,
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+        // 后备：发布任务未能停止客户端时，esp-mqtt按退避上限重连
+        .network.reconnect_timeout_ms = CONFIG_IOT_RECONNECT_MAX_MS,
+#else
+        .network.disable_auto_reconnect = true,
+#endif
     };
 
     // 如果配置了用户名和密码
@@ -195,29 +1515,63 @@ esp_err_t iot_manager_init(const iot_manager_config_t *config)
 #endif
 
     // 配置遗嘱消息（使用静态内存以避免栈溢出）
-    static char will_topic[128];
     static char will_message[256];
-    snprintf(will_topic, sizeof(will_topic), 
-            CONFIG_IOT_STATUS_TOPIC_TEMPLATE, manager_config.device_id);
-    snprintf(will_message, sizeof(will_message), 
-            "{\"device_id\":\"%s\",\"status\":\"offline\"}",
-            manager_config.device_id);
-    
-    mqtt_cfg.session.last_will.topic = will_topic;
+    iot_payload_writer_t w;
+    iot_payload_init(&w, will_message, sizeof(will_message));
+    iot_payload_object_begin(&w);
+    iot_payload_kv_str(&w, "device_id", manager_config.device_id);
+    iot_payload_kv_str(&w, "status", "offline");
+    iot_payload_object_end(&w);
+    int will_len = iot_payload_finish(&w);
+    if (will_len < 0) {
+        ESP_LOGE(TAG, "设备ID过长");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mqtt_cfg.session.last_will.topic = class_topics[IOT_MSG_CLASS_STATUS];
     mqtt_cfg.session.last_will.msg = will_message;
-    mqtt_cfg.session.last_will.msg_len = strlen(will_message);
+    mqtt_cfg.session.last_will.msg_len = will_len;
     mqtt_cfg.session.last_will.qos = 1;
     mqtt_cfg.session.last_will.retain = true;
 
+    // 创建发布任务（重复初始化时保留发送队列和离线缓存内容）
+    esp_err_t ret = publisher_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 创建命令工作任务
+    ret = iot_command_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
     // 初始化MQTT客户端
-    mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
-    if (!mqtt_client) {
+    esp_mqtt_client_handle_t client = esp_mqtt_client_init(&mqtt_cfg);
+    if (!client) {
         ESP_LOGE(TAG, "MQTT客户端初始化失败");
         return ESP_FAIL;
     }
+#if CONFIG_IOT_MQTT_PROTOCOL_V5
+    // 遗嘱消息的格式通过MQTT5遗嘱属性告知服务器
+    esp_mqtt5_connection_property_config_t connect_property = {
+        .payload_format_indicator = (TX_FMT_DEFAULT == TX_FMT_JSON),
+        .content_type = content_types[TX_FMT_DEFAULT],
+        .topic_alias_maximum = CONFIG_IOT_MQTT5_TOPIC_ALIAS_MAXIMUM,
+    };
+    esp_mqtt5_client_set_connect_property(client, &connect_property);
+#endif
+
+    xSemaphoreTake(client_lock, portMAX_DELAY);
+    mqtt_client = client;
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+    atomic_store(&mqtt_dropped, false);
+    atomic_store(&reconnect_waiting, false);
+#endif
+    xSemaphoreGive(client_lock);
 
     // 注册事件处理器
-    esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID, 
+    esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID,
                                    mqtt_event_handler, NULL);
 
     ESP_LOGI(TAG, "IoT管理器初始化完成");
@@ -235,6 +1589,7 @@ esp_err_t iot_manager_start(void)
     }
 
     ESP_LOGI(TAG, "启动MQTT客户端...");
+    iot_boot_mark("mqtt_start");
     esp_err_t ret = esp_mqtt_client_start(mqtt_client);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "MQTT客户端启动失败");
@@ -254,13 +1609,34 @@ esp_err_t iot_manager_stop(void)
         return ESP_OK;
     }
 
+    // 停止前发出发送队列和批量缓冲中的消息
+    xSemaphoreTake(tx_sync_sem, 0);
+    if (tx_enqueue(IOT_MSG_CLASS_PROPERTY, NULL, NULL, 0, 0, 0,
+                   TX_FLAG_FLUSH | TX_FLAG_SYNC) == 0) {
+        if (xSemaphoreTake(tx_sync_sem, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            ESP_LOGW(TAG, "等待发送队列清空超时");
+        }
+    }
+
     ESP_LOGI(TAG, "停止MQTT客户端...");
-    esp_err_t ret = esp_mqtt_client_stop(mqtt_client);
+    xSemaphoreTake(client_lock, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+#if CONFIG_IOT_ENABLE_AUTO_RECONNECT
+    esp_timer_stop(reconnect_timer);
+    // 等待重连时客户端已经停止
+    if (!atomic_exchange(&reconnect_waiting, false)) {
+        ret = esp_mqtt_client_stop(mqtt_client);
+    }
+#else
+    ret = esp_mqtt_client_stop(mqtt_client);
+#endif
     if (ret == ESP_OK) {
         esp_mqtt_client_destroy(mqtt_client);
         mqtt_client = NULL;
         is_connected = false;
+        iot_stats_abandon_in_flight();
     }
+    xSemaphoreGive(client_lock);
     return ret;
 }
 
@@ -269,18 +1645,10 @@ esp_err_t iot_manager_stop(void)
  */
 int iot_manager_publish(const char *topic, const char *data, int len, int qos, int retain)
 {
-    if (!mqtt_client || !is_connected) {
-        ESP_LOGW(TAG, "MQTT未连接，无法发布消息");
+    if (!topic) {
         return -1;
     }
-
-    int msg_id = esp_mqtt_client_publish(mqtt_client, topic, data, len, qos, retain);
-    if (msg_id >= 0) {
-        ESP_LOGD(TAG, "发布消息到 %s, msg_id=%d", topic, msg_id);
-    } else {
-        ESP_LOGE(TAG, "发布消息失败");
-    }
-    return msg_id;
+    return tx_enqueue(IOT_MSG_CLASS_CUSTOM, topic, data, len, qos, retain, 0);
 }
 
 /**
@@ -316,6 +1684,92 @@ int iot_manager_unsubscribe(const char *topic)
     return msg_id;
 }
 
+/**
+ * @brief 订阅主题过滤器并指定处理函数
+ */
+esp_err_t iot_manager_subscribe_handler(const char *filter, int qos,
+                                        iot_topic_handler_t handler, void *ctx)
+{
+    if (!handler || !iot_topic_filter_valid(filter)) {
+        ESP_LOGE(TAG, "订阅过滤器无效: %s", filter ? filter : "(null)");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t filter_len = strlen(filter);
+    iot_route_t *route = malloc(sizeof(*route) + filter_len + 1);
+    if (!route) {
+        return ESP_ERR_NO_MEM;
+    }
+    route->handler = handler;
+    route->ctx = ctx;
+    route->qos = qos;
+    memcpy(route->filter, filter, filter_len + 1);
+
+    xSemaphoreTake(route_lock_get(), portMAX_DELAY);
+    if (!topic_router) {
+        topic_router = iot_topic_router_create();
+    }
+    bool added = topic_router && iot_topic_router_add(topic_router, filter, route);
+    if (added) {
+        route->next = route_list;
+        route_list = route;
+    }
+    xSemaphoreGive(route_lock);
+
+    if (!added) {
+        free(route);
+        ESP_LOGE(TAG, "订阅路由表内存不足");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 未连接时等连接成功后统一订阅
+    if (mqtt_client && is_connected) {
+        iot_manager_subscribe(filter, qos);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 取消订阅处理函数
+ */
+esp_err_t iot_manager_unsubscribe_handler(const char *filter,
+                                          iot_topic_handler_t handler, void *ctx)
+{
+    if (!filter) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    iot_route_t *found = NULL;
+    bool filter_in_use = false;
+    xSemaphoreTake(route_lock_get(), portMAX_DELAY);
+    for (iot_route_t **link = &route_list; *link;) {
+        iot_route_t *r = *link;
+        if (!found && r->handler == handler && r->ctx == ctx && strcmp(r->filter, filter) == 0) {
+            found = r;
+            *link = r->next;
+            continue;
+        }
+        if (strcmp(r->filter, filter) == 0) {
+            filter_in_use = true;
+        }
+        link = &r->next;
+    }
+    if (found) {
+        iot_topic_router_remove(topic_router, filter, found);
+    }
+    xSemaphoreGive(route_lock);
+
+    if (!found) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    // MQTT任务只保存处理函数的拷贝，可以直接释放
+    free(found);
+    if (!filter_in_use) {
+        iot_manager_unsubscribe(filter);
+    }
+    return ESP_OK;
+}
+
 /**
  * @brief 获取客户端句柄
  */
@@ -337,11 +1791,8 @@ bool iot_manager_is_connected(void)
  */
 int iot_manager_report_status(const char *status_json)
 {
-    // 使用静态缓冲区避免栈使用
-    static char topic[128];
-    snprintf(topic, sizeof(topic), CONFIG_IOT_STATUS_TOPIC_TEMPLATE, 
-            manager_config.device_id);
-    return iot_manager_publish(topic, status_json, 0, 1, 0);
+    return tx_enqueue(IOT_MSG_CLASS_STATUS, NULL, status_json, 0, 1, 0,
+                      TX_TAG_FMT_SET(TX_FMT_JSON));
 }
 
 /**
@@ -349,28 +1800,167 @@ int iot_manager_report_status(const char *status_json)
  */
 int iot_manager_report_properties(const char *properties_json)
 {
-    // 使用静态缓冲区避免栈使用
-    static char topic[128];
-    snprintf(topic, sizeof(topic), CONFIG_IOT_PROPERTY_TOPIC_TEMPLATE, 
-            manager_config.device_id);
-    return iot_manager_publish(topic, properties_json, 0, 1, 0);
+    return tx_enqueue(IOT_MSG_CLASS_PROPERTY, NULL, properties_json, 0,
+                      CONFIG_IOT_PROPERTY_QOS, 0, TX_TAG_FMT_SET(TX_FMT_JSON));
+}
+
+/**
+ * @brief 批量上报设备属性
+ */
+int iot_manager_batch_properties(const char *properties_json)
+{
+    if (!properties_json) {
+        return -1;
+    }
+#if CONFIG_IOT_BATCH_ENABLE
+    return tx_enqueue(IOT_MSG_CLASS_PROPERTY, NULL, properties_json, 0,
+                      CONFIG_IOT_PROPERTY_QOS, 0, TX_FLAG_SAMPLE | TX_TAG_FMT_SET(TX_FMT_JSON));
+#else
+    return iot_manager_report_properties(properties_json);
+#endif
+}
+
+/**
+ * @brief 按类别上报已编码的负载
+ */
+int iot_manager_report(iot_msg_class_t msg_class, const void *payload, size_t len, uint32_t flags)
+{
+    if (msg_class == IOT_MSG_CLASS_CUSTOM || msg_class >= IOT_MSG_CLASS_MAX ||
+        !payload || len == 0 || len > INT32_MAX) {
+        return -1;
+    }
+
+    uint8_t format = TX_FMT_JSON;
+    if (flags & IOT_REPORT_FLAG_TSZ) {
+        format = TX_FMT_TSZ;
+    } else if (flags & IOT_REPORT_FLAG_CBOR) {
+        format = TX_FMT_CBOR;
+    }
+    uint32_t tx_flags = TX_TAG_FMT_SET(format);
+#if CONFIG_IOT_BATCH_ENABLE
+    // 压缩序列本身已是多个样本，不再合并
+    if ((flags & IOT_REPORT_FLAG_BATCH) && msg_class == IOT_MSG_CLASS_PROPERTY &&
+        format != TX_FMT_TSZ) {
+        tx_flags |= TX_FLAG_SAMPLE;
+    }
+#endif
+    int qos = msg_class == IOT_MSG_CLASS_PROPERTY ? CONFIG_IOT_PROPERTY_QOS : 1;
+    return tx_enqueue(msg_class, NULL, payload, (int)len, qos, 0, tx_flags);
+}
+
+/**
+ * @brief 立即发送批量缓冲中的样本
+ */
+int iot_manager_flush_properties(void)
+{
+#if CONFIG_IOT_BATCH_ENABLE
+    return tx_enqueue(IOT_MSG_CLASS_PROPERTY, NULL, NULL, 0, 0, 0, TX_FLAG_FLUSH);
+#else
+    return 0;
+#endif
 }
 
 /**
  * @brief 响应命令结果
+ *
+ * 直接在发送队列槽位中编码，不经过中间缓冲区
  */
 int iot_manager_reply_command(const char *command_id, int result, const char *message)
 {
-    // 使用静态缓冲区避免栈使用
-    static char topic[128];
-    static char reply_json[512];
-    
-    snprintf(topic, sizeof(topic), CONFIG_IOT_REPLY_TOPIC_TEMPLATE, 
-            manager_config.device_id);
-    snprintf(reply_json, sizeof(reply_json), 
-            "{\"command_id\":\"%s\",\"result\":%d,\"message\":\"%s\",\"timestamp\":%lld}",
-            command_id, result, message, esp_timer_get_time() / 1000);
-    
-    return iot_manager_publish(topic, reply_json, 0, 1, 0);
+    iot_mpsc_slot_t *slot = tx_reserve();
+    if (!slot) {
+        return -1;
+    }
+
+    // 预留结尾'\0'（发送队列的数据约定以'\0'结尾）
+    iot_payload_writer_t w;
+    iot_payload_init(&w, slot->data, iot_mpsc_slot_size(&tx_queue) - 1);
+    iot_payload_object_begin(&w);
+    iot_payload_kv_str(&w, "command_id", command_id);
+    iot_payload_kv_int(&w, "result", result);
+    iot_payload_kv_str(&w, "message", message);
+    iot_payload_kv_int(&w, "timestamp", esp_timer_get_time() / 1000);
+    iot_payload_object_end(&w);
+    int len = iot_payload_finish(&w);
+
+    uint32_t tag = IOT_MSG_CLASS_REPLY | TX_TAG_QOS_SET(1) | TX_TAG_FMT_SET(TX_FMT_DEFAULT);
+    if (len < 0) {
+        // 槽位已预留，必须提交，标记为取消由发布任务丢弃
+        iot_mpsc_commit(&tx_queue, slot, 1, tag | TX_FLAG_CANCEL);
+        ESP_LOGE(TAG, "命令响应超过%lu字节，未发送",
+                 (unsigned long)iot_mpsc_slot_size(&tx_queue));
+        return -1;
+    }
+    slot->data[len] = '\0';
+    tx_commit(slot, len + 1, tag);
+    return 0;
+}
+
+/**
+ * @brief 设置离线缓存策略
+ */
+esp_err_t iot_manager_set_offline_policy(iot_msg_class_t msg_class, iot_offline_policy_t policy)
+{
+    if (msg_class >= IOT_MSG_CLASS_MAX || policy > IOT_OFFLINE_NO_BUFFER) {
+        return ESP_ERR_INVALID_ARG;
+    }
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+    offline_policy[msg_class] = policy;
+#endif
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取离线缓存消息条数
+ */
+uint32_t iot_manager_get_offline_count(void)
+{
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+    if (offline_ready) {
+        return iot_offline_queue_count(&offline_queue);
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief 获取发布统计
+ */
+esp_err_t iot_manager_get_stats(iot_manager_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    iot_stats_get(stats);
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+    // 离线缓存满、消息过大被丢弃的条数由离线缓存自己统计
+    if (offline_ready) {
+        stats->dropped += offline_queue.dropped;
+    }
+#endif
+    return ESP_OK;
+}
+
+/**
+ * @brief 立即上报发布统计
+ */
+int iot_manager_report_stats(void)
+{
+    if (!publisher_task_handle || !is_connected) {
+        return -1;
+    }
+    xTaskNotify(publisher_task_handle, TX_NOTIFY_STATS, eSetBits);
+    return 0;
 }
 
+/**
+ * @brief 立即上报健康数据
+ */
+int iot_manager_report_health(void)
+{
+    if (!publisher_task_handle || !is_connected) {
+        return -1;
+    }
+    xTaskNotify(publisher_task_handle, TX_NOTIFY_HEALTH, eSetBits);
+    return 0;
+}
@@ -10,7 +10,10 @@
 #ifndef IOT_MANAGER_H
 #define IOT_MANAGER_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "esp_err.h"
+#include "esp_event.h"
 #include "mqtt_client.h"
 
 #ifdef __cplusplus
@@ -20,6 +23,10 @@ extern "C" {
 /**
  * @brief MQTT消息回调函数类型
  * 
+ * 超过 IOT_MQTT_BUFFER_SIZE 的消息会分多次回调，只有第一片带主题（后续topic_len为0），
+ * 可用 iot_json_reader.h 中的增量解析器逐片解析，无需拼接整条消息。
+ * 命令主题上已注册的命令、匹配到订阅处理函数的消息不会进入此回调。
+ * 
  * @param topic 消息主题
  * @param topic_len 主题长度
  * @param data 消息数据
@@ -28,6 +35,113 @@ extern "C" {
 typedef void (*iot_mqtt_data_callback_t)(const char *topic, int topic_len, 
                                           const char *data, int data_len);
 
+/**
+ * @brief IoT管理器事件
+ *
+ * 连接状态变化时投递到默认事件循环（esp_event_loop_create_default），
+ * 其他模块可用 esp_event_handler_register(IOT_MANAGER_EVENT, ...) 订阅，不需要轮询
+ * iot_manager_is_connected()。事件不带数据。
+ */
+ESP_EVENT_DECLARE_BASE(IOT_MANAGER_EVENT);
+
+typedef enum {
+    IOT_MANAGER_EVENT_CONNECTED,        ///< MQTT已连接
+    IOT_MANAGER_EVENT_DISCONNECTED,     ///< MQTT连接断开
+} iot_manager_event_t;
+
+/**
+ * @brief 消息类别
+ *
+ * 用于离线缓存的分类丢弃策略
+ */
+typedef enum {
+    IOT_MSG_CLASS_CUSTOM = 0,           ///< 通过iot_manager_publish发布的自定义消息
+    IOT_MSG_CLASS_STATUS,               ///< 设备状态
+    IOT_MSG_CLASS_PROPERTY,             ///< 设备属性/数据
+    IOT_MSG_CLASS_REPLY,                ///< 命令响应
+    IOT_MSG_CLASS_EVENT,                ///< 设备事件
+    IOT_MSG_CLASS_MAX,
+} iot_msg_class_t;
+
+/**
+ * @brief 离线缓存策略
+ */
+typedef enum {
+    IOT_OFFLINE_DROP_OLDEST = 0,        ///< 缓存满时挤掉最早的消息
+    IOT_OFFLINE_DROP_NEW,               ///< 缓存满时丢弃新消息
+    IOT_OFFLINE_NO_BUFFER,              ///< 不缓存，断线时直接丢弃
+} iot_offline_policy_t;
+
+/**
+ * @brief 后台下发的命令
+ *
+ * 命令消息格式: {"command":"restart","command_id":"123","params":{...}}
+ * 所有字段在处理函数返回后失效
+ */
+typedef struct {
+    const char *name;                   ///< 命令名
+    const char *id;                     ///< 命令ID（未携带时为空字符串）
+    const char *params;                 ///< params字段的JSON文本（未携带时为NULL）
+    int params_len;                     ///< params长度
+} iot_command_t;
+
+/**
+ * @brief 命令处理函数类型
+ *
+ * 在命令工作任务中执行，可以阻塞。返回后组件自动调用
+ * iot_manager_reply_command() 回复执行结果。
+ *
+ * @param cmd 命令
+ * @param message 回复消息缓冲区，不写入时回复"ok"或"failed"
+ * @param message_size 缓冲区大小
+ * @return int 执行结果（0: 成功, 其他: 失败码）
+ */
+typedef int (*iot_command_handler_t)(const iot_command_t *cmd, char *message, size_t message_size);
+
+// 命令注册标志
+#define IOT_CMD_FLAG_NO_REPLY       (1u << 0)   ///< 不自动回复执行结果
+#define IOT_CMD_TIMEOUT_SEC(sec)    (((uint32_t)(sec) & 0xffff) << 16)  ///< 超时时间，0使用默认值
+
+// 命令名最大长度（含结尾'\0'）
+#define IOT_CMD_NAME_MAX_LEN        32
+
+// 组件生成的命令结果码
+#define IOT_CMD_RESULT_TIMEOUT      (-2)        ///< 执行超时
+#define IOT_CMD_RESULT_BUSY         (-3)        ///< 工作任务繁忙，命令被拒绝
+#define IOT_CMD_RESULT_BAD_REQUEST  (-4)        ///< 命令格式错误
+
+/**
+ * @brief 属性类型（见 iot_manager_property_define()）
+ */
+typedef enum {
+    IOT_PROP_INT = 0,                   ///< 整数
+    IOT_PROP_FLOAT,                     ///< 浮点数（CBOR下按单精度编码）
+    IOT_PROP_BOOL,                      ///< 布尔值（忽略死区，变化即上报）
+} iot_prop_type_t;
+
+// 属性名最大长度（含结尾'\0'）
+#define IOT_PROP_NAME_MAX_LEN       24
+
+// iot_manager_report() 标志
+#define IOT_REPORT_FLAG_CBOR        (1u << 0)   ///< 负载为CBOR编码（默认JSON）
+#define IOT_REPORT_FLAG_BATCH       (1u << 1)   ///< 属性样本进入批量缓冲（仅IOT_MSG_CLASS_PROPERTY）
+#define IOT_REPORT_FLAG_TSZ         (1u << 2)   ///< 负载为压缩时间序列（iot_tsz.h），忽略BATCH
+
+/**
+ * @brief 订阅处理函数类型（见 iot_manager_subscribe_handler()）
+ * 
+ * 分片消息的约定与 iot_mqtt_data_callback_t 相同：后续分片topic_len为0，
+ * 仍交给第一片匹配到的处理函数。
+ * 
+ * @param topic 消息主题
+ * @param topic_len 主题长度
+ * @param data 消息数据
+ * @param data_len 数据长度
+ * @param ctx 注册时传入的参数
+ */
+typedef void (*iot_topic_handler_t)(const char *topic, int topic_len,
+                                    const char *data, int data_len, void *ctx);
+
 /**
  * @brief IoT管理器配置结构
  */
@@ -73,12 +187,17 @@ esp_err_t iot_manager_stop(void);
 /**
  * @brief 发布数据到指定主题
  * 
+ * 消息拷贝到无锁发送队列后立即返回，由发布任务按入队顺序发布，
+ * 可在任意任务中并发调用（不可在中断中调用）。
+ * 启用离线缓存时，MQTT未连接或仍有离线消息未补发的情况下，
+ * 消息进入离线缓存，连接恢复后按顺序补发。
+ * 
  * @param topic 目标主题
  * @param data 数据内容
  * @param len 数据长度（0表示自动计算字符串长度）
  * @param qos QoS级别 (0, 1, 2)
  * @param retain 是否保留消息
- * @return int 消息ID，失败返回-1
+ * @return int 0已进入发送队列，未初始化或队列已满返回-1
  */
 int iot_manager_publish(const char *topic, const char *data, int len, int qos, int retain);
 
@@ -99,6 +218,40 @@ int iot_manager_subscribe(const char *topic, int qos);
  */
 int iot_manager_unsubscribe(const char *topic);
 
+/**
+ * @brief 订阅主题过滤器并指定处理函数
+ * 
+ * 过滤器预先编入主题字典树，收到消息时逐层匹配，耗时只与主题层级数有关。
+ * 匹配到处理函数的消息不再进入 data_cb；一条消息匹配多个过滤器时依次调用。
+ * 可在连接前调用，每次连接成功后自动重新订阅。处理函数在MQTT任务中执行，应尽快返回。
+ * 
+ * @param filter 主题过滤器，支持'+'（单层）和'#'（多层，只能在末尾）通配符
+ * @param qos QoS级别 (0, 1, 2)
+ * @param handler 处理函数
+ * @param ctx 传给处理函数的参数
+ * @return esp_err_t 
+ *         - ESP_OK: 成功
+ *         - ESP_ERR_INVALID_ARG: 过滤器非法或处理函数为空
+ *         - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t iot_manager_subscribe_handler(const char *filter, int qos,
+                                        iot_topic_handler_t handler, void *ctx);
+
+/**
+ * @brief 取消 iot_manager_subscribe_handler() 的订阅
+ * 
+ * 该过滤器上没有其他处理函数时向服务器取消订阅
+ * 
+ * @param filter 注册时的主题过滤器
+ * @param handler 注册时的处理函数
+ * @param ctx 注册时的参数
+ * @return esp_err_t 
+ *         - ESP_OK: 成功
+ *         - ESP_ERR_NOT_FOUND: 未找到
+ */
+esp_err_t iot_manager_unsubscribe_handler(const char *filter,
+                                          iot_topic_handler_t handler, void *ctx);
+
 /**
  * @brief 获取MQTT客户端句柄
  * 
@@ -120,7 +273,7 @@ bool iot_manager_is_connected(void);
  * 使用JSON格式上报设备状态
  * 
  * @param status_json JSON格式的状态数据
- * @return int 消息ID，失败返回-1
+ * @return int 0已进入发送队列，失败返回-1
  */
 int iot_manager_report_status(const char *status_json);
 
@@ -128,20 +281,200 @@ int iot_manager_report_status(const char *status_json);
  * @brief 上报设备属性
  * 
  * @param properties_json JSON格式的属性数据
- * @return int 消息ID，失败返回-1
+ * @return int 0已进入发送队列，失败返回-1
  */
 int iot_manager_report_properties(const char *properties_json);
 
+/**
+ * @brief 批量上报设备属性
+ * 
+ * 启用批量上报（IOT_BATCH_ENABLE）时，样本先合并到批量缓冲，
+ * 以JSON数组 [{...},{...}] 的形式发布到属性主题。满足以下任一条件时发送：
+ * - 缓冲字节数达到 IOT_BATCH_MAX_BYTES
+ * - 样本数达到 IOT_BATCH_MAX_SAMPLES
+ * - 第一个样本入缓冲后超过 IOT_BATCH_MAX_LATENCY_MS
+ * - 调用 iot_manager_flush_properties()
+ * 
+ * 未启用批量上报时等同于 iot_manager_report_properties()。
+ * 
+ * @param properties_json 单个样本，JSON对象
+ * @return int 0成功，失败返回-1
+ */
+int iot_manager_batch_properties(const char *properties_json);
+
+/**
+ * @brief 按类别上报已编码的负载（JSON、CBOR或压缩时间序列）
+ * 
+ * 负载可以是二进制数据。MQTT5下设置content-type属性
+ * （application/json、application/cbor 或 application/x-iot-tsz），服务器据此识别格式；
+ * 压缩时间序列在负载开头另有 'T' 'Z' 标记，MQTT 3.1.1下也能识别。
+ * 批量上报时CBOR样本合并为CBOR不定长数组，格式变化时先发出已有的批次。
+ * 
+ * @param msg_class 消息类别（STATUS/PROPERTY/REPLY/EVENT）
+ * @param payload 负载
+ * @param len 负载长度
+ * @param flags IOT_REPORT_FLAG_*，可使用 iot_payload.h 中的 IOT_PAYLOAD_REPORT_FLAGS
+ * @return int 0已进入发送队列，失败返回-1
+ */
+int iot_manager_report(iot_msg_class_t msg_class, const void *payload, size_t len, uint32_t flags);
+
+/**
+ * @brief 立即发送批量缓冲中的样本
+ * 
+ * @return int 0已进入发送队列，失败返回-1
+ */
+int iot_manager_flush_properties(void);
+
+/**
+ * @brief 定义一个带死区的属性（本地影子）
+ * 
+ * 组件记录每个属性最后一次上报的值，iot_manager_property_report() 只上报
+ * 变化达到死区的属性。deadband和deadband_pct都为0时，任何变化都上报；
+ * 都设置时，达到其中之一即上报。重复定义同名属性时更新死区并返回原句柄。
+ * 
+ * @param name 属性名（JSON/CBOR中的键名）
+ * @param type 属性类型
+ * @param deadband 绝对死区，0表示不使用
+ * @param deadband_pct 相对上次上报值的百分比死区，0表示不使用
+ * @return int 属性句柄，失败返回-1（名称无效或超过 IOT_SHADOW_MAX_PROPS）
+ */
+int iot_manager_property_define(const char *name, iot_prop_type_t type,
+                                double deadband, double deadband_pct);
+
+/**
+ * @brief 更新整数/布尔属性的当前值（只更新影子，不发送）
+ */
+esp_err_t iot_manager_property_set_int(int prop, int64_t value);
+
+/**
+ * @brief 更新浮点属性的当前值（只更新影子，不发送）
+ */
+esp_err_t iot_manager_property_set_float(int prop, double value);
+
+/**
+ * @brief 上报变化的属性
+ * 
+ * 负载为 {"timestamp":..., "属性名":值, ...}，只包含变化达到死区的属性，
+ * 按 IOT_PAYLOAD_FORMAT 编码并进入批量缓冲（见 iot_manager_report()）。
+ * full为true或每 IOT_SHADOW_FULL_EVERY 次调用发送一次完整快照，
+ * 快照包含全部已设置的属性并带 "snapshot":true。
+ * 负载在调用任务的栈上编码（约48字节/属性）。
+ * 
+ * @param full 是否发送完整快照
+ * @return int 上报的属性数（0表示没有变化，未发送），失败返回-1
+ */
+int iot_manager_property_report(bool full);
+
 /**
  * @brief 响应命令执行结果
  * 
+ * 响应直接编码到发送队列槽位中，长度不能超过 IOT_TX_SLOT_SIZE。
+ * 
  * @param command_id 命令ID
  * @param result 执行结果 (0: 成功, 其他: 失败码)
  * @param message 结果消息
- * @return int 消息ID，失败返回-1
+ * @return int 0已进入发送队列，失败返回-1
  */
 int iot_manager_reply_command(const char *command_id, int result, const char *message);
 
+/**
+ * @brief 注册命令处理函数
+ * 
+ * 命令主题上收到已注册的命令时，不再交给数据回调，而是放入命令队列，
+ * 由命令工作任务执行，不阻塞MQTT任务。工作任务全忙且队列已满时回复
+ * IOT_CMD_RESULT_BUSY；超过超时时间未返回时回复 IOT_CMD_RESULT_TIMEOUT，
+ * 处理函数之后的返回结果被丢弃（任务无法被强制终止，处理函数应自行避免长时间阻塞）。
+ * 
+ * 可在 iot_manager_init() 之前调用。重复注册同名命令会替换原处理函数。
+ * 
+ * @param name 命令名（会被拷贝，长度小于 IOT_CMD_NAME_MAX_LEN）
+ * @param handler 处理函数，NULL表示注销
+ * @param flags IOT_CMD_FLAG_* 与 IOT_CMD_TIMEOUT_SEC() 的组合
+ * @return esp_err_t 
+ *         - ESP_OK: 成功
+ *         - ESP_ERR_INVALID_ARG: 参数错误或命令名过长
+ *         - ESP_ERR_NO_MEM: 命令表已满
+ */
+esp_err_t iot_manager_register_command(const char *name, iot_command_handler_t handler, uint32_t flags);
+
+/**
+ * @brief 设置某类消息的离线缓存策略
+ * 
+ * 默认状态消息不缓存（重连后会重新上报上线状态），其余类别挤掉最早的消息。
+ * 
+ * @param msg_class 消息类别
+ * @param policy 缓存策略
+ * @return esp_err_t 
+ *         - ESP_OK: 成功
+ *         - ESP_ERR_INVALID_ARG: 参数错误
+ */
+esp_err_t iot_manager_set_offline_policy(iot_msg_class_t msg_class, iot_offline_policy_t policy);
+
+/**
+ * @brief 获取离线缓存中待补发的消息条数
+ * 
+ * @return uint32_t 消息条数
+ */
+uint32_t iot_manager_get_offline_count(void);
+
+// 确认延迟直方图桶数，各桶上界为 10/25/50/100/250/500/1000/2500/5000ms，最后一桶无上界
+#define IOT_STATS_LATENCY_BUCKETS   10
+
+/**
+ * @brief 某类消息的发送流量
+ */
+typedef struct {
+    uint32_t messages;                  ///< 发布成功的消息数
+    uint64_t bytes;                     ///< 实际发送的主题和负载字节数（不含MQTT报文头）
+} iot_traffic_stats_t;
+
+/**
+ * @brief 发布统计（自启动起累计）
+ */
+typedef struct {
+    iot_traffic_stats_t traffic[IOT_MSG_CLASS_MAX];         ///< 按消息类别的流量
+    uint32_t ack_latency_hist[IOT_STATS_LATENCY_BUCKETS];   ///< QoS1/2发布到确认的延迟分布
+    uint64_t ack_latency_sum_ms;        ///< 延迟总和，除以直方图总数得到平均值
+    uint32_t ack_latency_max_ms;        ///< 最大延迟
+    uint16_t in_flight;                 ///< 当前等待确认的消息数
+    uint16_t in_flight_peak;            ///< 等待确认消息数的峰值
+    uint32_t untracked;                 ///< 在途表满、未计时的消息数
+    uint32_t retried;                   ///< 从离线缓存补发的消息数
+    uint32_t dropped;                   ///< 丢弃的消息数（队列满、缓存满、过期、发布失败）
+} iot_manager_stats_t;
+
+/**
+ * @brief 获取发布统计
+ *
+ * 设置 IOT_STATS_REPORT_INTERVAL_SEC 后，统计还会定期以事件消息上报
+ *
+ * @param stats 输出
+ * @return esp_err_t
+ *         - ESP_OK: 成功
+ *         - ESP_ERR_INVALID_ARG: 参数错误
+ */
+esp_err_t iot_manager_get_stats(iot_manager_stats_t *stats);
+
+/**
+ * @brief 立即在事件主题上报一次发布统计
+ *
+ * 由发布任务异步发送，格式与定期上报相同（含当前和最低空闲堆）。
+ * 外部压测工具可通过 get_stats 命令触发，用前后两次的计数和timestamp计算吞吐量。
+ *
+ * @return int 0已请求，-1未连接
+ */
+int iot_manager_report_stats(void);
+
+/**
+ * @brief 立即在事件主题上报一次健康数据
+ *
+ * 内容与 iot_health_encode() 相同：各任务栈剩余最小值和各类内存的空闲/最低/最大连续块，
+ * 由发布任务异步发送。定期上报间隔见 IOT_HEALTH_REPORT_INTERVAL_SEC。
+ *
+ * @return int 0已请求，-1未连接
+ */
+int iot_manager_report_health(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,96 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 无锁多生产者单消费者队列实现
+ *
+ * 槽位序号约定（pos为写入位置，N为槽位数）：
+ *   seq == pos       槽位空闲，可由写入位置为pos的生产者预留
+ *   seq == pos + 1   槽位已提交，可由消费者读取
+ *   seq == pos + N   消费者已释放，留给下一轮写入
+ */
+
+#include <string.h>
+#include "iot_mpsc_queue.h"
+
+#define MPSC_ALIGN          4
+#define MPSC_ALIGN_UP(x)    (((x) + (MPSC_ALIGN - 1)) & ~((size_t)MPSC_ALIGN - 1))
+
+static inline iot_mpsc_slot_t *slot_at(iot_mpsc_queue_t *q, uint32_t pos)
+{
+    return (iot_mpsc_slot_t *)(q->slots + (size_t)(pos & q->mask) * q->stride);
+}
+
+size_t iot_mpsc_mem_size(uint32_t capacity, uint32_t slot_size)
+{
+    return (size_t)capacity * MPSC_ALIGN_UP(sizeof(iot_mpsc_slot_t) + slot_size);
+}
+
+bool iot_mpsc_init(iot_mpsc_queue_t *q, void *mem, uint32_t capacity, uint32_t slot_size)
+{
+    if (!q || !mem || capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+
+    q->slots = mem;
+    q->stride = MPSC_ALIGN_UP(sizeof(iot_mpsc_slot_t) + slot_size);
+    q->slot_size = slot_size;
+    q->mask = capacity - 1;
+    q->dequeue_pos = 0;
+    atomic_init(&q->enqueue_pos, 0);
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        atomic_init(&slot_at(q, i)->seq, i);
+    }
+    return true;
+}
+
+iot_mpsc_slot_t *iot_mpsc_reserve(iot_mpsc_queue_t *q)
+{
+    uint32_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+
+    while (1) {
+        iot_mpsc_slot_t *slot = slot_at(q, pos);
+        uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            // 槽位空闲，竞争写入位置；失败时pos会被更新为最新值
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                slot->pos = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            // 消费者还没释放上一轮的数据，队列已满
+            return NULL;
+        } else {
+            // 其他生产者已抢先预留，重新读取写入位置
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+void iot_mpsc_commit(iot_mpsc_queue_t *q, iot_mpsc_slot_t *slot, uint32_t len, uint32_t tag)
+{
+    (void)q;
+    slot->len = len;
+    slot->tag = tag;
+    atomic_store_explicit(&slot->seq, slot->pos + 1, memory_order_release);
+}
+
+iot_mpsc_slot_t *iot_mpsc_peek(iot_mpsc_queue_t *q)
+{
+    iot_mpsc_slot_t *slot = slot_at(q, q->dequeue_pos);
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (seq != q->dequeue_pos + 1) {
+        return NULL;
+    }
+    return slot;
+}
+
+void iot_mpsc_release(iot_mpsc_queue_t *q, iot_mpsc_slot_t *slot)
+{
+    atomic_store_explicit(&slot->seq, q->dequeue_pos + q->mask + 1, memory_order_release);
+    q->dequeue_pos++;
+}
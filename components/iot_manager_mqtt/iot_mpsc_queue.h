@@ -0,0 +1,113 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 无锁多生产者单消费者队列
+ *
+ * 固定槽位的有界环形队列（基于每个槽位的序号实现），生产者之间只通过一次CAS竞争
+ * 写入位置，不加锁。生产者先预留槽位、直接在槽位中写数据、再提交，
+ * 因此消息可以在槽位内原地编码，无需额外拷贝。
+ *
+ * 只依赖C11原子操作，可以在主机上编译测试。
+ */
+
+#ifndef IOT_MPSC_QUEUE_H
+#define IOT_MPSC_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 队列槽位
+ */
+typedef struct {
+    _Atomic uint32_t seq;       ///< 槽位序号（内部使用）
+    uint32_t pos;               ///< 预留时的写入位置（内部使用）
+    uint32_t len;               ///< 数据长度
+    uint32_t tag;               ///< 用户自定义标记
+    uint8_t data[];             ///< 数据区，大小为slot_size
+} iot_mpsc_slot_t;
+
+/**
+ * @brief 队列
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    uint8_t *slots;             ///< 槽位存储区
+    size_t stride;              ///< 相邻槽位间隔
+    uint32_t slot_size;         ///< 每个槽位的数据区大小
+    uint32_t mask;              ///< 槽位数-1（槽位数为2的幂）
+    _Atomic uint32_t enqueue_pos; ///< 生产者写入位置
+    uint32_t dequeue_pos;       ///< 消费者读取位置（仅消费者访问）
+} iot_mpsc_queue_t;
+
+/**
+ * @brief 计算队列所需的存储区大小
+ *
+ * @param capacity 槽位数（必须为2的幂）
+ * @param slot_size 每个槽位的数据区大小
+ */
+size_t iot_mpsc_mem_size(uint32_t capacity, uint32_t slot_size);
+
+/**
+ * @brief 初始化队列
+ *
+ * @param q 队列
+ * @param mem 存储区，大小由 iot_mpsc_mem_size() 计算
+ * @param capacity 槽位数（必须为2的幂）
+ * @param slot_size 每个槽位的数据区大小
+ * @return true 成功
+ * @return false 参数错误
+ */
+bool iot_mpsc_init(iot_mpsc_queue_t *q, void *mem, uint32_t capacity, uint32_t slot_size);
+
+/**
+ * @brief 生产者预留一个槽位
+ *
+ * 可在任意任务中并发调用。预留后必须尽快调用 iot_mpsc_commit()，
+ * 否则消费者会在该槽位处等待。
+ *
+ * @return iot_mpsc_slot_t* 槽位，队列已满返回NULL
+ */
+iot_mpsc_slot_t *iot_mpsc_reserve(iot_mpsc_queue_t *q);
+
+/**
+ * @brief 生产者提交槽位
+ *
+ * @param slot 预留的槽位
+ * @param len 数据长度
+ * @param tag 用户自定义标记
+ */
+void iot_mpsc_commit(iot_mpsc_queue_t *q, iot_mpsc_slot_t *slot, uint32_t len, uint32_t tag);
+
+/**
+ * @brief 消费者查看下一个已提交的槽位
+ *
+ * @return iot_mpsc_slot_t* 槽位，没有可读数据返回NULL
+ */
+iot_mpsc_slot_t *iot_mpsc_peek(iot_mpsc_queue_t *q);
+
+/**
+ * @brief 消费者释放 iot_mpsc_peek() 返回的槽位
+ */
+void iot_mpsc_release(iot_mpsc_queue_t *q, iot_mpsc_slot_t *slot);
+
+/**
+ * @brief 获取槽位数据区大小
+ */
+static inline uint32_t iot_mpsc_slot_size(const iot_mpsc_queue_t *q)
+{
+    return q->slot_size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_MPSC_QUEUE_H
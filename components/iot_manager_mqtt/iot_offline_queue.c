@@ -0,0 +1,203 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 离线消息环形缓存实现
+ *
+ * 存储布局：每条记录 = 记录头 + 主题(含'\0') + 数据(含'\0')，按8字节对齐连续存放。
+ * 尾部剩余空间放不下一条完整记录时，写入填充标记并回绕到存储区开头，
+ * 保证每条记录在内存中都是连续的，出队发布时无需拷贝。
+ */
+
+#include <string.h>
+#include "iot_offline_queue.h"
+
+#define OQ_ALIGN            8
+#define OQ_ALIGN_UP(x)      (((x) + (OQ_ALIGN - 1)) & ~((size_t)OQ_ALIGN - 1))
+
+#define OQ_FLAG_QOS_MASK    0x03
+#define OQ_FLAG_RETAIN      0x04
+#define OQ_FLAG_FMT_SHIFT   3
+#define OQ_FLAG_FMT_MASK    0x03
+#define OQ_FLAG_PAD         0x80
+
+// 记录头
+typedef struct {
+    uint32_t seq;
+    uint32_t data_len;
+    int64_t enqueue_ms;
+    uint16_t topic_len;
+    uint8_t msg_class;
+    uint8_t flags;
+} oq_hdr_t;
+
+#define OQ_HDR_SIZE         OQ_ALIGN_UP(sizeof(oq_hdr_t))
+
+void iot_offline_queue_init(iot_offline_queue_t *q, void *buf, size_t capacity)
+{
+    memset(q, 0, sizeof(*q));
+    q->buf = buf;
+    // 容量向下对齐，保证每条记录的起始偏移都是对齐的
+    q->capacity = capacity & ~((size_t)OQ_ALIGN - 1);
+}
+
+/**
+ * @brief 跳过队首的回绕填充区
+ */
+static void skip_padding(iot_offline_queue_t *q)
+{
+    if (q->count == 0) {
+        return;
+    }
+    size_t remain = q->capacity - q->head;
+    bool is_pad = remain < OQ_HDR_SIZE;
+    if (!is_pad) {
+        oq_hdr_t hdr;
+        memcpy(&hdr, q->buf + q->head, sizeof(hdr));
+        is_pad = (hdr.flags & OQ_FLAG_PAD) != 0;
+    }
+    if (is_pad) {
+        q->used -= remain;
+        q->head = 0;
+    }
+}
+
+/**
+ * @brief 在存储区中为一条记录预留连续空间
+ */
+static bool reserve(iot_offline_queue_t *q, size_t size, size_t *offset)
+{
+    if (q->count == 0) {
+        q->head = q->tail = q->used = 0;
+    } else if (q->tail == q->head) {
+        return false;   // 已满
+    }
+
+    if (q->tail >= q->head) {
+        // 空闲区为 [tail, capacity) 和 [0, head)
+        if (q->capacity - q->tail >= size) {
+            *offset = q->tail;
+            return true;
+        }
+        if (q->head >= size) {
+            size_t remain = q->capacity - q->tail;
+            if (remain >= OQ_HDR_SIZE) {
+                oq_hdr_t pad = { .flags = OQ_FLAG_PAD };
+                memcpy(q->buf + q->tail, &pad, sizeof(pad));
+            }
+            q->used += remain;
+            q->tail = 0;
+            *offset = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // 空闲区为 [tail, head)
+    if (q->head - q->tail >= size) {
+        *offset = q->tail;
+        return true;
+    }
+    return false;
+}
+
+iot_oq_err_t iot_offline_queue_push(iot_offline_queue_t *q, uint8_t msg_class,
+                                    const char *topic, const char *data, uint32_t data_len,
+                                    uint8_t qos, bool retain, uint8_t format,
+                                    int64_t now_ms, bool evict_oldest)
+{
+    if (!q || !q->buf || !topic || (!data && data_len > 0)) {
+        return IOT_OQ_ERR_ARG;
+    }
+
+    size_t topic_len = strlen(topic);
+    if (topic_len > UINT16_MAX) {
+        return IOT_OQ_ERR_ARG;
+    }
+
+    size_t size = OQ_ALIGN_UP(OQ_HDR_SIZE + topic_len + 1 + data_len + 1);
+    if (size > q->capacity) {
+        q->dropped++;
+        return IOT_OQ_ERR_TOO_BIG;
+    }
+
+    size_t offset;
+    while (!reserve(q, size, &offset)) {
+        if (!evict_oldest || q->count == 0) {
+            q->dropped++;
+            return IOT_OQ_ERR_FULL;
+        }
+        iot_offline_queue_pop(q);
+        q->dropped++;
+    }
+
+    oq_hdr_t hdr = {
+        .seq = q->next_seq++,
+        .data_len = data_len,
+        .enqueue_ms = now_ms,
+        .topic_len = (uint16_t)topic_len,
+        .msg_class = msg_class,
+        .flags = (qos & OQ_FLAG_QOS_MASK) | (retain ? OQ_FLAG_RETAIN : 0) |
+                 ((format & OQ_FLAG_FMT_MASK) << OQ_FLAG_FMT_SHIFT),
+    };
+    uint8_t *p = q->buf + offset;
+    memcpy(p, &hdr, sizeof(hdr));
+    memcpy(p + OQ_HDR_SIZE, topic, topic_len + 1);
+    uint8_t *payload = p + OQ_HDR_SIZE + topic_len + 1;
+    if (data_len > 0) {
+        memcpy(payload, data, data_len);
+    }
+    payload[data_len] = '\0';
+
+    q->tail = offset + size;
+    if (q->tail == q->capacity) {
+        q->tail = 0;
+    }
+    q->used += size;
+    q->count++;
+    return IOT_OQ_OK;
+}
+
+bool iot_offline_queue_peek(iot_offline_queue_t *q, iot_oq_record_t *rec)
+{
+    skip_padding(q);
+    if (q->count == 0) {
+        return false;
+    }
+
+    oq_hdr_t hdr;
+    const uint8_t *p = q->buf + q->head;
+    memcpy(&hdr, p, sizeof(hdr));
+
+    rec->seq = hdr.seq;
+    rec->enqueue_ms = hdr.enqueue_ms;
+    rec->topic = (const char *)(p + OQ_HDR_SIZE);
+    rec->data = (const char *)(p + OQ_HDR_SIZE + hdr.topic_len + 1);
+    rec->data_len = hdr.data_len;
+    rec->msg_class = hdr.msg_class;
+    rec->qos = hdr.flags & OQ_FLAG_QOS_MASK;
+    rec->retain = (hdr.flags & OQ_FLAG_RETAIN) != 0;
+    rec->format = (hdr.flags >> OQ_FLAG_FMT_SHIFT) & OQ_FLAG_FMT_MASK;
+    return true;
+}
+
+void iot_offline_queue_pop(iot_offline_queue_t *q)
+{
+    skip_padding(q);
+    if (q->count == 0) {
+        return;
+    }
+
+    oq_hdr_t hdr;
+    memcpy(&hdr, q->buf + q->head, sizeof(hdr));
+    size_t size = OQ_ALIGN_UP(OQ_HDR_SIZE + hdr.topic_len + 1 + hdr.data_len + 1);
+
+    q->head += size;
+    if (q->head == q->capacity) {
+        q->head = 0;
+    }
+    q->used -= size;
+    q->count--;
+    if (q->count == 0) {
+        q->head = q->tail = q->used = 0;
+    }
+}
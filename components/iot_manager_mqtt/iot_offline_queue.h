@@ -0,0 +1,133 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 离线消息环形缓存
+ *
+ * MQTT断线期间暂存待发布消息的字节环形队列。
+ * 本模块只依赖C标准库，不加锁，由调用者负责互斥，
+ * 因此可以直接在主机上编译测试。
+ */
+
+#ifndef IOT_OFFLINE_QUEUE_H
+#define IOT_OFFLINE_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 入队结果
+ */
+typedef enum {
+    IOT_OQ_OK = 0,              ///< 入队成功
+    IOT_OQ_ERR_FULL = -1,       ///< 队列已满，新消息被丢弃
+    IOT_OQ_ERR_TOO_BIG = -2,    ///< 单条消息超过队列容量
+    IOT_OQ_ERR_ARG = -3,        ///< 参数错误
+} iot_oq_err_t;
+
+/**
+ * @brief 队列中的一条消息（指向队列内部存储，出队后失效）
+ */
+typedef struct {
+    uint32_t seq;               ///< 入队序号
+    int64_t enqueue_ms;         ///< 入队时间（毫秒）
+    const char *topic;          ///< 主题（以'\0'结尾）
+    const char *data;           ///< 消息数据（以'\0'结尾）
+    uint32_t data_len;          ///< 数据长度
+    uint8_t msg_class;          ///< 消息类别
+    uint8_t qos;                ///< QoS级别
+    bool retain;                ///< 是否保留消息
+    uint8_t format;             ///< 负载格式（由调用者定义，0~3）
+} iot_oq_record_t;
+
+/**
+ * @brief 离线队列
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    uint8_t *buf;               ///< 存储区
+    size_t capacity;            ///< 存储区字节数
+    size_t head;                ///< 最早一条记录的偏移
+    size_t tail;                ///< 下一条记录写入偏移
+    size_t used;                ///< 已用字节（含回绕填充）
+    uint32_t count;             ///< 记录条数
+    uint32_t next_seq;          ///< 下一个入队序号
+    uint32_t dropped;           ///< 累计丢弃条数
+} iot_offline_queue_t;
+
+/**
+ * @brief 初始化队列
+ *
+ * @param q 队列
+ * @param buf 调用者提供的存储区（建议8字节对齐）
+ * @param capacity 存储区字节数
+ */
+void iot_offline_queue_init(iot_offline_queue_t *q, void *buf, size_t capacity);
+
+/**
+ * @brief 消息入队
+ *
+ * @param q 队列
+ * @param msg_class 消息类别
+ * @param topic 主题
+ * @param data 数据
+ * @param data_len 数据长度
+ * @param qos QoS级别
+ * @param retain 是否保留消息
+ * @param format 负载格式（由调用者定义，0~3）
+ * @param now_ms 当前时间（毫秒）
+ * @param evict_oldest 空间不足时是否挤掉最早的消息
+ * @return iot_oq_err_t
+ */
+iot_oq_err_t iot_offline_queue_push(iot_offline_queue_t *q, uint8_t msg_class,
+                                    const char *topic, const char *data, uint32_t data_len,
+                                    uint8_t qos, bool retain, uint8_t format,
+                                    int64_t now_ms, bool evict_oldest);
+
+/**
+ * @brief 查看队首消息（不出队）
+ *
+ * @return true 有消息
+ * @return false 队列为空
+ */
+bool iot_offline_queue_peek(iot_offline_queue_t *q, iot_oq_record_t *rec);
+
+/**
+ * @brief 丢弃队首消息
+ */
+void iot_offline_queue_pop(iot_offline_queue_t *q);
+
+/**
+ * @brief 获取队列中的消息条数
+ */
+static inline uint32_t iot_offline_queue_count(const iot_offline_queue_t *q)
+{
+    return q->count;
+}
+
+/**
+ * @brief 获取已用字节数
+ */
+static inline size_t iot_offline_queue_used(const iot_offline_queue_t *q)
+{
+    return q->used;
+}
+
+/**
+ * @brief 获取累计丢弃条数
+ */
+static inline uint32_t iot_offline_queue_dropped(const iot_offline_queue_t *q)
+{
+    return q->dropped;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_OFFLINE_QUEUE_H
@@ -0,0 +1,92 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 按配置选择的负载编码器
+ *
+ * iot_payload_* 在编译时映射到JSON或CBOR编码器（menuconfig → Payload Encoding），
+ * 组件自身的上线消息、命令响应以及使用本头文件的应用代码都随配置切换格式。
+ * 上报时把 IOT_PAYLOAD_REPORT_FLAGS 传给 iot_manager_report()，
+ * MQTT5下服务器可以通过content-type识别格式。
+ *
+ * 示例:
+ *     uint8_t buf[128];
+ *     iot_payload_writer_t w;
+ *     iot_payload_init(&w, buf, sizeof(buf));
+ *     iot_payload_object_begin(&w);
+ *     iot_payload_kv_int(&w, "uptime", 3600);
+ *     iot_payload_kv_float(&w, "temperature", 23.5f);
+ *     iot_payload_object_end(&w);
+ *     int len = iot_payload_finish(&w);
+ *     iot_manager_report(IOT_MSG_CLASS_PROPERTY, buf, len, IOT_PAYLOAD_REPORT_FLAGS);
+ */
+
+#ifndef IOT_PAYLOAD_H
+#define IOT_PAYLOAD_H
+
+#include "sdkconfig.h"
+#include "iot_manager.h"
+
+#if CONFIG_IOT_PAYLOAD_FORMAT_CBOR
+
+#include "iot_cbor_writer.h"
+
+typedef iot_cbor_writer_t iot_payload_writer_t;
+
+#define IOT_PAYLOAD_REPORT_FLAGS    IOT_REPORT_FLAG_CBOR
+
+#define iot_payload_init            iot_cbor_init
+#define iot_payload_finish          iot_cbor_finish
+#define iot_payload_object_begin    iot_cbor_object_begin
+#define iot_payload_object_end      iot_cbor_object_end
+#define iot_payload_array_begin     iot_cbor_array_begin
+#define iot_payload_array_end       iot_cbor_array_end
+#define iot_payload_key             iot_cbor_key
+#define iot_payload_str             iot_cbor_str
+#define iot_payload_str_n           iot_cbor_str_n
+#define iot_payload_int             iot_cbor_int
+#define iot_payload_uint            iot_cbor_uint
+#define iot_payload_double          iot_cbor_double
+#define iot_payload_float           iot_cbor_float
+#define iot_payload_bool            iot_cbor_bool
+#define iot_payload_null            iot_cbor_null
+#define iot_payload_kv_str          iot_cbor_kv_str
+#define iot_payload_kv_int          iot_cbor_kv_int
+#define iot_payload_kv_uint         iot_cbor_kv_uint
+#define iot_payload_kv_double       iot_cbor_kv_double
+#define iot_payload_kv_float        iot_cbor_kv_float
+#define iot_payload_kv_bool         iot_cbor_kv_bool
+
+#else
+
+#include "iot_json_writer.h"
+
+typedef iot_json_writer_t iot_payload_writer_t;
+
+#define IOT_PAYLOAD_REPORT_FLAGS    0
+
+// JSON编码器的缓冲区为char，结尾保留'\0'
+#define iot_payload_init(w, buf, cap)   iot_json_init((w), (char *)(buf), (cap))
+#define iot_payload_finish          iot_json_finish
+#define iot_payload_object_begin    iot_json_object_begin
+#define iot_payload_object_end      iot_json_object_end
+#define iot_payload_array_begin     iot_json_array_begin
+#define iot_payload_array_end       iot_json_array_end
+#define iot_payload_key             iot_json_key
+#define iot_payload_str             iot_json_str
+#define iot_payload_str_n           iot_json_str_n
+#define iot_payload_int             iot_json_int
+#define iot_payload_uint            iot_json_uint
+#define iot_payload_double          iot_json_double
+#define iot_payload_float           iot_json_double
+#define iot_payload_bool            iot_json_bool
+#define iot_payload_null            iot_json_null
+#define iot_payload_kv_str          iot_json_kv_str
+#define iot_payload_kv_int          iot_json_kv_int
+#define iot_payload_kv_uint         iot_json_kv_uint
+#define iot_payload_kv_double       iot_json_kv_double
+#define iot_payload_kv_float        iot_json_kv_double
+#define iot_payload_kv_bool         iot_json_kv_bool
+
+#endif
+
+#endif // IOT_PAYLOAD_H
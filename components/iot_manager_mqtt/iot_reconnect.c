@@ -0,0 +1,148 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 连接监控与重连退避实现
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "iot_reconnect.h"
+
+static const char *TAG = "IOT_RECONNECT";
+
+// 退避指数上限，避免移位溢出
+#define BACKOFF_SHIFT_MAX   16
+
+typedef struct {
+    iot_reconnect_stats_t stats;
+    bool reported;                      ///< 是否报告过状态
+    uint32_t backoff;                   ///< 本次断开后的重连次数，决定退避时间
+    int64_t down_us;                    ///< 断开时间，0表示未在计时
+} link_state_t;
+
+static link_state_t links[IOT_LINK_MAX];
+static iot_link_up_callback_t link_up_callback = NULL;
+static portMUX_TYPE link_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const link_names[IOT_LINK_MAX] = { "WiFi", "MQTT" };
+
+void iot_reconnect_link_down(iot_link_t link)
+{
+    if (link >= IOT_LINK_MAX) {
+        return;
+    }
+
+    portENTER_CRITICAL(&link_mux);
+    link_state_t *l = &links[link];
+    bool was_up = l->stats.up;
+    if (was_up) {
+        // 首次连接之前的失败不算断开
+        l->stats.outages++;
+        l->down_us = esp_timer_get_time();
+    }
+    l->stats.up = false;
+    l->reported = true;
+    portEXIT_CRITICAL(&link_mux);
+
+    if (was_up) {
+        ESP_LOGW(TAG, "%s断开", link_names[link]);
+    }
+}
+
+void iot_reconnect_link_up(iot_link_t link)
+{
+    if (link >= IOT_LINK_MAX) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    uint32_t down_ms = 0;
+    uint32_t attempts = 0;
+    bool recovered = false;
+
+    portENTER_CRITICAL(&link_mux);
+    link_state_t *l = &links[link];
+    if (l->down_us) {
+        down_ms = (uint32_t)((now - l->down_us) / 1000);
+        attempts = l->backoff;
+        l->stats.recoveries++;
+        l->stats.last_ms = down_ms;
+        l->stats.total_ms += down_ms;
+        if (down_ms > l->stats.max_ms) {
+            l->stats.max_ms = down_ms;
+        }
+        l->down_us = 0;
+        recovered = true;
+    }
+    l->stats.up = true;
+    l->reported = true;
+    // 下层恢复后，上层从最短间隔重新开始退避
+    for (int i = link; i < IOT_LINK_MAX; i++) {
+        links[i].backoff = 0;
+    }
+    iot_link_up_callback_t cb = link_up_callback;
+    portEXIT_CRITICAL(&link_mux);
+
+    if (recovered) {
+        ESP_LOGI(TAG, "%s已恢复，断开%lums，重连%lu次", link_names[link],
+                 (unsigned long)down_ms, (unsigned long)attempts);
+    }
+    if (cb) {
+        cb(link);
+    }
+}
+
+bool iot_reconnect_link_is_up(iot_link_t link)
+{
+    if (link >= IOT_LINK_MAX) {
+        return false;
+    }
+    portENTER_CRITICAL(&link_mux);
+    bool up = links[link].stats.up || !links[link].reported;
+    portEXIT_CRITICAL(&link_mux);
+    return up;
+}
+
+uint32_t iot_reconnect_next_delay_ms(iot_link_t link)
+{
+    if (link >= IOT_LINK_MAX) {
+        return CONFIG_IOT_RECONNECT_MAX_MS;
+    }
+
+    portENTER_CRITICAL(&link_mux);
+    link_state_t *l = &links[link];
+    uint32_t shift = l->backoff < BACKOFF_SHIFT_MAX ? l->backoff : BACKOFF_SHIFT_MAX;
+    l->backoff++;
+    if (l->down_us) {
+        l->stats.attempts++;
+    }
+    portEXIT_CRITICAL(&link_mux);
+
+    uint64_t cap = (uint64_t)CONFIG_IOT_RECONNECT_BASE_MS << shift;
+    if (cap > CONFIG_IOT_RECONNECT_MAX_MS) {
+        cap = CONFIG_IOT_RECONNECT_MAX_MS;
+    }
+    uint32_t half = (uint32_t)cap / 2;
+    return half + esp_random() % (half + 1);
+}
+
+void iot_reconnect_set_callback(iot_link_up_callback_t callback)
+{
+    portENTER_CRITICAL(&link_mux);
+    link_up_callback = callback;
+    portEXIT_CRITICAL(&link_mux);
+}
+
+esp_err_t iot_reconnect_get_stats(iot_link_t link, iot_reconnect_stats_t *stats)
+{
+    if (link >= IOT_LINK_MAX || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&link_mux);
+    *stats = links[link].stats;
+    portEXIT_CRITICAL(&link_mux);
+    return ESP_OK;
+}
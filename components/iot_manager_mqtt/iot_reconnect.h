@@ -0,0 +1,100 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 连接监控与重连退避
+ *
+ * WiFi和MQTT共用的重连策略：每条链路断开后第n次重连前等待
+ *     d = min(IOT_RECONNECT_MAX_MS, IOT_RECONNECT_BASE_MS * 2^n)
+ * 中的 d/2 + random(0, d/2)（equal jitter），既保证间隔递增，又让同时断电恢复的
+ * 大量设备把重连分散开，不会同时冲击AP或服务器。
+ * 下层链路（WiFi）恢复时重置上层链路（MQTT）的退避，并通知上层立即安排重连。
+ * 同时记录每条链路的断开次数和从断开到恢复的时间。
+ *
+ * 所有函数可在任意任务中调用。
+ */
+
+#ifndef IOT_RECONNECT_H
+#define IOT_RECONNECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 受监控的链路，按层次从下到上排列
+ */
+typedef enum {
+    IOT_LINK_WIFI = 0,                  ///< WiFi STA（获取到IP为可用）
+    IOT_LINK_MQTT,                      ///< MQTT连接
+    IOT_LINK_MAX,
+} iot_link_t;
+
+/**
+ * @brief 链路重连统计（自启动起累计）
+ *
+ * 首次连接不计入，只统计连接成功后又断开的情况
+ */
+typedef struct {
+    bool up;                            ///< 当前是否可用
+    uint32_t outages;                   ///< 断开次数
+    uint32_t recoveries;                ///< 恢复次数
+    uint32_t attempts;                  ///< 断开期间的重连尝试次数（累计）
+    uint32_t last_ms;                   ///< 最近一次从断开到恢复的时间
+    uint32_t max_ms;                    ///< 最长恢复时间
+    uint64_t total_ms;                  ///< 恢复时间总和，除以recoveries得到平均值
+} iot_reconnect_stats_t;
+
+/**
+ * @brief 链路恢复回调（在调用 iot_reconnect_link_up() 的任务中执行，不能阻塞）
+ */
+typedef void (*iot_link_up_callback_t)(iot_link_t link);
+
+/**
+ * @brief 链路断开
+ *
+ * 可重复调用，只有从可用变为断开时开始计时
+ */
+void iot_reconnect_link_down(iot_link_t link);
+
+/**
+ * @brief 链路恢复，记录恢复时间并重置本链路和上层链路的退避
+ */
+void iot_reconnect_link_up(iot_link_t link);
+
+/**
+ * @brief 链路是否可用
+ *
+ * 从未报告过状态的链路视为可用（例如应用不使用wifi_manager时，WiFi不会阻止MQTT重连）
+ */
+bool iot_reconnect_link_is_up(iot_link_t link);
+
+/**
+ * @brief 计算下一次重连前的等待时间，并计入一次重连尝试
+ *
+ * @return uint32_t 等待时间（毫秒）
+ */
+uint32_t iot_reconnect_next_delay_ms(iot_link_t link);
+
+/**
+ * @brief 设置链路恢复回调（只支持一个，组件内部用于WiFi恢复后安排MQTT重连）
+ */
+void iot_reconnect_set_callback(iot_link_up_callback_t callback);
+
+/**
+ * @brief 获取链路重连统计
+ *
+ * @return esp_err_t
+ *         - ESP_OK: 成功
+ *         - ESP_ERR_INVALID_ARG: 参数错误
+ */
+esp_err_t iot_reconnect_get_stats(iot_link_t link, iot_reconnect_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_RECONNECT_H
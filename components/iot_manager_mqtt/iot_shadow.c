@@ -0,0 +1,232 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 属性影子与死区上报实现
+ *
+ * 每个属性保存当前值和最后一次上报的值。上报时在临界区内挑出需要发送的属性并拷贝其值，
+ * 在临界区外编码并写入发送队列，入队成功后再把拷贝的值记为已上报；
+ * 入队失败时影子不变，下次上报会重新发送这些属性。
+ */
+
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "iot_manager.h"
+#include "iot_payload.h"
+
+static const char *TAG = "IOT_SHADOW";
+
+// 上报负载缓冲区大小（在调用任务栈上）
+#define SHADOW_BUF_SIZE     (CONFIG_IOT_SHADOW_MAX_PROPS * (IOT_PROP_NAME_MAX_LEN + 24) + 48)
+
+typedef union {
+    int64_t i;
+    double f;
+} prop_value_t;
+
+/**
+ * @brief 属性影子
+ *
+ * name和type定义后不再修改，可在临界区外读取
+ */
+typedef struct {
+    char name[IOT_PROP_NAME_MAX_LEN];
+    iot_prop_type_t type;
+    double deadband;
+    double deadband_pct;
+    bool has_value;                     ///< 已设置过当前值
+    bool has_reported;                  ///< 已上报过
+    prop_value_t value;                 ///< 当前值
+    prop_value_t reported;              ///< 最后一次上报的值
+} prop_entry_t;
+
+static prop_entry_t props[CONFIG_IOT_SHADOW_MAX_PROPS];
+static int prop_count = 0;
+static portMUX_TYPE prop_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// 距上次完整快照的上报次数
+static uint32_t reports_since_full = 0;
+
+int iot_manager_property_define(const char *name, iot_prop_type_t type,
+                                double deadband, double deadband_pct)
+{
+    if (!name || type > IOT_PROP_BOOL || deadband < 0 || deadband_pct < 0) {
+        return -1;
+    }
+    size_t len = strlen(name);
+    if (len == 0 || len >= IOT_PROP_NAME_MAX_LEN) {
+        ESP_LOGE(TAG, "属性名无效: %s", name);
+        return -1;
+    }
+
+    int prop = -1;
+    portENTER_CRITICAL(&prop_mux);
+    for (int i = 0; i < prop_count; i++) {
+        if (strcmp(props[i].name, name) == 0) {
+            prop = i;
+            break;
+        }
+    }
+    if (prop < 0 && prop_count < CONFIG_IOT_SHADOW_MAX_PROPS) {
+        prop = prop_count;
+        memcpy(props[prop].name, name, len + 1);
+        props[prop].type = type;
+        prop_count++;
+    }
+    if (prop >= 0) {
+        props[prop].deadband = deadband;
+        props[prop].deadband_pct = deadband_pct;
+    }
+    portEXIT_CRITICAL(&prop_mux);
+
+    if (prop < 0) {
+        ESP_LOGE(TAG, "属性数已达上限(%d)，无法定义: %s", CONFIG_IOT_SHADOW_MAX_PROPS, name);
+    }
+    return prop;
+}
+
+static esp_err_t prop_set(int prop, prop_value_t value)
+{
+    if (prop < 0 || prop >= prop_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&prop_mux);
+    props[prop].value = value;
+    props[prop].has_value = true;
+    portEXIT_CRITICAL(&prop_mux);
+    return ESP_OK;
+}
+
+esp_err_t iot_manager_property_set_int(int prop, int64_t value)
+{
+    if (prop >= 0 && prop < prop_count && props[prop].type == IOT_PROP_FLOAT) {
+        return prop_set(prop, (prop_value_t){ .f = (double)value });
+    }
+    return prop_set(prop, (prop_value_t){ .i = value });
+}
+
+esp_err_t iot_manager_property_set_float(int prop, double value)
+{
+    if (prop >= 0 && prop < prop_count && props[prop].type != IOT_PROP_FLOAT) {
+        return prop_set(prop, (prop_value_t){ .i = (int64_t)llround(value) });
+    }
+    return prop_set(prop, (prop_value_t){ .f = value });
+}
+
+/**
+ * @brief 当前值相对上次上报值的变化是否达到死区（持有prop_mux时调用）
+ */
+static bool prop_changed(const prop_entry_t *p)
+{
+    if (!p->has_reported) {
+        return true;
+    }
+
+    double cur;
+    double last;
+    if (p->type == IOT_PROP_FLOAT) {
+        cur = p->value.f;
+        last = p->reported.f;
+        if (isnan(cur) || isnan(last)) {
+            return isnan(cur) != isnan(last);
+        }
+    } else {
+        if (p->value.i == p->reported.i) {
+            return false;
+        }
+        if (p->type == IOT_PROP_BOOL) {
+            return true;
+        }
+        cur = (double)p->value.i;
+        last = (double)p->reported.i;
+    }
+    if (cur == last) {
+        return false;
+    }
+    if (p->deadband <= 0 && p->deadband_pct <= 0) {
+        return true;
+    }
+
+    double diff = fabs(cur - last);
+    if (p->deadband > 0 && diff >= p->deadband) {
+        return true;
+    }
+    return p->deadband_pct > 0 && diff >= fabs(last) * p->deadband_pct / 100.0;
+}
+
+int iot_manager_property_report(bool full)
+{
+    struct {
+        int prop;
+        prop_value_t value;
+    } pending[CONFIG_IOT_SHADOW_MAX_PROPS];
+    int count = 0;
+
+    portENTER_CRITICAL(&prop_mux);
+#if CONFIG_IOT_SHADOW_FULL_EVERY > 0
+    if (++reports_since_full >= CONFIG_IOT_SHADOW_FULL_EVERY) {
+        full = true;
+    }
+#endif
+    for (int i = 0; i < prop_count; i++) {
+        if (props[i].has_value && (full || prop_changed(&props[i]))) {
+            pending[count].prop = i;
+            pending[count].value = props[i].value;
+            count++;
+        }
+    }
+    portEXIT_CRITICAL(&prop_mux);
+
+    if (count == 0) {
+        return 0;
+    }
+
+    char buf[SHADOW_BUF_SIZE];
+    iot_payload_writer_t w;
+    iot_payload_init(&w, buf, sizeof(buf));
+    iot_payload_object_begin(&w);
+    iot_payload_kv_int(&w, "timestamp", esp_timer_get_time() / 1000);
+    if (full) {
+        iot_payload_kv_bool(&w, "snapshot", true);
+    }
+    for (int i = 0; i < count; i++) {
+        const prop_entry_t *p = &props[pending[i].prop];
+        switch (p->type) {
+        case IOT_PROP_INT:
+            iot_payload_kv_int(&w, p->name, pending[i].value.i);
+            break;
+        case IOT_PROP_FLOAT:
+            iot_payload_kv_float(&w, p->name, pending[i].value.f);
+            break;
+        case IOT_PROP_BOOL:
+            iot_payload_kv_bool(&w, p->name, pending[i].value.i != 0);
+            break;
+        }
+    }
+    iot_payload_object_end(&w);
+
+    int len = iot_payload_finish(&w);
+    if (len < 0) {
+        ESP_LOGE(TAG, "属性上报超过%d字节", SHADOW_BUF_SIZE);
+        return -1;
+    }
+    if (iot_manager_report(IOT_MSG_CLASS_PROPERTY, buf, len,
+                           IOT_PAYLOAD_REPORT_FLAGS | IOT_REPORT_FLAG_BATCH) < 0) {
+        return -1;
+    }
+
+    portENTER_CRITICAL(&prop_mux);
+    for (int i = 0; i < count; i++) {
+        props[pending[i].prop].reported = pending[i].value;
+        props[pending[i].prop].has_reported = true;
+    }
+    if (full) {
+        reports_since_full = 0;
+    }
+    portEXIT_CRITICAL(&prop_mux);
+
+    ESP_LOGD(TAG, "上报%d个属性%s, %d字节", count, full ? "（完整快照）" : "", len);
+    return count;
+}
@@ -0,0 +1,111 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 固定大小内存块池实现
+ */
+
+#include "iot_slab.h"
+
+#define SLAB_NIL            0xffffu
+#define SLAB_INDEX(h)       ((h) & 0xffffu)
+#define SLAB_HEAD(ver, i)   (((ver) & 0xffff0000u) | (i))
+#define SLAB_VER_INC        0x10000u
+
+// 空闲链表放在块存储区之后
+static size_t slab_blocks_size(uint32_t block_size, uint32_t count)
+{
+    size_t size = (size_t)block_size * count;
+    return (size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+}
+
+static uint32_t slab_round_size(uint32_t block_size)
+{
+    return (block_size + 3) & ~3u;
+}
+
+size_t iot_slab_mem_size(uint32_t block_size, uint32_t count)
+{
+    return slab_blocks_size(slab_round_size(block_size), count) + count * sizeof(uint16_t);
+}
+
+bool iot_slab_init(iot_slab_t *s, void *mem, uint32_t block_size, uint32_t count)
+{
+    if (!s || !mem || block_size == 0 || count == 0 || count > IOT_SLAB_MAX_BLOCKS) {
+        return false;
+    }
+
+    s->block_size = slab_round_size(block_size);
+    s->count = count;
+    s->blocks = mem;
+    s->next = (_Atomic uint16_t *)(s->blocks + slab_blocks_size(s->block_size, count));
+    for (uint32_t i = 0; i < count; i++) {
+        atomic_init(&s->next[i], i + 1 < count ? (uint16_t)(i + 1) : SLAB_NIL);
+    }
+    atomic_init(&s->head, 0);
+    atomic_init(&s->used, 0);
+    atomic_init(&s->peak, 0);
+    atomic_init(&s->allocs, 0);
+    atomic_init(&s->fails, 0);
+    return true;
+}
+
+void *iot_slab_alloc(iot_slab_t *s)
+{
+    uint32_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+    uint32_t index;
+    for (;;) {
+        index = SLAB_INDEX(head);
+        if (index == SLAB_NIL) {
+            atomic_fetch_add_explicit(&s->fails, 1, memory_order_relaxed);
+            return NULL;
+        }
+        // 读到的next可能已过期，此时head的版本号已变化，CAS会失败重试
+        uint32_t next = atomic_load_explicit(&s->next[index], memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&s->head, &head,
+                                                  SLAB_HEAD(head + SLAB_VER_INC, next),
+                                                  memory_order_acquire, memory_order_acquire)) {
+            break;
+        }
+    }
+
+    uint32_t used = atomic_fetch_add_explicit(&s->used, 1, memory_order_relaxed) + 1;
+    uint32_t peak = atomic_load_explicit(&s->peak, memory_order_relaxed);
+    while (used > peak &&
+           !atomic_compare_exchange_weak_explicit(&s->peak, &peak, used,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    atomic_fetch_add_explicit(&s->allocs, 1, memory_order_relaxed);
+    return s->blocks + (size_t)index * s->block_size;
+}
+
+void iot_slab_free(iot_slab_t *s, void *p)
+{
+    if (!p) {
+        return;
+    }
+    uint32_t index = (uint32_t)(((uint8_t *)p - s->blocks) / s->block_size);
+    // 先减计数再放回，计数不会超过实际使用的块数
+    atomic_fetch_sub_explicit(&s->used, 1, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&s->next[index], (uint16_t)SLAB_INDEX(head), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&s->head, &head,
+                                                    SLAB_HEAD(head + SLAB_VER_INC, index),
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+bool iot_slab_owns(const iot_slab_t *s, const void *p)
+{
+    const uint8_t *b = p;
+    return s->blocks && b >= s->blocks && b < s->blocks + (size_t)s->block_size * s->count;
+}
+
+void iot_slab_get_stats(iot_slab_t *s, iot_slab_stats_t *stats)
+{
+    stats->block_size = s->block_size;
+    stats->count = s->count;
+    stats->used = atomic_load_explicit(&s->used, memory_order_relaxed);
+    stats->peak = atomic_load_explicit(&s->peak, memory_order_relaxed);
+    stats->allocs = atomic_load_explicit(&s->allocs, memory_order_relaxed);
+    stats->fails = atomic_load_explicit(&s->fails, memory_order_relaxed);
+}
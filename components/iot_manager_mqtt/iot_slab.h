@@ -0,0 +1,107 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 固定大小内存块池
+ *
+ * 启动时一次性分配的若干等大内存块，用无锁栈（带版本号的CAS，避免ABA）管理空闲块，
+ * 可在任意任务中并发分配和释放。反复分配释放同样大小的短生命周期缓冲区时不经过通用堆，
+ * 长时间运行也不会产生碎片。记录使用峰值和分配失败次数，用于调整块数。
+ *
+ * 只依赖C11原子操作，可以在主机上编译测试。
+ */
+
+#ifndef IOT_SLAB_H
+#define IOT_SLAB_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_SLAB_MAX_BLOCKS     0xfffe  ///< 最多块数
+
+/**
+ * @brief 内存块池
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    uint8_t *blocks;                    ///< 块存储区
+    _Atomic uint16_t *next;             ///< 空闲链表
+    uint32_t block_size;
+    uint32_t count;
+    _Atomic uint32_t head;              ///< 高16位版本号，低16位空闲块下标
+    _Atomic uint32_t used;
+    _Atomic uint32_t peak;
+    _Atomic uint32_t allocs;
+    _Atomic uint32_t fails;
+} iot_slab_t;
+
+/**
+ * @brief 内存块池统计
+ */
+typedef struct {
+    uint32_t block_size;                ///< 块大小
+    uint32_t count;                     ///< 块数
+    uint32_t used;                      ///< 当前使用的块数
+    uint32_t peak;                      ///< 使用峰值
+    uint32_t allocs;                    ///< 分配成功次数
+    uint32_t fails;                     ///< 池已满导致的分配失败次数
+} iot_slab_stats_t;
+
+/**
+ * @brief 计算块池所需的存储区大小
+ */
+size_t iot_slab_mem_size(uint32_t block_size, uint32_t count);
+
+/**
+ * @brief 初始化块池
+ *
+ * @param s 块池
+ * @param mem 存储区，大小由 iot_slab_mem_size() 计算，按指针对齐
+ * @param block_size 块大小（向上取整为4的倍数）
+ * @param count 块数，1 ~ IOT_SLAB_MAX_BLOCKS
+ * @return true 成功
+ * @return false 参数错误
+ */
+bool iot_slab_init(iot_slab_t *s, void *mem, uint32_t block_size, uint32_t count);
+
+/**
+ * @brief 分配一块
+ *
+ * @return void* 内存块，池已满返回NULL
+ */
+void *iot_slab_alloc(iot_slab_t *s);
+
+/**
+ * @brief 释放 iot_slab_alloc() 分配的块
+ */
+void iot_slab_free(iot_slab_t *s, void *p);
+
+/**
+ * @brief 指针是否属于块池
+ */
+bool iot_slab_owns(const iot_slab_t *s, const void *p);
+
+/**
+ * @brief 获取块大小
+ */
+static inline uint32_t iot_slab_block_size(const iot_slab_t *s)
+{
+    return s->block_size;
+}
+
+/**
+ * @brief 获取统计
+ */
+void iot_slab_get_stats(iot_slab_t *s, iot_slab_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_SLAB_H
@@ -0,0 +1,64 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 无锁单生产者单消费者环形缓冲区实现
+ *
+ * head和tail单调递增（32位回绕），head - tail为元素个数。
+ * 生产者先写元素再以release发布head，消费者以acquire读到head后元素内容一定可见；
+ * 消费者拷贝完元素再以release发布tail，生产者读到tail后才会覆盖该位置。
+ */
+
+#include <string.h>
+#include "iot_spsc_ring.h"
+
+size_t iot_spsc_mem_size(uint32_t capacity, uint32_t item_size)
+{
+    return (size_t)capacity * item_size;
+}
+
+bool iot_spsc_init(iot_spsc_ring_t *r, void *mem, uint32_t capacity, uint32_t item_size)
+{
+    if (!r || !mem || item_size == 0 || capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+
+    r->items = mem;
+    r->item_size = item_size;
+    r->mask = capacity - 1;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return true;
+}
+
+bool iot_spsc_push(iot_spsc_ring_t *r, const void *item)
+{
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail > r->mask) {
+        return false;
+    }
+
+    memcpy(r->items + (size_t)(head & r->mask) * r->item_size, item, r->item_size);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool iot_spsc_pop(iot_spsc_ring_t *r, void *item)
+{
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+
+    memcpy(item, r->items + (size_t)(tail & r->mask) * r->item_size, r->item_size);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+uint32_t iot_spsc_count(iot_spsc_ring_t *r)
+{
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    return head - tail;
+}
@@ -0,0 +1,91 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 无锁单生产者单消费者环形缓冲区
+ *
+ * 固定大小元素的有界环形缓冲区。写入位置只由生产者修改，读取位置只由消费者修改，
+ * 双方各用一次acquire读取对方的位置，不需要CAS和锁，适合采样任务和处理任务之间
+ * 高频传递样本。满时写入失败，由生产者决定丢弃并计数。
+ *
+ * 只依赖C11原子操作，可以在主机上编译测试。
+ */
+
+#ifndef IOT_SPSC_RING_H
+#define IOT_SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 环形缓冲区
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    uint8_t *items;             ///< 元素存储区
+    uint32_t item_size;         ///< 元素大小
+    uint32_t mask;              ///< 容量-1（容量为2的幂）
+    _Atomic uint32_t head;      ///< 写入位置（仅生产者修改）
+    _Atomic uint32_t tail;      ///< 读取位置（仅消费者修改）
+} iot_spsc_ring_t;
+
+/**
+ * @brief 计算环形缓冲区所需的存储区大小
+ *
+ * @param capacity 元素个数（必须为2的幂）
+ * @param item_size 元素大小
+ */
+size_t iot_spsc_mem_size(uint32_t capacity, uint32_t item_size);
+
+/**
+ * @brief 初始化环形缓冲区
+ *
+ * @param r 环形缓冲区
+ * @param mem 存储区，大小由 iot_spsc_mem_size() 计算
+ * @param capacity 元素个数（必须为2的幂）
+ * @param item_size 元素大小
+ * @return true 成功
+ * @return false 参数错误
+ */
+bool iot_spsc_init(iot_spsc_ring_t *r, void *mem, uint32_t capacity, uint32_t item_size);
+
+/**
+ * @brief 生产者写入一个元素（只能在一个任务中调用）
+ *
+ * @return true 成功
+ * @return false 已满
+ */
+bool iot_spsc_push(iot_spsc_ring_t *r, const void *item);
+
+/**
+ * @brief 消费者取出一个元素（只能在一个任务中调用）
+ *
+ * @return true 成功
+ * @return false 为空
+ */
+bool iot_spsc_pop(iot_spsc_ring_t *r, void *item);
+
+/**
+ * @brief 当前元素个数（任意任务中调用，结果只是一个快照）
+ */
+uint32_t iot_spsc_count(iot_spsc_ring_t *r);
+
+/**
+ * @brief 获取容量
+ */
+static inline uint32_t iot_spsc_capacity(const iot_spsc_ring_t *r)
+{
+    return r->mask + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_SPSC_RING_H
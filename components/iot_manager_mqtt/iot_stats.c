@@ -0,0 +1,168 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 发布统计实现
+ *
+ * QoS>0的消息发布后在固定大小的在途表中记录msg_id和开始时间，
+ * 收到PUBLISHED事件时按msg_id找到表项，计入延迟直方图。
+ * esp-mqtt可能在esp_mqtt_client_publish()返回之前就处理了确认，
+ * 这种确认先放入early_acks，登记在途表项时再匹配。
+ */
+
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "iot_stats.h"
+
+// 先于登记到达的确认最多保留几条
+#define EARLY_ACK_SLOTS     4
+
+// 延迟直方图各桶上界（毫秒），最后一桶无上界
+static const uint32_t latency_bounds_ms[IOT_STATS_LATENCY_BUCKETS - 1] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000,
+};
+
+typedef struct {
+    int msg_id;                         ///< 0表示空闲
+    int64_t start_us;
+} in_flight_t;
+
+typedef struct {
+    int msg_id;
+    int64_t ack_us;
+} early_ack_t;
+
+static iot_manager_stats_t stats;
+static in_flight_t in_flight[CONFIG_IOT_STATS_IN_FLIGHT_MAX];
+static early_ack_t early_acks[EARLY_ACK_SLOTS];
+static uint32_t early_ack_next = 0;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief 计入一次确认延迟（持有stats_mux时调用）
+ */
+static void record_latency(int64_t latency_us)
+{
+    uint32_t ms = latency_us > 0 ? (uint32_t)(latency_us / 1000) : 0;
+    int bucket = 0;
+    while (bucket < IOT_STATS_LATENCY_BUCKETS - 1 && ms >= latency_bounds_ms[bucket]) {
+        bucket++;
+    }
+    stats.ack_latency_hist[bucket]++;
+    stats.ack_latency_sum_ms += ms;
+    if (ms > stats.ack_latency_max_ms) {
+        stats.ack_latency_max_ms = ms;
+    }
+}
+
+/**
+ * @brief 取出在途表项（持有stats_mux时调用）
+ */
+static in_flight_t *in_flight_take(int msg_id)
+{
+    for (int i = 0; i < CONFIG_IOT_STATS_IN_FLIGHT_MAX; i++) {
+        if (in_flight[i].msg_id == msg_id) {
+            in_flight[i].msg_id = 0;
+            stats.in_flight--;
+            return &in_flight[i];
+        }
+    }
+    return NULL;
+}
+
+void iot_stats_published(iot_msg_class_t msg_class, size_t bytes, int msg_id, int64_t start_us)
+{
+    portENTER_CRITICAL(&stats_mux);
+    stats.traffic[msg_class].messages++;
+    stats.traffic[msg_class].bytes += bytes;
+
+    if (msg_id > 0) {
+        // 早于本次发布开始的确认属于之前使用同一msg_id的消息（例如断开时放弃的），不匹配
+        for (int i = 0; i < EARLY_ACK_SLOTS; i++) {
+            if (early_acks[i].msg_id == msg_id && early_acks[i].ack_us >= start_us) {
+                early_acks[i].msg_id = 0;
+                record_latency(early_acks[i].ack_us - start_us);
+                portEXIT_CRITICAL(&stats_mux);
+                return;
+            }
+        }
+
+        // 表满时替换最早的表项，被替换的消息不再计时
+        in_flight_t *slot = &in_flight[0];
+        for (int i = 0; i < CONFIG_IOT_STATS_IN_FLIGHT_MAX; i++) {
+            if (in_flight[i].msg_id == 0) {
+                slot = &in_flight[i];
+                break;
+            }
+            if (in_flight[i].start_us < slot->start_us) {
+                slot = &in_flight[i];
+            }
+        }
+        if (slot->msg_id != 0) {
+            stats.untracked++;
+        } else {
+            stats.in_flight++;
+            if (stats.in_flight > stats.in_flight_peak) {
+                stats.in_flight_peak = stats.in_flight;
+            }
+        }
+        slot->msg_id = msg_id;
+        slot->start_us = start_us;
+    }
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void iot_stats_acked(int msg_id)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&stats_mux);
+    in_flight_t *entry = in_flight_take(msg_id);
+    if (entry) {
+        record_latency(now_us - entry->start_us);
+    } else {
+        early_acks[early_ack_next].msg_id = msg_id;
+        early_acks[early_ack_next].ack_us = now_us;
+        early_ack_next = (early_ack_next + 1) % EARLY_ACK_SLOTS;
+    }
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void iot_stats_deleted(int msg_id)
+{
+    portENTER_CRITICAL(&stats_mux);
+    in_flight_take(msg_id);
+    stats.dropped++;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void iot_stats_abandon_in_flight(void)
+{
+    portENTER_CRITICAL(&stats_mux);
+    stats.dropped += stats.in_flight;
+    stats.in_flight = 0;
+    memset(in_flight, 0, sizeof(in_flight));
+    memset(early_acks, 0, sizeof(early_acks));
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void iot_stats_dropped(void)
+{
+    portENTER_CRITICAL(&stats_mux);
+    stats.dropped++;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void iot_stats_retried(void)
+{
+    portENTER_CRITICAL(&stats_mux);
+    stats.retried++;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void iot_stats_get(iot_manager_stats_t *out)
+{
+    portENTER_CRITICAL(&stats_mux);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_mux);
+}
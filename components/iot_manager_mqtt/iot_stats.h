@@ -0,0 +1,66 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 发布统计（组件内部接口）
+ *
+ * 公共类型和 iot_manager_get_stats() 声明在 iot_manager.h 中。
+ * 所有函数可在任意任务中调用。
+ */
+
+#ifndef IOT_STATS_H
+#define IOT_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "iot_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 记录一次成功的发布
+ *
+ * QoS>0的消息按msg_id记录开始时间，收到确认时计算延迟
+ *
+ * @param bytes 实际发送的主题和负载字节数
+ * @param msg_id esp_mqtt_client_publish()的返回值，QoS0为0
+ * @param start_us 调用发布前的时间戳
+ */
+void iot_stats_published(iot_msg_class_t msg_class, size_t bytes, int msg_id, int64_t start_us);
+
+/**
+ * @brief 收到确认（MQTT_EVENT_PUBLISHED，在MQTT任务中调用）
+ */
+void iot_stats_acked(int msg_id);
+
+/**
+ * @brief 消息超时从esp-mqtt outbox删除（MQTT_EVENT_DELETED）
+ */
+void iot_stats_deleted(int msg_id);
+
+/**
+ * @brief 未确认的消息全部作废（客户端销毁时调用）
+ */
+void iot_stats_abandon_in_flight(void);
+
+/**
+ * @brief 丢弃消息计数
+ */
+void iot_stats_dropped(void);
+
+/**
+ * @brief 离线缓存补发计数
+ */
+void iot_stats_retried(void);
+
+/**
+ * @brief 读取统计快照
+ */
+void iot_stats_get(iot_manager_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_STATS_H
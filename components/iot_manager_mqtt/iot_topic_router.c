@@ -0,0 +1,366 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - MQTT主题路由实现
+ *
+ * 节点保存在一个连续数组中，0号为根节点。普通子节点登记在开放寻址哈希表里，
+ * 键为(父节点编号, 层级名)；'+'子节点由父节点的plus字段直接指向；
+ * 以'#'结尾的过滤器不单独建节点，其值挂在'#'前一层节点的multi链表上。
+ * 节点只增不删，删除过滤器时只摘除值，因此哈希表不需要处理删除标记。
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "iot_topic_router.h"
+
+#define TR_NONE             UINT32_MAX
+#define TR_INIT_NODES       16
+#define TR_INIT_SLOTS       32
+
+typedef struct {
+    char *seg;              // 层级名（'\0'结尾）
+    uint32_t seg_len;
+    uint32_t parent;
+    uint32_t hash;          // (parent, seg)的哈希值，扩容时复用
+    uint32_t plus;          // '+'子节点
+    uint32_t values;        // 在本层结束的过滤器的值链表
+    uint32_t multi;         // 本层之后为'#'的过滤器的值链表
+} tr_node_t;
+
+typedef struct {
+    void *value;
+    uint32_t next;
+} tr_value_t;
+
+struct iot_topic_router {
+    tr_node_t *nodes;
+    uint32_t node_count;
+    uint32_t node_cap;
+    tr_value_t *values;
+    uint32_t value_count;
+    uint32_t value_cap;
+    uint32_t value_free;    // 空闲值链表
+    uint32_t *slots;        // 普通子节点哈希表，存节点编号
+    uint32_t slot_mask;
+};
+
+static uint32_t seg_hash(uint32_t parent, const char *s, size_t len)
+{
+    // FNV-1a，以父节点编号作为前缀
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 4; i++) {
+        h = (h ^ ((parent >> (i * 8)) & 0xFF)) * 16777619u;
+    }
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)s[i]) * 16777619u;
+    }
+    return h;
+}
+
+static uint32_t find_child(const iot_topic_router_t *r, uint32_t parent,
+                           const char *s, size_t len, uint32_t hash)
+{
+    for (uint32_t i = hash & r->slot_mask;; i = (i + 1) & r->slot_mask) {
+        uint32_t n = r->slots[i];
+        if (n == TR_NONE) {
+            return TR_NONE;
+        }
+        const tr_node_t *node = &r->nodes[n];
+        if (node->hash == hash && node->parent == parent && node->seg_len == len &&
+            memcmp(node->seg, s, len) == 0) {
+            return n;
+        }
+    }
+}
+
+static void slot_insert(uint32_t *slots, uint32_t mask, uint32_t hash, uint32_t n)
+{
+    uint32_t i = hash & mask;
+    while (slots[i] != TR_NONE) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = n;
+}
+
+/**
+ * @brief 哈希表扩容一倍（负载因子保持在1/2以下）
+ */
+static bool slots_grow(iot_topic_router_t *r)
+{
+    uint32_t size = (r->slot_mask + 1) * 2;
+    uint32_t *slots = malloc(size * sizeof(uint32_t));
+    if (slots == NULL) {
+        return false;
+    }
+    memset(slots, 0xFF, size * sizeof(uint32_t));
+    for (uint32_t i = 0; i <= r->slot_mask; i++) {
+        uint32_t n = r->slots[i];
+        if (n != TR_NONE) {
+            slot_insert(slots, size - 1, r->nodes[n].hash, n);
+        }
+    }
+    free(r->slots);
+    r->slots = slots;
+    r->slot_mask = size - 1;
+    return true;
+}
+
+static uint32_t new_node(iot_topic_router_t *r, uint32_t parent, const char *s, size_t len)
+{
+    if (r->node_count == r->node_cap) {
+        tr_node_t *nodes = realloc(r->nodes, r->node_cap * 2 * sizeof(tr_node_t));
+        if (nodes == NULL) {
+            return TR_NONE;
+        }
+        r->nodes = nodes;
+        r->node_cap *= 2;
+    }
+    char *seg = malloc(len + 1);
+    if (seg == NULL) {
+        return TR_NONE;
+    }
+    memcpy(seg, s, len);
+    seg[len] = '\0';
+
+    uint32_t n = r->node_count++;
+    tr_node_t *node = &r->nodes[n];
+    node->seg = seg;
+    node->seg_len = (uint32_t)len;
+    node->parent = parent;
+    node->hash = seg_hash(parent, s, len);
+    node->plus = TR_NONE;
+    node->values = TR_NONE;
+    node->multi = TR_NONE;
+    return n;
+}
+
+iot_topic_router_t *iot_topic_router_create(void)
+{
+    iot_topic_router_t *r = calloc(1, sizeof(*r));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->nodes = malloc(TR_INIT_NODES * sizeof(tr_node_t));
+    r->slots = malloc(TR_INIT_SLOTS * sizeof(uint32_t));
+    if (r->nodes == NULL || r->slots == NULL) {
+        free(r->nodes);
+        free(r->slots);
+        free(r);
+        return NULL;
+    }
+    r->node_cap = TR_INIT_NODES;
+    r->slot_mask = TR_INIT_SLOTS - 1;
+    memset(r->slots, 0xFF, TR_INIT_SLOTS * sizeof(uint32_t));
+    r->value_free = TR_NONE;
+
+    if (new_node(r, TR_NONE, "", 0) == TR_NONE) {
+        iot_topic_router_destroy(r);
+        return NULL;
+    }
+    return r;
+}
+
+void iot_topic_router_destroy(iot_topic_router_t *r)
+{
+    if (r == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i < r->node_count; i++) {
+        free(r->nodes[i].seg);
+    }
+    free(r->nodes);
+    free(r->values);
+    free(r->slots);
+    free(r);
+}
+
+bool iot_topic_filter_valid(const char *filter)
+{
+    if (filter == NULL || filter[0] == '\0') {
+        return false;
+    }
+    for (const char *p = filter; *p; p++) {
+        if (*p == '+' || *p == '#') {
+            bool level_start = (p == filter || p[-1] == '/');
+            bool level_end = (p[1] == '\0' || p[1] == '/');
+            if (!level_start || !level_end) {
+                return false;
+            }
+            if (*p == '#' && p[1] != '\0') {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 沿过滤器查找值链表头
+ *
+ * @param create 不存在的节点是否创建
+ * @return uint32_t* 值链表头，找不到或内存不足返回NULL
+ */
+static uint32_t *filter_list(iot_topic_router_t *r, const char *filter, bool create)
+{
+    uint32_t n = 0;
+    const char *p = filter;
+    for (;;) {
+        const char *sep = strchr(p, '/');
+        size_t len = sep ? (size_t)(sep - p) : strlen(p);
+
+        if (len == 1 && p[0] == '#') {
+            return &r->nodes[n].multi;
+        }
+
+        uint32_t child;
+        if (len == 1 && p[0] == '+') {
+            child = r->nodes[n].plus;
+            if (child == TR_NONE && create) {
+                child = new_node(r, n, p, len);
+                if (child != TR_NONE) {
+                    r->nodes[n].plus = child;
+                }
+            }
+        } else {
+            uint32_t hash = seg_hash(n, p, len);
+            child = find_child(r, n, p, len, hash);
+            if (child == TR_NONE && create) {
+                if ((r->node_count + 1) * 2 > r->slot_mask + 1 && !slots_grow(r)) {
+                    return NULL;
+                }
+                child = new_node(r, n, p, len);
+                if (child != TR_NONE) {
+                    slot_insert(r->slots, r->slot_mask, hash, child);
+                }
+            }
+        }
+        if (child == TR_NONE) {
+            return NULL;
+        }
+        n = child;
+
+        if (sep == NULL) {
+            return &r->nodes[n].values;
+        }
+        p = sep + 1;
+    }
+}
+
+bool iot_topic_router_add(iot_topic_router_t *r, const char *filter, void *value)
+{
+    if (r == NULL || value == NULL || !iot_topic_filter_valid(filter)) {
+        return false;
+    }
+
+    // 先准备好值槽位，避免建好节点后才发现内存不足
+    if (r->value_free == TR_NONE && r->value_count == r->value_cap) {
+        uint32_t cap = r->value_cap ? r->value_cap * 2 : 8;
+        tr_value_t *values = realloc(r->values, cap * sizeof(tr_value_t));
+        if (values == NULL) {
+            return false;
+        }
+        r->values = values;
+        r->value_cap = cap;
+    }
+
+    uint32_t *head = filter_list(r, filter, true);
+    if (head == NULL) {
+        return false;
+    }
+
+    uint32_t v;
+    if (r->value_free != TR_NONE) {
+        v = r->value_free;
+        r->value_free = r->values[v].next;
+    } else {
+        v = r->value_count++;
+    }
+    r->values[v].value = value;
+    r->values[v].next = *head;
+    *head = v;
+    return true;
+}
+
+bool iot_topic_router_remove(iot_topic_router_t *r, const char *filter, void *value)
+{
+    if (r == NULL || !iot_topic_filter_valid(filter)) {
+        return false;
+    }
+    uint32_t *link = filter_list(r, filter, false);
+    if (link == NULL) {
+        return false;
+    }
+    while (*link != TR_NONE) {
+        uint32_t v = *link;
+        if (r->values[v].value == value) {
+            *link = r->values[v].next;
+            r->values[v].value = NULL;
+            r->values[v].next = r->value_free;
+            r->value_free = v;
+            return true;
+        }
+        link = &r->values[v].next;
+    }
+    return false;
+}
+
+static size_t visit_list(const iot_topic_router_t *r, uint32_t v,
+                         iot_topic_router_visit_t visit, void *arg)
+{
+    size_t count = 0;
+    for (; v != TR_NONE; v = r->values[v].next) {
+        if (visit) {
+            visit(r->values[v].value, arg);
+        }
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief 从节点n开始匹配主题的剩余层级
+ *
+ * 递归深度不超过字典树深度（即最长过滤器的层级数）
+ *
+ * @param p 当前层级起始位置
+ * @param done 主题已全部匹配完
+ * @param wild_ok 本层允许匹配通配符（'$'开头的主题首层不允许）
+ */
+static size_t match_node(const iot_topic_router_t *r, uint32_t n, const char *p, const char *end,
+                         bool done, bool wild_ok, iot_topic_router_visit_t visit, void *arg)
+{
+    const tr_node_t *node = &r->nodes[n];
+    size_t count = 0;
+
+    // '#'匹配零个或多个层级（"a/#"也匹配"a"）
+    if (wild_ok) {
+        count += visit_list(r, node->multi, visit, arg);
+    }
+    if (done) {
+        return count + visit_list(r, node->values, visit, arg);
+    }
+
+    const char *sep = memchr(p, '/', (size_t)(end - p));
+    size_t len = sep ? (size_t)(sep - p) : (size_t)(end - p);
+    const char *next = sep ? sep + 1 : end;
+    bool next_done = (sep == NULL);
+
+    uint32_t child = find_child(r, n, p, len, seg_hash(n, p, len));
+    if (child != TR_NONE) {
+        count += match_node(r, child, next, end, next_done, true, visit, arg);
+    }
+    if (wild_ok && node->plus != TR_NONE) {
+        count += match_node(r, node->plus, next, end, next_done, true, visit, arg);
+    }
+    return count;
+}
+
+size_t iot_topic_router_match(const iot_topic_router_t *r, const char *topic, size_t topic_len,
+                              iot_topic_router_visit_t visit, void *arg)
+{
+    if (r == NULL || topic == NULL) {
+        return 0;
+    }
+    bool wild_ok = !(topic_len > 0 && topic[0] == '$');
+    return match_node(r, 0, topic, topic + topic_len, false, wild_ok, visit, arg);
+}
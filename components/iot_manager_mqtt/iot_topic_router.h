@@ -0,0 +1,92 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - MQTT主题路由（主题字典树）
+ *
+ * 订阅过滤器按层级预先编入字典树，普通层级的子节点存放在以(父节点, 层级名)为键的
+ * 哈希表中，'+'和'#'子节点单独记录。匹配时逐层查表，耗时只与主题层级数有关，
+ * 与过滤器数量无关，也不需要为每条消息拼接字符串。
+ *
+ * 本模块只依赖C标准库，不加锁，由调用者负责互斥，可以在主机上编译测试。
+ */
+
+#ifndef IOT_TOPIC_ROUTER_H
+#define IOT_TOPIC_ROUTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct iot_topic_router iot_topic_router_t;
+
+/**
+ * @brief 匹配结果回调
+ *
+ * @param value 添加过滤器时关联的值
+ * @param arg iot_topic_router_match() 传入的参数
+ */
+typedef void (*iot_topic_router_visit_t)(void *value, void *arg);
+
+/**
+ * @brief 创建路由表
+ *
+ * @return iot_topic_router_t* 路由表，内存不足返回NULL
+ */
+iot_topic_router_t *iot_topic_router_create(void);
+
+/**
+ * @brief 销毁路由表（不释放关联的值）
+ */
+void iot_topic_router_destroy(iot_topic_router_t *r);
+
+/**
+ * @brief 检查订阅过滤器是否合法
+ *
+ * '+'必须独占一个层级，'#'必须独占最后一个层级
+ */
+bool iot_topic_filter_valid(const char *filter);
+
+/**
+ * @brief 添加过滤器
+ *
+ * 同一过滤器可以关联多个值
+ *
+ * @param filter 订阅过滤器，支持'+'和'#'通配符
+ * @param value 关联的值（不能为NULL）
+ * @return true 成功
+ * @return false 过滤器非法或内存不足
+ */
+bool iot_topic_router_add(iot_topic_router_t *r, const char *filter, void *value);
+
+/**
+ * @brief 删除过滤器上关联的值
+ *
+ * @return true 已删除
+ * @return false 未找到
+ */
+bool iot_topic_router_remove(iot_topic_router_t *r, const char *filter, void *value);
+
+/**
+ * @brief 匹配主题
+ *
+ * 按MQTT规则匹配：'+'匹配一个层级，'#'匹配零个或多个层级，
+ * 以'$'开头的主题不匹配首层通配符。
+ *
+ * @param topic 主题（不需要以'\0'结尾）
+ * @param topic_len 主题长度
+ * @param visit 每个匹配的值调用一次
+ * @param arg 传给visit的参数
+ * @return size_t 匹配的值个数
+ */
+size_t iot_topic_router_match(const iot_topic_router_t *r, const char *topic, size_t topic_len,
+                              iot_topic_router_visit_t visit, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_TOPIC_ROUTER_H
@@ -0,0 +1,197 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 时间序列压缩编码实现
+ *
+ * 序列头部的点数和位流长度在 iot_tsz_series_end() 时回填。
+ * 追加一个点前保存编码状态，中途放不下时恢复状态并清除当前字节中已写入的位，
+ * 因此缓冲区可以一直写到满为止。
+ */
+
+#include <string.h>
+#include "iot_tsz.h"
+
+// 序列头部中名称之后的固定字段：点数(u16) 位流字节数(u16)
+#define SERIES_FIELDS_LEN   4
+
+/**
+ * @brief 写入v的低n位（n <= 64），缓冲区不足返回false
+ */
+static bool put_bits(iot_tsz_writer_t *w, uint64_t v, int n)
+{
+    while (n > 0) {
+        size_t pos = w->data + (w->bits >> 3);
+        // 位流字节数用u16记录
+        if (pos >= w->size || (w->bits >> 3) >= 0xffff) {
+            return false;
+        }
+        int used = w->bits & 7;
+        if (used == 0) {
+            w->buf[pos] = 0;
+        }
+        int room = 8 - used;
+        int take = n < room ? n : room;
+        uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+        w->buf[pos] |= (uint8_t)(chunk << (room - take));
+        w->bits += take;
+        n -= take;
+    }
+    return true;
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void iot_tsz_init(iot_tsz_writer_t *w, void *buf, size_t size)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->size = size;
+    if (!buf || size < IOT_TSZ_HEADER_LEN) {
+        w->overflow = true;
+        return;
+    }
+    w->buf[0] = 'T';
+    w->buf[1] = 'Z';
+    w->buf[2] = IOT_TSZ_VERSION;
+    w->len = IOT_TSZ_HEADER_LEN;
+}
+
+bool iot_tsz_series_begin(iot_tsz_writer_t *w, const char *name)
+{
+    iot_tsz_series_end(w);
+    if (w->overflow) {
+        return false;
+    }
+
+    size_t name_len = name ? strlen(name) : 0;
+    if (name_len == 0 || name_len > 255 ||
+        w->len + 1 + name_len + SERIES_FIELDS_LEN > w->size) {
+        w->overflow = true;
+        return false;
+    }
+
+    w->buf[w->len] = (uint8_t)name_len;
+    memcpy(w->buf + w->len + 1, name, name_len);
+    w->data = w->len + 1 + name_len + SERIES_FIELDS_LEN;
+    w->bits = 0;
+    w->count = 0;
+    return true;
+}
+
+/**
+ * @brief 写入时间戳的二阶差分
+ */
+static bool put_timestamp(iot_tsz_writer_t *w, int64_t ts_ms)
+{
+    int64_t delta = ts_ms - w->prev_ts;
+    int64_t dod = delta - w->prev_delta;
+    w->prev_ts = ts_ms;
+    w->prev_delta = delta;
+
+    if (dod == 0) {
+        return put_bits(w, 0, 1);
+    }
+    if (dod >= -64 && dod <= 63) {
+        return put_bits(w, 0x2, 2) && put_bits(w, (uint64_t)dod, 7);
+    }
+    if (dod >= -256 && dod <= 255) {
+        return put_bits(w, 0x6, 3) && put_bits(w, (uint64_t)dod, 9);
+    }
+    if (dod >= -2048 && dod <= 2047) {
+        return put_bits(w, 0xe, 4) && put_bits(w, (uint64_t)dod, 12);
+    }
+    if (dod >= INT32_MIN && dod <= INT32_MAX) {
+        return put_bits(w, 0xf, 4) && put_bits(w, (uint64_t)dod, 32);
+    }
+    return false;
+}
+
+/**
+ * @brief 写入数值与上一点的异或
+ */
+static bool put_value(iot_tsz_writer_t *w, uint32_t value)
+{
+    uint32_t x = value ^ w->prev_value;
+    w->prev_value = value;
+
+    if (x == 0) {
+        return put_bits(w, 0, 1);
+    }
+
+    uint8_t lead = (uint8_t)__builtin_clz(x);
+    uint8_t trail = (uint8_t)__builtin_ctz(x);
+    // prev_lead为0xff表示还没有记录过窗口
+    if (w->prev_lead != 0xff && lead >= w->prev_lead && trail >= w->prev_trail) {
+        int meaningful = 32 - w->prev_lead - w->prev_trail;
+        return put_bits(w, 0x2, 2) && put_bits(w, x >> w->prev_trail, meaningful);
+    }
+
+    int meaningful = 32 - lead - trail;
+    w->prev_lead = lead;
+    w->prev_trail = trail;
+    return put_bits(w, 0x3, 2) && put_bits(w, lead, 5) &&
+           put_bits(w, (uint64_t)(meaningful - 1), 5) && put_bits(w, x >> trail, meaningful);
+}
+
+bool iot_tsz_append(iot_tsz_writer_t *w, int64_t ts_ms, float value)
+{
+    if (w->overflow || w->data == 0 || w->count == IOT_TSZ_MAX_POINTS) {
+        return false;
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    iot_tsz_writer_t saved = *w;
+    bool ok;
+    if (w->count == 0) {
+        ok = put_bits(w, (uint64_t)ts_ms, 64) && put_bits(w, bits, 32);
+        w->prev_ts = ts_ms;
+        w->prev_delta = 0;
+        w->prev_value = bits;
+        w->prev_lead = 0xff;
+    } else {
+        ok = put_timestamp(w, ts_ms) && put_value(w, bits);
+    }
+
+    if (!ok) {
+        // 恢复状态，清掉写了一半的字节中多出来的位
+        *w = saved;
+        int used = w->bits & 7;
+        if (used) {
+            w->buf[w->data + (w->bits >> 3)] &= (uint8_t)(0xff << (8 - used));
+        }
+        return false;
+    }
+    w->count++;
+    return true;
+}
+
+void iot_tsz_series_end(iot_tsz_writer_t *w)
+{
+    if (w->data == 0) {
+        return;
+    }
+    if (w->count > 0) {
+        size_t bytes = (w->bits + 7) >> 3;
+        put_u16(w->buf + w->data - SERIES_FIELDS_LEN, w->count);
+        put_u16(w->buf + w->data - SERIES_FIELDS_LEN + 2, (uint16_t)bytes);
+        w->len = w->data + bytes;
+    }
+    w->data = 0;
+    w->bits = 0;
+    w->count = 0;
+}
+
+int iot_tsz_finish(iot_tsz_writer_t *w)
+{
+    iot_tsz_series_end(w);
+    if (w->overflow) {
+        return -1;
+    }
+    return (int)w->len;
+}
@@ -0,0 +1,119 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 时间序列压缩编码（Gorilla）
+ *
+ * 把一组 (时间戳, 数值) 点压缩为位流：时间戳记录二阶差分（间隔固定时每点1位），
+ * 数值记录与前一个值的异或（不变时1位，缓慢变化时只写中间的有效位）。
+ * 算法来自Facebook Gorilla（Pelkonen et al., VLDB 2015），数值改为单精度：
+ * 传感器数据本身多为单精度，ESP32也只有单精度浮点单元。
+ *
+ * 负载格式（多字节整数为小端）:
+ *     头部:  'T' 'Z' 版本(1)
+ *     序列:  名称长度(1字节) 名称  点数(u16)  位流字节数(u16)  位流
+ * 一个负载可以包含多个序列。位流从每个字节的最高位开始写，末尾不足一字节补0:
+ *     第一个点: 时间戳64位（有符号，毫秒），数值32位（IEEE 754单精度）
+ *     之后每个点:
+ *       时间 dod = (t[i] - t[i-1]) - (t[i-1] - t[i-2])，第二个点的前一个间隔按0计算
+ *         '0'               dod == 0
+ *         '10'   + 7位      -64 ~ 63     （补码，下同）
+ *         '110'  + 9位      -256 ~ 255
+ *         '1110' + 12位     -2048 ~ 2047
+ *         '1111' + 32位     其他
+ *       数值 x = 本点位模式 ^ 上一点位模式
+ *         '0'               x == 0
+ *         '10' + 有效位     x的前导零和尾随零都不少于上一次记录的窗口，沿用窗口
+ *         '11' + 5位前导零个数 + 5位(有效位数-1) + 有效位
+ *
+ * 参考解码器: tools/tsz_decode.py。MQTT5下以content-type application/x-iot-tsz 发送，
+ * MQTT 3.1.1下由负载开头的 'T' 'Z' 识别。
+ *
+ * 不申请堆内存，只依赖C标准库，可以在主机上编译测试。
+ */
+
+#ifndef IOT_TSZ_H
+#define IOT_TSZ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_TSZ_VERSION     1
+#define IOT_TSZ_HEADER_LEN  3           ///< 'T' 'Z' 版本
+#define IOT_TSZ_MAX_POINTS  0xffff      ///< 每个序列最多的点数
+
+/**
+ * @brief 编码器状态
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t len;                         ///< 已完成的序列（和头部）的长度
+    size_t data;                        ///< 当前序列位流的起始位置，0表示没有打开的序列
+    size_t bits;                        ///< 当前序列已写入的位数
+    uint16_t count;                     ///< 当前序列的点数
+    uint8_t prev_lead;                  ///< 上一次记录的前导零个数
+    uint8_t prev_trail;                 ///< 上一次记录的尾随零个数
+    uint32_t prev_value;                ///< 上一点的数值位模式
+    int64_t prev_ts;
+    int64_t prev_delta;
+    bool overflow;
+} iot_tsz_writer_t;
+
+/**
+ * @brief 初始化编码器并写入头部
+ */
+void iot_tsz_init(iot_tsz_writer_t *w, void *buf, size_t size);
+
+/**
+ * @brief 开始一个序列（会先结束已打开的序列）
+ *
+ * @param name 序列名（属性名），最长255字节
+ * @return true 成功
+ * @return false 名称无效或缓冲区不足（之后 iot_tsz_finish() 返回-1）
+ */
+bool iot_tsz_series_begin(iot_tsz_writer_t *w, const char *name);
+
+/**
+ * @brief 向当前序列追加一个点
+ *
+ * 放不下时不写入任何内容并返回false，已写入的点不受影响，
+ * 调用者可以先 iot_tsz_finish() 发出当前负载，再用新的负载继续。
+ *
+ * @param ts_ms 时间戳（毫秒）
+ * @return true 成功
+ * @return false 没有打开的序列、缓冲区不足或点数已达 IOT_TSZ_MAX_POINTS
+ */
+bool iot_tsz_append(iot_tsz_writer_t *w, int64_t ts_ms, float value);
+
+/**
+ * @brief 结束当前序列，没有点的序列不写入负载
+ */
+void iot_tsz_series_end(iot_tsz_writer_t *w);
+
+/**
+ * @brief 当前序列的点数
+ */
+static inline uint16_t iot_tsz_count(const iot_tsz_writer_t *w)
+{
+    return w->count;
+}
+
+/**
+ * @brief 结束编码
+ *
+ * @return int 负载长度，出错返回-1
+ */
+int iot_tsz_finish(iot_tsz_writer_t *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_TSZ_H
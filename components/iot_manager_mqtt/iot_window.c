@@ -0,0 +1,211 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 采样窗口聚合实现
+ *
+ * P²估计器的5个标记点分别跟踪最小值、p/2、p、(1+p)/2分位和最大值。
+ * 前 IOT_WINDOW_EXACT_MAX 个样本只存入first，下一个样本到达时连同它一起排序，用对应位置的
+ * 样本初始化标记点（原算法只用前5个样本，刚切换到P²时误差很大）；
+ * 之后每个样本更新落在其后的标记点位置，中间3个标记点偏离期望位置超过1时
+ * 用抛物线插值（超出相邻点时退回线性插值）调整高度。
+ * 标记点用float：ESP32有单精度浮点单元，double为软件实现。
+ */
+
+#include <math.h>
+#include <string.h>
+#include "iot_window.h"
+
+const uint8_t iot_window_percentiles[IOT_WINDOW_PERCENTILES] = { 50, 90, 99 };
+
+void iot_window_reset(iot_window_t *w)
+{
+    memset(w, 0, sizeof(*w));
+}
+
+/**
+ * @brief 插入排序（最多 IOT_WINDOW_EXACT_MAX + 1 个样本）
+ */
+static void sort_samples(float *v, uint32_t n)
+{
+    for (uint32_t i = 1; i < n; i++) {
+        float x = v[i];
+        uint32_t j = i;
+        while (j > 0 && v[j - 1] > x) {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+}
+
+/**
+ * @brief 标记点期望位置的增量（每个样本）
+ */
+static void p2_increments(float p, float dn[5])
+{
+    dn[0] = 0;
+    dn[1] = p / 2;
+    dn[2] = p;
+    dn[3] = (1 + p) / 2;
+    dn[4] = 1;
+}
+
+/**
+ * @brief 用排序后的前n个样本初始化估计器
+ *
+ * 标记点放在最接近期望位置的样本上（保持严格递增），高度取该样本的值，
+ * 相当于从n个样本的精确分位开始迭代，而不是从5个样本开始。
+ */
+static void p2_init(iot_p2_t *e, float p, const float *sorted, int32_t n)
+{
+    float dn[5];
+    p2_increments(p, dn);
+    for (int i = 0; i < 5; i++) {
+        e->np[i] = (n - 1) * dn[i];
+    }
+    e->n[0] = 0;
+    e->n[4] = n - 1;
+    for (int i = 1; i <= 3; i++) {
+        int32_t pos = (int32_t)lroundf(e->np[i]);
+        e->n[i] = pos > e->n[i - 1] ? pos : e->n[i - 1] + 1;
+    }
+    for (int i = 3; i >= 1; i--) {
+        if (e->n[i] >= e->n[i + 1]) {
+            e->n[i] = e->n[i + 1] - 1;
+        }
+    }
+    for (int i = 0; i < 5; i++) {
+        e->q[i] = sorted[e->n[i]];
+    }
+}
+
+/**
+ * @brief 抛物线插值计算标记点i移动d后的高度
+ */
+static float p2_parabolic(const iot_p2_t *e, int i, int d)
+{
+    float n0 = (float)e->n[i - 1];
+    float n1 = (float)e->n[i];
+    float n2 = (float)e->n[i + 1];
+    return e->q[i] + d / (n2 - n0) *
+           ((n1 - n0 + d) * (e->q[i + 1] - e->q[i]) / (n2 - n1) +
+            (n2 - n1 - d) * (e->q[i] - e->q[i - 1]) / (n1 - n0));
+}
+
+/**
+ * @brief 加入一个样本（估计器已初始化）
+ */
+static void p2_add(iot_p2_t *e, float p, float x)
+{
+    float dn[5];
+    p2_increments(p, dn);
+
+    // 找到x所在的区间，超出两端时更新最小/最大值
+    int k;
+    if (x < e->q[0]) {
+        e->q[0] = x;
+        k = 0;
+    } else if (x >= e->q[4]) {
+        e->q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (x >= e->q[k + 1]) {
+            k++;
+        }
+    }
+
+    for (int i = k + 1; i < 5; i++) {
+        e->n[i]++;
+    }
+    for (int i = 0; i < 5; i++) {
+        e->np[i] += dn[i];
+    }
+
+    for (int i = 1; i <= 3; i++) {
+        float delta = e->np[i] - e->n[i];
+        if ((delta >= 1 && e->n[i + 1] - e->n[i] > 1) ||
+            (delta <= -1 && e->n[i - 1] - e->n[i] < -1)) {
+            int d = delta > 0 ? 1 : -1;
+            float q = p2_parabolic(e, i, d);
+            if (e->q[i - 1] < q && q < e->q[i + 1]) {
+                e->q[i] = q;
+            } else {
+                e->q[i] += d * (e->q[i + d] - e->q[i]) / (float)(e->n[i + d] - e->n[i]);
+            }
+            e->n[i] += d;
+        }
+    }
+}
+
+void iot_window_add(iot_window_t *w, float x)
+{
+    if (isnan(x)) {
+        return;
+    }
+
+    if (w->count == 0 || x < w->min) {
+        w->min = x;
+    }
+    if (w->count == 0 || x > w->max) {
+        w->max = x;
+    }
+    w->sum += x;
+    if (w->count < IOT_WINDOW_EXACT_MAX) {
+        // 精确样本区未满时不运行P²
+        w->first[w->count++] = x;
+        return;
+    }
+
+    if (w->count == IOT_WINDOW_EXACT_MAX) {
+        // 用保存的样本和当前样本初始化
+        float sorted[IOT_WINDOW_EXACT_MAX + 1];
+        memcpy(sorted, w->first, sizeof(w->first));
+        sorted[IOT_WINDOW_EXACT_MAX] = x;
+        sort_samples(sorted, IOT_WINDOW_EXACT_MAX + 1);
+        for (int i = 0; i < IOT_WINDOW_PERCENTILES; i++) {
+            p2_init(&w->p2[i], iot_window_percentiles[i] / 100.0f, sorted, IOT_WINDOW_EXACT_MAX + 1);
+        }
+    } else {
+        for (int i = 0; i < IOT_WINDOW_PERCENTILES; i++) {
+            p2_add(&w->p2[i], iot_window_percentiles[i] / 100.0f, x);
+        }
+    }
+    w->count++;
+}
+
+bool iot_window_get(const iot_window_t *w, iot_window_result_t *result)
+{
+    if (!result || w->count == 0) {
+        return false;
+    }
+
+    result->count = w->count;
+    result->min = w->min;
+    result->max = w->max;
+    result->mean = (float)(w->sum / w->count);
+
+    if (w->count > IOT_WINDOW_EXACT_MAX) {
+        for (int i = 0; i < IOT_WINDOW_PERCENTILES; i++) {
+            // 样本数不足100/(100-p)时最近秩就是最大值（例如p99在100个样本以内），
+            // 此时P²的中间标记点还没有收敛到尾部
+            if (w->count * (100 - iot_window_percentiles[i]) < 100) {
+                result->pct[i] = w->max;
+            } else {
+                result->pct[i] = w->p2[i].q[2];
+            }
+        }
+        return true;
+    }
+
+    // 样本较少时按排序后的样本取最近秩
+    float sorted[IOT_WINDOW_EXACT_MAX];
+    uint32_t n = w->count;
+    memcpy(sorted, w->first, n * sizeof(float));
+    sort_samples(sorted, n);
+    for (int i = 0; i < IOT_WINDOW_PERCENTILES; i++) {
+        uint32_t rank = (iot_window_percentiles[i] * n + 99) / 100;
+        result->pct[i] = sorted[rank ? rank - 1 : 0];
+    }
+    return true;
+}
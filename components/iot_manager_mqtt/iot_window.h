@@ -0,0 +1,101 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 采样窗口聚合
+ *
+ * 对一个上报窗口内的样本计算个数、最小值、最大值、平均值和近似百分位（p50/p90/p99），
+ * 高频传感器可以在设备上汇总后每个窗口上报一次，而不是上报原始样本或降低采样率。
+ *
+ * 百分位使用P²算法（Jain & Chlamtac, 1985）：每个百分位只保存5个标记点，
+ * 每个样本O(1)更新，内存与样本数无关。窗口的前 IOT_WINDOW_EXACT_MAX 个样本保存下来，
+ * 样本数不超过它时按排序结果给出精确值（最近秩）；超过时用这些样本初始化P²标记点，
+ * 之后为估计值。
+ *
+ * 误差按秩计（估计值在窗口样本中的位置与p之差），均匀/正态/指数分布下实测的最大值
+ * （test/host/test_window.c 中检查）：
+ *   33~99个样本     0.25（指数分布p90，其余0.13以内）
+ *   100~499个样本   0.10
+ *   500~1999个样本  0.04
+ *   2000个以上      0.01
+ * 分布中有远离主体的异常值时，相邻标记点的插值会被拉向异常值：p50/p90的数值误差
+ * 在2%以内，但若p恰好落在主体和异常值之间的空档（例如恰好1%异常值时的p99），
+ * 估计值是空档中的某个插值，与最近秩（主体的最大值）可以相差很多，需要时结合max判断。
+ *
+ * 不加锁，同一个窗口只能在一个任务中使用。只依赖C标准库，可以在主机上编译测试。
+ */
+
+#ifndef IOT_WINDOW_H
+#define IOT_WINDOW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_WINDOW_PERCENTILES  3       ///< 百分位个数，见 iot_window_percentiles
+#define IOT_WINDOW_EXACT_MAX    32      ///< 样本数不超过此值时百分位为精确值
+
+/**
+ * @brief 计算的百分位（50、90、99）
+ */
+extern const uint8_t iot_window_percentiles[IOT_WINDOW_PERCENTILES];
+
+/**
+ * @brief P²百分位估计器（内部使用）
+ */
+typedef struct {
+    float q[5];                         ///< 标记点高度
+    int32_t n[5];                       ///< 标记点位置
+    float np[5];                        ///< 标记点期望位置
+} iot_p2_t;
+
+/**
+ * @brief 窗口聚合状态
+ *
+ * 所有字段为内部状态，请通过API访问
+ */
+typedef struct {
+    uint32_t count;
+    float min;
+    float max;
+    double sum;                         ///< 用double累加，避免长窗口中大数吃掉小数
+    float first[IOT_WINDOW_EXACT_MAX];  ///< 窗口的前几个样本
+    iot_p2_t p2[IOT_WINDOW_PERCENTILES];
+} iot_window_t;
+
+/**
+ * @brief 窗口聚合结果
+ */
+typedef struct {
+    uint32_t count;                     ///< 样本数
+    float min;
+    float max;
+    float mean;
+    float pct[IOT_WINDOW_PERCENTILES];  ///< 与 iot_window_percentiles 对应
+} iot_window_result_t;
+
+/**
+ * @brief 清空窗口，开始新的窗口
+ */
+void iot_window_reset(iot_window_t *w);
+
+/**
+ * @brief 加入一个样本（NaN被忽略）
+ */
+void iot_window_add(iot_window_t *w, float x);
+
+/**
+ * @brief 读取窗口聚合结果（不清空窗口）
+ *
+ * @return true 成功
+ * @return false 窗口内没有样本
+ */
+bool iot_window_get(const iot_window_t *w, iot_window_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_WINDOW_H
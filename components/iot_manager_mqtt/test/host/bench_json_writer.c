@@ -0,0 +1,132 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - JSON编码器与cJSON的对比基准
+ *
+ * 编码同一条典型的上报消息（时间戳、状态、5个属性、需要转义的消息文本）：
+ *   iot_json  写入调用者的缓冲区
+ *   cjson     建树、cJSON_PrintUnformatted()、拷贝、释放字符串和树（改造前的做法）
+ * 每种实现输出一行JSON：每秒编码次数、每次耗时、输出字节数、每次堆分配次数。
+ * 编译时找不到cJSON（CJSON_DIR或IDF_PATH）则只测iot_json。
+ */
+
+#include <stdbool.h>
+#include "host_alloc.h"
+#include "host_test.h"
+#include "iot_json_writer.h"
+#if HAVE_CJSON
+#include "cJSON.h"
+#endif
+
+// 一条上报消息的内容
+typedef struct {
+    int64_t timestamp;
+    const char *status;
+    double temperature;
+    double humidity;
+    int64_t free_heap;
+    int64_t uptime;
+    double voltage;
+    const char *message;
+} report_t;
+
+static int encode_iot_json(const report_t *r, char *buf, size_t size)
+{
+    iot_json_writer_t w;
+    iot_json_init(&w, buf, size);
+    iot_json_object_begin(&w);
+    iot_json_kv_int(&w, "timestamp", r->timestamp);
+    iot_json_kv_str(&w, "status", r->status);
+    iot_json_key(&w, "props");
+    iot_json_object_begin(&w);
+    iot_json_kv_double(&w, "temperature", r->temperature);
+    iot_json_kv_double(&w, "humidity", r->humidity);
+    iot_json_kv_int(&w, "free_heap", r->free_heap);
+    iot_json_kv_int(&w, "uptime", r->uptime);
+    iot_json_kv_double(&w, "voltage", r->voltage);
+    iot_json_object_end(&w);
+    iot_json_kv_str(&w, "message", r->message);
+    iot_json_object_end(&w);
+    return iot_json_finish(&w);
+}
+
+#if HAVE_CJSON
+static int encode_cjson(const report_t *r, char *buf, size_t size)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "timestamp", (double)r->timestamp);
+    cJSON_AddStringToObject(root, "status", r->status);
+    cJSON *props = cJSON_AddObjectToObject(root, "props");
+    cJSON_AddNumberToObject(props, "temperature", r->temperature);
+    cJSON_AddNumberToObject(props, "humidity", r->humidity);
+    cJSON_AddNumberToObject(props, "free_heap", (double)r->free_heap);
+    cJSON_AddNumberToObject(props, "uptime", (double)r->uptime);
+    cJSON_AddNumberToObject(props, "voltage", r->voltage);
+    cJSON_AddStringToObject(root, "message", r->message);
+
+    int len = -1;
+    char *json = cJSON_PrintUnformatted(root);
+    if (json) {
+        size_t n = strlen(json);
+        if (n < size) {
+            memcpy(buf, json, n + 1);
+            len = (int)n;
+        }
+        cJSON_free(json);
+    }
+    cJSON_Delete(root);
+    return len;
+}
+#endif
+
+static void run(const char *impl, int (*encode)(const report_t *, char *, size_t))
+{
+    long iterations = bench_iterations(200000);
+    char buf[512];
+    report_t r = {
+        .timestamp = 1731234567890LL,
+        .status = "online",
+        .temperature = 23.45,
+        .humidity = 45.2,
+        .free_heap = 183456,
+        .uptime = 86400,
+        .voltage = 3.3125,
+        .message = "sensor \"A1\" ok\n",
+    };
+
+    host_alloc_stats_t before, after;
+    host_alloc_reset_peak();
+    host_alloc_get(&before);
+    double start = host_now_sec();
+    long bytes = 0;
+    for (long i = 0; i < iterations; i++) {
+        // 每次的数值不同，避免只测到同一个数字的格式化
+        r.uptime = i;
+        r.temperature = 20 + (i % 1000) * 0.01;
+        int len = encode(&r, buf, sizeof(buf));
+        CHECK(len > 0);
+        bytes += len;
+    }
+    double elapsed = host_now_sec() - start;
+    host_alloc_get(&after);
+
+    printf("{\"bench\":\"json_encode\",\"impl\":\"%s\",\"iterations\":%ld,"
+           "\"ops_per_sec\":%.0f,\"ns_per_op\":%.1f,\"bytes_per_op\":%.1f",
+           impl, iterations, iterations / elapsed, elapsed * 1e9 / iterations,
+           (double)bytes / iterations);
+    if (host_alloc_supported()) {
+        printf(",\"allocs_per_op\":%.2f,\"peak_heap_bytes\":%ld",
+               (double)(after.allocs - before.allocs) / iterations,
+               after.peak_bytes - before.bytes_in_use);
+    }
+    printf("}\n");
+}
+
+int main(void)
+{
+    run("iot_json", encode_iot_json);
+#if HAVE_CJSON
+    run("cjson", encode_cjson);
+#endif
+    return TEST_RESULT();
+}
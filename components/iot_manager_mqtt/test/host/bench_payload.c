@@ -0,0 +1,121 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - JSON与CBOR负载对比基准
+ *
+ * 编码 report_task() 上报的7个字段（设备ID、时间戳、运行时间、空闲内存、计数、温度、湿度），
+ * 输出README中“与JSON的对比”表格的数据：每种编码一行JSON，含字节数和每次编码耗时。
+ *   json         iot_json，数值按双精度
+ *   cbor_double  iot_cbor，浮点字段用 kv_double（能无损表示时自动缩短，23.4这类值仍需8字节）
+ *   cbor_float   iot_cbor，浮点字段转成float后用 kv_float（固定单精度）
+ */
+
+#include <stdbool.h>
+#include "host_test.h"
+#include "iot_cbor_writer.h"
+#include "iot_json_writer.h"
+
+// 一次上报的字段
+typedef struct {
+    const char *device_id;
+    int64_t timestamp;
+    int64_t uptime;
+    uint32_t free_heap;
+    uint32_t count;
+    double temperature;
+    double humidity;
+} sample_t;
+
+static int encode_json(const sample_t *s, void *buf, size_t size)
+{
+    iot_json_writer_t w;
+    iot_json_init(&w, buf, size);
+    iot_json_object_begin(&w);
+    iot_json_kv_str(&w, "device_id", s->device_id);
+    iot_json_kv_int(&w, "timestamp", s->timestamp);
+    iot_json_kv_int(&w, "uptime", s->uptime);
+    iot_json_kv_uint(&w, "free_heap", s->free_heap);
+    iot_json_kv_uint(&w, "count", s->count);
+    iot_json_kv_double(&w, "temperature", s->temperature);
+    iot_json_kv_double(&w, "humidity", s->humidity);
+    iot_json_object_end(&w);
+    return iot_json_finish(&w);
+}
+
+static int encode_cbor(const sample_t *s, void *buf, size_t size, bool single)
+{
+    iot_cbor_writer_t w;
+    iot_cbor_init(&w, buf, size);
+    iot_cbor_object_begin(&w);
+    iot_cbor_kv_str(&w, "device_id", s->device_id);
+    iot_cbor_kv_int(&w, "timestamp", s->timestamp);
+    iot_cbor_kv_int(&w, "uptime", s->uptime);
+    iot_cbor_kv_uint(&w, "free_heap", s->free_heap);
+    iot_cbor_kv_uint(&w, "count", s->count);
+    if (single) {
+        iot_cbor_kv_float(&w, "temperature", (float)s->temperature);
+        iot_cbor_kv_float(&w, "humidity", (float)s->humidity);
+    } else {
+        iot_cbor_kv_double(&w, "temperature", s->temperature);
+        iot_cbor_kv_double(&w, "humidity", s->humidity);
+    }
+    iot_cbor_object_end(&w);
+    return iot_cbor_finish(&w);
+}
+
+static int encode_cbor_double(const sample_t *s, void *buf, size_t size)
+{
+    return encode_cbor(s, buf, size, false);
+}
+
+static int encode_cbor_float(const sample_t *s, void *buf, size_t size)
+{
+    return encode_cbor(s, buf, size, true);
+}
+
+static int json_size;
+
+static void run(const char *name, int (*encode)(const sample_t *, void *, size_t))
+{
+    uint8_t buf[256];
+    sample_t s = {
+        .device_id = "esp32_a1b2c3",
+        .timestamp = 1731234567890LL,
+        .uptime = 86400,
+        .free_heap = 183456,
+        .count = 1440,
+        .temperature = 23.4,
+        .humidity = 61.7,
+    };
+
+    // 大小取固定样本，耗时取数值变化的样本
+    int size = encode(&s, buf, sizeof(buf));
+    CHECK(size > 0);
+    if (strcmp(name, "json") == 0) {
+        json_size = size;
+    } else {
+        // CBOR总比同样内容的JSON小
+        CHECK(size < json_size);
+    }
+
+    long iterations = bench_iterations(500000);
+    double start = host_now_sec();
+    for (long i = 0; i < iterations; i++) {
+        s.uptime = 86400 + i;
+        s.count = (uint32_t)i;
+        s.temperature = 20 + (i % 100) * 0.1;
+        CHECK(encode(&s, buf, sizeof(buf)) > 0);
+    }
+    double elapsed = host_now_sec() - start;
+
+    printf("{\"bench\":\"payload\",\"encoding\":\"%s\",\"bytes\":%d,\"ns_per_op\":%.1f}\n",
+           name, size, elapsed * 1e9 / iterations);
+}
+
+int main(void)
+{
+    run("json", encode_json);
+    run("cbor_double", encode_cbor_double);
+    run("cbor_float", encode_cbor_float);
+    return TEST_RESULT();
+}
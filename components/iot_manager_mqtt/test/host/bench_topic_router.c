@@ -0,0 +1,207 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主题路由基准
+ *
+ * 按网关场景生成几百到上万个过滤器（精确主题、'+'、'#'、$SYS），
+ * 比较主题树匹配和逐个过滤器线性比较（原来的做法）的耗时。
+ * 线性比较同时作为参考实现，抽样检查主题树匹配到的过滤器集合完全一致。
+ * 每种规模输出一行JSON。
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "host_test.h"
+#include "iot_topic_router.h"
+
+#define MAX_FILTERS     20000
+#define FILTER_LEN      64
+#define TOPIC_COUNT     4096
+
+static char filters[MAX_FILTERS][FILTER_LEN];
+static char topics[TOPIC_COUNT][FILTER_LEN];
+static size_t topic_lens[TOPIC_COUNT];
+
+/**
+ * @brief 参考实现：按MQTT规范逐层比较
+ */
+static bool naive_match(const char *filter, const char *topic)
+{
+    // '$'开头的主题首层不匹配通配符
+    if (topic[0] == '$' && (filter[0] == '+' || filter[0] == '#')) {
+        return false;
+    }
+    const char *f = filter;
+    const char *t = topic;
+    while (1) {
+        const char *fe = strchr(f, '/');
+        size_t fl = fe ? (size_t)(fe - f) : strlen(f);
+        if (fl == 1 && f[0] == '#') {
+            return true;
+        }
+        const char *te = strchr(t, '/');
+        size_t tl = te ? (size_t)(te - t) : strlen(t);
+        if (!(fl == 1 && f[0] == '+') && (fl != tl || memcmp(f, t, fl) != 0)) {
+            return false;
+        }
+        if (!te) {
+            // 主题结束，过滤器只能以 "/#" 结束
+            return !fe || strcmp(fe + 1, "#") == 0;
+        }
+        if (!fe) {
+            return false;
+        }
+        f = fe + 1;
+        t = te + 1;
+    }
+}
+
+/**
+ * @brief 生成一个过滤器
+ *
+ * @param ids 设备ID的取值个数，越小越容易有多个过滤器匹配同一主题
+ */
+static void gen_filter(char *out, uint32_t *rng, uint32_t ids)
+{
+    uint32_t id = host_rand(rng) % ids;
+    uint32_t k = host_rand(rng) % 8;
+    switch (host_rand(rng) % 10) {
+    case 0: case 1: case 2:
+        snprintf(out, FILTER_LEN, "device/%u/command", id);
+        break;
+    case 3: case 4: case 5:
+        snprintf(out, FILTER_LEN, "device/%u/config/k%u", id, k);
+        break;
+    case 6:
+        snprintf(out, FILTER_LEN, "device/+/config/k%u", k);
+        break;
+    case 7:
+        snprintf(out, FILTER_LEN, "sensor/room%u/+/temp", id % 64);
+        break;
+    case 8:
+        snprintf(out, FILTER_LEN, "device/%u/#", id);
+        break;
+    default:
+        snprintf(out, FILTER_LEN, k < 4 ? "$SYS/broker/k%u" : "+/%u/#", k < 4 ? k : id);
+        break;
+    }
+}
+
+/**
+ * @brief 生成一个主题（同一组取值，部分主题不匹配任何过滤器）
+ */
+static size_t gen_topic(char *out, uint32_t *rng, uint32_t ids)
+{
+    uint32_t id = host_rand(rng) % ids;
+    uint32_t k = host_rand(rng) % 8;
+    switch (host_rand(rng) % 5) {
+    case 0:
+        return snprintf(out, FILTER_LEN, "device/%u/command", id);
+    case 1:
+        return snprintf(out, FILTER_LEN, "device/%u/config/k%u", id, k);
+    case 2:
+        return snprintf(out, FILTER_LEN, "sensor/room%u/dev%u/temp", id % 64, k);
+    case 3:
+        return snprintf(out, FILTER_LEN, "$SYS/broker/k%u", k);
+    default:
+        return snprintf(out, FILTER_LEN, "other/%u/unrelated/topic", id);
+    }
+}
+
+// 一次匹配的结果
+typedef struct {
+    size_t hits;
+    uint8_t *seen;          // 每个过滤器是否被匹配
+} visit_ctx_t;
+
+static void on_visit(void *value, void *arg)
+{
+    visit_ctx_t *ctx = arg;
+    size_t idx = (size_t)(uintptr_t)value - 1;
+    ctx->seen[idx]++;
+    ctx->hits++;
+}
+
+static void run(int count)
+{
+    uint32_t rng = 0x5eed0000u + (uint32_t)count;
+    uint32_t ids = count / 4 + 1;
+
+    for (int i = 0; i < count; i++) {
+        gen_filter(filters[i], &rng, ids);
+    }
+    for (int i = 0; i < TOPIC_COUNT; i++) {
+        topic_lens[i] = gen_topic(topics[i], &rng, ids);
+    }
+
+    iot_topic_router_t *r = iot_topic_router_create();
+    CHECK(r != NULL);
+    double start = host_now_sec();
+    for (int i = 0; i < count; i++) {
+        CHECK(iot_topic_router_add(r, filters[i], (void *)(uintptr_t)(i + 1)));
+    }
+    double add_sec = host_now_sec() - start;
+
+    // 主题树和参考实现的匹配结果一致
+    uint8_t *seen = calloc(count, 1);
+    visit_ctx_t ctx = { .seen = seen };
+    size_t total_hits = 0;
+    for (int t = 0; t < TOPIC_COUNT; t += 4) {
+        memset(seen, 0, count);
+        ctx.hits = 0;
+        iot_topic_router_match(r, topics[t], topic_lens[t], on_visit, &ctx);
+        for (int i = 0; i < count; i++) {
+            if (seen[i] != (naive_match(filters[i], topics[t]) ? 1 : 0)) {
+                fprintf(stderr, "过滤器\"%s\" 主题\"%s\" 结果不一致\n", filters[i], topics[t]);
+                host_test_failures++;
+            }
+        }
+        total_hits += ctx.hits;
+    }
+
+    // 主题树匹配
+    long lookups = bench_iterations(400000);
+    start = host_now_sec();
+    size_t hits = 0;
+    for (long n = 0; n < lookups; n++) {
+        int t = (int)(n % TOPIC_COUNT);
+        ctx.hits = 0;
+        hits += iot_topic_router_match(r, topics[t], topic_lens[t], on_visit, &ctx);
+    }
+    double trie_ns = (host_now_sec() - start) * 1e9 / lookups;
+
+    // 线性比较，次数按过滤器数缩减以控制总耗时
+    long linear = bench_iterations(8000000) / count;
+    if (linear < 16) {
+        linear = 16;
+    }
+    start = host_now_sec();
+    size_t linear_hits = 0;
+    for (long n = 0; n < linear; n++) {
+        const char *topic = topics[n % TOPIC_COUNT];
+        for (int i = 0; i < count; i++) {
+            linear_hits += naive_match(filters[i], topic);
+        }
+    }
+    double linear_ns = (host_now_sec() - start) * 1e9 / linear;
+
+    printf("{\"bench\":\"topic_router\",\"filters\":%d,\"add_ns_per_filter\":%.1f,"
+           "\"hits_per_topic\":%.2f,\"trie_ns_per_match\":%.1f,\"linear_ns_per_match\":%.1f,"
+           "\"speedup\":%.1f}\n",
+           count, add_sec * 1e9 / count, (double)total_hits / (TOPIC_COUNT / 4),
+           trie_ns, linear_ns, linear_ns / trie_ns);
+    (void)hits;
+    (void)linear_hits;
+
+    free(seen);
+    iot_topic_router_destroy(r);
+}
+
+int main(void)
+{
+    static const int sizes[] = { 16, 256, 1000, 5000, 20000 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        run(sizes[i]);
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author: xingnian j_xingnian@163.com
+@Date: 2025-11-10
+@Description: 用参考解码器检查iot_tsz编码结果
+
+用法: check_tsz.py <test_tsz的输出目录>
+
+对每个 <数据>.exp，用 tools/tsz_decode.py 依次解码 <数据>_*.bin，
+拼接后的点（时间戳和数值位模式）必须与期望完全一致。
+"""
+
+import glob
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '../../../../tools'))
+import tsz_decode  # noqa: E402
+
+
+def float_bits(v):
+    return struct.unpack('<I', struct.pack('<f', v))[0]
+
+
+def check(out_dir, name):
+    with open(os.path.join(out_dir, name + '.exp')) as f:
+        want = [(int(ts), int(bits, 16)) for ts, bits in (line.split() for line in f)]
+
+    got = []
+    for path in sorted(glob.glob(os.path.join(out_dir, name + '_*.bin'))):
+        with open(path, 'rb') as f:
+            series = tsz_decode.decode(f.read())
+        if list(series) != [name]:
+            print('%s: 序列名不符 %s' % (os.path.basename(path), list(series)))
+            return False
+        got += [(ts, float_bits(v)) for ts, v in series[name]]
+
+    if got == want:
+        print('%s: %d个点一致' % (name, len(got)))
+        return True
+    if len(got) != len(want):
+        print('%s: 解码%d个点，应为%d个' % (name, len(got), len(want)))
+    else:
+        i = next(i for i, (a, b) in enumerate(zip(got, want)) if a != b)
+        print('%s: 第%d个点为%s，应为%s' % (name, i, got[i], want[i]))
+    return False
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 2
+    out_dir = sys.argv[1]
+    names = sorted(os.path.basename(p)[:-4] for p in glob.glob(os.path.join(out_dir, '*.exp')))
+    if not names:
+        print('%s 中没有期望文件，先运行test_tsz' % out_dir)
+        return 1
+    ok = all([check(out_dir, name) for name in names])
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,109 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试的堆分配计数实现
+ *
+ * 每块前面放一个头记录大小，以便free时扣减占用。单线程使用。
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "host_alloc.h"
+
+#if HOST_ALLOC_WRAP
+
+// 块头，保持16字节对齐
+typedef union {
+    size_t size;
+    max_align_t align;
+} alloc_hdr_t;
+
+static host_alloc_stats_t stats;
+
+void *__real_malloc(size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static void *track(alloc_hdr_t *h, size_t size)
+{
+    if (!h) {
+        return NULL;
+    }
+    h->size = size;
+    stats.allocs++;
+    stats.bytes_in_use += (long)size;
+    if (stats.bytes_in_use > stats.peak_bytes) {
+        stats.peak_bytes = stats.bytes_in_use;
+    }
+    return h + 1;
+}
+
+void *__wrap_malloc(size_t size)
+{
+    return track(__real_malloc(sizeof(alloc_hdr_t) + size), size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    if (size && n > (SIZE_MAX - sizeof(alloc_hdr_t)) / size) {
+        return NULL;
+    }
+    void *p = __wrap_malloc(n * size);
+    if (p) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+void __wrap_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    alloc_hdr_t *h = (alloc_hdr_t *)ptr - 1;
+    stats.frees++;
+    stats.bytes_in_use -= (long)h->size;
+    __real_free(h);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    if (!ptr) {
+        return __wrap_malloc(size);
+    }
+    alloc_hdr_t *h = (alloc_hdr_t *)ptr - 1;
+    size_t old = h->size;
+    alloc_hdr_t *n = __real_realloc(h, sizeof(alloc_hdr_t) + size);
+    if (!n) {
+        return NULL;
+    }
+    stats.frees++;
+    stats.bytes_in_use -= (long)old;
+    return track(n, size);
+}
+
+bool host_alloc_supported(void)
+{
+    return true;
+}
+
+#else
+
+static host_alloc_stats_t stats = { -1, -1, -1, -1 };
+
+bool host_alloc_supported(void)
+{
+    return false;
+}
+
+#endif
+
+void host_alloc_get(host_alloc_stats_t *out)
+{
+    *out = stats;
+}
+
+void host_alloc_reset_peak(void)
+{
+    stats.peak_bytes = stats.bytes_in_use;
+}
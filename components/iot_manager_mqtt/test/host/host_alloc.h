@@ -0,0 +1,37 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试的堆分配计数
+ *
+ * 链接时用 -Wl,--wrap=malloc 等包装libc的分配函数（见CMakeLists.txt中的
+ * iot_host_count_allocs()），统计被测代码和对比库的分配次数和当前占用。
+ * 不支持--wrap的平台上 host_alloc_supported() 返回false。
+ * 只有链接进来的目标文件中的调用会被包装，这些代码不能free()由libc内部分配的内存
+ * （如strdup()的返回值）。
+ */
+
+#ifndef HOST_ALLOC_H
+#define HOST_ALLOC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief 分配计数
+ */
+typedef struct {
+    long allocs;                ///< malloc/calloc/realloc 调用次数
+    long frees;                 ///< free 调用次数（不含free(NULL)）
+    long bytes_in_use;          ///< 当前占用的字节数
+    long peak_bytes;            ///< 占用峰值
+} host_alloc_stats_t;
+
+bool host_alloc_supported(void);
+void host_alloc_get(host_alloc_stats_t *stats);
+
+/**
+ * @brief 从当前占用开始重新统计峰值
+ */
+void host_alloc_reset_peak(void);
+
+#endif // HOST_ALLOC_H
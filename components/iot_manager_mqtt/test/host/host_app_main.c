@@ -0,0 +1,16 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机构建的程序入口
+ *
+ * ESP-IDF的linux目标在main任务中调用app_main()；主机构建（host_rtos.c）中任务就是线程，
+ * 直接在主线程中调用即可。
+ */
+
+void app_main(void);
+
+int main(void)
+{
+    app_main();
+    return 0;
+}
@@ -0,0 +1,873 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机上的MQTT客户端（实现esp-mqtt接口）
+ *
+ * TCP上的MQTT 3.1.1客户端，只实现组件用到的部分：QoS0/1发布、订阅、遗嘱、心跳。
+ * 行为与esp-mqtt保持一致的地方：
+ *   - 每个客户端一个线程负责连接和接收，事件在该线程中同步调用处理函数；
+ *   - 连接失败或断开时投递DISCONNECTED，未禁用自动重连时等待reconnect_timeout_ms后重连；
+ *   - 未确认的QoS1消息保存在发件箱中，重新连接后带DUP标记重发，收到PUBACK时投递PUBLISHED；
+ *   - 未连接时发布返回-1（相当于esp-mqtt的MQTT_SKIP_PUBLISH_IF_DISCONNECTED）。
+ * 与esp-mqtt不同：发件箱中的消息在投递CONNECTED之前重发完；接收的消息不分片。
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mqtt_client.h"
+
+static const char *TAG = "host_mqtt";
+
+static const char *const MQTT_EVENTS = "MQTT_EVENTS";
+
+#define MQTT_DEFAULT_PORT       1883
+#define MQTT_DEFAULT_KEEPALIVE  120
+#define MQTT_CONNECT_TIMEOUT_MS 5000
+#define MQTT_PACKET_MAX         (1024 * 1024)
+
+// 控制报文类型（固定报头高4位）
+#define PKT_CONNECT     0x10
+#define PKT_CONNACK     0x20
+#define PKT_PUBLISH     0x30
+#define PKT_PUBACK      0x40
+#define PKT_SUBSCRIBE   0x82
+#define PKT_SUBACK      0x90
+#define PKT_UNSUBSCRIBE 0xA2
+#define PKT_UNSUBACK    0xB0
+#define PKT_PINGREQ     0xC0
+#define PKT_PINGRESP    0xD0
+#define PKT_DISCONNECT  0xE0
+#define PUBLISH_DUP     0x08
+
+// 发件箱：已发出、等待PUBACK的QoS1消息，按发送顺序
+typedef struct outbox_item {
+    struct outbox_item *next;
+    int msg_id;
+    size_t len;
+    uint8_t packet[];
+} outbox_item_t;
+
+struct esp_mqtt_client {
+    // 配置（初始化时复制）
+    char *host;
+    char *port;
+    char *client_id;
+    char *username;
+    char *password;
+    char *will_topic;
+    char *will_msg;
+    int will_len;
+    int will_qos;
+    int will_retain;
+    int keepalive_sec;
+    int reconnect_ms;
+    bool auto_reconnect;
+
+    esp_event_handler_t handler;
+    void *handler_arg;
+
+    // lock保护以下状态和发件箱；写socket时持有write_lock。同时持有时先lock后write_lock，
+    // 接收线程等待数据时两者都不持有
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool running;
+    bool stopping;
+    bool connected;
+    uint16_t last_msg_id;
+    outbox_item_t *outbox;
+
+    pthread_mutex_t write_lock;
+    int sock;                       ///< 只在持有write_lock时修改
+    int64_t last_tx_us;
+};
+
+/* ==================== 编码 ==================== */
+
+/**
+ * @brief 写入剩余长度（变长编码）
+ */
+static size_t put_remaining_len(uint8_t *p, size_t len)
+{
+    size_t n = 0;
+    do {
+        uint8_t b = len % 128;
+        len /= 128;
+        p[n++] = b | (len ? 0x80 : 0);
+    } while (len);
+    return n;
+}
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v >> 8;
+    p[1] = v & 0xff;
+    return p + 2;
+}
+
+static uint8_t *put_str(uint8_t *p, const char *s, size_t len)
+{
+    p = put_u16(p, (uint16_t)len);
+    memcpy(p, s, len);
+    return p + len;
+}
+
+/**
+ * @brief 按可变报头和负载长度分配报文，写入固定报头
+ *
+ * @param[out] body 可变报头开始位置
+ */
+static uint8_t *packet_alloc(uint8_t type, size_t body_len, size_t *total, uint8_t **body)
+{
+    uint8_t *pkt = malloc(body_len + 5);
+    if (!pkt) {
+        return NULL;
+    }
+    pkt[0] = type;
+    size_t hdr = 1 + put_remaining_len(pkt + 1, body_len);
+    *body = pkt + hdr;
+    *total = hdr + body_len;
+    return pkt;
+}
+
+/* ==================== 收发 ==================== */
+
+static bool send_all(int sock, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(sock, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief 在当前连接上发送报文
+ */
+static bool client_send(esp_mqtt_client_handle_t c, const uint8_t *pkt, size_t len)
+{
+    pthread_mutex_lock(&c->write_lock);
+    bool ok = c->sock >= 0 && send_all(c->sock, pkt, len);
+    if (ok) {
+        c->last_tx_us = esp_timer_get_time();
+    } else if (c->sock >= 0) {
+        // 让接收线程发现连接已断开
+        shutdown(c->sock, SHUT_RDWR);
+    }
+    pthread_mutex_unlock(&c->write_lock);
+    return ok;
+}
+
+static bool recv_all(int sock, uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = recv(sock, buf, len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief 接收一个报文
+ *
+ * @param[out] body 可变报头和负载（调用者释放）
+ */
+static bool recv_packet(int sock, uint8_t *type, uint8_t **body, size_t *len)
+{
+    uint8_t b;
+    if (!recv_all(sock, type, 1)) {
+        return false;
+    }
+    size_t remaining = 0;
+    for (int shift = 0; shift <= 21; shift += 7) {
+        if (!recv_all(sock, &b, 1)) {
+            return false;
+        }
+        remaining |= (size_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+    }
+    if (remaining > MQTT_PACKET_MAX) {
+        ESP_LOGE(TAG, "报文过长(%zu字节)", remaining);
+        return false;
+    }
+    *body = malloc(remaining + 1);
+    if (!*body || !recv_all(sock, *body, remaining)) {
+        free(*body);
+        return false;
+    }
+    (*body)[remaining] = '\0';
+    *len = remaining;
+    return true;
+}
+
+/* ==================== 事件 ==================== */
+
+static void dispatch(esp_mqtt_client_handle_t c, esp_mqtt_event_t *event)
+{
+    event->client = c;
+    event->protocol_ver = MQTT_PROTOCOL_V_3_1_1;
+    if (c->handler) {
+        c->handler(c->handler_arg, MQTT_EVENTS, event->event_id, event);
+    }
+}
+
+static void dispatch_simple(esp_mqtt_client_handle_t c, esp_mqtt_event_id_t id, int msg_id)
+{
+    esp_mqtt_event_t event = {
+        .event_id = id,
+        .msg_id = msg_id,
+    };
+    dispatch(c, &event);
+}
+
+/* ==================== 连接 ==================== */
+
+static int tcp_connect(esp_mqtt_client_handle_t c)
+{
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res;
+    if (getaddrinfo(c->host, c->port, &hints, &res) != 0) {
+        return -1;
+    }
+    int sock = -1;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock < 0) {
+            continue;
+        }
+        if (connect(sock, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        close(sock);
+        sock = -1;
+    }
+    freeaddrinfo(res);
+    if (sock >= 0) {
+        int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return sock;
+}
+
+/**
+ * @brief 建立MQTT连接：TCP连接、CONNECT、等待CONNACK
+ *
+ * @return int socket，失败返回-1
+ */
+static int mqtt_connect(esp_mqtt_client_handle_t c)
+{
+    int sock = tcp_connect(c);
+    if (sock < 0) {
+        return -1;
+    }
+
+    size_t id_len = strlen(c->client_id);
+    size_t body_len = 10 + 2 + id_len;
+    uint8_t flags = 0x02;   // clean session
+    if (c->will_topic) {
+        body_len += 2 + strlen(c->will_topic) + 2 + c->will_len;
+        flags |= 0x04 | (c->will_qos << 3) | (c->will_retain ? 0x20 : 0);
+    }
+    if (c->username) {
+        body_len += 2 + strlen(c->username);
+        flags |= 0x80;
+    }
+    if (c->password) {
+        body_len += 2 + strlen(c->password);
+        flags |= 0x40;
+    }
+
+    size_t total;
+    uint8_t *p;
+    uint8_t *pkt = packet_alloc(PKT_CONNECT, body_len, &total, &p);
+    if (!pkt) {
+        close(sock);
+        return -1;
+    }
+    p = put_str(p, "MQTT", 4);
+    *p++ = 4;               // 协议级别：3.1.1
+    *p++ = flags;
+    p = put_u16(p, c->keepalive_sec);
+    p = put_str(p, c->client_id, id_len);
+    if (c->will_topic) {
+        p = put_str(p, c->will_topic, strlen(c->will_topic));
+        p = put_str(p, c->will_msg, c->will_len);
+    }
+    if (c->username) {
+        p = put_str(p, c->username, strlen(c->username));
+    }
+    if (c->password) {
+        p = put_str(p, c->password, strlen(c->password));
+    }
+    bool sent = send_all(sock, pkt, total);
+    free(pkt);
+
+    // 等待CONNACK
+    struct pollfd pfd = { .fd = sock, .events = POLLIN };
+    uint8_t type;
+    uint8_t *body = NULL;
+    size_t len = 0;
+    if (!sent || poll(&pfd, 1, MQTT_CONNECT_TIMEOUT_MS) != 1 ||
+        !recv_packet(sock, &type, &body, &len)) {
+        close(sock);
+        return -1;
+    }
+    bool accepted = (type & 0xf0) == PKT_CONNACK && len >= 2 && body[1] == 0;
+    if (!accepted) {
+        ESP_LOGE(TAG, "服务器拒绝连接, 返回码%d", len >= 2 ? body[1] : -1);
+    }
+    free(body);
+    if (!accepted) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/**
+ * @brief 新连接建立后重发发件箱中未确认的消息
+ */
+static bool outbox_resend(esp_mqtt_client_handle_t c)
+{
+    int resent = 0;
+    bool ok = true;
+    pthread_mutex_lock(&c->lock);
+    for (outbox_item_t *it = c->outbox; it && ok; it = it->next) {
+        it->packet[0] |= PUBLISH_DUP;
+        ok = client_send(c, it->packet, it->len);
+        resent++;
+    }
+    pthread_mutex_unlock(&c->lock);
+    if (resent) {
+        ESP_LOGI(TAG, "重发%d条未确认的消息", resent);
+    }
+    return ok;
+}
+
+/**
+ * @brief 收到PUBACK，从发件箱中删除
+ *
+ * @return true 是发件箱中的消息
+ */
+static bool outbox_ack(esp_mqtt_client_handle_t c, int msg_id)
+{
+    bool found = false;
+    pthread_mutex_lock(&c->lock);
+    for (outbox_item_t **link = &c->outbox; *link; link = &(*link)->next) {
+        if ((*link)->msg_id == msg_id) {
+            outbox_item_t *it = *link;
+            *link = it->next;
+            free(it);
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&c->lock);
+    return found;
+}
+
+/**
+ * @brief 处理收到的报文
+ */
+static void handle_packet(esp_mqtt_client_handle_t c, uint8_t type, uint8_t *body, size_t len)
+{
+    switch (type & 0xf0) {
+    case PKT_PUBLISH: {
+        if (len < 2) {
+            break;
+        }
+        int qos = (type >> 1) & 0x03;
+        size_t topic_len = (body[0] << 8) | body[1];
+        size_t pos = 2 + topic_len;
+        int msg_id = 0;
+        if (qos > 0) {
+            if (pos + 2 > len) {
+                break;
+            }
+            msg_id = (body[pos] << 8) | body[pos + 1];
+            pos += 2;
+        }
+        if (pos > len) {
+            break;
+        }
+        esp_mqtt_event_t event = {
+            .event_id = MQTT_EVENT_DATA,
+            .topic = (char *)body + 2,
+            .topic_len = (int)topic_len,
+            .data = (char *)body + pos,
+            .data_len = (int)(len - pos),
+            .total_data_len = (int)(len - pos),
+            .current_data_offset = 0,
+            .msg_id = msg_id,
+            .qos = qos,
+            .retain = (type & 0x01) != 0,
+            .dup = (type & PUBLISH_DUP) != 0,
+        };
+        dispatch(c, &event);
+        if (qos > 0) {
+            uint8_t ack[4] = { PKT_PUBACK, 2, msg_id >> 8, msg_id & 0xff };
+            client_send(c, ack, sizeof(ack));
+        }
+        break;
+    }
+    case PKT_PUBACK:
+        if (len >= 2) {
+            int msg_id = (body[0] << 8) | body[1];
+            if (outbox_ack(c, msg_id)) {
+                dispatch_simple(c, MQTT_EVENT_PUBLISHED, msg_id);
+            }
+        }
+        break;
+    case PKT_SUBACK:
+        if (len >= 2) {
+            dispatch_simple(c, MQTT_EVENT_SUBSCRIBED, (body[0] << 8) | body[1]);
+        }
+        break;
+    case PKT_UNSUBACK:
+        if (len >= 2) {
+            dispatch_simple(c, MQTT_EVENT_UNSUBSCRIBED, (body[0] << 8) | body[1]);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief 距上次发送的时间
+ */
+static int64_t idle_us(esp_mqtt_client_handle_t c)
+{
+    pthread_mutex_lock(&c->write_lock);
+    int64_t last_tx_us = c->last_tx_us;
+    pthread_mutex_unlock(&c->write_lock);
+    return esp_timer_get_time() - last_tx_us;
+}
+
+/**
+ * @brief 接收直到连接断开或客户端停止，空闲时发送心跳
+ */
+static void receive_loop(esp_mqtt_client_handle_t c, int sock)
+{
+    int64_t ping_interval_us = (int64_t)c->keepalive_sec * 1000000 / 2;
+    for (;;) {
+        int64_t wait_us = ping_interval_us - idle_us(c);
+        if (wait_us <= 0) {
+            uint8_t ping[2] = { PKT_PINGREQ, 0 };
+            if (!client_send(c, ping, sizeof(ping))) {
+                return;
+            }
+            continue;
+        }
+
+        struct pollfd pfd = { .fd = sock, .events = POLLIN };
+        int n = poll(&pfd, 1, (int)(wait_us / 1000) + 1);
+        if (n < 0 && errno != EINTR) {
+            return;
+        }
+        if (n <= 0) {
+            continue;
+        }
+        uint8_t type;
+        uint8_t *body;
+        size_t len;
+        if (!recv_packet(sock, &type, &body, &len)) {
+            return;
+        }
+        handle_packet(c, type, body, len);
+        free(body);
+    }
+}
+
+/**
+ * @brief 关闭当前连接
+ */
+static void close_connection(esp_mqtt_client_handle_t c, int sock)
+{
+    pthread_mutex_lock(&c->lock);
+    c->connected = false;
+    pthread_mutex_unlock(&c->lock);
+
+    pthread_mutex_lock(&c->write_lock);
+    c->sock = -1;
+    pthread_mutex_unlock(&c->write_lock);
+    close(sock);
+}
+
+static bool stop_requested(esp_mqtt_client_handle_t c)
+{
+    pthread_mutex_lock(&c->lock);
+    bool stopping = c->stopping;
+    pthread_mutex_unlock(&c->lock);
+    return stopping;
+}
+
+/**
+ * @brief 客户端线程：连接、接收、断开后按固定间隔重连
+ */
+static void *client_thread(void *arg)
+{
+    esp_mqtt_client_handle_t c = arg;
+
+    while (!stop_requested(c)) {
+        int sock = mqtt_connect(c);
+        if (sock >= 0) {
+            pthread_mutex_lock(&c->write_lock);
+            c->sock = sock;
+            c->last_tx_us = esp_timer_get_time();
+            pthread_mutex_unlock(&c->write_lock);
+
+            // 停止请求可能在连接期间到达，此时socket尚未登记
+            pthread_mutex_lock(&c->lock);
+            c->connected = !c->stopping;
+            pthread_mutex_unlock(&c->lock);
+
+            if (c->connected && outbox_resend(c)) {
+                ESP_LOGI(TAG, "已连接 %s:%s", c->host, c->port);
+                esp_mqtt_event_t event = { .event_id = MQTT_EVENT_CONNECTED };
+                dispatch(c, &event);
+                receive_loop(c, sock);
+            }
+            close_connection(c, sock);
+        } else {
+            esp_mqtt_error_codes_t error = {
+                .error_type = MQTT_ERROR_TYPE_TCP_TRANSPORT,
+                .esp_transport_sock_errno = errno,
+            };
+            esp_mqtt_event_t event = { .event_id = MQTT_EVENT_ERROR, .error_handle = &error };
+            dispatch(c, &event);
+        }
+
+        if (stop_requested(c)) {
+            break;
+        }
+        dispatch_simple(c, MQTT_EVENT_DISCONNECTED, 0);
+
+        // 等待重连（禁用自动重连时等待停止）
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += c->reconnect_ms / 1000;
+        deadline.tv_nsec += (long)(c->reconnect_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&c->lock);
+        int err = 0;
+        while (!c->stopping && err != ETIMEDOUT) {
+            err = c->auto_reconnect ? pthread_cond_timedwait(&c->cond, &c->lock, &deadline) :
+                  pthread_cond_wait(&c->cond, &c->lock);
+        }
+        pthread_mutex_unlock(&c->lock);
+    }
+    return NULL;
+}
+
+/* ==================== 接口 ==================== */
+
+static char *dup_or_null(const char *s)
+{
+    return s ? strdup(s) : NULL;
+}
+
+/**
+ * @brief 解析 mqtt://host[:port]
+ */
+static bool parse_uri(esp_mqtt_client_handle_t c, const char *uri)
+{
+    const char *prefix = "mqtt://";
+    if (!uri || strncmp(uri, prefix, strlen(prefix)) != 0) {
+        ESP_LOGE(TAG, "只支持mqtt://地址: %s", uri ? uri : "(null)");
+        return false;
+    }
+    const char *host = uri + strlen(prefix);
+    size_t host_len = strcspn(host, ":/");
+    c->host = strndup(host, host_len);
+    char port[8];
+    if (host[host_len] == ':') {
+        snprintf(port, sizeof(port), "%d", atoi(host + host_len + 1));
+    } else {
+        snprintf(port, sizeof(port), "%d", MQTT_DEFAULT_PORT);
+    }
+    c->port = strdup(port);
+    return c->host && c->port;
+}
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config)
+{
+    esp_mqtt_client_handle_t c = calloc(1, sizeof(*c));
+    if (!c) {
+        return NULL;
+    }
+    if (!parse_uri(c, config->broker.address.uri)) {
+        esp_mqtt_client_destroy(c);
+        return NULL;
+    }
+    c->client_id = strdup(config->credentials.client_id ? config->credentials.client_id : "host");
+    c->username = dup_or_null(config->credentials.username);
+    c->password = dup_or_null(config->credentials.authentication.password);
+    if (config->session.last_will.topic) {
+        c->will_topic = strdup(config->session.last_will.topic);
+        c->will_len = config->session.last_will.msg_len ? config->session.last_will.msg_len :
+                      (int)strlen(config->session.last_will.msg);
+        c->will_msg = malloc(c->will_len + 1);
+        memcpy(c->will_msg, config->session.last_will.msg, c->will_len);
+        c->will_qos = config->session.last_will.qos;
+        c->will_retain = config->session.last_will.retain;
+    }
+    c->keepalive_sec = config->session.keepalive ? config->session.keepalive :
+                       MQTT_DEFAULT_KEEPALIVE;
+    c->reconnect_ms = config->network.reconnect_timeout_ms ?
+                      config->network.reconnect_timeout_ms : 10000;
+    c->auto_reconnect = !config->network.disable_auto_reconnect;
+    c->sock = -1;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_mutex_init(&c->write_lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&c->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return c;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t event_handler,
+                                         void *event_handler_arg)
+{
+    if (!client) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    client->handler = event_handler;
+    client->handler_arg = event_handler_arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client)
+{
+    if (!client) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&client->lock);
+    esp_err_t ret = ESP_FAIL;
+    if (!client->running) {
+        client->stopping = false;
+        if (pthread_create(&client->thread, NULL, client_thread, client) == 0) {
+            client->running = true;
+            ret = ESP_OK;
+        }
+    } else {
+        ESP_LOGE(TAG, "客户端已启动");
+    }
+    pthread_mutex_unlock(&client->lock);
+    return ret;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client)
+{
+    if (!client) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&client->lock);
+    if (!client->running || pthread_equal(client->thread, pthread_self())) {
+        pthread_mutex_unlock(&client->lock);
+        ESP_LOGE(TAG, "客户端未启动，或在客户端线程中停止");
+        return ESP_FAIL;
+    }
+    bool connected = client->connected;
+    client->stopping = true;
+    client->connected = false;
+    pthread_cond_broadcast(&client->cond);
+    pthread_mutex_unlock(&client->lock);
+
+    pthread_mutex_lock(&client->write_lock);
+    if (client->sock >= 0) {
+        if (connected) {
+            uint8_t disconnect[2] = { PKT_DISCONNECT, 0 };
+            send_all(client->sock, disconnect, sizeof(disconnect));
+        }
+        shutdown(client->sock, SHUT_RDWR);
+    }
+    pthread_mutex_unlock(&client->write_lock);
+
+    pthread_join(client->thread, NULL);
+    pthread_mutex_lock(&client->lock);
+    client->running = false;
+    pthread_mutex_unlock(&client->lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client)
+{
+    if (!client) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->running) {
+        esp_mqtt_client_stop(client);
+    }
+    while (client->outbox) {
+        outbox_item_t *it = client->outbox;
+        client->outbox = it->next;
+        free(it);
+    }
+    free(client->host);
+    free(client->port);
+    free(client->client_id);
+    free(client->username);
+    free(client->password);
+    free(client->will_topic);
+    free(client->will_msg);
+    pthread_cond_destroy(&client->cond);
+    pthread_mutex_destroy(&client->write_lock);
+    pthread_mutex_destroy(&client->lock);
+    free(client);
+    return ESP_OK;
+}
+
+/**
+ * @brief 分配报文标识（持有lock时调用）
+ */
+static int next_msg_id(esp_mqtt_client_handle_t c)
+{
+    if (++c->last_msg_id == 0) {
+        c->last_msg_id = 1;
+    }
+    return c->last_msg_id;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain)
+{
+    if (!client || !topic || qos < 0 || qos > 1) {
+        return -1;
+    }
+    if (len <= 0) {
+        len = data ? (int)strlen(data) : 0;
+    }
+    size_t topic_len = strlen(topic);
+    size_t body_len = 2 + topic_len + (qos ? 2 : 0) + len;
+
+    // 发件箱中的消息重发时原样使用报文，放在同一块内存中
+    outbox_item_t *item = malloc(sizeof(*item) + body_len + 5);
+    if (!item) {
+        return -1;
+    }
+    uint8_t *pkt = item->packet;
+    pkt[0] = PKT_PUBLISH | (qos << 1) | (retain ? 0x01 : 0);
+    size_t hdr = 1 + put_remaining_len(pkt + 1, body_len);
+    item->len = hdr + body_len;
+
+    pthread_mutex_lock(&client->lock);
+    if (!client->connected) {
+        pthread_mutex_unlock(&client->lock);
+        free(item);
+        return -1;
+    }
+    int msg_id = qos ? next_msg_id(client) : 0;
+    uint8_t *p = put_str(pkt + hdr, topic, topic_len);
+    if (qos) {
+        p = put_u16(p, msg_id);
+    }
+    memcpy(p, data, len);
+    item->msg_id = msg_id;
+
+    // 持有lock发送：PUBACK不会早于登记到发件箱，接收线程也不会在发送期间释放报文
+    bool sent = client_send(client, item->packet, item->len);
+    if (qos && sent) {
+        item->next = NULL;
+        outbox_item_t **link = &client->outbox;
+        while (*link) {
+            link = &(*link)->next;
+        }
+        *link = item;
+    } else {
+        // 发送失败时不保留，调用者自行处理（组件转入离线缓存），避免重连后重复
+        free(item);
+    }
+    pthread_mutex_unlock(&client->lock);
+    return sent ? msg_id : -1;
+}
+
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos)
+{
+    if (!client || !topic) {
+        return -1;
+    }
+    pthread_mutex_lock(&client->lock);
+    bool connected = client->connected;
+    int msg_id = next_msg_id(client);
+    pthread_mutex_unlock(&client->lock);
+    if (!connected) {
+        return -1;
+    }
+
+    size_t total;
+    uint8_t *p;
+    uint8_t *pkt = packet_alloc(PKT_SUBSCRIBE, 2 + 2 + strlen(topic) + 1, &total, &p);
+    if (!pkt) {
+        return -1;
+    }
+    p = put_u16(p, msg_id);
+    p = put_str(p, topic, strlen(topic));
+    *p = (uint8_t)qos;
+    bool sent = client_send(client, pkt, total);
+    free(pkt);
+    return sent ? msg_id : -1;
+}
+
+int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client, const char *topic)
+{
+    if (!client || !topic) {
+        return -1;
+    }
+    pthread_mutex_lock(&client->lock);
+    bool connected = client->connected;
+    int msg_id = next_msg_id(client);
+    pthread_mutex_unlock(&client->lock);
+    if (!connected) {
+        return -1;
+    }
+
+    size_t total;
+    uint8_t *p;
+    uint8_t *pkt = packet_alloc(PKT_UNSUBSCRIBE, 2 + 2 + strlen(topic), &total, &p);
+    if (!pkt) {
+        return -1;
+    }
+    p = put_u16(p, msg_id);
+    put_str(p, topic, strlen(topic));
+    bool sent = client_send(client, pkt, total);
+    free(pkt);
+    return sent ? msg_id : -1;
+}
@@ -0,0 +1,736 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机上的实时运行环境
+ *
+ * 用线程实现组件用到的FreeRTOS任务、任务通知和队列，以及esp_timer（回调在
+ * 定时器线程中执行）和默认事件循环（处理函数在事件循环线程中执行），时间为真实时间。
+ * 组件源文件不加修改地在开发机上编译运行，用于连接本机MQTT服务器的测试和基准。
+ */
+
+#include <errno.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#define EVENT_HANDLERS_MAX  32
+
+/* ==================== 时间 ==================== */
+
+static struct timespec start_time;
+
+__attribute__((constructor)) static void host_rtos_clock_init(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)(ts.tv_sec - start_time.tv_sec) * 1000000 +
+           (ts.tv_nsec - start_time.tv_nsec) / 1000;
+}
+
+/**
+ * @brief 计算等待的截止时间（CLOCK_MONOTONIC）
+ */
+static struct timespec deadline_after_us(int64_t us)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += us / 1000000;
+    ts.tv_nsec += (us % 1000000) * 1000;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+/**
+ * @brief 等待条件变量，deadline为NULL时一直等待
+ *
+ * @return int 0被唤醒，ETIMEDOUT超时
+ */
+static int cond_wait_until(pthread_cond_t *cond, pthread_mutex_t *lock,
+                           const struct timespec *deadline)
+{
+    if (!deadline) {
+        return pthread_cond_wait(cond, lock);
+    }
+    return pthread_cond_timedwait(cond, lock, deadline);
+}
+
+static void cond_init_monotonic(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/* ==================== 日志和C库 ==================== */
+
+// IOT_HOST_LOG=W/I/D/V 输出该级别及更重要的日志，其他值输出全部；未设置时只输出错误
+static const char log_levels[] = "EWIDV";
+static int log_max_level = 0;               ///< log_levels中的下标
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+
+static void log_level_init(void)
+{
+    const char *env = getenv("IOT_HOST_LOG");
+    const char *level = env && env[0] ? strchr(log_levels, env[0]) : NULL;
+    log_max_level = level ? (int)(level - log_levels) : env ? (int)strlen(log_levels) - 1 : 0;
+}
+
+void host_log(char level, const char *tag, const char *format, ...)
+{
+    pthread_once(&log_once, log_level_init);
+    const char *pos = strchr(log_levels, level);
+    if (!pos || pos - log_levels > log_max_level) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, format);
+    flockfile(stderr);
+    fprintf(stderr, "[%9.3f] %c %s: ", esp_timer_get_time() / 1e6, level, tag);
+    vfprintf(stderr, format, ap);
+    fputc('\n', stderr);
+    funlockfile(stderr);
+    va_end(ap);
+}
+
+const char *esp_err_to_name(esp_err_t err)
+{
+    switch (err) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    default: return "ESP_FAIL";
+    }
+}
+
+uint32_t esp_random(void)
+{
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    static uint32_t state = 0x2545f491;
+    pthread_mutex_lock(&lock);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    uint32_t x = state;
+    pthread_mutex_unlock(&lock);
+    return x;
+}
+
+#if !HAVE_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+// 主机上的堆没有固定大小，统计中的空闲内存记为0
+uint32_t esp_get_free_heap_size(void)
+{
+    return 0;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return 0;
+}
+
+/* ==================== 任务和任务通知 ==================== */
+
+typedef struct host_task {
+    struct host_task *next;
+    pthread_t thread;
+    char name[configMAX_TASK_NAME_LEN];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify_value;
+    bool notify_pending;
+} host_task_t;
+
+typedef struct {
+    TaskFunction_t fn;
+    void *arg;
+} task_start_t;
+
+// 任务表：任务句柄为线程ID（与 xTaskGetCurrentTaskHandle 一致），按线程ID查找通知状态
+static host_task_t *task_list = NULL;
+static pthread_mutex_t task_list_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief 查找任务，不存在时创建（非xTaskCreate创建的线程第一次使用通知时）
+ */
+static host_task_t *task_get(pthread_t thread)
+{
+    pthread_mutex_lock(&task_list_lock);
+    host_task_t *t = task_list;
+    while (t && !pthread_equal(t->thread, thread)) {
+        t = t->next;
+    }
+    if (!t) {
+        t = calloc(1, sizeof(*t));
+        if (!t) {
+            abort();
+        }
+        t->thread = thread;
+        pthread_mutex_init(&t->lock, NULL);
+        cond_init_monotonic(&t->cond);
+        t->next = task_list;
+        task_list = t;
+    }
+    pthread_mutex_unlock(&task_list_lock);
+    return t;
+}
+
+static host_task_t *task_from_handle(TaskHandle_t handle)
+{
+    return task_get(handle ? (pthread_t)(uintptr_t)handle : pthread_self());
+}
+
+static void *task_entry(void *arg)
+{
+    task_start_t start = *(task_start_t *)arg;
+    free(arg);
+    start.fn(start.arg);
+    // FreeRTOS任务函数不能返回
+    fprintf(stderr, "任务函数返回，未调用vTaskDelete\n");
+    abort();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out_handle)
+{
+    task_start_t *start = malloc(sizeof(*start));
+    if (!start) {
+        return pdFAIL;
+    }
+    start->fn = fn;
+    start->arg = arg;
+
+    // 栈大小按设备上的4倍分配，主机的C库（printf等）用栈更多
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    size_t stack = (size_t)stack_depth * 4;
+    if (stack < 65536) {
+        stack = 65536;
+    }
+    pthread_attr_setstacksize(&attr, stack);
+
+    pthread_t thread;
+    int err = pthread_create(&thread, &attr, task_entry, start);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        free(start);
+        return pdFAIL;
+    }
+    host_task_t *t = task_get(thread);
+    snprintf(t->name, sizeof(t->name), "%s", name ? name : "");
+    if (out_handle) {
+        *out_handle = (TaskHandle_t)(uintptr_t)thread;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task && !pthread_equal((pthread_t)(uintptr_t)task, pthread_self())) {
+        fprintf(stderr, "主机上不支持删除其他任务\n");
+        abort();
+    }
+    pthread_t self = pthread_self();
+    pthread_mutex_lock(&task_list_lock);
+    for (host_task_t **link = &task_list; *link; link = &(*link)->next) {
+        if (pthread_equal((*link)->thread, self)) {
+            host_task_t *t = *link;
+            *link = t->next;
+            pthread_cond_destroy(&t->cond);
+            pthread_mutex_destroy(&t->lock);
+            free(t);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&task_list_lock);
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    struct timespec ts = {
+        .tv_sec = ticks / configTICK_RATE_HZ,
+        .tv_nsec = (long)(ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ),
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / (1000000 / configTICK_RATE_HZ));
+}
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    host_task_t *t = task_from_handle(task);
+    BaseType_t ret = pdPASS;
+
+    pthread_mutex_lock(&t->lock);
+    switch (action) {
+    case eSetBits:
+        t->notify_value |= value;
+        break;
+    case eIncrement:
+        t->notify_value++;
+        break;
+    case eSetValueWithOverwrite:
+        t->notify_value = value;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (t->notify_pending) {
+            ret = pdFAIL;
+        } else {
+            t->notify_value = value;
+        }
+        break;
+    case eNoAction:
+        break;
+    }
+    t->notify_pending = true;
+    pthread_cond_broadcast(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+    return ret;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t *value, TickType_t ticks)
+{
+    host_task_t *t = task_from_handle(NULL);
+    struct timespec deadline = deadline_after_us((int64_t)ticks * 1000);
+
+    pthread_mutex_lock(&t->lock);
+    if (!t->notify_pending) {
+        t->notify_value &= ~clear_on_entry;
+    }
+    int err = 0;
+    while (!t->notify_pending && ticks > 0 && err != ETIMEDOUT) {
+        err = cond_wait_until(&t->cond, &t->lock, ticks == portMAX_DELAY ? NULL : &deadline);
+    }
+    if (value) {
+        *value = t->notify_value;
+    }
+    BaseType_t received = t->notify_pending;
+    if (received) {
+        t->notify_value &= ~clear_on_exit;
+        t->notify_pending = false;
+    }
+    pthread_mutex_unlock(&t->lock);
+    return received ? pdTRUE : pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    host_task_t *t = task_from_handle(NULL);
+    struct timespec deadline = deadline_after_us((int64_t)ticks * 1000);
+
+    pthread_mutex_lock(&t->lock);
+    int err = 0;
+    while (t->notify_value == 0 && ticks > 0 && err != ETIMEDOUT) {
+        err = cond_wait_until(&t->cond, &t->lock, ticks == portMAX_DELAY ? NULL : &deadline);
+    }
+    uint32_t value = t->notify_value;
+    if (value) {
+        t->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    t->notify_pending = false;
+    pthread_mutex_unlock(&t->lock);
+    return value;
+}
+
+/* ==================== 队列 ==================== */
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t items[];
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t q = calloc(1, sizeof(*q) + (size_t)length * item_size);
+    if (!q) {
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    cond_init_monotonic(&q->not_empty);
+    cond_init_monotonic(&q->not_full);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->lock);
+    free(q);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    struct timespec deadline = deadline_after_us((int64_t)ticks * 1000);
+
+    pthread_mutex_lock(&q->lock);
+    int err = 0;
+    while (q->count == q->length && ticks > 0 && err != ETIMEDOUT) {
+        err = cond_wait_until(&q->not_full, &q->lock, ticks == portMAX_DELAY ? NULL : &deadline);
+    }
+    BaseType_t ok = q->count < q->length;
+    if (ok) {
+        UBaseType_t tail = (q->head + q->count) % q->length;
+        memcpy(q->items + (size_t)tail * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_signal(&q->not_empty);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    struct timespec deadline = deadline_after_us((int64_t)ticks * 1000);
+
+    pthread_mutex_lock(&q->lock);
+    int err = 0;
+    while (q->count == 0 && ticks > 0 && err != ETIMEDOUT) {
+        err = cond_wait_until(&q->not_empty, &q->lock, ticks == portMAX_DELAY ? NULL : &deadline);
+    }
+    BaseType_t ok = q->count > 0;
+    if (ok) {
+        memcpy(item, q->items + (size_t)q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+/* ==================== esp_timer ==================== */
+
+struct esp_timer {
+    struct esp_timer *next;     ///< 按到期时间排序的活动定时器链表
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t due_us;
+    bool active;
+};
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_cond;
+static struct esp_timer *timer_list = NULL;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief 从活动链表中移除（持有timer_lock时调用）
+ */
+static void timer_unlink(esp_timer_handle_t timer)
+{
+    for (struct esp_timer **link = &timer_list; *link; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+    timer->active = false;
+}
+
+static void *timer_thread(void *arg)
+{
+    pthread_mutex_lock(&timer_lock);
+    for (;;) {
+        if (!timer_list) {
+            pthread_cond_wait(&timer_cond, &timer_lock);
+            continue;
+        }
+        int64_t remain_us = timer_list->due_us - esp_timer_get_time();
+        if (remain_us > 0) {
+            struct timespec deadline = deadline_after_us(remain_us);
+            pthread_cond_timedwait(&timer_cond, &timer_lock, &deadline);
+            continue;
+        }
+        esp_timer_handle_t timer = timer_list;
+        timer_unlink(timer);
+        // 回调中可以重新启动或停止定时器
+        pthread_mutex_unlock(&timer_lock);
+        timer->callback(timer->arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    return NULL;
+}
+
+static void timer_thread_start(void)
+{
+    pthread_t thread;
+    cond_init_monotonic(&timer_cond);
+    if (pthread_create(&thread, NULL, timer_thread, NULL) != 0) {
+        abort();
+    }
+    pthread_detach(thread);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    if (!args || !args->callback || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_once(&timer_once, timer_thread_start);
+    esp_timer_handle_t timer = calloc(1, sizeof(*timer));
+    if (!timer) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    pthread_mutex_lock(&timer_lock);
+    if (timer->active) {
+        pthread_mutex_unlock(&timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+    timer->active = true;
+    struct esp_timer **link = &timer_list;
+    while (*link && (*link)->due_us <= timer->due_us) {
+        link = &(*link)->next;
+    }
+    timer->next = *link;
+    *link = timer;
+    pthread_cond_signal(&timer_cond);
+    pthread_mutex_unlock(&timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer_lock);
+    bool active = timer->active;
+    if (active) {
+        timer_unlink(timer);
+    }
+    pthread_mutex_unlock(&timer_lock);
+    return active ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&timer_lock);
+    bool active = timer->active;
+    pthread_mutex_unlock(&timer_lock);
+    if (active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(timer);
+    return ESP_OK;
+}
+
+/* ==================== 默认事件循环 ==================== */
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void *arg;
+} event_handler_t;
+
+typedef struct posted_event {
+    struct posted_event *next;
+    esp_event_base_t base;
+    int32_t id;
+    size_t size;
+    uint8_t data[];
+} posted_event_t;
+
+static pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t event_cond;
+static event_handler_t event_handlers[EVENT_HANDLERS_MAX];
+static posted_event_t *event_head = NULL;
+static posted_event_t *event_tail = NULL;
+static bool event_loop_running = false;
+
+static bool base_matches(esp_event_base_t want, esp_event_base_t base)
+{
+    return want == ESP_EVENT_ANY_BASE || want == base || strcmp(want, base) == 0;
+}
+
+static void *event_loop_thread(void *arg)
+{
+    for (;;) {
+        pthread_mutex_lock(&event_lock);
+        while (!event_head) {
+            pthread_cond_wait(&event_cond, &event_lock);
+        }
+        posted_event_t *ev = event_head;
+        event_head = ev->next;
+        if (!event_head) {
+            event_tail = NULL;
+        }
+        // 拷贝匹配的处理函数后再调用，处理函数中可以注册或注销
+        event_handler_t matched[EVENT_HANDLERS_MAX];
+        int n = 0;
+        for (int i = 0; i < EVENT_HANDLERS_MAX; i++) {
+            event_handler_t *h = &event_handlers[i];
+            if (h->handler && base_matches(h->base, ev->base) &&
+                (h->id == ESP_EVENT_ANY_ID || h->id == ev->id)) {
+                matched[n++] = *h;
+            }
+        }
+        pthread_mutex_unlock(&event_lock);
+
+        for (int i = 0; i < n; i++) {
+            matched[i].handler(matched[i].arg, ev->base, ev->id, ev->size ? ev->data : NULL);
+        }
+        free(ev);
+    }
+    return NULL;
+}
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    pthread_mutex_lock(&event_lock);
+    if (event_loop_running) {
+        pthread_mutex_unlock(&event_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    cond_init_monotonic(&event_cond);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, event_loop_thread, NULL) != 0) {
+        pthread_mutex_unlock(&event_lock);
+        return ESP_FAIL;
+    }
+    pthread_detach(thread);
+    event_loop_running = true;
+    pthread_mutex_unlock(&event_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id,
+                                              esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance)
+{
+    if (!handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&event_lock);
+    for (int i = 0; i < EVENT_HANDLERS_MAX; i++) {
+        event_handler_t *h = &event_handlers[i];
+        if (!h->handler) {
+            *h = (event_handler_t){ base, id, handler, arg };
+            if (instance) {
+                *instance = h;
+            }
+            pthread_mutex_unlock(&event_lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&event_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id,
+                                     esp_event_handler_t handler, void *arg)
+{
+    return esp_event_handler_instance_register(base, id, handler, arg, NULL);
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t base, int32_t id,
+                                       esp_event_handler_t handler)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    pthread_mutex_lock(&event_lock);
+    for (int i = 0; i < EVENT_HANDLERS_MAX; i++) {
+        event_handler_t *h = &event_handlers[i];
+        if (h->handler == handler && h->base == base && h->id == id) {
+            h->handler = NULL;
+            ret = ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&event_lock);
+    return ret;
+}
+
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data, size_t size,
+                         TickType_t ticks)
+{
+    posted_event_t *ev = malloc(sizeof(*ev) + size);
+    if (!ev) {
+        return ESP_ERR_NO_MEM;
+    }
+    ev->next = NULL;
+    ev->base = base;
+    ev->id = id;
+    ev->size = data ? size : 0;
+    if (ev->size) {
+        memcpy(ev->data, data, size);
+    }
+
+    pthread_mutex_lock(&event_lock);
+    if (!event_loop_running) {
+        pthread_mutex_unlock(&event_lock);
+        free(ev);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (event_tail) {
+        event_tail->next = ev;
+    } else {
+        event_head = ev;
+    }
+    event_tail = ev;
+    pthread_cond_signal(&event_cond);
+    pthread_mutex_unlock(&event_lock);
+    return ESP_OK;
+}
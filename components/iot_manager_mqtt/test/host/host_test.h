@@ -0,0 +1,66 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试公共宏
+ *
+ * 测试用 CHECK() 记录失败并继续，main() 返回 TEST_RESULT()。
+ * 基准测试每个结果向标准输出写一行JSON，方便按提交记录和绘图。
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int host_test_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) 失败\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() \
+    (host_test_failures ? (fprintf(stderr, "%d项检查失败\n", host_test_failures), 1) : 0)
+
+/**
+ * @brief 单调时钟（秒）
+ */
+static inline double host_now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief 可重复的伪随机数（xorshift32），测试结果不依赖libc的rand()
+ */
+static inline uint32_t host_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief 基准测试迭代次数，可以通过环境变量 IOT_BENCH_SCALE 按比例放大
+ */
+static inline long bench_iterations(long base)
+{
+    const char *scale = getenv("IOT_BENCH_SCALE");
+    if (scale && atof(scale) > 0) {
+        return (long)(base * atof(scale));
+    }
+    return base;
+}
+
+#endif // HOST_TEST_H
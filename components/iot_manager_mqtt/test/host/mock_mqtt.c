@@ -0,0 +1,285 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的模拟MQTT客户端实现
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "mock_mqtt.h"
+#include "mqtt_client.h"
+
+static const char *const MQTT_EVENTS = "MQTT_EVENTS";
+
+struct esp_mqtt_client {
+    esp_mqtt_protocol_ver_t protocol_ver;
+    esp_event_handler_t handler;
+    void *handler_arg;
+    bool started;
+};
+
+// 以下状态由lock保护，cond在记录消息和启动客户端时通知
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static esp_mqtt_client_handle_t the_client;
+static bool connected;
+static uint32_t conn_seq;
+static uint16_t alias_max;
+static int last_msg_id;
+static esp_mqtt5_publish_property_config_t pending_property;
+static bool property_pending;
+static mock_mqtt_msg_t msgs[MOCK_MQTT_MAX_MSGS];
+static int msg_count;
+static uint32_t start_count;        // esp_mqtt_client_start()成功的次数
+static uint32_t start_at_disconnect;
+
+/* ==================== 测试接口 ==================== */
+
+void mock_mqtt_set_alias_max(uint16_t max)
+{
+    pthread_mutex_lock(&lock);
+    alias_max = max;
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * @brief 在调用线程中投递事件（不持有lock，处理函数会回调本模块）
+ */
+static void dispatch(esp_mqtt_event_id_t id)
+{
+    esp_mqtt5_event_property_t property = { 0 };
+    esp_mqtt_event_t event = {
+        .event_id = id,
+        .client = the_client,
+        .protocol_ver = the_client->protocol_ver,
+        .property = &property,
+    };
+    the_client->handler(the_client->handler_arg, MQTT_EVENTS, id, &event);
+}
+
+void mock_mqtt_connect(void)
+{
+    pthread_mutex_lock(&lock);
+    connected = true;
+    conn_seq++;
+    pthread_mutex_unlock(&lock);
+    dispatch(MQTT_EVENT_CONNECTED);
+}
+
+void mock_mqtt_disconnect(void)
+{
+    pthread_mutex_lock(&lock);
+    connected = false;
+    start_at_disconnect = start_count;
+    pthread_mutex_unlock(&lock);
+    dispatch(MQTT_EVENT_DISCONNECTED);
+}
+
+/**
+ * @brief 计算timeout_ms之后的绝对时间，供pthread_cond_timedwait使用
+ */
+static void deadline_after(struct timespec *deadline, int timeout_ms)
+{
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+bool mock_mqtt_wait_restart(int timeout_ms)
+{
+    struct timespec deadline;
+    deadline_after(&deadline, timeout_ms);
+
+    pthread_mutex_lock(&lock);
+    while (start_count == start_at_disconnect &&
+           pthread_cond_timedwait(&cond, &lock, &deadline) == 0) {
+    }
+    bool restarted = start_count != start_at_disconnect;
+    pthread_mutex_unlock(&lock);
+    return restarted;
+}
+
+int mock_mqtt_count(void)
+{
+    pthread_mutex_lock(&lock);
+    int n = msg_count;
+    pthread_mutex_unlock(&lock);
+    return n;
+}
+
+int mock_mqtt_wait(int count, int timeout_ms)
+{
+    struct timespec deadline;
+    deadline_after(&deadline, timeout_ms);
+
+    pthread_mutex_lock(&lock);
+    while (msg_count < count &&
+           pthread_cond_timedwait(&cond, &lock, &deadline) == 0) {
+    }
+    int n = msg_count;
+    pthread_mutex_unlock(&lock);
+    return n;
+}
+
+const mock_mqtt_msg_t *mock_mqtt_get(int i)
+{
+    pthread_mutex_lock(&lock);
+    const mock_mqtt_msg_t *m = (i >= 0 && i < msg_count) ? &msgs[i] : NULL;
+    pthread_mutex_unlock(&lock);
+    return m;
+}
+
+int mock_mqtt_find(const char *topic_suffix, int from)
+{
+    size_t suffix_len = strlen(topic_suffix);
+    pthread_mutex_lock(&lock);
+    int found = -1;
+    for (int i = from < 0 ? 0 : from; i < msg_count && found < 0; i++) {
+        size_t len = strlen(msgs[i].topic);
+        if (len >= suffix_len && strcmp(msgs[i].topic + len - suffix_len, topic_suffix) == 0) {
+            found = i;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return found;
+}
+
+/* ==================== esp-mqtt接口 ==================== */
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config)
+{
+    esp_mqtt_client_handle_t client = calloc(1, sizeof(*client));
+    if (client) {
+        client->protocol_ver = config->session.protocol_ver;
+        the_client = client;
+    }
+    return client;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t event_handler,
+                                         void *event_handler_arg)
+{
+    client->handler = event_handler;
+    client->handler_arg = event_handler_arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client)
+{
+    if (client->started) {
+        return ESP_FAIL;
+    }
+    client->started = true;
+    pthread_mutex_lock(&lock);
+    start_count++;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client)
+{
+    if (!client->started) {
+        return ESP_FAIL;
+    }
+    client->started = false;
+    pthread_mutex_lock(&lock);
+    connected = false;
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client)
+{
+    if (the_client == client) {
+        the_client = NULL;
+    }
+    free(client);
+    return ESP_OK;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain)
+{
+    if (len <= 0) {
+        len = data ? (int)strlen(data) : 0;
+    }
+
+    pthread_mutex_lock(&lock);
+    uint16_t alias = property_pending ? pending_property.topic_alias : 0;
+    property_pending = false;
+    if (!connected || msg_count >= MOCK_MQTT_MAX_MSGS || (topic[0] == '\0' && alias == 0)) {
+        pthread_mutex_unlock(&lock);
+        return -1;
+    }
+    mock_mqtt_msg_t *m = &msgs[msg_count];
+    strncpy(m->topic, topic, sizeof(m->topic) - 1);
+    m->len = len;
+    int copy = len < MOCK_MQTT_DATA_MAX ? len : MOCK_MQTT_DATA_MAX;
+    memcpy(m->data, data, copy);
+    m->data[copy] = '\0';
+    m->qos = qos;
+    m->msg_id = qos > 0 ? ++last_msg_id : 0;
+    m->topic_alias = alias;
+    m->conn_seq = conn_seq;
+    m->time_us = esp_timer_get_time();
+    msg_count++;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+    return m->msg_id;
+}
+
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos)
+{
+    pthread_mutex_lock(&lock);
+    int msg_id = connected ? ++last_msg_id : -1;
+    pthread_mutex_unlock(&lock);
+    return msg_id;
+}
+
+int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client, const char *topic)
+{
+    return esp_mqtt_client_subscribe(client, topic, 0);
+}
+
+esp_err_t esp_mqtt5_client_set_publish_property(esp_mqtt_client_handle_t client,
+                                                const esp_mqtt5_publish_property_config_t *property)
+{
+    pthread_mutex_lock(&lock);
+    // 与esp-mqtt一样，超过服务器Topic Alias Maximum的别名返回失败
+    esp_err_t ret = ESP_FAIL;
+    if (property->topic_alias <= alias_max) {
+        pending_property = *property;
+        property_pending = true;
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&lock);
+    return ret;
+}
+
+esp_err_t esp_mqtt5_client_set_connect_property(esp_mqtt_client_handle_t client,
+                                                const esp_mqtt5_connection_property_config_t *property)
+{
+    return ESP_OK;
+}
+
+uint8_t esp_mqtt5_client_get_user_property_count(mqtt5_user_property_handle_t user_property)
+{
+    return 0;
+}
+
+esp_err_t esp_mqtt5_client_get_user_property(mqtt5_user_property_handle_t user_property,
+                                             esp_mqtt5_user_property_item_t *item, uint8_t *count)
+{
+    *count = 0;
+    return ESP_OK;
+}
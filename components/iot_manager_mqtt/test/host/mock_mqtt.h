@@ -0,0 +1,81 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的模拟MQTT客户端
+ *
+ * 实现esp-mqtt接口但不连网络：发布的消息记录下来供测试检查，连接、断开由测试调用
+ * mock_mqtt_connect()/mock_mqtt_disconnect() 触发，事件在调用线程中同步交给组件的处理函数。
+ * 与 host_rtos.c 一起使用，组件源文件原样编译（iot_host_component）。
+ */
+
+#ifndef MOCK_MQTT_H
+#define MOCK_MQTT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MOCK_MQTT_MAX_MSGS      256
+#define MOCK_MQTT_TOPIC_MAX     128
+#define MOCK_MQTT_DATA_MAX      4096
+
+// 一条发布的消息
+typedef struct {
+    char topic[MOCK_MQTT_TOPIC_MAX];    // 实际发送的主题，只带别名时为空
+    char data[MOCK_MQTT_DATA_MAX + 1];  // 负载（截断到MOCK_MQTT_DATA_MAX，补'\0'）
+    int len;
+    int qos;
+    int msg_id;
+    uint16_t topic_alias;               // MQTT5主题别名，0表示没有
+    uint32_t conn_seq;                  // 发布时所在的连接（第几次连接，从1开始）
+    int64_t time_us;
+} mock_mqtt_msg_t;
+
+/**
+ * @brief 服务器在CONNACK中给出的Topic Alias Maximum（默认0：不接受别名）
+ */
+void mock_mqtt_set_alias_max(uint16_t max);
+
+/**
+ * @brief 模拟连接成功，投递CONNECTED
+ */
+void mock_mqtt_connect(void);
+
+/**
+ * @brief 模拟连接断开，投递DISCONNECTED
+ */
+void mock_mqtt_disconnect(void);
+
+/**
+ * @brief 等待组件在上次mock_mqtt_disconnect()之后重新启动客户端
+ *
+ * 组件处理断开时先停止客户端，退避后再启动，之后才能mock_mqtt_connect()。
+ *
+ * @return bool 超时返回false
+ */
+bool mock_mqtt_wait_restart(int timeout_ms);
+
+/**
+ * @brief 已记录的消息数
+ */
+int mock_mqtt_count(void);
+
+/**
+ * @brief 等待记录到至少count条消息
+ *
+ * @return int 返回时的消息数
+ */
+int mock_mqtt_wait(int count, int timeout_ms);
+
+/**
+ * @brief 取第i条消息（从0开始），不存在时返回NULL
+ */
+const mock_mqtt_msg_t *mock_mqtt_get(int i);
+
+/**
+ * @brief 从下标from开始查找主题以suffix结尾的消息
+ *
+ * @return int 下标，没有时返回-1
+ */
+int mock_mqtt_find(const char *topic_suffix, int from);
+
+#endif // MOCK_MQTT_H
@@ -0,0 +1,37 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的esp_err.h替身
+ */
+
+#ifndef HOST_STUB_ESP_ERR_H
+#define HOST_STUB_ESP_ERR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK                      0
+#define ESP_FAIL                    -1
+#define ESP_ERR_NO_MEM              0x101
+#define ESP_ERR_INVALID_ARG         0x102
+#define ESP_ERR_INVALID_STATE       0x103
+#define ESP_ERR_INVALID_SIZE        0x104
+#define ESP_ERR_NOT_FOUND           0x105
+#define ESP_ERR_WIFI_BASE           0x3000
+#define ESP_ERR_WIFI_CONN           (ESP_ERR_WIFI_BASE + 7)
+#define ESP_ERR_WIFI_STATE          (ESP_ERR_WIFI_BASE + 8)
+
+const char *esp_err_to_name(esp_err_t err);
+
+#define ESP_ERROR_CHECK(x) do { \
+        esp_err_t err_rc_ = (x); \
+        if (err_rc_ != ESP_OK) { \
+            fprintf(stderr, "%s:%d: ESP_ERROR_CHECK失败: %s\n", __FILE__, __LINE__, \
+                    esp_err_to_name(err_rc_)); \
+            abort(); \
+        } \
+    } while (0)
+
+#endif // HOST_STUB_ESP_ERR_H
@@ -0,0 +1,38 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的esp_event.h替身
+ *
+ * 事件由 host_rtos.c 的事件循环线程，或测试程序的虚拟时钟按时间顺序分发给注册的处理函数。
+ */
+
+#ifndef HOST_STUB_ESP_EVENT_H
+#define HOST_STUB_ESP_EVENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef const char *esp_event_base_t;
+typedef void *esp_event_handler_instance_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t base, int32_t id, void *data);
+
+#define ESP_EVENT_ANY_BASE  NULL
+#define ESP_EVENT_ANY_ID    -1
+
+#define ESP_EVENT_DECLARE_BASE(id)  extern esp_event_base_t const id
+#define ESP_EVENT_DEFINE_BASE(id)   esp_event_base_t const id = #id
+
+esp_err_t esp_event_loop_create_default(void);
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id,
+                                     esp_event_handler_t handler, void *arg);
+esp_err_t esp_event_handler_unregister(esp_event_base_t base, int32_t id,
+                                       esp_event_handler_t handler);
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id,
+                                              esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance);
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data, size_t size,
+                         TickType_t ticks);
+
+#endif // HOST_STUB_ESP_EVENT_H
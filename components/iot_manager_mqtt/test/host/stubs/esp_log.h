@@ -0,0 +1,21 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的esp_log.h替身
+ *
+ * 日志由测试程序的 host_log() 输出（设置 IOT_HOST_LOG 环境变量时写到标准错误）。
+ */
+
+#ifndef HOST_STUB_ESP_LOG_H
+#define HOST_STUB_ESP_LOG_H
+
+void host_log(char level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, format, ...)  host_log('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)  host_log('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)  host_log('I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)  host_log('D', tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)  host_log('V', tag, format, ##__VA_ARGS__)
+
+#endif // HOST_STUB_ESP_LOG_H
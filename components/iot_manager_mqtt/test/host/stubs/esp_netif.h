@@ -0,0 +1,45 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的esp_netif.h替身
+ */
+
+#ifndef HOST_STUB_ESP_NETIF_H
+#define HOST_STUB_ESP_NETIF_H
+
+#include <stdint.h>
+#include "esp_event.h"
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct {
+    uint32_t addr;
+} esp_ip4_addr_t;
+
+typedef struct {
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+typedef struct {
+    esp_netif_ip_info_t ip_info;
+} ip_event_got_ip_t;
+
+extern const esp_event_base_t IP_EVENT;
+
+typedef enum {
+    IP_EVENT_STA_GOT_IP = 0,
+    IP_EVENT_STA_LOST_IP,
+} ip_event_t;
+
+#define IPSTR           "%d.%d.%d.%d"
+#define IP2STR(ip)      (int)((ip)->addr & 0xff), (int)(((ip)->addr >> 8) & 0xff), \
+                        (int)(((ip)->addr >> 16) & 0xff), (int)(((ip)->addr >> 24) & 0xff)
+
+esp_netif_t *esp_netif_create_default_wifi_ap(void);
+esp_netif_t *esp_netif_create_default_wifi_sta(void);
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key);
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info);
+
+#endif // HOST_STUB_ESP_NETIF_H
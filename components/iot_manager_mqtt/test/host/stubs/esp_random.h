@@ -0,0 +1,14 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的esp_random.h替身（可重复的伪随机数）
+ */
+
+#ifndef HOST_STUB_ESP_RANDOM_H
+#define HOST_STUB_ESP_RANDOM_H
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif // HOST_STUB_ESP_RANDOM_H
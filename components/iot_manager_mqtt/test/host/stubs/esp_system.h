@@ -0,0 +1,16 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的esp_system.h替身
+ */
+
+#ifndef HOST_STUB_ESP_SYSTEM_H
+#define HOST_STUB_ESP_SYSTEM_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+
+#endif // HOST_STUB_ESP_SYSTEM_H
@@ -0,0 +1,171 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的esp_wifi.h替身
+ *
+ * 只有被测代码用到的类型和接口，字段名与ESP-IDF一致；接口由测试程序的模拟驱动实现。
+ */
+
+#ifndef HOST_STUB_ESP_WIFI_H
+#define HOST_STUB_ESP_WIFI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+typedef enum {
+    WIFI_IF_STA = 0,
+    WIFI_IF_AP,
+} wifi_interface_t;
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+} wifi_auth_mode_t;
+
+typedef enum {
+    WIFI_FAST_SCAN = 0,             // 按信道顺序扫描，找到匹配的AP即停止
+    WIFI_ALL_CHANNEL_SCAN,          // 扫描全部信道
+} wifi_scan_method_t;
+
+typedef enum {
+    WIFI_CONNECT_AP_BY_SIGNAL = 0,
+    WIFI_CONNECT_AP_BY_SECURITY,
+} wifi_sort_method_t;
+
+typedef enum {
+    WIFI_SCAN_TYPE_ACTIVE = 0,
+    WIFI_SCAN_TYPE_PASSIVE,
+} wifi_scan_type_t;
+
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+} wifi_active_scan_time_t;
+
+typedef struct {
+    wifi_active_scan_time_t active;
+    uint32_t passive;
+} wifi_scan_time_t;
+
+typedef struct {
+    uint8_t *ssid;
+    uint8_t *bssid;
+    uint8_t channel;
+    bool show_hidden;
+    wifi_scan_type_t scan_type;
+    wifi_scan_time_t scan_time;
+} wifi_scan_config_t;
+
+typedef struct {
+    char cc[3];
+    uint8_t schan;
+    uint8_t nchan;
+} wifi_country_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t ssid[33];
+    uint8_t primary;
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} wifi_ap_record_t;
+
+typedef struct {
+    bool capable;
+    bool required;
+} wifi_pmf_config_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    uint8_t ssid_len;
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    uint8_t max_connection;
+    wifi_pmf_config_t pmf_cfg;
+} wifi_ap_config_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    wifi_scan_method_t scan_method;
+    bool bssid_set;
+    uint8_t bssid[6];
+    uint8_t channel;
+    wifi_sort_method_t sort_method;
+} wifi_sta_config_t;
+
+typedef union {
+    wifi_ap_config_t ap;
+    wifi_sta_config_t sta;
+} wifi_config_t;
+
+typedef struct {
+    int reserved;
+} wifi_init_config_t;
+
+#define WIFI_INIT_CONFIG_DEFAULT()  { 0 }
+
+extern const esp_event_base_t WIFI_EVENT;
+
+typedef enum {
+    WIFI_EVENT_SCAN_DONE = 1,
+    WIFI_EVENT_STA_START,
+    WIFI_EVENT_STA_STOP,
+    WIFI_EVENT_STA_CONNECTED,
+    WIFI_EVENT_STA_DISCONNECTED,
+    WIFI_EVENT_AP_STACONNECTED = 14,
+    WIFI_EVENT_AP_STADISCONNECTED,
+} wifi_event_t;
+
+// 断开原因（与ESP-IDF的wifi_err_reason_t取值相同）
+typedef enum {
+    WIFI_REASON_ASSOC_LEAVE = 8,
+    WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15,
+    WIFI_REASON_BEACON_TIMEOUT = 200,
+    WIFI_REASON_NO_AP_FOUND = 201,
+} wifi_err_reason_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint8_t aid;
+} wifi_event_ap_staconnected_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint8_t aid;
+} wifi_event_ap_stadisconnected_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+    int8_t rssi;
+} wifi_event_sta_disconnected_t;
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config);
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_start(void);
+esp_err_t esp_wifi_connect(void);
+esp_err_t esp_wifi_disconnect(void);
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records);
+esp_err_t esp_wifi_get_country(wifi_country_t *country);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info);
+
+#endif // HOST_STUB_ESP_WIFI_H
@@ -0,0 +1,38 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的FreeRTOS替身
+ *
+ * 临界区用互斥锁实现；任务、通知、队列由 host_rtos.c（实时线程）或
+ * 测试程序的虚拟时钟实现。节拍为1ms。
+ */
+
+#ifndef HOST_STUB_FREERTOS_H
+#define HOST_STUB_FREERTOS_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE                          1
+#define pdFALSE                         0
+#define pdPASS                          pdTRUE
+#define pdFAIL                          pdFALSE
+#define portMAX_DELAY                   ((TickType_t)0xffffffffUL)
+
+#define configTICK_RATE_HZ              1000
+#define configMAX_TASK_NAME_LEN         16
+#define tskIDLE_PRIORITY                0
+#define portTICK_PERIOD_MS              (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)               ((TickType_t)((uint64_t)(ms) * configTICK_RATE_HZ / 1000))
+
+typedef pthread_mutex_t portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    PTHREAD_MUTEX_INITIALIZER
+#define portENTER_CRITICAL(mux)         pthread_mutex_lock(mux)
+#define portEXIT_CRITICAL(mux)          pthread_mutex_unlock(mux)
+
+#endif // HOST_STUB_FREERTOS_H
@@ -0,0 +1,114 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的FreeRTOS信号量替身
+ *
+ * 互斥量和二值信号量都用互斥锁加条件变量实现，等待时间按节拍（1ms）计算。
+ * 同一线程重复获取互斥量（实际设备上会死锁）时直接退出。
+ */
+
+#ifndef HOST_STUB_SEMPHR_H
+#define HOST_STUB_SEMPHR_H
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int count;                  ///< 可获取的次数（0或1）
+    int is_mutex;
+    int is_static;
+    pthread_t owner;            ///< 互斥量的持有线程
+} StaticSemaphore_t;
+
+typedef struct host_sem *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t host_sem_init(struct host_sem *s, int is_mutex, int count)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    s->count = count;
+    s->is_mutex = is_mutex;
+    s->is_static = 0;
+    return s;
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    struct host_sem *s = malloc(sizeof(*s));
+    return s ? host_sem_init(s, 1, 1) : NULL;
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buf)
+{
+    host_sem_init(buf, 1, 1);
+    buf->is_static = 1;
+    return buf;
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    struct host_sem *s = malloc(sizeof(*s));
+    return s ? host_sem_init(s, 0, 0) : NULL;
+}
+
+static inline void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    if (!s->is_static) {
+        free(s);
+    }
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t timeout)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if (timeout != portMAX_DELAY) {
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (long)(timeout % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&s->lock);
+    if (s->is_mutex && s->count == 0 && pthread_equal(s->owner, pthread_self())) {
+        fprintf(stderr, "互斥量重复获取（设备上会死锁）\n");
+        abort();
+    }
+    int err = 0;
+    while (s->count == 0 && err != ETIMEDOUT) {
+        err = timeout == portMAX_DELAY ? pthread_cond_wait(&s->cond, &s->lock) :
+              pthread_cond_timedwait(&s->cond, &s->lock, &deadline);
+    }
+    BaseType_t ok = s->count > 0;
+    if (ok) {
+        s->count = 0;
+        s->owner = pthread_self();
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    pthread_mutex_lock(&s->lock);
+    BaseType_t ok = s->count == 0;
+    s->count = 1;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+#endif // HOST_STUB_SEMPHR_H
@@ -0,0 +1,47 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的FreeRTOS任务替身
+ *
+ * 每个线程对应一个任务，任务句柄取线程ID。任务接口由 host_rtos.c（实时线程）
+ * 或测试程序的虚拟时钟实现，只用到当前任务句柄的模块不需要链接它们。
+ */
+
+#ifndef HOST_STUB_TASK_H
+#define HOST_STUB_TASK_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+static inline TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return (TaskHandle_t)(uintptr_t)pthread_self();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out_handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t *value, TickType_t ticks);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#define xTaskNotify(task, value, action)    xTaskGenericNotify((task), (value), (action))
+#define xTaskNotifyGive(task)               xTaskGenericNotify((task), 0, eIncrement)
+
+#endif // HOST_STUB_TASK_H
@@ -0,0 +1,16 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试的C库补充
+ *
+ * ESP-IDF的newlib提供strlcpy，glibc 2.38之前没有。CMake检测到缺少时强制包含本文件。
+ */
+
+#ifndef HOST_COMPAT_H
+#define HOST_COMPAT_H
+
+#include <stddef.h>
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+
+#endif // HOST_COMPAT_H
@@ -0,0 +1 @@
+/* 主机测试：lwip/err.h 替身（被测代码不使用其中的定义） */
@@ -0,0 +1 @@
+/* 主机测试：lwip/sys.h 替身（被测代码不使用其中的定义） */
@@ -0,0 +1,181 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的mqtt_client.h替身
+ *
+ * 只有被测代码用到的类型和接口，字段名与esp-mqtt一致。接口由 host_mqtt.c
+ * （TCP上的MQTT 3.1.1客户端）或测试程序的模拟客户端实现。
+ */
+
+#ifndef HOST_STUB_MQTT_CLIENT_H
+#define HOST_STUB_MQTT_CLIENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+
+typedef struct esp_mqtt_client *esp_mqtt_client_handle_t;
+
+typedef enum {
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+    MQTT_EVENT_BEFORE_CONNECT,
+    MQTT_EVENT_DELETED,
+} esp_mqtt_event_id_t;
+
+typedef enum {
+    MQTT_PROTOCOL_UNDEFINED = 0,
+    MQTT_PROTOCOL_V_3_1,
+    MQTT_PROTOCOL_V_3_1_1,
+    MQTT_PROTOCOL_V_5,
+} esp_mqtt_protocol_ver_t;
+
+typedef enum {
+    MQTT_ERROR_TYPE_NONE = 0,
+    MQTT_ERROR_TYPE_TCP_TRANSPORT,
+    MQTT_ERROR_TYPE_CONNECTION_REFUSED,
+} esp_mqtt_error_type_t;
+
+typedef struct {
+    esp_err_t esp_tls_last_esp_err;
+    int esp_tls_stack_err;
+    int esp_tls_cert_verify_flags;
+    esp_mqtt_error_type_t error_type;
+    int connect_return_code;
+    int esp_transport_sock_errno;
+} esp_mqtt_error_codes_t;
+
+typedef struct mqtt5_user_property_list_t *mqtt5_user_property_handle_t;
+
+typedef struct {
+    const char *key;
+    const char *value;
+} esp_mqtt5_user_property_item_t;
+
+typedef struct {
+    bool payload_format_indicator;
+    char *response_topic;
+    int response_topic_len;
+    char *correlation_data;
+    uint16_t correlation_data_len;
+    char *content_type;
+    int content_type_len;
+    uint16_t subscribe_id;
+    mqtt5_user_property_handle_t user_property;
+} esp_mqtt5_event_property_t;
+
+typedef struct esp_mqtt_event_t {
+    esp_mqtt_event_id_t event_id;
+    esp_mqtt_client_handle_t client;
+    char *data;
+    int data_len;
+    int total_data_len;
+    int current_data_offset;
+    char *topic;
+    int topic_len;
+    int msg_id;
+    int session_present;
+    esp_mqtt_error_codes_t *error_handle;
+    bool retain;
+    int qos;
+    bool dup;
+    esp_mqtt_protocol_ver_t protocol_ver;
+    esp_mqtt5_event_property_t *property;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
+
+typedef struct {
+    struct {
+        struct {
+            const char *uri;
+        } address;
+    } broker;
+    struct {
+        const char *username;
+        const char *client_id;
+        struct {
+            const char *password;
+        } authentication;
+    } credentials;
+    struct {
+        struct {
+            const char *topic;
+            const char *msg;
+            int msg_len;
+            int qos;
+            int retain;
+        } last_will;
+        bool disable_clean_session;
+        int keepalive;
+        esp_mqtt_protocol_ver_t protocol_ver;
+    } session;
+    struct {
+        int reconnect_timeout_ms;
+        int timeout_ms;
+        bool disable_auto_reconnect;
+    } network;
+    struct {
+        int size;
+        int out_size;
+    } buffer;
+} esp_mqtt_client_config_t;
+
+typedef struct {
+    bool payload_format_indicator;
+    uint32_t message_expiry_interval;
+    uint16_t topic_alias;
+    const char *response_topic;
+    const char *correlation_data;
+    uint16_t correlation_data_len;
+    const char *content_type;
+    mqtt5_user_property_handle_t user_property;
+} esp_mqtt5_publish_property_config_t;
+
+typedef struct {
+    uint32_t session_expiry_interval;
+    uint32_t maximum_packet_size;
+    uint16_t receive_maximum;
+    uint16_t topic_alias_maximum;
+    bool request_resp_info;
+    bool request_problem_info;
+    mqtt5_user_property_handle_t user_property;
+    uint32_t will_delay_interval;
+    uint32_t message_expiry_interval;
+    bool payload_format_indicator;
+    const char *content_type;
+    const char *response_topic;
+    const char *correlation_data;
+    uint16_t correlation_data_len;
+    mqtt5_user_property_handle_t will_user_property;
+} esp_mqtt5_connection_property_config_t;
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t event_handler,
+                                         void *event_handler_arg);
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain);
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos);
+int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client, const char *topic);
+
+esp_err_t esp_mqtt5_client_set_publish_property(esp_mqtt_client_handle_t client,
+                                                const esp_mqtt5_publish_property_config_t *property);
+esp_err_t esp_mqtt5_client_set_connect_property(esp_mqtt_client_handle_t client,
+                                                const esp_mqtt5_connection_property_config_t *property);
+uint8_t esp_mqtt5_client_get_user_property_count(mqtt5_user_property_handle_t user_property);
+esp_err_t esp_mqtt5_client_get_user_property(mqtt5_user_property_handle_t user_property,
+                                             esp_mqtt5_user_property_item_t *item, uint8_t *count);
+
+#endif // HOST_STUB_MQTT_CLIENT_H
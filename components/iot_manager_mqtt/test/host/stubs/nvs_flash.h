@@ -0,0 +1,34 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的nvs_flash.h替身（只有blob读写）
+ */
+
+#ifndef HOST_STUB_NVS_FLASH_H
+#define HOST_STUB_NVS_FLASH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+
+#define NVS_KEY_NAME_MAX_SIZE   16      // 含结尾'\0'
+#define NVS_NS_NAME_MAX_SIZE    NVS_KEY_NAME_MAX_SIZE
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+#define ESP_ERR_NVS_NOT_FOUND   0x1102
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out_handle);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length);
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key);
+esp_err_t nvs_commit(nvs_handle_t handle);
+void nvs_close(nvs_handle_t handle);
+
+#endif // HOST_STUB_NVS_FLASH_H
@@ -0,0 +1,12 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 主机测试用的sdkconfig.h替身
+ *
+ * 主机构建中Kconfig选项由CMakeLists.txt作为编译定义传入（iot_host_component）。
+ */
+
+#ifndef HOST_STUB_SDKCONFIG_H
+#define HOST_STUB_SDKCONFIG_H
+
+#endif // HOST_STUB_SDKCONFIG_H
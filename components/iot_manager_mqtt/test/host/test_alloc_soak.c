@@ -0,0 +1,264 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 内存块池和arena的长时间运行测试
+ *
+ * 内存块池：4个线程随机分配/释放共数百万次，每块写满本线程的标记，释放前检查
+ * 没有被别的线程改写（同一块不会同时分给两个线程）；结束后计数、峰值与实际一致，
+ * 所有块都能重新分配且互不相同，整个过程不经过堆。
+ * arena：模拟cJSON的处理过程（多次小块分配、部分提前释放、放不下的回退到堆），
+ * 每次处理后堆占用回到初始值，堆分配次数等于回退次数，不会随运行时间增长。
+ * 没进入arena的线程不受影响。
+ * 每部分输出一行JSON。IOT_BENCH_SCALE 环境变量按比例调整次数。
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include "host_alloc.h"
+#include "host_test.h"
+#include "iot_arena.h"
+#include "iot_slab.h"
+
+#define SLAB_THREADS        4
+#define SLAB_HELD           4           // 每个线程同时持有的块数
+#define SLAB_BLOCK_SIZE     101         // 向上取整为104
+#define SLAB_BLOCKS         8
+
+#define ARENA_SIZE          1024
+#define ARENA_MAX_ALLOCS    24
+
+static iot_slab_t slab;
+static long slab_ops;
+
+typedef struct {
+    uint32_t seed;
+    uint8_t tag;
+    long allocs;
+    long fails;
+    long corrupt;
+} slab_worker_t;
+
+static void *slab_worker(void *arg)
+{
+    slab_worker_t *wk = arg;
+    uint32_t rng = wk->seed;
+    uint8_t *held[SLAB_HELD] = { 0 };
+    uint32_t size = iot_slab_block_size(&slab);
+
+    for (long i = 0; i < slab_ops; i++) {
+        int k = host_rand(&rng) % SLAB_HELD;
+        uint8_t tag = (uint8_t)(wk->tag | k);
+        if (held[k]) {
+            for (uint32_t j = 0; j < size; j++) {
+                if (held[k][j] != tag) {
+                    wk->corrupt++;
+                    break;
+                }
+            }
+            iot_slab_free(&slab, held[k]);
+            held[k] = NULL;
+        } else {
+            held[k] = iot_slab_alloc(&slab);
+            if (held[k]) {
+                memset(held[k], tag, size);
+                wk->allocs++;
+            } else {
+                wk->fails++;
+            }
+        }
+    }
+    for (int k = 0; k < SLAB_HELD; k++) {
+        if (held[k]) {
+            iot_slab_free(&slab, held[k]);
+        }
+    }
+    return NULL;
+}
+
+static void test_slab(void)
+{
+    size_t mem_size = iot_slab_mem_size(SLAB_BLOCK_SIZE, SLAB_BLOCKS);
+    void *mem = malloc(mem_size);
+    CHECK(mem != NULL);
+    CHECK(iot_slab_init(&slab, mem, SLAB_BLOCK_SIZE, SLAB_BLOCKS));
+    CHECK(iot_slab_block_size(&slab) == 104);
+    CHECK(!iot_slab_init(&slab, mem, SLAB_BLOCK_SIZE, 0) &&
+          iot_slab_init(&slab, mem, SLAB_BLOCK_SIZE, SLAB_BLOCKS));
+
+    host_alloc_stats_t before, after;
+    host_alloc_get(&before);
+
+    slab_ops = bench_iterations(1000000);
+    pthread_t threads[SLAB_THREADS];
+    slab_worker_t workers[SLAB_THREADS] = { 0 };
+    double start = host_now_sec();
+    for (int i = 0; i < SLAB_THREADS; i++) {
+        workers[i].seed = 0x51ab0000u + i;
+        workers[i].tag = (uint8_t)((i + 1) << 4);
+        CHECK(pthread_create(&threads[i], NULL, slab_worker, &workers[i]) == 0);
+    }
+    long allocs = 0;
+    long fails = 0;
+    long corrupt = 0;
+    for (int i = 0; i < SLAB_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        allocs += workers[i].allocs;
+        fails += workers[i].fails;
+        corrupt += workers[i].corrupt;
+    }
+    double elapsed = host_now_sec() - start;
+    host_alloc_get(&after);
+
+    iot_slab_stats_t st;
+    iot_slab_get_stats(&slab, &st);
+    CHECK(corrupt == 0);
+    CHECK(st.used == 0);
+    CHECK(st.peak >= 1 && st.peak <= SLAB_BLOCKS);
+    CHECK(st.allocs == (uint32_t)allocs);
+    CHECK(st.fails == (uint32_t)fails);
+    // 分配释放不经过堆（不支持堆计数的平台上两者都是-1）
+    CHECK(after.allocs == before.allocs);
+
+    // 所有块都还在空闲链表上，能全部分配出来且互不相同
+    uint8_t *blocks[SLAB_BLOCKS];
+    for (int i = 0; i < SLAB_BLOCKS; i++) {
+        blocks[i] = iot_slab_alloc(&slab);
+        CHECK(blocks[i] != NULL && iot_slab_owns(&slab, blocks[i]));
+        CHECK(((uintptr_t)blocks[i] & 3) == 0);
+        for (int j = 0; j < i; j++) {
+            CHECK(blocks[i] != blocks[j]);
+        }
+    }
+    CHECK(iot_slab_alloc(&slab) == NULL);
+    int dummy;
+    CHECK(!iot_slab_owns(&slab, &dummy));
+    for (int i = 0; i < SLAB_BLOCKS; i++) {
+        iot_slab_free(&slab, blocks[i]);
+    }
+    iot_slab_get_stats(&slab, &st);
+    CHECK(st.used == 0);
+
+    printf("{\"test\":\"slab_soak\",\"threads\":%d,\"ops\":%ld,\"allocs\":%ld,\"fails\":%ld,"
+           "\"peak\":%u,\"blocks\":%d,\"heap_allocs\":%ld,\"ns_per_op\":%.1f}\n",
+           SLAB_THREADS, slab_ops * SLAB_THREADS, allocs, fails, st.peak, SLAB_BLOCKS,
+           after.allocs - before.allocs, elapsed * 1e9 / (slab_ops * SLAB_THREADS));
+    free(mem);
+}
+
+static iot_arena_t arena;
+static uint8_t arena_buf[ARENA_SIZE];
+
+static bool in_arena(const void *p)
+{
+    return (const uint8_t *)p >= arena_buf && (const uint8_t *)p < arena_buf + ARENA_SIZE;
+}
+
+// 没有进入arena的线程：分配来自堆
+static void *outside_worker(void *arg)
+{
+    void *p = iot_arena_hook_malloc(16);
+    *(bool *)arg = p != NULL && !in_arena(p);
+    iot_arena_hook_free(p);
+    return NULL;
+}
+
+static void test_arena(void)
+{
+    CHECK(iot_arena_init(&arena, arena_buf, sizeof(arena_buf)));
+
+    host_alloc_stats_t base, now;
+    host_alloc_reset_peak();
+    host_alloc_get(&base);
+
+    long requests = bench_iterations(200000);
+    long heap_fallbacks = 0;
+    long bad = 0;
+    uint32_t rng = 0xa7e4a;
+    double start = host_now_sec();
+    for (long r = 0; r < requests; r++) {
+        uint8_t *p[ARENA_MAX_ALLOCS];
+        size_t sizes[ARENA_MAX_ALLOCS];
+        int n = 1 + host_rand(&rng) % ARENA_MAX_ALLOCS;
+
+        iot_arena_enter(&arena);
+        for (int i = 0; i < n; i++) {
+            // 大多是小块，偶尔有放不下的大块（如打印结果）
+            sizes[i] = host_rand(&rng) % 16 == 0 ? 300 + host_rand(&rng) % 700 : 1 + host_rand(&rng) % 64;
+            p[i] = iot_arena_hook_malloc(sizes[i]);
+            if (!p[i]) {
+                bad++;
+                continue;
+            }
+            if (in_arena(p[i])) {
+                bad += ((uintptr_t)p[i] & 7) != 0;
+            } else {
+                heap_fallbacks++;
+            }
+            memset(p[i], (uint8_t)i, sizes[i]);
+            // 中途释放一些，arena中的释放被忽略
+            if (i > 0 && host_rand(&rng) % 4 == 0) {
+                iot_arena_hook_free(p[i - 1]);
+                p[i - 1] = NULL;
+            }
+        }
+        // 还持有的块互不重叠
+        for (int i = 0; i < n; i++) {
+            if (p[i]) {
+                for (size_t j = 0; j < sizes[i]; j++) {
+                    if (p[i][j] != (uint8_t)i) {
+                        bad++;
+                        break;
+                    }
+                }
+                iot_arena_hook_free(p[i]);
+            }
+        }
+        iot_arena_leave(&arena);
+
+        // 每次处理后堆占用回到初始值
+        host_alloc_get(&now);
+        if (now.bytes_in_use != base.bytes_in_use) {
+            bad++;
+        }
+    }
+    double elapsed = host_now_sec() - start;
+    host_alloc_get(&now);
+
+    iot_arena_stats_t st;
+    iot_arena_get_stats(&arena, &st);
+    CHECK(bad == 0);
+    CHECK(st.cap == ARENA_SIZE && st.peak <= ARENA_SIZE && st.peak > 0);
+    CHECK((long)st.overflows == heap_fallbacks);
+    CHECK(!host_alloc_supported() || now.allocs - base.allocs == heap_fallbacks);
+
+    // 不在arena中时回退到堆
+    void *h = iot_arena_hook_malloc(8);
+    CHECK(h != NULL && !in_arena(h));
+    iot_arena_hook_free(h);
+
+    // 进入arena只影响当前线程
+    iot_arena_enter(&arena);
+    bool outside_ok = false;
+    pthread_t t;
+    CHECK(pthread_create(&t, NULL, outside_worker, &outside_ok) == 0);
+    pthread_join(t, NULL);
+    CHECK(outside_ok);
+    void *a = iot_arena_hook_malloc(8);
+    CHECK(in_arena(a));
+    iot_arena_leave(&arena);
+
+    host_alloc_get(&now);
+    CHECK(now.bytes_in_use == base.bytes_in_use);
+
+    printf("{\"test\":\"arena_soak\",\"requests\":%ld,\"arena_bytes\":%d,\"arena_peak\":%zu,"
+           "\"heap_fallbacks\":%ld,\"heap_peak_bytes\":%ld,\"ns_per_request\":%.1f}\n",
+           requests, ARENA_SIZE, st.peak, heap_fallbacks,
+           now.peak_bytes - base.bytes_in_use, elapsed * 1e9 / requests);
+}
+
+int main(void)
+{
+    test_slab();
+    test_arena();
+    return TEST_RESULT();
+}
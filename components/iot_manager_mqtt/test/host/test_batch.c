@@ -0,0 +1,186 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 属性批量上报测试
+ *
+ * 整个组件在模拟MQTT客户端（mock_mqtt.c）上运行，批量选项在CMakeLists.txt中调小：
+ * 256字节、4个样本、300ms。检查按样本数、按字节数、按截止时间和显式刷新四种发送
+ * 条件，以及超过缓冲大小的样本单独上报。
+ */
+
+#include <stdbool.h>
+#include "host_test.h"
+#include "mock_mqtt.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "iot_manager.h"
+#include "iot_reconnect.h"
+
+#define DATA_TOPIC      "/data"
+
+// 组件处理完发送队列所需的时间上限（远小于批量截止时间）
+#define SETTLE_MS       100
+
+/**
+ * @brief 生成一个恰好len字节的JSON样本 {"n":N,"p":"xx…"}
+ */
+static void make_sample(char *buf, int len, int n)
+{
+    int head = snprintf(buf, len + 1, "{\"n\":%d,\"p\":\"", n);
+    memset(buf + head, 'x', len - head - 2);
+    strcpy(buf + len - 2, "\"}");
+}
+
+/**
+ * @brief 等待下一条属性消息
+ *
+ * @return const mock_mqtt_msg_t* 超时返回NULL
+ */
+static const mock_mqtt_msg_t *next_data(int *from, int timeout_ms)
+{
+    int64_t deadline_us = esp_timer_get_time() + timeout_ms * 1000LL;
+    for (;;) {
+        int i = mock_mqtt_find(DATA_TOPIC, *from);
+        if (i >= 0) {
+            *from = i + 1;
+            return mock_mqtt_get(i);
+        }
+        if (esp_timer_get_time() >= deadline_us) {
+            return NULL;
+        }
+        mock_mqtt_wait(mock_mqtt_count() + 1, 20);
+    }
+}
+
+/**
+ * @brief 等待SETTLE_MS，确认期间没有新的属性消息
+ */
+static bool no_data(int from)
+{
+    vTaskDelay(pdMS_TO_TICKS(SETTLE_MS));
+    return mock_mqtt_find(DATA_TOPIC, from) < 0;
+}
+
+// 达到样本数上限立即发送
+static void test_flush_on_samples(int *from)
+{
+    for (int i = 0; i < 4; i++) {
+        char msg[32];
+        snprintf(msg, sizeof(msg), "{\"n\":%d}", i);
+        CHECK(iot_manager_batch_properties(msg) == 0);
+    }
+    const mock_mqtt_msg_t *m = next_data(from, SETTLE_MS);
+    CHECK(m != NULL);
+    if (m) {
+        CHECK(strcmp(m->data, "[{\"n\":0},{\"n\":1},{\"n\":2},{\"n\":3}]") == 0);
+        CHECK(m->qos == CONFIG_IOT_PROPERTY_QOS);
+    }
+    CHECK(no_data(*from));
+}
+
+// 加入后超过字节上限时先发出已有样本，新样本留在缓冲中
+static void test_flush_on_size(int *from)
+{
+    char s[3][101];
+    for (int i = 0; i < 3; i++) {
+        make_sample(s[i], 100, i);
+        CHECK(iot_manager_batch_properties(s[i]) == 0);
+    }
+    const mock_mqtt_msg_t *m = next_data(from, SETTLE_MS);
+    CHECK(m != NULL);
+    if (m) {
+        char expect[256];
+        snprintf(expect, sizeof(expect), "[%s,%s]", s[0], s[1]);
+        CHECK(strcmp(m->data, expect) == 0);
+        CHECK(m->len <= CONFIG_IOT_BATCH_MAX_BYTES);
+    }
+    CHECK(no_data(*from));
+
+    // 第三个样本由显式刷新发出
+    CHECK(iot_manager_flush_properties() == 0);
+    m = next_data(from, SETTLE_MS);
+    CHECK(m != NULL);
+    if (m) {
+        char expect[128];
+        snprintf(expect, sizeof(expect), "[%s]", s[2]);
+        CHECK(strcmp(m->data, expect) == 0);
+    }
+}
+
+// 缓冲为空时刷新不发送
+static void test_flush_empty(int *from)
+{
+    CHECK(iot_manager_flush_properties() == 0);
+    CHECK(no_data(*from));
+}
+
+// 不满足其它条件时，第一个样本入缓冲后CONFIG_IOT_BATCH_MAX_LATENCY_MS发出
+static void test_flush_on_deadline(int *from)
+{
+    int64_t start_us = esp_timer_get_time();
+    CHECK(iot_manager_batch_properties("{\"n\":10}") == 0);
+    vTaskDelay(pdMS_TO_TICKS(50));
+    CHECK(iot_manager_batch_properties("{\"n\":11}") == 0);
+
+    const mock_mqtt_msg_t *m = next_data(from, CONFIG_IOT_BATCH_MAX_LATENCY_MS * 3);
+    CHECK(m != NULL);
+    if (m) {
+        int64_t waited_ms = (m->time_us - start_us) / 1000;
+        CHECK(strcmp(m->data, "[{\"n\":10},{\"n\":11}]") == 0);
+        // 截止时间从第一个样本算起，第二个样本不推迟
+        CHECK(waited_ms >= CONFIG_IOT_BATCH_MAX_LATENCY_MS);
+        CHECK(waited_ms < CONFIG_IOT_BATCH_MAX_LATENCY_MS + SETTLE_MS);
+        fprintf(stderr, "截止时间发送: %lldms\n", (long long)waited_ms);
+    }
+}
+
+// 单个样本放不进缓冲时直接上报，不带数组括号，也不影响缓冲中已有的样本
+static void test_oversize(int *from)
+{
+    char big[301];
+    make_sample(big, 300, 20);
+    CHECK(iot_manager_batch_properties("{\"n\":21}") == 0);
+    CHECK(iot_manager_batch_properties(big) == 0);
+
+    const mock_mqtt_msg_t *m = next_data(from, SETTLE_MS);
+    CHECK(m != NULL);
+    if (m) {
+        CHECK(strcmp(m->data, big) == 0);
+    }
+    CHECK(iot_manager_flush_properties() == 0);
+    m = next_data(from, SETTLE_MS);
+    CHECK(m != NULL);
+    if (m) {
+        CHECK(strcmp(m->data, "[{\"n\":21}]") == 0);
+    }
+}
+
+int main(void)
+{
+    esp_event_loop_create_default();
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+
+    iot_manager_config_t config = {
+        .device_id = "batch-test",
+        .device_name = "batch-test",
+        .device_type = "host",
+    };
+    if (iot_manager_init(&config) != ESP_OK || iot_manager_start() != ESP_OK) {
+        fprintf(stderr, "iot_manager启动失败\n");
+        return 1;
+    }
+    mock_mqtt_connect();
+    CHECK(iot_manager_is_connected());
+
+    int from = 0;
+    test_flush_on_samples(&from);
+    test_flush_on_size(&from);
+    test_flush_empty(&from);
+    test_flush_on_deadline(&from);
+    test_oversize(&from);
+
+    iot_manager_stop();
+    return TEST_RESULT();
+}
@@ -0,0 +1,174 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 启动阶段计时测试
+ *
+ * iot_boot.c 单独编译，esp_timer_get_time() 由本文件的虚拟时钟提供，每次读取前进1ms并休眠一会，
+ * 放大并发记录时读时钟和加入列表之间的间隔。检查：
+ * - 多个任务同时记录时，列表顺序和时间顺序一致（时间不递减）
+ * - 阶段按记录顺序保存，时间为启动后的毫秒数（不足1ms的部分舍去）
+ * - 重复的阶段（同一指针或相同内容）、NULL和超过上限的阶段被忽略（上限在子进程中检查）
+ * - iot_boot_get() 按容量截断
+ * - 启动完成后不再记录，完成时只打印一次
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "host_test.h"
+#include "esp_timer.h"
+#include "iot_boot.h"
+
+#define THREADS             4
+#define STAGES_PER_THREAD   3
+
+static atomic_llong now_us = 1000000;
+static int log_lines;
+static char thread_names[THREADS][STAGES_PER_THREAD][16];
+
+int64_t esp_timer_get_time(void)
+{
+    int64_t t = atomic_fetch_add(&now_us, 1000);
+    usleep(200);
+    return t;
+}
+
+void host_log(char level, const char *tag, const char *format, ...)
+{
+    if (strcmp(tag, "IOT_BOOT") == 0) {
+        log_lines++;
+    }
+}
+
+static size_t get_all(iot_boot_stage_t *list)
+{
+    return iot_boot_get(list, IOT_BOOT_MAX_STAGES);
+}
+
+static void *mark_thread(void *arg)
+{
+    char (*names)[16] = arg;
+    for (int i = 0; i < STAGES_PER_THREAD; i++) {
+        iot_boot_mark(names[i]);
+    }
+    return NULL;
+}
+
+// 各阶段由不同任务同时完成（init_sched.c 中每个阶段一个任务），列表的时间不递减
+static void test_concurrent(void)
+{
+    pthread_t threads[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        for (int i = 0; i < STAGES_PER_THREAD; i++) {
+            snprintf(thread_names[t][i], sizeof(thread_names[t][i]), "task%d_%d", t, i);
+        }
+        pthread_create(&threads[t], NULL, mark_thread, thread_names[t]);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    iot_boot_stage_t list[IOT_BOOT_MAX_STAGES];
+    size_t n = get_all(list);
+    CHECK(n == THREADS * STAGES_PER_THREAD);
+    for (size_t i = 1; i < n; i++) {
+        CHECK(list[i].ms >= list[i - 1].ms);
+        if (list[i].ms < list[i - 1].ms) {
+            fprintf(stderr, "%s %lums 排在 %s %lums 之后\n", list[i].name,
+                    (unsigned long)list[i].ms, list[i - 1].name, (unsigned long)list[i - 1].ms);
+        }
+    }
+    // 同一任务的阶段保持先后顺序
+    for (int t = 0; t < THREADS; t++) {
+        int next = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (next < STAGES_PER_THREAD && list[i].name == thread_names[t][next]) {
+                next++;
+            }
+        }
+        CHECK(next == STAGES_PER_THREAD);
+    }
+}
+
+// 按记录顺序保存，重复和NULL被忽略
+static void test_sequential(void)
+{
+    static const char nvs[] = "nvs";
+    static const char netif[] = "netif";
+    char copy[] = "nvs";
+    const size_t before = THREADS * STAGES_PER_THREAD;
+
+    atomic_store(&now_us, 5000999);
+    iot_boot_mark(nvs);
+    iot_boot_mark(nvs);
+    iot_boot_mark(copy);
+    iot_boot_mark(NULL);
+    atomic_store(&now_us, 7250000);
+    iot_boot_mark(netif);
+
+    iot_boot_stage_t list[IOT_BOOT_MAX_STAGES];
+    CHECK(get_all(list) == before + 2);
+    CHECK(list[before].name == nvs && list[before].ms == 5000);
+    CHECK(list[before + 1].name == netif && list[before + 1].ms == 7250);
+
+    // 按容量截断，只取前面的阶段
+    iot_boot_stage_t head[2];
+    CHECK(iot_boot_get(head, 2) == 2);
+    CHECK(head[0].name == list[0].name && head[1].name == list[1].name);
+    CHECK(iot_boot_get(NULL, 2) == 0);
+    CHECK(iot_boot_get(head, 0) == 0);
+}
+
+// 超过上限的阶段被忽略（在子进程中填满，不影响之后的检查）
+static void test_limit(void)
+{
+    static const char *const names[] = { "a", "b", "c", "d", "e", "f" };
+    pid_t pid = fork();
+    if (pid == 0) {
+        host_test_failures = 0;
+        iot_boot_stage_t list[IOT_BOOT_MAX_STAGES];
+        size_t n = get_all(list);
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            iot_boot_mark(names[i]);
+        }
+        CHECK(get_all(list) == IOT_BOOT_MAX_STAGES);
+        CHECK(list[n].name == names[0]);
+        CHECK(list[IOT_BOOT_MAX_STAGES - 1].name == names[IOT_BOOT_MAX_STAGES - 1 - n]);
+        _exit(host_test_failures);
+    }
+    int status = -1;
+    CHECK(pid > 0 && waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+// 完成时只打印一次，之后的标记被忽略
+static void test_complete(void)
+{
+    iot_boot_stage_t list[IOT_BOOT_MAX_STAGES];
+    size_t n = get_all(list);
+    CHECK(n < IOT_BOOT_MAX_STAGES);
+
+    CHECK(!iot_boot_is_complete());
+    CHECK(log_lines == 0);
+    iot_boot_complete();
+    CHECK(iot_boot_is_complete());
+    CHECK(log_lines == 1 + (int)n);
+    iot_boot_complete();
+    CHECK(log_lines == 1 + (int)n);
+    CHECK(strcmp(iot_boot_firmware_version(), "linux") == 0);
+
+    iot_boot_mark("reconnect");
+    CHECK(get_all(list) == n);
+}
+
+int main(void)
+{
+    test_concurrent();
+    test_sequential();
+    test_limit();
+    test_complete();
+
+    return TEST_RESULT();
+}
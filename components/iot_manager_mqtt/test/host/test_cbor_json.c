@@ -0,0 +1,249 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - CBOR转JSON测试
+ *
+ * 同一组调用分别写入JSON和CBOR编码器，CBOR转换后的JSON必须与直接编码的JSON逐字节相同，
+ * 覆盖各种长度的整数、半/单/双精度浮点数、NaN和无穷大、转义、空容器和最大嵌套深度。
+ * 另外检查定长容器以及各种无效数据（截断、字节串、标签、多余数据、缺少结束符、
+ * 非文本的键、嵌套过深、缓冲区不足）返回-1。
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include "host_test.h"
+#include "iot_cbor_json.h"
+#include "iot_cbor_writer.h"
+#include "iot_json_writer.h"
+
+typedef struct {
+    iot_json_writer_t json;
+    iot_cbor_writer_t cbor;
+    char json_buf[1024];
+    uint8_t cbor_buf[1024];
+} pair_t;
+
+// 同一个调用写入两个编码器
+#define BOTH(p, fn, ...) do { \
+        iot_json_##fn(&(p)->json, ##__VA_ARGS__); \
+        iot_cbor_##fn(&(p)->cbor, ##__VA_ARGS__); \
+    } while (0)
+
+static void pair_init(pair_t *p)
+{
+    iot_json_init(&p->json, p->json_buf, sizeof(p->json_buf));
+    iot_cbor_init(&p->cbor, p->cbor_buf, sizeof(p->cbor_buf));
+}
+
+// 转换CBOR并与直接编码的JSON比较
+static void pair_check(pair_t *p, const char *what)
+{
+    int json_len = iot_json_finish(&p->json);
+    int cbor_len = iot_cbor_finish(&p->cbor);
+    CHECK(json_len > 0 && cbor_len > 0);
+    if (json_len <= 0 || cbor_len <= 0) {
+        fprintf(stderr, "%s: 编码失败\n", what);
+        return;
+    }
+
+    char out[1024];
+    int len = iot_cbor_to_json(p->cbor_buf, cbor_len, out, sizeof(out));
+    CHECK(len == json_len && strcmp(out, p->json_buf) == 0);
+    if (len != json_len || strcmp(out, p->json_buf) != 0) {
+        fprintf(stderr, "%s:\n  JSON: %s\n  转换: %s\n", what, p->json_buf, len >= 0 ? out : "(失败)");
+    }
+
+    // 缓冲区恰好容纳时成功，少一个字节时失败
+    CHECK(iot_cbor_to_json(p->cbor_buf, cbor_len, out, json_len + 1) == json_len);
+    CHECK(iot_cbor_to_json(p->cbor_buf, cbor_len, out, json_len) == -1);
+}
+
+// 健康数据、上线消息这类结构
+static void test_report(void)
+{
+    pair_t p;
+    pair_init(&p);
+    BOTH(&p, object_begin);
+    BOTH(&p, kv_str, "event", "health");
+    BOTH(&p, kv_int, "timestamp", 300012);
+    BOTH(&p, kv_uint, "uptime", 300);
+    BOTH(&p, key, "heap");
+    BOTH(&p, object_begin);
+    BOTH(&p, key, "internal");
+    BOTH(&p, array_begin);
+    BOTH(&p, uint, 98304);
+    BOTH(&p, uint, 61440);
+    BOTH(&p, uint, 45056);
+    BOTH(&p, array_end);
+    BOTH(&p, object_end);
+    BOTH(&p, key, "stack");
+    BOTH(&p, object_begin);
+    BOTH(&p, kv_uint, "iot_pub", 1220);
+    BOTH(&p, kv_uint, "main", 2100);
+    BOTH(&p, object_end);
+    BOTH(&p, object_end);
+    pair_check(&p, "健康数据");
+}
+
+// 各种长度的整数（CBOR首部参数0/1/2/4/8字节的边界）
+static void test_integers(void)
+{
+    static const int64_t ints[] = {
+        0, 1, 23, 24, 255, 256, 65535, 65536, 4294967295LL, 4294967296LL, INT64_MAX,
+        -1, -24, -25, -256, -257, -65537, -4294967297LL, INT64_MIN,
+    };
+    pair_t p;
+    pair_init(&p);
+    BOTH(&p, array_begin);
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        BOTH(&p, int, ints[i]);
+    }
+    BOTH(&p, uint, UINT64_MAX);
+    BOTH(&p, array_end);
+    pair_check(&p, "整数");
+}
+
+// 浮点数：整数值、半/单/双精度、非规格化、NaN和无穷大
+static void test_floats(void)
+{
+    static const double doubles[] = {
+        0.5, -2.25, 65504.0, 5.960464477539063e-08, 6.103515625e-05, 100000.5, 3.4028234663852886e+38,
+        23.4, 61.7, -0.1, 1e300, 4.9e-324, 1e15 + 0.5, 20.0, -0.0, NAN, INFINITY, -INFINITY,
+    };
+    static const float floats[] = { 23.4f, 61.7f, 0.5f, 1e-40f, NAN };
+    pair_t p;
+    pair_init(&p);
+    BOTH(&p, array_begin);
+    for (size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); i++) {
+        BOTH(&p, double, doubles[i]);
+    }
+    // JSON没有单精度接口，iot_payload_float 映射到 iot_json_double
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+        iot_json_double(&p.json, floats[i]);
+        iot_cbor_float(&p.cbor, floats[i]);
+    }
+    BOTH(&p, array_end);
+    pair_check(&p, "浮点数");
+}
+
+// 字符串转义、空字符串、空容器、true/false/null
+static void test_strings(void)
+{
+    static const char with_nul[] = "a\0b";
+    pair_t p;
+    pair_init(&p);
+    BOTH(&p, object_begin);
+    BOTH(&p, kv_str, "q\"uote", "a\"b\\c\n\x01\xe4\xb8\xad");
+    BOTH(&p, kv_str, "", "");
+    BOTH(&p, key, "nul");
+    BOTH(&p, str_n, with_nul, sizeof(with_nul) - 1);
+    BOTH(&p, key, "null_str");
+    BOTH(&p, str, NULL);
+    BOTH(&p, kv_bool, "t", true);
+    BOTH(&p, kv_bool, "f", false);
+    BOTH(&p, key, "empty_obj");
+    BOTH(&p, object_begin);
+    BOTH(&p, object_end);
+    BOTH(&p, key, "empty_arr");
+    BOTH(&p, array_begin);
+    BOTH(&p, array_end);
+    BOTH(&p, key, "n");
+    BOTH(&p, null);
+    BOTH(&p, object_end);
+    pair_check(&p, "字符串");
+
+    // 顶层不是容器
+    pair_init(&p);
+    BOTH(&p, str, "top");
+    pair_check(&p, "顶层字符串");
+}
+
+// 最大嵌套深度可以转换，再深一层无效
+static void test_depth(void)
+{
+    pair_t p;
+    pair_init(&p);
+    for (int i = 0; i < IOT_CBOR_MAX_DEPTH - 1; i++) {
+        BOTH(&p, array_begin);
+    }
+    BOTH(&p, int, 1);
+    for (int i = 0; i < IOT_CBOR_MAX_DEPTH - 1; i++) {
+        BOTH(&p, array_end);
+    }
+    pair_check(&p, "最大深度");
+
+    uint8_t deep[2 * IOT_CBOR_MAX_DEPTH];
+    memset(deep, 0x9F, IOT_CBOR_MAX_DEPTH);
+    memset(deep + IOT_CBOR_MAX_DEPTH, 0xFF, IOT_CBOR_MAX_DEPTH);
+    char out[128];
+    CHECK(iot_cbor_to_json(deep, sizeof(deep), out, sizeof(out)) == -1);
+}
+
+static int convert(const uint8_t *cbor, size_t len, char *out, size_t size)
+{
+    return iot_cbor_to_json(cbor, len, out, size);
+}
+
+// 其他编码器生成的定长容器
+static void test_definite(void)
+{
+    static const uint8_t map[] = { 0xA2, 0x61, 'a', 0x01, 0x61, 'b', 0x82, 0xF5, 0xF6 };
+    static const uint8_t long_text[] = { 0x78, 0x03, 'x', 'y', 'z' };
+    static const uint8_t empty[] = { 0xA0 };
+    char out[64];
+    CHECK(convert(map, sizeof(map), out, sizeof(out)) == 23 && strcmp(out, "{\"a\":1,\"b\":[true,null]}") == 0);
+    CHECK(convert(long_text, sizeof(long_text), out, sizeof(out)) == 5 && strcmp(out, "\"xyz\"") == 0);
+    CHECK(convert(empty, sizeof(empty), out, sizeof(out)) == 2 && strcmp(out, "{}") == 0);
+}
+
+// 无效数据
+static void test_invalid(void)
+{
+    static const struct {
+        const char *what;
+        uint8_t data[20];
+        size_t len;
+    } cases[] = {
+        { "空数据",         { 0 }, 0 },
+        { "截断的整数",     { 0x19, 0x01 }, 2 },
+        { "截断的文本",     { 0x63, 'a', 'b' }, 3 },
+        { "截断的容器",     { 0xBF, 0x61, 'a', 0x01 }, 4 },
+        { "缺少值",         { 0xBF, 0x61, 'a', 0xFF }, 4 },
+        { "字节串",         { 0x41, 0x00 }, 2 },
+        { "标签",           { 0xC1, 0x00 }, 2 },
+        { "多余数据",       { 0x01, 0x02 }, 2 },
+        { "非文本的键",     { 0xBF, 0x01, 0x01, 0x02, 0xFF }, 5 },
+        { "顶层结束符",     { 0xFF }, 1 },
+        { "定长数组中的结束符", { 0x82, 0x01, 0xFF }, 3 },
+        { "undefined",      { 0xF7 }, 1 },
+        { "保留的附加信息", { 0x1C, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 }, 17 },
+        { "不定长文本",     { 0x7F, 0x61, 'a', 0xFF }, 4 },
+        { "不定长整数",     { 0x1F }, 1 },
+        { "超长文本",       { 0x7B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 'a' }, 10 },
+        { "超出int64的负数", { 0x3B, 0x80, 0, 0, 0, 0, 0, 0, 0 }, 9 },
+    };
+    char out[64];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        int len = convert(cases[i].data, cases[i].len, out, sizeof(out));
+        CHECK(len == -1);
+        if (len != -1) {
+            fprintf(stderr, "%s: 返回%d %s\n", cases[i].what, len, out);
+        }
+    }
+    static const uint8_t one[] = { 0x01 };
+    CHECK(iot_cbor_to_json(NULL, 1, out, sizeof(out)) == -1);
+    CHECK(iot_cbor_to_json(one, sizeof(one), NULL, sizeof(out)) == -1);
+}
+
+int main(void)
+{
+    test_report();
+    test_integers();
+    test_floats();
+    test_strings();
+    test_depth();
+    test_definite();
+    test_invalid();
+
+    return TEST_RESULT();
+}
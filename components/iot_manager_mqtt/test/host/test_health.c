@@ -0,0 +1,70 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 健康数据编码测试
+ *
+ * iot_health.c 单独编译两次（JSON和CBOR负载格式），esp_timer_get_time() 由本文件提供固定时间。
+ * 主机构建没有堆和任务信息，只有时间和空的栈列表。检查：
+ * - iot_health_encode() 按负载格式编码（CBOR格式时转换后与JSON相同）
+ * - 两种格式下 iot_health_to_json() 都输出同样的JSON
+ * - 缓冲区不足和NULL返回-1
+ */
+
+#include "host_test.h"
+#include "esp_timer.h"
+#include "iot_cbor_json.h"
+#include "iot_health.h"
+
+static const char expected[] = "{\"event\":\"health\",\"timestamp\":300012,\"uptime\":300,\"stack\":{}}";
+
+int64_t esp_timer_get_time(void)
+{
+    return 300012345;
+}
+
+void host_log(char level, const char *tag, const char *format, ...)
+{
+}
+
+static void test_encode(void)
+{
+    uint8_t buf[IOT_HEALTH_MSG_SIZE];
+    int len = iot_health_encode(buf, sizeof(buf));
+    CHECK(len > 0);
+
+    char json[IOT_HEALTH_MSG_SIZE];
+#if CONFIG_IOT_PAYLOAD_FORMAT_CBOR
+    CHECK(buf[0] == 0xBF);
+    CHECK(iot_cbor_to_json(buf, len, json, sizeof(json)) == (int)strlen(expected));
+#else
+    CHECK(len == (int)strlen(expected));
+    memcpy(json, buf, len + 1);
+#endif
+    CHECK(strcmp(json, expected) == 0);
+
+    CHECK(iot_health_encode(buf, 8) == -1);
+    CHECK(iot_health_encode(NULL, sizeof(buf)) == -1);
+}
+
+static void test_to_json(void)
+{
+    char json[IOT_HEALTH_MSG_SIZE];
+    CHECK(iot_health_to_json(json, sizeof(json)) == (int)strlen(expected));
+    CHECK(strcmp(json, expected) == 0);
+    if (strcmp(json, expected) != 0) {
+        fprintf(stderr, "输出: %s\n", json);
+    }
+
+    // 恰好容纳时成功，少一个字节时失败
+    CHECK(iot_health_to_json(json, sizeof(expected)) == (int)strlen(expected));
+    CHECK(iot_health_to_json(json, sizeof(expected) - 1) == -1);
+    CHECK(iot_health_to_json(NULL, sizeof(json)) == -1);
+}
+
+int main(void)
+{
+    test_encode();
+    test_to_json();
+
+    return TEST_RESULT();
+}
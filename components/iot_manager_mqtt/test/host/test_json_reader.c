@@ -0,0 +1,297 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 增量式JSON解析器测试
+ *
+ * 每个文档先整体送入，记录事件流（事件、深度、文本、截断标记）和结果；再在每个字节位置
+ * 切成两段、在每对位置切成三段、逐字节送入，事件流和结果必须与整体送入完全相同。
+ * 文档包括：正常的命令消息、各种转义（含代理对和切在转义序列中间）、顶层数字、
+ * 超过记号缓冲区的键名/字符串/数字、原始文本捕获及其溢出、回调停止，
+ * 以及截断和各类语法错误。整体送入的事件流另与期望值逐字比对。
+ */
+
+#include <stdbool.h>
+#include "host_test.h"
+#include "iot_json_reader.h"
+
+#define TOK_CAP     16
+#define CAP_SMALL   8
+#define LOG_MAX     4096
+
+/**
+ * @brief 解析结果：事件流文本和成功标志
+ */
+typedef struct {
+    char log[LOG_MAX];
+    size_t len;
+    char tok[TOK_CAP];
+    char cap[64];
+    size_t cap_size;        // 捕获缓冲区大小，0表示不捕获
+    bool ok;
+} run_t;
+
+static void log_put(run_t *run, const char *s, size_t n)
+{
+    if (run->len + n >= LOG_MAX) {
+        n = LOG_MAX - 1 - run->len;
+    }
+    memcpy(run->log + run->len, s, n);
+    run->len += n;
+    run->log[run->len] = '\0';
+}
+
+/**
+ * @brief 事件回调：每个事件记一行 "<深度><事件>[文本][~]"，~表示文本被截断
+ *
+ * 键名 "params" 的值被捕获（run->cap_size不为0时），键名 "stop" 使解析停止。
+ */
+static bool on_event(iot_json_reader_t *r, iot_json_event_t ev,
+                     const char *text, size_t len, void *ctx)
+{
+    static const char *const names[] = {
+        "{", "}", "[", "]", "K:", "S:", "N:", "true", "false", "null", "R:",
+    };
+    run_t *run = ctx;
+    char depth = (char)('0' + iot_json_reader_depth(r));
+    log_put(run, &depth, 1);
+    log_put(run, names[ev], strlen(names[ev]));
+    if (ev == IOT_JSON_EV_RAW && !text) {
+        log_put(run, "!", 1);
+    } else if (text) {
+        CHECK(strlen(text) == len);
+        log_put(run, text, len);
+    }
+    if (ev >= IOT_JSON_EV_KEY && ev <= IOT_JSON_EV_NUMBER && iot_json_reader_truncated(r)) {
+        log_put(run, "~", 1);
+    }
+    log_put(run, "\n", 1);
+
+    if (ev == IOT_JSON_EV_KEY && strcmp(text, "params") == 0 && run->cap_size) {
+        iot_json_reader_capture(r, run->cap, run->cap_size);
+    }
+    return !(ev == IOT_JSON_EV_KEY && strcmp(text, "stop") == 0);
+}
+
+/**
+ * @brief 按给定切分位置送入文档
+ *
+ * @param cuts 切分位置（递增），共ncuts个
+ */
+static void parse(run_t *run, size_t cap_size, const char *doc, size_t len,
+                  const size_t *cuts, int ncuts)
+{
+    iot_json_reader_t r;
+    run->len = 0;
+    run->log[0] = '\0';
+    run->cap_size = cap_size;
+    iot_json_reader_init(&r, run->tok, sizeof(run->tok), on_event, run);
+
+    bool fed = true;
+    size_t start = 0;
+    for (int i = 0; i <= ncuts; i++) {
+        size_t end = i < ncuts ? cuts[i] : len;
+        // 出错后继续送入也不应产生事件
+        fed = iot_json_reader_feed(&r, doc + start, end - start) && fed;
+        start = end;
+    }
+    run->ok = iot_json_reader_finish(&r);
+    CHECK(fed || !run->ok);
+}
+
+typedef struct {
+    const char *doc;
+    bool ok;
+    size_t cap_size;
+    const char *events;     // 整体送入的期望事件流，NULL表示不比对
+} doc_t;
+
+static const doc_t docs[] = {
+    // 命令消息，参数整体捕获（去掉值外的空白，字符串内保留）
+    { "{\"cmd\":\"reboot\", \"id\":\"abc-1\",\n \"params\" : {\"delay\": 5, \"l\":[1, \"a b\"]},\"t\":1}",
+      true, 64,
+      "1{\n1K:cmd\n1S:reboot\n1K:id\n1S:abc-1\n1K:params\n1R:{\"delay\":5,\"l\":[1,\"a b\"]}\n"
+      "1K:t\n1N:1\n0}\n" },
+    // 捕获缓冲区溢出：RAW文本为NULL，之后的事件不受影响
+    { "{\"params\":{\"delay\":5},\"t\":true}", true, CAP_SMALL,
+      "1{\n1K:params\n1R:!\n1K:t\n1true\n0}\n" },
+    // 捕获标量和空容器
+    { "{\"params\":-1.5e3,\"x\":[],\"params\":[]}", true, 64,
+      "1{\n1K:params\n1R:-1.5e3\n1K:x\n2[\n1]\n1K:params\n1R:[]\n0}\n" },
+    // 各种转义
+    { "[\"q\\\"b\\\\s\\/\",\"\\b\\f\\n\\r\\t\",\"\\u0041\\u00e9\\u4e2d\"]", true, 0,
+      "1[\n1S:q\"b\\s/\n1S:\b\f\n\r\t\n1S:A\xc3\xa9\xe4\xb8\xad\n0]\n" },
+    // 代理对合成U+1F600；孤立的高、低代理项替换为U+FFFD
+    { "[\"\\ud83d\\ude00\",\"\\uD800x\",\"\\udc00\",\"\\ud800\\ud800\\udc00\"]", true, 0,
+      "1[\n1S:\xf0\x9f\x98\x80\n1S:\xef\xbf\xbdx\n1S:\xef\xbf\xbd\n"
+      "1S:\xef\xbf\xbd\xf0\x90\x80\x80\n0]\n" },
+    // 字面量、嵌套、空白
+    { " \t\r\n[true,false,null,[[]],{},{\"a\":[{}]}] \n", true, 0,
+      "1[\n1true\n1false\n1null\n2[\n3[\n2]\n1]\n2{\n1}\n2{\n2K:a\n3[\n4{\n3}\n2]\n1}\n0]\n" },
+    // 数字语法
+    { "[0,-0,12,-3.25,1e5,1E+5,2.5e-3,0.0]", true, 0,
+      "1[\n1N:0\n1N:-0\n1N:12\n1N:-3.25\n1N:1e5\n1N:1E+5\n1N:2.5e-3\n1N:0.0\n0]\n" },
+    // 顶层数字没有结束符，finish时发出
+    { "-12.5e+10", true, 0, "0N:-12.5e+10\n" },
+    { "\"top\"", true, 0, "0S:top\n" },
+    // 超过记号缓冲区（15字节+'\0'）的键名、字符串、数字被截断并标记，转义在截断处也不出错
+    { "{\"0123456789abcdefXYZ\":\"\\u4e2d\\u4e2d\\u4e2d\\u4e2d\\u4e2d\\u4e2d\",\"n\":1234567890123456789}",
+      true, 0,
+      "1{\n1K:0123456789abcde~\n1S:\xe4\xb8\xad\xe4\xb8\xad\xe4\xb8\xad\xe4\xb8\xad\xe4\xb8\xad~\n"
+      "1K:n\n1N:123456789012345~\n0}\n" },
+    // 恰好15字节不算截断
+    { "[\"0123456789abcde\"]", true, 0, "1[\n1S:0123456789abcde\n0]\n" },
+    // 回调返回false：停止，之后没有事件，finish返回false
+    { "{\"a\":1,\"stop\":2,\"b\":3}", false, 0, "1{\n1K:a\n1N:1\n1K:stop\n" },
+
+    // 截断
+    { "", false, 0, "" },
+    { "   ", false, 0, "" },
+    { "{\"a\":1", false, 0, "1{\n1K:a\n1N:1\n" },
+    { "{\"a\":\"abc", false, 0, "1{\n1K:a\n" },
+    { "{\"a\":tru", false, 0, "1{\n1K:a\n" },
+    { "[1,", false, 0, "1[\n1N:1\n" },
+    { "[\"\\u12", false, 0, "1[\n" },
+    { "[\"\\", false, 0, "1[\n" },
+    { "{\"a\"", false, 0, "1{\n1K:a\n" },
+    { "-", false, 0, "" },
+    { "1.", false, 0, "" },
+    { "1e+", false, 0, "" },
+
+    // 语法错误
+    { "{\"a\" 1}", false, 0, "1{\n1K:a\n" },
+    { "{\"a\":1,}", false, 0, "1{\n1K:a\n1N:1\n" },
+    { "[1 2]", false, 0, "1[\n1N:1\n" },
+    { "[1,]", false, 0, "1[\n1N:1\n" },
+    { "[01]", false, 0, "1[\n" },
+    { "[1.e5]", false, 0, "1[\n" },
+    { "[-]", false, 0, "1[\n" },
+    { "[+1]", false, 0, "1[\n" },
+    { "[tRue]", false, 0, "1[\n" },
+    { "[nul]", false, 0, "1[\n" },
+    { "[\"\\x\"]", false, 0, "1[\n" },
+    { "[\"\\u12g4\"]", false, 0, "1[\n" },
+    { "[\"a\x01\"]", false, 0, "1[\n" },
+    { "{1:2}", false, 0, "1{\n" },
+    { "[1}", false, 0, "1[\n1N:1\n" },
+    { "{\"a\":1]", false, 0, "1{\n1K:a\n1N:1\n" },
+    { "]", false, 0, "" },
+    { "{\"a\":1}}", false, 0, "1{\n1K:a\n1N:1\n0}\n" },
+    { "{\"a\":1} x", false, 0, "1{\n1K:a\n1N:1\n0}\n" },
+    { "1 2", false, 0, "0N:1\n" },
+    { "[1]\"", false, 0, "1[\n1N:1\n0]\n" },
+};
+
+/**
+ * @brief 生成depth层嵌套数组 [[...]]
+ */
+static size_t nested(char *buf, int depth)
+{
+    memset(buf, '[', depth);
+    memset(buf + depth, ']', depth);
+    buf[2 * depth] = '\0';
+    return 2 * (size_t)depth;
+}
+
+static run_t whole;
+static run_t part;
+
+/**
+ * @brief 整体送入与各种切分方式比较
+ *
+ * @return long 比较的切分方式数
+ */
+static long check_splits(const char *doc, size_t len, size_t cap_size)
+{
+    long runs = 0;
+    parse(&whole, cap_size, doc, len, NULL, 0);
+
+    // 两段
+    for (size_t i = 0; i <= len; i++) {
+        parse(&part, cap_size, doc, len, &i, 1);
+        if (part.ok != whole.ok || strcmp(part.log, whole.log) != 0) {
+            fprintf(stderr, "切分位置%zu不一致: %s\n", i, doc);
+            CHECK(false);
+        }
+        runs++;
+    }
+    // 三段（文档不长时遍历所有位置对）
+    if (len <= 96) {
+        for (size_t i = 0; i <= len; i++) {
+            for (size_t j = i; j <= len; j++) {
+                size_t cuts[2] = { i, j };
+                parse(&part, cap_size, doc, len, cuts, 2);
+                if (part.ok != whole.ok || strcmp(part.log, whole.log) != 0) {
+                    fprintf(stderr, "切分位置%zu,%zu不一致: %s\n", i, j, doc);
+                    CHECK(false);
+                }
+                runs++;
+            }
+        }
+    }
+    // 逐字节
+    size_t cuts[256];
+    size_t n = len < 256 ? len : 256;
+    for (size_t i = 0; i < n; i++) {
+        cuts[i] = i;
+    }
+    parse(&part, cap_size, doc, len, cuts, (int)n);
+    CHECK(part.ok == whole.ok && strcmp(part.log, whole.log) == 0);
+    return runs + 1;
+}
+
+static void test_docs(void)
+{
+    long runs = 0;
+    for (size_t d = 0; d < sizeof(docs) / sizeof(docs[0]); d++) {
+        const doc_t *t = &docs[d];
+        size_t len = strlen(t->doc);
+        runs += check_splits(t->doc, len, t->cap_size);
+        if (whole.ok != t->ok || (t->events && strcmp(whole.log, t->events) != 0)) {
+            fprintf(stderr, "文档%zu: %s\n结果%d，事件:\n%s", d, t->doc, whole.ok, whole.log);
+            CHECK(false);
+        }
+    }
+    printf("{\"test\":\"json_reader_splits\",\"docs\":%zu,\"runs\":%ld}\n",
+           sizeof(docs) / sizeof(docs[0]), runs);
+}
+
+// 嵌套深度上限：IOT_JSON_READER_MAX_DEPTH层可以解析，再多一层报错
+static void test_depth(void)
+{
+    char buf[2 * IOT_JSON_READER_MAX_DEPTH + 3];
+    size_t len = nested(buf, IOT_JSON_READER_MAX_DEPTH);
+    check_splits(buf, len, 0);
+    CHECK(whole.ok);
+
+    len = nested(buf, IOT_JSON_READER_MAX_DEPTH + 1);
+    check_splits(buf, len, 0);
+    CHECK(!whole.ok);
+}
+
+// 出错或停止后再送入的数据被忽略
+static void test_after_error(void)
+{
+    iot_json_reader_t r;
+    run_t *run = &whole;
+    run->len = 0;
+    run->cap_size = 0;
+    iot_json_reader_init(&r, run->tok, sizeof(run->tok), on_event, run);
+    CHECK(!iot_json_reader_feed(&r, "[1,,", 4));
+    size_t events = run->len;
+    CHECK(!iot_json_reader_feed(&r, "2]", 2));
+    CHECK(run->len == events);
+    CHECK(!iot_json_reader_finish(&r));
+
+    // 没有记号缓冲区时初始化即为错误状态
+    iot_json_reader_init(&r, NULL, 0, on_event, run);
+    CHECK(!iot_json_reader_feed(&r, "1", 1));
+    CHECK(!iot_json_reader_finish(&r));
+}
+
+int main(void)
+{
+    test_docs();
+    test_depth();
+    test_after_error();
+    return TEST_RESULT();
+}
@@ -0,0 +1,216 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - JSON编码器测试
+ *
+ * 结构和转义按固定输出比对；浮点数检查语法合法、strtod() 解析回来的相对误差
+ * 不超过10位有效数字的舍入误差（5e-10），并覆盖舍入进位、DBL_MAX和非规格化数。
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include "host_test.h"
+#include "iot_json_writer.h"
+
+static void test_structure(void)
+{
+    char buf[256];
+    iot_json_writer_t w;
+    iot_json_init(&w, buf, sizeof(buf));
+    iot_json_object_begin(&w);
+    iot_json_kv_str(&w, "msg", "a\"b\\c\n\x01");
+    iot_json_kv_int(&w, "i", INT64_MIN);
+    iot_json_kv_uint(&w, "u", UINT64_MAX);
+    iot_json_key(&w, "arr");
+    iot_json_array_begin(&w);
+    iot_json_bool(&w, true);
+    iot_json_null(&w);
+    iot_json_double(&w, NAN);
+    iot_json_array_end(&w);
+    iot_json_object_end(&w);
+    int len = iot_json_finish(&w);
+
+    const char *expect = "{\"msg\":\"a\\\"b\\\\c\\n\\u0001\",\"i\":-9223372036854775808,"
+                         "\"u\":18446744073709551615,\"arr\":[true,null,null]}";
+    CHECK(len == (int)strlen(expect));
+    CHECK(strcmp(buf, expect) == 0);
+
+    // 缓冲区不足时整体失败，不输出截断的JSON
+    char small[8];
+    iot_json_init(&w, small, sizeof(small));
+    iot_json_object_begin(&w);
+    iot_json_kv_str(&w, "key", "value");
+    iot_json_object_end(&w);
+    CHECK(iot_json_finish(&w) < 0);
+    CHECK(small[0] == '\0');
+}
+
+/**
+ * @brief 检查JSON数字语法: -?(0|[1-9]d*)(.d+)?(e-?d+)?
+ */
+static bool valid_number(const char *s)
+{
+    if (*s == '-') {
+        s++;
+    }
+    if (*s == '0') {
+        s++;
+    } else if (*s >= '1' && *s <= '9') {
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+    } else {
+        return false;
+    }
+    if (*s == '.') {
+        s++;
+        if (!(*s >= '0' && *s <= '9')) {
+            return false;
+        }
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+    }
+    if (*s == 'e') {
+        s++;
+        if (*s == '-') {
+            s++;
+        }
+        if (!(*s >= '0' && *s <= '9')) {
+            return false;
+        }
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+    }
+    return *s == '\0';
+}
+
+static const char *format_double(double v, char *buf, size_t size)
+{
+    iot_json_writer_t w;
+    iot_json_init(&w, buf, size);
+    iot_json_double(&w, v);
+    iot_json_finish(&w);
+    return buf;
+}
+
+/**
+ * @brief 编码后解析回来，检查语法和误差
+ *
+ * @return double 相对误差
+ */
+static double check_round_trip(double v)
+{
+    char buf[64];
+    format_double(v, buf, sizeof(buf));
+    if (!valid_number(buf)) {
+        fprintf(stderr, "%.17g -> \"%s\" 不是合法的JSON数字\n", v, buf);
+        host_test_failures++;
+        return INFINITY;
+    }
+    double back = strtod(buf, NULL);
+    if (isinf(back)) {
+        fprintf(stderr, "%.17g -> \"%s\" 解析为无穷大\n", v, buf);
+        host_test_failures++;
+        return INFINITY;
+    }
+    double err = v == 0 ? fabs(back) : fabs(back - v) / fabs(v);
+    // 非规格化数本身的精度低于10位，允许差一个最小间隔
+    if (err > 5e-10 && fabs(back - v) > DBL_TRUE_MIN) {
+        fprintf(stderr, "%.17g -> \"%s\" 误差%.3g\n", v, buf, err);
+        host_test_failures++;
+    }
+    return err;
+}
+
+static void test_double_exact(void)
+{
+    static const struct {
+        double v;
+        const char *s;
+    } cases[] = {
+        { 0, "0" },
+        { -0.0, "0" },
+        { 1, "1" },
+        { -2.5, "-2.5" },
+        { 23.45, "23.45" },
+        { 0.1, "0.1" },
+        { 100, "100" },
+        { 1e9, "1000000000" },
+        { 1234567890123.0, "1234567890123" },       // 整数部分超过10位时保留全部整数位
+        { 1e-4, "0.0001" },
+        { -0.00047113056782297917, "-0.0004711305678" },
+        { 0.012345678912345, "0.01234567891" },
+        { 9.99999999995e-5, "0.0001" },             // 舍入进位后重新归一化
+        { 9.99999999995e-8, "1e-7" },
+        { 9.99999999995e14, "1e15" },
+        { 1e15, "1e15" },
+        { 1.5e-7, "1.5e-7" },
+        { DBL_MAX, "1.797693134e308" },             // 向零舍入，不超过DBL_MAX
+        { -DBL_MAX, "-1.797693134e308" },
+        { DBL_MIN, "2.225073859e-308" },
+        { INFINITY, "null" },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        char buf[64];
+        format_double(cases[i].v, buf, sizeof(buf));
+        if (strcmp(buf, cases[i].s) != 0) {
+            fprintf(stderr, "%.17g -> \"%s\"，应为\"%s\"\n", cases[i].v, buf, cases[i].s);
+            host_test_failures++;
+        }
+    }
+    check_round_trip(DBL_TRUE_MIN);
+    check_round_trip(DBL_MAX);
+}
+
+static void test_double_random(void)
+{
+    uint32_t rng = 2025;
+    double worst = 0;
+    long count = 0;
+
+    // 各个数量级上的随机尾数
+    for (int e = -320; e <= 308; e++) {
+        for (int i = 0; i < 200; i++) {
+            double mant = 1 + (host_rand(&rng) / 4294967296.0) * 9;
+            double v = mant * pow(10, e);
+            if (isinf(v) || v == 0) {
+                continue;
+            }
+            if (host_rand(&rng) & 1) {
+                v = -v;
+            }
+            double err = check_round_trip(v);
+            if (fpclassify(v) == FP_NORMAL && err > worst) {
+                worst = err;
+            }
+            count++;
+        }
+    }
+
+    // 随机位模式
+    for (int i = 0; i < 200000; i++) {
+        uint64_t bits = ((uint64_t)host_rand(&rng) << 32) | host_rand(&rng);
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        if (isnan(v) || isinf(v)) {
+            continue;
+        }
+        double err = check_round_trip(v);
+        if (fpclassify(v) == FP_NORMAL && err > worst) {
+            worst = err;
+        }
+        count++;
+    }
+    printf("%ld个浮点数，最大相对误差%.3g\n", count, worst);
+}
+
+int main(void)
+{
+    test_structure();
+    test_double_exact();
+    test_double_random();
+    return TEST_RESULT();
+}
@@ -0,0 +1,296 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 无锁多生产者单消费者队列测试
+ *
+ * 单线程部分：队列满时预留返回NULL；提交顺序与预留顺序不同时消费者在未提交的槽位处等待；
+ * 写入位置绕环很多圈、以及32位位置计数器溢出时数据不错位。
+ * 并发部分：多个生产者线程各自按序号写入消息（槽位数据写满与序号相关的内容），
+ * 一个消费者线程读出，检查没有丢失、没有重复、每个生产者的消息按顺序到达、数据没有被改写。
+ * test_mpsc_queue_tsan 是同一程序的ThreadSanitizer构建（次数较少）。
+ * 第一个命令行参数为每个生产者的消息数，IOT_BENCH_SCALE 环境变量按比例调整。
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "host_test.h"
+#include "iot_mpsc_queue.h"
+
+#define SLOT_SIZE       24
+#define PRODUCERS       4
+#define STRESS_CAPACITY 16
+
+/**
+ * @brief 消息内容：tag为生产者编号，数据区前4字节为序号，其余字节由序号决定
+ */
+static void fill_slot(iot_mpsc_slot_t *slot, uint32_t seq, uint32_t len)
+{
+    memcpy(slot->data, &seq, sizeof(seq));
+    for (uint32_t i = sizeof(seq); i < len; i++) {
+        slot->data[i] = (uint8_t)(seq * 31 + i);
+    }
+}
+
+static bool slot_intact(const iot_mpsc_slot_t *slot, uint32_t *seq)
+{
+    memcpy(seq, slot->data, sizeof(*seq));
+    for (uint32_t i = sizeof(*seq); i < slot->len; i++) {
+        if (slot->data[i] != (uint8_t)(*seq * 31 + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t msg_len(uint32_t seq)
+{
+    return sizeof(uint32_t) + seq % (SLOT_SIZE - sizeof(uint32_t) + 1);
+}
+
+static void produce(iot_mpsc_queue_t *q, uint32_t seq, uint32_t tag)
+{
+    iot_mpsc_slot_t *slot = iot_mpsc_reserve(q);
+    CHECK(slot != NULL);
+    if (slot) {
+        fill_slot(slot, seq, msg_len(seq));
+        iot_mpsc_commit(q, slot, msg_len(seq), tag);
+    }
+}
+
+/**
+ * @brief 取出一条消息并检查序号
+ */
+static void consume(iot_mpsc_queue_t *q, uint32_t expect_seq, uint32_t expect_tag)
+{
+    iot_mpsc_slot_t *slot = iot_mpsc_peek(q);
+    CHECK(slot != NULL);
+    if (slot) {
+        uint32_t seq;
+        CHECK(slot_intact(slot, &seq));
+        CHECK(seq == expect_seq);
+        CHECK(slot->tag == expect_tag);
+        CHECK(slot->len == msg_len(expect_seq));
+        iot_mpsc_release(q, slot);
+    }
+}
+
+static void test_init_args(void)
+{
+    iot_mpsc_queue_t q;
+    uint8_t mem[256];
+    CHECK(!iot_mpsc_init(&q, mem, 0, 8));
+    CHECK(!iot_mpsc_init(&q, mem, 1, 8));
+    CHECK(!iot_mpsc_init(&q, mem, 6, 8));
+    CHECK(!iot_mpsc_init(&q, NULL, 4, 8));
+    CHECK(iot_mpsc_init(&q, mem, 4, 8));
+    CHECK(iot_mpsc_slot_size(&q) == 8);
+    CHECK(iot_mpsc_mem_size(4, 8) <= sizeof(mem));
+    // 槽位间隔按4字节对齐
+    CHECK(iot_mpsc_mem_size(4, 9) == 4 * ((sizeof(iot_mpsc_slot_t) + 9 + 3) & ~(size_t)3));
+}
+
+// 队列满时返回NULL，释放一个后又能预留一个
+static void test_full(void)
+{
+    enum { CAP = 8 };
+    iot_mpsc_queue_t q;
+    void *mem = malloc(iot_mpsc_mem_size(CAP, SLOT_SIZE));
+    CHECK(iot_mpsc_init(&q, mem, CAP, SLOT_SIZE));
+
+    CHECK(iot_mpsc_peek(&q) == NULL);
+    for (uint32_t i = 0; i < CAP; i++) {
+        produce(&q, i, 0);
+    }
+    CHECK(iot_mpsc_reserve(&q) == NULL);
+    CHECK(iot_mpsc_reserve(&q) == NULL);
+
+    consume(&q, 0, 0);
+    produce(&q, CAP, 0);
+    CHECK(iot_mpsc_reserve(&q) == NULL);
+    for (uint32_t i = 1; i <= CAP; i++) {
+        consume(&q, i, 0);
+    }
+    CHECK(iot_mpsc_peek(&q) == NULL);
+    free(mem);
+}
+
+// 先预留的槽位后提交：消费者在该槽位处等待，提交后按预留顺序读出
+static void test_commit_out_of_order(void)
+{
+    enum { CAP = 4 };
+    iot_mpsc_queue_t q;
+    void *mem = malloc(iot_mpsc_mem_size(CAP, SLOT_SIZE));
+    CHECK(iot_mpsc_init(&q, mem, CAP, SLOT_SIZE));
+
+    iot_mpsc_slot_t *a = iot_mpsc_reserve(&q);
+    iot_mpsc_slot_t *b = iot_mpsc_reserve(&q);
+    CHECK(a != NULL && b != NULL && a != b);
+    fill_slot(b, 1, msg_len(1));
+    iot_mpsc_commit(&q, b, msg_len(1), 0);
+    CHECK(iot_mpsc_peek(&q) == NULL);
+
+    fill_slot(a, 0, msg_len(0));
+    iot_mpsc_commit(&q, a, msg_len(0), 0);
+    consume(&q, 0, 0);
+    consume(&q, 1, 0);
+    CHECK(iot_mpsc_peek(&q) == NULL);
+    free(mem);
+}
+
+/**
+ * @brief 把空队列的读写位置移到start（模拟长时间运行后的状态）
+ *
+ * 按 iot_mpsc_queue.c 中的序号约定：空闲槽位的序号等于将写入它的位置。
+ */
+static void queue_seek(iot_mpsc_queue_t *q, uint32_t start)
+{
+    atomic_store(&q->enqueue_pos, start);
+    q->dequeue_pos = start;
+    for (uint32_t i = 0; i <= q->mask; i++) {
+        uint32_t pos = start + i;
+        iot_mpsc_slot_t *slot = (iot_mpsc_slot_t *)(q->slots + (size_t)(pos & q->mask) * q->stride);
+        atomic_store(&slot->seq, pos);
+    }
+}
+
+// 每次写入、读出的条数与槽位数互质，写入位置绕环很多圈；从0和计数器溢出前开始各测一遍
+static void test_wrap_around(void)
+{
+    enum { CAP = 8, ROUNDS = 1000, BURST = 5 };
+    static const uint32_t starts[] = { 0, UINT32_MAX - 3 * CAP - 2 };
+    iot_mpsc_queue_t q;
+    void *mem = malloc(iot_mpsc_mem_size(CAP, SLOT_SIZE));
+
+    for (size_t s = 0; s < sizeof(starts) / sizeof(starts[0]); s++) {
+        CHECK(iot_mpsc_init(&q, mem, CAP, SLOT_SIZE));
+        queue_seek(&q, starts[s]);
+        uint32_t next_in = 0;
+        uint32_t next_out = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < BURST; i++) {
+                produce(&q, next_in++, 7);
+            }
+            // 每轮少读一条，队列逐渐填满，满后再整体读空
+            for (int i = 0; i < BURST - 1; i++) {
+                consume(&q, next_out++, 7);
+            }
+            if (next_in - next_out > CAP - BURST) {
+                while (next_out < next_in) {
+                    consume(&q, next_out++, 7);
+                }
+            }
+        }
+        while (next_out < next_in) {
+            consume(&q, next_out++, 7);
+        }
+        CHECK(iot_mpsc_peek(&q) == NULL);
+        CHECK(atomic_load(&q.enqueue_pos) == starts[s] + next_in);
+    }
+    free(mem);
+}
+
+/* ==================== 多生产者并发 ==================== */
+
+static iot_mpsc_queue_t stress_q;
+static uint32_t stress_count;
+static atomic_int stress_start;
+
+typedef struct {
+    uint32_t id;
+    long full;          // 队列满的次数
+} producer_t;
+
+static void *producer_thread(void *arg)
+{
+    producer_t *p = arg;
+    while (!atomic_load(&stress_start)) {
+    }
+    for (uint32_t seq = 0; seq < stress_count; seq++) {
+        iot_mpsc_slot_t *slot;
+        while ((slot = iot_mpsc_reserve(&stress_q)) == NULL) {
+            p->full++;
+            sched_yield();
+        }
+        fill_slot(slot, seq, msg_len(seq));
+        iot_mpsc_commit(&stress_q, slot, msg_len(seq), p->id);
+    }
+    return NULL;
+}
+
+static void test_stress(void)
+{
+    void *mem = malloc(iot_mpsc_mem_size(STRESS_CAPACITY, SLOT_SIZE));
+    CHECK(iot_mpsc_init(&stress_q, mem, STRESS_CAPACITY, SLOT_SIZE));
+
+    pthread_t threads[PRODUCERS];
+    producer_t producers[PRODUCERS] = { 0 };
+    for (int i = 0; i < PRODUCERS; i++) {
+        producers[i].id = i;
+        CHECK(pthread_create(&threads[i], NULL, producer_thread, &producers[i]) == 0);
+    }
+
+    uint32_t next[PRODUCERS] = { 0 };   // 每个生产者期望的下一个序号
+    long total = (long)stress_count * PRODUCERS;
+    long received = 0;
+    long bad_tag = 0;
+    long out_of_order = 0;
+    long corrupt = 0;
+    long empty = 0;
+    double start = host_now_sec();
+    atomic_store(&stress_start, 1);
+    while (received < total) {
+        iot_mpsc_slot_t *slot = iot_mpsc_peek(&stress_q);
+        if (!slot) {
+            empty++;
+            sched_yield();
+            continue;
+        }
+        uint32_t seq;
+        if (!slot_intact(slot, &seq) || slot->len != msg_len(seq)) {
+            corrupt++;
+        }
+        if (slot->tag >= PRODUCERS) {
+            bad_tag++;
+        } else if (seq != next[slot->tag]) {
+            // 序号跳过是丢失，回退是重复，都算乱序
+            out_of_order++;
+            next[slot->tag] = seq + 1;
+        } else {
+            next[slot->tag]++;
+        }
+        iot_mpsc_release(&stress_q, slot);
+        received++;
+    }
+    double elapsed = host_now_sec() - start;
+
+    long full = 0;
+    for (int i = 0; i < PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+        full += producers[i].full;
+        CHECK(next[i] == stress_count);
+    }
+    CHECK(bad_tag == 0);
+    CHECK(out_of_order == 0);
+    CHECK(corrupt == 0);
+    CHECK(iot_mpsc_peek(&stress_q) == NULL);
+    CHECK(atomic_load(&stress_q.enqueue_pos) == (uint32_t)total);
+
+    printf("{\"test\":\"mpsc_stress\",\"producers\":%d,\"capacity\":%d,\"messages\":%ld,"
+           "\"full_retries\":%ld,\"empty_polls\":%ld,\"ns_per_msg\":%.1f}\n",
+           PRODUCERS, STRESS_CAPACITY, total, full, empty, elapsed * 1e9 / total);
+    free(mem);
+}
+
+int main(int argc, char **argv)
+{
+    stress_count = (uint32_t)bench_iterations(argc > 1 ? atol(argv[1]) : 200000);
+
+    test_init_args();
+    test_full();
+    test_commit_out_of_order();
+    test_wrap_around();
+    test_stress();
+    return TEST_RESULT();
+}
@@ -0,0 +1,175 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 离线缓存测试
+ *
+ * 随机入队/出队，与一个简单的FIFO模型逐条比对：顺序、内容、字段、
+ * 回绕填充，以及满时拒绝新消息或挤掉最早消息两种策略。
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "host_test.h"
+#include "iot_offline_queue.h"
+
+#define MODEL_MAX   4096
+
+// 模型中的一条消息
+typedef struct {
+    uint32_t seq;
+    uint32_t len;
+    uint8_t fill;
+    uint8_t msg_class;
+    uint8_t qos;
+    bool retain;
+    uint8_t format;
+} model_msg_t;
+
+static model_msg_t model[MODEL_MAX];
+static int model_head = 0;
+static int model_count = 0;
+
+static model_msg_t *model_at(int i)
+{
+    return &model[(model_head + i) % MODEL_MAX];
+}
+
+static void model_pop(void)
+{
+    model_head = (model_head + 1) % MODEL_MAX;
+    model_count--;
+}
+
+static void make_data(char *data, uint32_t len, uint8_t fill)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        data[i] = (char)('a' + (fill + i) % 26);
+    }
+}
+
+/**
+ * @brief 队首记录与模型一致
+ */
+static void check_front(iot_offline_queue_t *q)
+{
+    CHECK(iot_offline_queue_count(q) == (uint32_t)model_count);
+    iot_oq_record_t rec;
+    bool have = iot_offline_queue_peek(q, &rec);
+    CHECK(have == (model_count > 0));
+    if (!have || model_count == 0) {
+        return;
+    }
+
+    const model_msg_t *m = model_at(0);
+    char expect[600];
+    make_data(expect, m->len, m->fill);
+    CHECK(rec.seq == m->seq);
+    CHECK(rec.data_len == m->len);
+    CHECK(memcmp(rec.data, expect, m->len) == 0);
+    CHECK(rec.data[m->len] == '\0');
+    CHECK(strcmp(rec.topic, "device/test/data") == 0);
+    CHECK(rec.msg_class == m->msg_class);
+    CHECK(rec.qos == m->qos);
+    CHECK(rec.retain == m->retain);
+    CHECK(rec.format == m->format);
+    CHECK(rec.enqueue_ms == (int64_t)m->seq * 10);
+}
+
+static void test_random(bool evict_oldest)
+{
+    static uint8_t buf[2048] __attribute__((aligned(8)));
+    iot_offline_queue_t q;
+    iot_offline_queue_init(&q, buf, sizeof(buf));
+    model_head = model_count = 0;
+
+    uint32_t rng = evict_oldest ? 12345 : 67890;
+    uint32_t next_seq = 0;
+    int full = 0;
+    int evicted = 0;
+
+    for (int step = 0; step < 200000; step++) {
+        if (host_rand(&rng) % 100 < 55) {
+            model_msg_t m = {
+                .len = host_rand(&rng) % 300,
+                .fill = (uint8_t)host_rand(&rng),
+                .msg_class = host_rand(&rng) % 4,
+                .qos = host_rand(&rng) % 3,
+                .retain = host_rand(&rng) & 1,
+                .format = host_rand(&rng) % 4,
+            };
+            char data[600];
+            make_data(data, m.len, m.fill);
+
+            uint32_t dropped = iot_offline_queue_dropped(&q);
+            iot_oq_err_t err = iot_offline_queue_push(&q, m.msg_class, "device/test/data", data,
+                                                      m.len, m.qos, m.retain, m.format,
+                                                      (int64_t)next_seq * 10, evict_oldest);
+            uint32_t lost = iot_offline_queue_dropped(&q) - dropped;
+            if (err == IOT_OQ_OK) {
+                // 挤掉的一定是最早的消息
+                CHECK(evict_oldest || lost == 0);
+                for (uint32_t i = 0; i < lost; i++) {
+                    model_pop();
+                }
+                evicted += lost;
+                m.seq = next_seq++;
+                *model_at(model_count) = m;
+                model_count++;
+            } else {
+                CHECK(err == IOT_OQ_ERR_FULL);
+                CHECK(!evict_oldest);
+                CHECK(lost == 1);
+                full++;
+            }
+        } else if (model_count > 0) {
+            iot_offline_queue_pop(&q);
+            model_pop();
+        }
+        check_front(&q);
+        CHECK(iot_offline_queue_used(&q) <= sizeof(buf));
+    }
+
+    // 取空后不占用空间
+    while (model_count > 0) {
+        check_front(&q);
+        iot_offline_queue_pop(&q);
+        model_pop();
+    }
+    check_front(&q);
+    CHECK(iot_offline_queue_used(&q) == 0);
+
+    // 随机序列必须真正覆盖满的情况
+    CHECK(evict_oldest ? evicted > 0 : full > 0);
+    printf("evict_oldest=%d: %u条入队, 拒绝%d条, 挤掉%d条\n",
+           evict_oldest, next_seq, full, evicted);
+}
+
+static void test_limits(void)
+{
+    static uint8_t buf[256] __attribute__((aligned(8)));
+    iot_offline_queue_t q;
+    iot_offline_queue_init(&q, buf, sizeof(buf));
+
+    char big[300];
+    memset(big, 'x', sizeof(big));
+    CHECK(iot_offline_queue_push(&q, 0, "t", big, sizeof(big), 1, false, 0, 0, true) ==
+          IOT_OQ_ERR_TOO_BIG);
+    CHECK(iot_offline_queue_dropped(&q) == 1);
+    CHECK(iot_offline_queue_count(&q) == 0);
+
+    CHECK(iot_offline_queue_push(&q, 0, NULL, "x", 1, 1, false, 0, 0, true) == IOT_OQ_ERR_ARG);
+
+    // 空数据
+    CHECK(iot_offline_queue_push(&q, 0, "t", NULL, 0, 1, false, 0, 0, true) == IOT_OQ_OK);
+    iot_oq_record_t rec;
+    CHECK(iot_offline_queue_peek(&q, &rec));
+    CHECK(rec.data_len == 0 && rec.data[0] == '\0');
+}
+
+int main(void)
+{
+    test_limits();
+    test_random(false);
+    test_random(true);
+    return TEST_RESULT();
+}
@@ -0,0 +1,228 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 重连退避测试
+ *
+ * iot_reconnect.c 单独编译，esp_timer_get_time() 和 esp_random() 由本文件提供（虚拟时钟、
+ * 可指定的随机数），Kconfig取默认值（基础间隔1000ms，上限60000ms）。检查：
+ * - 第n次重连的等待时间在 [cap/2, cap] 之内，cap = min(基础间隔 << n, 上限)，随机数取最小、
+ *   最大值时恰好落在两端
+ * - 退避达到上限后保持不变，重连次数再多也不会因移位溢出变短
+ * - 链路恢复时重置本链路和上层链路的退避，上层恢复不影响下层；断开不重置
+ * - 统计：首次连接之前的失败不算断开，重复断开只计一次，断开期间的重连次数，恢复时间
+ */
+
+#include <stdbool.h>
+#include "host_test.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "iot_reconnect.h"
+
+#define BASE_MS     CONFIG_IOT_RECONNECT_BASE_MS
+#define MAX_MS      CONFIG_IOT_RECONNECT_MAX_MS
+
+static int64_t now_us = 1000000;
+static bool rand_fixed = true;
+static uint32_t rand_value;
+static uint32_t rand_state = 0x2545f491;
+static int callbacks;
+static iot_link_t callback_link;
+
+int64_t esp_timer_get_time(void)
+{
+    return now_us;
+}
+
+uint32_t esp_random(void)
+{
+    return rand_fixed ? rand_value : host_rand(&rand_state);
+}
+
+void host_log(char level, const char *tag, const char *format, ...)
+{
+}
+
+static void on_link_up(iot_link_t link)
+{
+    callbacks++;
+    callback_link = link;
+}
+
+// 第n次重连（n从0开始）的等待上限
+static uint32_t expected_cap(int n)
+{
+    uint64_t cap = n < 32 ? (uint64_t)BASE_MS << n : UINT64_MAX;
+    return cap < MAX_MS ? (uint32_t)cap : MAX_MS;
+}
+
+// 以指定的随机数取下一次等待时间
+static uint32_t delay_with(iot_link_t link, uint32_t r)
+{
+    rand_value = r;
+    return iot_reconnect_next_delay_ms(link);
+}
+
+static iot_reconnect_stats_t stats(iot_link_t link)
+{
+    iot_reconnect_stats_t st = { 0 };
+    CHECK(iot_reconnect_get_stats(link, &st) == ESP_OK);
+    return st;
+}
+
+// 从未报告过状态的链路视为可用，首次连接之前的失败不算断开
+static void test_never_reported(void)
+{
+    CHECK(iot_reconnect_link_is_up(IOT_LINK_WIFI));
+    CHECK(iot_reconnect_link_is_up(IOT_LINK_MQTT));
+
+    iot_reconnect_link_down(IOT_LINK_MQTT);
+    CHECK(!iot_reconnect_link_is_up(IOT_LINK_MQTT));
+    CHECK(stats(IOT_LINK_MQTT).outages == 0);
+    delay_with(IOT_LINK_MQTT, 0);
+    CHECK(stats(IOT_LINK_MQTT).attempts == 0);
+
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+    iot_reconnect_link_up(IOT_LINK_MQTT);
+    iot_reconnect_stats_t st = stats(IOT_LINK_MQTT);
+    CHECK(st.up && st.outages == 0 && st.recoveries == 0 && st.last_ms == 0);
+    CHECK(callbacks == 2 && callback_link == IOT_LINK_MQTT);
+}
+
+// 随机数取最小、最大值时等待时间恰好为 cap/2 和 cap；超过上限后保持上限
+static void test_bounds(void)
+{
+    const int attempts = 70;    // 远超移位上限，移位不饱和时会溢出
+
+    for (int n = 0; n < attempts; n++) {
+        uint32_t d = delay_with(IOT_LINK_MQTT, 0);
+        CHECK(d == expected_cap(n) / 2);
+        if (d != expected_cap(n) / 2) {
+            fprintf(stderr, "第%d次: %lu，预期最小值%lu\n", n, (unsigned long)d,
+                    (unsigned long)expected_cap(n) / 2);
+        }
+    }
+    iot_reconnect_link_up(IOT_LINK_MQTT);
+    for (int n = 0; n < attempts; n++) {
+        uint32_t cap = expected_cap(n);
+        uint32_t d = delay_with(IOT_LINK_MQTT, cap / 2);
+        CHECK(d == cap);
+        if (d != cap) {
+            fprintf(stderr, "第%d次: %lu，预期最大值%lu\n", n, (unsigned long)d, (unsigned long)cap);
+        }
+    }
+
+    // 几个具体的值：1000 → 2000 → ... → 32000 → 60000（64000超过上限）
+    CHECK(expected_cap(0) == 1000 && expected_cap(5) == 32000 && expected_cap(6) == MAX_MS);
+
+    // 任意随机数都在 [cap/2, cap] 之内
+    rand_fixed = false;
+    for (int round = 0; round < 200; round++) {
+        iot_reconnect_link_up(IOT_LINK_MQTT);
+        for (int n = 0; n < 20; n++) {
+            uint32_t cap = expected_cap(n);
+            uint32_t d = iot_reconnect_next_delay_ms(IOT_LINK_MQTT);
+            CHECK(d >= cap / 2 && d <= cap);
+        }
+    }
+    rand_fixed = true;
+    iot_reconnect_link_up(IOT_LINK_MQTT);
+}
+
+// 恢复时重置本链路和上层链路，断开不重置
+static void test_reset(void)
+{
+    for (int n = 0; n < 3; n++) {
+        delay_with(IOT_LINK_WIFI, 0);
+        delay_with(IOT_LINK_MQTT, 0);
+    }
+
+    // MQTT恢复只重置MQTT
+    iot_reconnect_link_up(IOT_LINK_MQTT);
+    CHECK(delay_with(IOT_LINK_MQTT, 0) == expected_cap(0) / 2);
+    CHECK(delay_with(IOT_LINK_WIFI, 0) == expected_cap(3) / 2);
+
+    // 断开不重置
+    iot_reconnect_link_down(IOT_LINK_WIFI);
+    iot_reconnect_link_down(IOT_LINK_MQTT);
+    CHECK(delay_with(IOT_LINK_WIFI, 0) == expected_cap(4) / 2);
+    CHECK(delay_with(IOT_LINK_MQTT, 0) == expected_cap(1) / 2);
+
+    // WiFi恢复同时重置MQTT
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+    CHECK(delay_with(IOT_LINK_WIFI, 0) == expected_cap(0) / 2);
+    CHECK(delay_with(IOT_LINK_MQTT, 0) == expected_cap(0) / 2);
+    iot_reconnect_link_up(IOT_LINK_MQTT);
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+}
+
+// 断开、重连次数和恢复时间
+static void test_stats(void)
+{
+    iot_reconnect_stats_t before = stats(IOT_LINK_WIFI);
+    CHECK(before.up);
+
+    // 可用期间的重连不计数
+    delay_with(IOT_LINK_WIFI, 0);
+    CHECK(stats(IOT_LINK_WIFI).attempts == before.attempts);
+
+    // 第一次断开2500ms，重连3次；重复的断开只计一次
+    iot_reconnect_link_down(IOT_LINK_WIFI);
+    now_us += 1000000;
+    iot_reconnect_link_down(IOT_LINK_WIFI);
+    CHECK(!iot_reconnect_link_is_up(IOT_LINK_WIFI));
+    for (int n = 0; n < 3; n++) {
+        delay_with(IOT_LINK_WIFI, 0);
+    }
+    now_us += 1500000;
+    int calls = callbacks;
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+    CHECK(callbacks == calls + 1 && callback_link == IOT_LINK_WIFI);
+
+    iot_reconnect_stats_t st = stats(IOT_LINK_WIFI);
+    CHECK(st.up && iot_reconnect_link_is_up(IOT_LINK_WIFI));
+    CHECK(st.outages == before.outages + 1 && st.recoveries == before.recoveries + 1);
+    CHECK(st.attempts == before.attempts + 3);
+    CHECK(st.last_ms == 2500 && st.max_ms == 2500 && st.total_ms == before.total_ms + 2500);
+
+    // 第二次断开1000ms：最长时间不变，总时间累加
+    iot_reconnect_link_down(IOT_LINK_WIFI);
+    now_us += 1000999;
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+    st = stats(IOT_LINK_WIFI);
+    CHECK(st.outages == before.outages + 2 && st.recoveries == before.recoveries + 2);
+    CHECK(st.last_ms == 1000 && st.max_ms == 2500 && st.total_ms == before.total_ms + 3500);
+
+    // 恢复后的重复报告不再计入恢复
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+    CHECK(stats(IOT_LINK_WIFI).recoveries == before.recoveries + 2);
+
+    // MQTT不受影响（test_reset()中断开一次，期间重连2次）
+    CHECK(stats(IOT_LINK_MQTT).outages == 1 && stats(IOT_LINK_MQTT).attempts == 2);
+}
+
+// 无效参数
+static void test_invalid(void)
+{
+    iot_reconnect_stats_t st;
+    int calls = callbacks;
+    CHECK(iot_reconnect_next_delay_ms(IOT_LINK_MAX) == MAX_MS);
+    CHECK(iot_reconnect_get_stats(IOT_LINK_MAX, &st) == ESP_ERR_INVALID_ARG);
+    CHECK(iot_reconnect_get_stats(IOT_LINK_WIFI, NULL) == ESP_ERR_INVALID_ARG);
+    CHECK(!iot_reconnect_link_is_up(IOT_LINK_MAX));
+    iot_reconnect_link_up(IOT_LINK_MAX);
+    iot_reconnect_link_down(IOT_LINK_MAX);
+    CHECK(callbacks == calls);
+}
+
+int main(void)
+{
+    iot_reconnect_set_callback(on_link_up);
+
+    test_never_reported();
+    test_bounds();
+    test_reset();
+    test_stats();
+    test_invalid();
+
+    return TEST_RESULT();
+}
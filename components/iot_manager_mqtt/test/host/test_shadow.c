@@ -0,0 +1,205 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 属性影子与死区上报测试
+ *
+ * 整个组件在模拟MQTT客户端（mock_mqtt.c）上运行，CMakeLists.txt中关闭批量上报（每次上报
+ * 一条消息）、完整快照间隔设为5次。检查：
+ * - 绝对死区从上次上报的值算起，不随期间设置的值漂移
+ * - 百分比死区按上次上报值的百分比计算；上次上报值为0时任何变化都上报
+ * - 布尔属性和不带死区的属性任何变化都上报，值不变不上报
+ * - 每5次调用（含没有变化的调用）发送一次带 "snapshot":true 的完整快照，显式快照重新计数
+ */
+
+#include <stdbool.h>
+#include "host_test.h"
+#include "mock_mqtt.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "iot_manager.h"
+#include "iot_reconnect.h"
+
+#define DATA_TOPIC      "/data"
+#define WAIT_MS         500
+
+static int from = 0;
+static int temp;        // 绝对死区0.5
+static int hum;         // 百分比死区10%
+static int level;       // 整数，百分比死区10%
+static int on;          // 布尔
+static int count;       // 整数，没有死区
+
+/**
+ * @brief 上报一次并检查结果
+ *
+ * @param expect 预期上报的属性数
+ * @param body 预期的负载中 "timestamp" 之后的部分，expect为0时不检查
+ */
+static void report(bool full, int expect, const char *body)
+{
+    int n = iot_manager_property_report(full);
+    CHECK(n == expect);
+    if (n != expect || expect == 0) {
+        return;
+    }
+
+    int64_t deadline_us = esp_timer_get_time() + WAIT_MS * 1000LL;
+    int i;
+    while ((i = mock_mqtt_find(DATA_TOPIC, from)) < 0 && esp_timer_get_time() < deadline_us) {
+        mock_mqtt_wait(mock_mqtt_count() + 1, 20);
+    }
+    CHECK(i >= 0);
+    if (i < 0) {
+        return;
+    }
+    from = i + 1;
+    const char *data = mock_mqtt_get(i)->data;
+    const char *rest = strchr(data, ',');
+    CHECK(strncmp(data, "{\"timestamp\":", 13) == 0 && rest && strcmp(rest + 1, body) == 0);
+    if (!rest || strcmp(rest + 1, body) != 0) {
+        fprintf(stderr, "负载: %s\n预期: ...,%s\n", data, body);
+    }
+}
+
+// 设置所有属性并发送显式快照，之后的调用从1开始计数
+static void snapshot(double t, double h, int64_t l, bool b, int64_t c, const char *body)
+{
+    iot_manager_property_set_float(temp, t);
+    iot_manager_property_set_float(hum, h);
+    iot_manager_property_set_int(level, l);
+    iot_manager_property_set_int(on, b);
+    iot_manager_property_set_int(count, c);
+    report(true, 5, body);
+}
+
+static void test_define(void)
+{
+    temp = iot_manager_property_define("temp", IOT_PROP_FLOAT, 0.5, 0);
+    hum = iot_manager_property_define("hum", IOT_PROP_FLOAT, 0, 10);
+    level = iot_manager_property_define("level", IOT_PROP_INT, 0, 10);
+    on = iot_manager_property_define("on", IOT_PROP_BOOL, 0, 0);
+    count = iot_manager_property_define("count", IOT_PROP_INT, 0, 0);
+    CHECK(temp >= 0 && hum >= 0 && level >= 0 && on >= 0 && count >= 0);
+    CHECK(iot_manager_property_define("temp", IOT_PROP_FLOAT, 0.5, 0) == temp);
+    CHECK(iot_manager_property_define("", IOT_PROP_INT, 0, 0) == -1);
+    CHECK(iot_manager_property_define("bad", IOT_PROP_INT, -1, 0) == -1);
+    CHECK(iot_manager_property_set_int(99, 1) == ESP_ERR_INVALID_ARG);
+
+    // 没有设置过值的属性不上报
+    report(false, 0, NULL);
+    report(true, 0, NULL);
+}
+
+// 绝对死区：与上次上报的值比较
+static void test_absolute_deadband(void)
+{
+    snapshot(20.5, 50.5, 0, true, 0,
+             "\"snapshot\":true,\"temp\":20.5,\"hum\":50.5,\"level\":0,\"on\":true,\"count\":0}");
+
+    iot_manager_property_set_float(temp, 20.75);
+    report(false, 0, NULL);                             // 变化0.25
+    iot_manager_property_set_float(temp, 20);
+    report(false, 1, "\"temp\":20}");                   // 变化0.5，达到死区
+    iot_manager_property_set_float(temp, 20.25);
+    iot_manager_property_set_float(temp, 19.75);
+    report(false, 0, NULL);                             // 相对上次上报只变化0.25
+    iot_manager_property_set_float(temp, 19.5);
+    report(false, 1, "\"temp\":19.5}");                 // 每次设置只变0.25，累计达到死区
+}
+
+// 百分比死区和上次上报值为0的情况
+static void test_percent_deadband(void)
+{
+    snapshot(20.5, 50, 0, true, 0,
+             "\"snapshot\":true,\"temp\":20.5,\"hum\":50,\"level\":0,\"on\":true,\"count\":0}");
+
+    iot_manager_property_set_float(hum, 54.5);
+    report(false, 0, NULL);                             // 9%
+    iot_manager_property_set_float(hum, 44.5);
+    report(false, 1, "\"hum\":44.5}");                  // 11%
+    iot_manager_property_set_float(hum, 40.25);
+    report(false, 0, NULL);                             // 相对44.5只变化约9.6%
+
+    // 上次上报为0：任何变化都达到百分比死区，值不变时不上报
+    snapshot(20.5, 0, 0, true, 0,
+             "\"snapshot\":true,\"temp\":20.5,\"hum\":0,\"level\":0,\"on\":true,\"count\":0}");
+    report(false, 0, NULL);
+    iot_manager_property_set_int(level, 1);
+    iot_manager_property_set_float(hum, 0.001);
+    report(false, 2, "\"hum\":0.001,\"level\":1}");
+    iot_manager_property_set_int(level, 1);
+    report(false, 0, NULL);
+}
+
+// 布尔属性和不带死区的属性
+static void test_no_deadband(void)
+{
+    snapshot(20.5, 50, 100, true, 0,
+             "\"snapshot\":true,\"temp\":20.5,\"hum\":50,\"level\":100,\"on\":true,\"count\":0}");
+
+    iot_manager_property_set_int(on, false);
+    iot_manager_property_set_int(count, 1);
+    report(false, 2, "\"on\":false,\"count\":1}");
+    iot_manager_property_set_int(on, false);
+    iot_manager_property_set_int(count, 1);
+    report(false, 0, NULL);
+    iot_manager_property_set_int(level, 109);
+    iot_manager_property_set_float(count, 2.4);         // 整数属性四舍五入
+    report(false, 1, "\"count\":2}");
+}
+
+// 每5次调用（含没有变化的调用）发送一次完整快照
+static void test_periodic_snapshot(void)
+{
+    const char *full = "\"snapshot\":true,\"temp\":20.5,\"hum\":50,\"level\":100,\"on\":true,\"count\":0}";
+    snapshot(20.5, 50, 100, true, 0, full);
+
+    for (int i = 1; i < CONFIG_IOT_SHADOW_FULL_EVERY; i++) {
+        report(false, 0, NULL);
+    }
+    report(false, 5, full);
+
+    // 快照之后重新计数；中间的变化上报不影响计数
+    iot_manager_property_set_int(count, 1);
+    report(false, 1, "\"count\":1}");
+    for (int i = 2; i < CONFIG_IOT_SHADOW_FULL_EVERY; i++) {
+        report(false, 0, NULL);
+    }
+    report(false, 5, "\"snapshot\":true,\"temp\":20.5,\"hum\":50,\"level\":100,\"on\":true,\"count\":1}");
+
+    // 显式快照也重新计数
+    report(false, 0, NULL);
+    report(false, 0, NULL);
+    report(true, 5, "\"snapshot\":true,\"temp\":20.5,\"hum\":50,\"level\":100,\"on\":true,\"count\":1}");
+    for (int i = 1; i < CONFIG_IOT_SHADOW_FULL_EVERY; i++) {
+        report(false, 0, NULL);
+    }
+    report(false, 5, "\"snapshot\":true,\"temp\":20.5,\"hum\":50,\"level\":100,\"on\":true,\"count\":1}");
+}
+
+int main(void)
+{
+    esp_event_loop_create_default();
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+
+    iot_manager_config_t config = {
+        .device_id = "shadow-test",
+        .device_name = "shadow-test",
+        .device_type = "host",
+    };
+    if (iot_manager_init(&config) != ESP_OK || iot_manager_start() != ESP_OK) {
+        fprintf(stderr, "iot_manager启动失败\n");
+        return 1;
+    }
+    mock_mqtt_connect();
+    CHECK(iot_manager_is_connected());
+
+    test_define();
+    test_absolute_deadband();
+    test_percent_deadband();
+    test_no_deadband();
+    test_periodic_snapshot();
+
+    iot_manager_stop();
+    return TEST_RESULT();
+}
@@ -0,0 +1,204 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 发布统计测试
+ *
+ * iot_stats.c 单独编译，esp_timer_get_time() 由本文件的虚拟时钟提供。检查：
+ * - 延迟直方图各桶的边界：恰好等于上界的延迟计入下一桶，不足1ms的部分舍去
+ * - 确认按msg_id匹配在途表项；找不到表项的确认（先于登记到达）在登记时匹配，只保留最近4条，
+ *   早于发布开始的确认（之前使用同一msg_id的消息）不匹配
+ * - 在途表满时替换最早的表项并计入untracked，被替换的消息确认时不计延迟
+ * - 删除和断开时放弃的在途消息计入dropped
+ */
+
+#include <stdbool.h>
+#include "host_test.h"
+#include "esp_timer.h"
+#include "iot_stats.h"
+
+static int64_t now_us = 1000000;
+static int next_msg_id = 1;
+
+int64_t esp_timer_get_time(void)
+{
+    return now_us;
+}
+
+static iot_manager_stats_t get(void)
+{
+    iot_manager_stats_t st;
+    iot_stats_get(&st);
+    return st;
+}
+
+/**
+ * @brief 发布一条QoS1消息，经过latency_us后确认
+ *
+ * @return int 延迟计入的桶，没有计入任何桶时返回-1
+ */
+static int publish_acked(int64_t latency_us)
+{
+    iot_manager_stats_t before = get();
+    int msg_id = next_msg_id++;
+    iot_stats_published(IOT_MSG_CLASS_PROPERTY, 10, msg_id, now_us);
+    now_us += latency_us;
+    iot_stats_acked(msg_id);
+    iot_manager_stats_t after = get();
+
+    int bucket = -1;
+    for (int i = 0; i < IOT_STATS_LATENCY_BUCKETS; i++) {
+        if (after.ack_latency_hist[i] != before.ack_latency_hist[i]) {
+            CHECK(bucket < 0 && after.ack_latency_hist[i] == before.ack_latency_hist[i] + 1);
+            bucket = i;
+        }
+    }
+    CHECK(after.in_flight == before.in_flight);
+    return bucket;
+}
+
+// 各桶上界：恰好等于上界计入下一桶，差1us仍在本桶
+static void test_bucket_edges(void)
+{
+    static const uint32_t bounds_ms[IOT_STATS_LATENCY_BUCKETS - 1] = {
+        10, 25, 50, 100, 250, 500, 1000, 2500, 5000,
+    };
+
+    CHECK(publish_acked(0) == 0);
+    for (int i = 0; i < IOT_STATS_LATENCY_BUCKETS - 1; i++) {
+        int64_t bound_us = bounds_ms[i] * 1000LL;
+        int below = publish_acked(bound_us - 1);
+        int at = publish_acked(bound_us);
+        CHECK(below == i && at == i + 1);
+        if (below != i || at != i + 1) {
+            fprintf(stderr, "上界%lums: 差1us计入桶%d，恰好等于计入桶%d\n",
+                    (unsigned long)bounds_ms[i], below, at);
+        }
+    }
+    CHECK(publish_acked(3600 * 1000000LL) == IOT_STATS_LATENCY_BUCKETS - 1);
+
+    // 总和与最大值按整毫秒计
+    iot_manager_stats_t before = get();
+    CHECK(publish_acked(12999) == 1);
+    iot_manager_stats_t after = get();
+    CHECK(after.ack_latency_sum_ms == before.ack_latency_sum_ms + 12);
+    CHECK(after.ack_latency_max_ms == 3600 * 1000);
+}
+
+// 按msg_id匹配，确认顺序与发布顺序无关
+static void test_match(void)
+{
+    iot_manager_stats_t before = get();
+    int64_t start = now_us;
+    iot_stats_published(IOT_MSG_CLASS_EVENT, 100, 1001, start);
+    iot_stats_published(IOT_MSG_CLASS_EVENT, 200, 1002, start + 20000);
+    iot_stats_published(IOT_MSG_CLASS_STATUS, 50, 0, start);           // QoS0不计时
+    iot_manager_stats_t st = get();
+    CHECK(st.in_flight == before.in_flight + 2);
+    CHECK(st.in_flight_peak >= 2);
+    CHECK(st.traffic[IOT_MSG_CLASS_EVENT].messages == before.traffic[IOT_MSG_CLASS_EVENT].messages + 2);
+    CHECK(st.traffic[IOT_MSG_CLASS_EVENT].bytes == before.traffic[IOT_MSG_CLASS_EVENT].bytes + 300);
+    CHECK(st.traffic[IOT_MSG_CLASS_STATUS].messages == before.traffic[IOT_MSG_CLASS_STATUS].messages + 1);
+
+    // 1002先确认：延迟30ms（桶2）；1001延迟60ms（桶3）
+    now_us = start + 50000;
+    iot_stats_acked(1002);
+    now_us = start + 60000;
+    iot_stats_acked(1001);
+    st = get();
+    CHECK(st.in_flight == before.in_flight);
+    CHECK(st.ack_latency_hist[2] == before.ack_latency_hist[2] + 1);
+    CHECK(st.ack_latency_hist[3] == before.ack_latency_hist[3] + 1);
+    CHECK(st.ack_latency_sum_ms == before.ack_latency_sum_ms + 90);
+
+    // 重复的确认找不到表项，不再计入
+    iot_stats_acked(1001);
+    CHECK(get().ack_latency_sum_ms == st.ack_latency_sum_ms);
+    iot_stats_abandon_in_flight();
+}
+
+// 先于登记到达的确认：登记时立即计入，在途表不变
+static void test_early_ack(void)
+{
+    iot_manager_stats_t before = get();
+    int64_t start = now_us;
+    now_us = start + 30000;
+    iot_stats_acked(2001);
+    CHECK(get().ack_latency_sum_ms == before.ack_latency_sum_ms);
+    iot_stats_published(IOT_MSG_CLASS_PROPERTY, 10, 2001, start);
+    iot_manager_stats_t st = get();
+    CHECK(st.in_flight == before.in_flight);
+    CHECK(st.ack_latency_hist[2] == before.ack_latency_hist[2] + 1);
+    CHECK(st.ack_latency_sum_ms == before.ack_latency_sum_ms + 30);
+
+    // 只保留最近4条：2101被2105覆盖，登记后进入在途表等待确认
+    for (int id = 2101; id <= 2105; id++) {
+        iot_stats_acked(id);
+    }
+    before = get();
+    iot_stats_published(IOT_MSG_CLASS_PROPERTY, 10, 2101, start);
+    CHECK(get().in_flight == before.in_flight + 1);
+    for (int id = 2102; id <= 2105; id++) {
+        iot_stats_published(IOT_MSG_CLASS_PROPERTY, 10, id, start);
+    }
+    st = get();
+    CHECK(st.in_flight == before.in_flight + 1);
+    uint32_t counted = 0;
+    for (int i = 0; i < IOT_STATS_LATENCY_BUCKETS; i++) {
+        counted += st.ack_latency_hist[i] - before.ack_latency_hist[i];
+    }
+    CHECK(counted == 4);
+    iot_stats_abandon_in_flight();
+}
+
+// 在途表满时替换最早的表项
+static void test_table_full(void)
+{
+    iot_manager_stats_t before = get();
+    int64_t start = now_us;
+    for (int i = 0; i < CONFIG_IOT_STATS_IN_FLIGHT_MAX; i++) {
+        // 3005最早开始
+        iot_stats_published(IOT_MSG_CLASS_PROPERTY, 10, 3000 + i, start + (i == 5 ? -1000 : i * 1000));
+    }
+    CHECK(get().in_flight == CONFIG_IOT_STATS_IN_FLIGHT_MAX);
+    CHECK(get().in_flight_peak == CONFIG_IOT_STATS_IN_FLIGHT_MAX);
+
+    // 替换最早的3005
+    iot_stats_published(IOT_MSG_CLASS_PROPERTY, 10, 3100, start + 100000);
+    iot_manager_stats_t st = get();
+    CHECK(st.in_flight == CONFIG_IOT_STATS_IN_FLIGHT_MAX);
+    CHECK(st.untracked == before.untracked + 1);
+
+    now_us = start + 200000;
+    iot_stats_acked(3005);
+    CHECK(get().ack_latency_sum_ms == st.ack_latency_sum_ms);
+    iot_stats_acked(3100);
+    CHECK(get().ack_latency_sum_ms == st.ack_latency_sum_ms + 100);
+    CHECK(get().in_flight == CONFIG_IOT_STATS_IN_FLIGHT_MAX - 1);
+
+    // 删除一条，断开时放弃其余的
+    iot_stats_deleted(3001);
+    st = get();
+    CHECK(st.in_flight == CONFIG_IOT_STATS_IN_FLIGHT_MAX - 2);
+    CHECK(st.dropped == before.dropped + 1);
+    iot_stats_abandon_in_flight();
+    st = get();
+    CHECK(st.in_flight == 0);
+    CHECK(st.dropped == before.dropped + 1 + CONFIG_IOT_STATS_IN_FLIGHT_MAX - 2);
+
+    // 放弃后迟到的确认不计入，之后重用同一msg_id的消息不与它匹配
+    iot_stats_acked(3002);
+    now_us += 1000;
+    iot_stats_published(IOT_MSG_CLASS_PROPERTY, 10, 3002, now_us);
+    CHECK(get().in_flight == 1);
+    CHECK(get().ack_latency_sum_ms == st.ack_latency_sum_ms);
+    iot_stats_abandon_in_flight();
+}
+
+int main(void)
+{
+    test_bucket_edges();
+    test_match();
+    test_early_ack();
+    test_table_full();
+    return TEST_RESULT();
+}
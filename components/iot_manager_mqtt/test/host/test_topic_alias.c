@@ -0,0 +1,191 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - MQTT5主题别名测试
+ *
+ * 整个组件在模拟MQTT客户端（mock_mqtt.c）上运行，CMakeLists.txt中打开MQTT5和主题别名，
+ * 属性QoS设为0、关闭批量。模拟客户端与esp-mqtt相同，按服务器的Topic Alias Maximum检查别名。检查：
+ * - QoS0：每个连接上第一条消息带完整主题和别名，之后只带别名（主题为空）
+ * - QoS1（上线状态、事件）始终带完整主题，即使该类别的别名已由QoS0消息建立
+ * - 自定义主题不使用别名
+ * - 重新连接后重新建立映射
+ * - 别名超过服务器的上限时该类别在本连接内使用完整主题，下次连接重新尝试
+ */
+
+#include <stdbool.h>
+#include "host_test.h"
+#include "mock_mqtt.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "iot_manager.h"
+#include "iot_reconnect.h"
+
+#define DEVICE_ID       "alias-test"
+#define STATUS_TOPIC    "device/" DEVICE_ID "/status"
+#define DATA_TOPIC      "device/" DEVICE_ID "/data"
+#define EVENT_TOPIC     "device/" DEVICE_ID "/event"
+#define WAIT_MS         500
+#define RESTART_MS      3000
+
+static int from = 0;
+
+/**
+ * @brief 等待下一条消息（按发布顺序）
+ *
+ * @return const mock_mqtt_msg_t* 超时返回NULL
+ */
+static const mock_mqtt_msg_t *next_msg(void)
+{
+    if (mock_mqtt_wait(from + 1, WAIT_MS) <= from) {
+        return NULL;
+    }
+    return mock_mqtt_get(from++);
+}
+
+/**
+ * @brief 检查下一条消息的主题、别名和所在的连接
+ *
+ * @param topic 预期发送的主题，""表示只带别名
+ */
+static void expect_msg(const char *topic, uint16_t alias, uint32_t conn)
+{
+    const mock_mqtt_msg_t *m = next_msg();
+    CHECK(m != NULL);
+    if (!m) {
+        return;
+    }
+    CHECK(strcmp(m->topic, topic) == 0 && m->topic_alias == alias && m->conn_seq == conn);
+    if (strcmp(m->topic, topic) != 0 || m->topic_alias != alias || m->conn_seq != conn) {
+        fprintf(stderr, "消息%d: \"%s\" 别名%u 连接%u，预期 \"%s\" 别名%u 连接%u\n", from - 1,
+                m->topic, m->topic_alias, m->conn_seq, topic, alias, conn);
+    }
+}
+
+static void data(int n)
+{
+    char msg[16];
+    snprintf(msg, sizeof(msg), "{\"n\":%d}", n);
+    CHECK(iot_manager_report_properties(msg) == 0);
+}
+
+static void event(void)
+{
+    static const char msg[] = "{\"event\":\"test\"}";
+    CHECK(iot_manager_report(IOT_MSG_CLASS_EVENT, msg, sizeof(msg) - 1, 0) == 0);
+}
+
+// 连接并检查上线状态：QoS1，带完整主题和别名
+static void connect(uint32_t conn)
+{
+    mock_mqtt_connect();
+    CHECK(iot_manager_is_connected());
+    expect_msg(STATUS_TOPIC, IOT_MSG_CLASS_STATUS, conn);
+}
+
+// 断开后等组件退避、重新启动客户端，再以新的Topic Alias Maximum连接
+static void reconnect(uint16_t alias_max, uint32_t conn)
+{
+    CHECK(mock_mqtt_count() == from);
+    mock_mqtt_disconnect();
+    CHECK(!iot_manager_is_connected());
+    CHECK(mock_mqtt_wait_restart(RESTART_MS));
+    mock_mqtt_set_alias_max(alias_max);
+    connect(conn);
+}
+
+// 第一条带完整主题建立映射，之后的QoS0消息只带别名；QoS1始终带完整主题
+static void test_first_connection(void)
+{
+    connect(1);
+    // 首次连接时自动上报的指标和健康事件（QoS0），事件类别的别名由此建立
+    expect_msg(EVENT_TOPIC, IOT_MSG_CLASS_EVENT, 1);
+    expect_msg("", IOT_MSG_CLASS_EVENT, 1);
+
+    data(1);
+    data(2);
+    data(3);
+    expect_msg(DATA_TOPIC, IOT_MSG_CLASS_PROPERTY, 1);
+    expect_msg("", IOT_MSG_CLASS_PROPERTY, 1);
+    expect_msg("", IOT_MSG_CLASS_PROPERTY, 1);
+
+    event();
+    event();
+    expect_msg(EVENT_TOPIC, IOT_MSG_CLASS_EVENT, 1);
+    expect_msg(EVENT_TOPIC, IOT_MSG_CLASS_EVENT, 1);
+
+    // 自定义主题
+    CHECK(iot_manager_publish("custom/topic", "x", 1, 0, 0) == 0);
+    CHECK(iot_manager_publish("custom/topic", "x", 1, 0, 0) == 0);
+    expect_msg("custom/topic", 0, 1);
+    expect_msg("custom/topic", 0, 1);
+}
+
+// 新的连接上映射重新建立
+static void test_reconnect_resets(void)
+{
+    reconnect(4, 2);
+    data(4);
+    data(5);
+    expect_msg(DATA_TOPIC, IOT_MSG_CLASS_PROPERTY, 2);
+    expect_msg("", IOT_MSG_CLASS_PROPERTY, 2);
+}
+
+// 服务器只接受别名1~2：事件（别名4）改用完整主题，属性照常使用别名
+static void test_rejected_alias(void)
+{
+    reconnect(2, 3);
+    event();
+    data(6);
+    event();
+    data(7);
+    expect_msg(EVENT_TOPIC, 0, 3);
+    expect_msg(DATA_TOPIC, IOT_MSG_CLASS_PROPERTY, 3);
+    expect_msg(EVENT_TOPIC, 0, 3);
+    expect_msg("", IOT_MSG_CLASS_PROPERTY, 3);
+
+    // 服务器不接受任何别名：状态和属性都使用完整主题
+    CHECK(mock_mqtt_count() == from);
+    mock_mqtt_disconnect();
+    CHECK(mock_mqtt_wait_restart(RESTART_MS));
+    mock_mqtt_set_alias_max(0);
+    mock_mqtt_connect();
+    expect_msg(STATUS_TOPIC, 0, 4);
+    data(8);
+    data(9);
+    expect_msg(DATA_TOPIC, 0, 4);
+    expect_msg(DATA_TOPIC, 0, 4);
+
+    // 下次连接重新尝试别名
+    reconnect(4, 5);
+    event();
+    data(10);
+    data(11);
+    expect_msg(EVENT_TOPIC, IOT_MSG_CLASS_EVENT, 5);
+    expect_msg(DATA_TOPIC, IOT_MSG_CLASS_PROPERTY, 5);
+    expect_msg("", IOT_MSG_CLASS_PROPERTY, 5);
+}
+
+int main(void)
+{
+    esp_event_loop_create_default();
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+    mock_mqtt_set_alias_max(4);
+
+    iot_manager_config_t config = {
+        .device_id = DEVICE_ID,
+        .device_name = DEVICE_ID,
+        .device_type = "host",
+    };
+    if (iot_manager_init(&config) != ESP_OK || iot_manager_start() != ESP_OK) {
+        fprintf(stderr, "iot_manager启动失败\n");
+        return 1;
+    }
+
+    test_first_connection();
+    test_reconnect_resets();
+    test_rejected_alias();
+
+    CHECK(mock_mqtt_count() == from);
+    iot_manager_stop();
+    return TEST_RESULT();
+}
@@ -0,0 +1,230 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 时间序列压缩编码测试
+ *
+ * 用模拟的传感器数据编码，每个负载512字节，放不下时发出当前负载再开始新的负载（与应用的用法相同）。
+ * 每种数据输出一行JSON（点数、负载数、压缩后字节数、每点字节数、相对JSON的压缩比），
+ * 并检查压缩后大小与README表格中的值相差不超过2%（sinf等libm函数的结果因平台略有不同）。
+ *
+ * 指定输出目录时把每个负载写成 <数据>_<序号>.bin，期望的点写成 <数据>.exp
+ * （每行“时间戳 数值位模式(十六进制)”），由 check_tsz.py 用 tools/tsz_decode.py 解码比对。
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include "host_test.h"
+#include "iot_tsz.h"
+
+#define PAYLOAD_SIZE    512
+
+static uint8_t payload[PAYLOAD_SIZE];
+static const char *out_dir;
+
+// 均匀分布的 [0, 1)
+static double uniform(uint32_t *rng)
+{
+    return (host_rand(rng) >> 8) / 16777216.0;
+}
+
+// 温度，1Hz，0.1℃分辨率，10%的点有10ms抖动
+static float gen_temperature(int i, int64_t *ts, uint32_t *rng)
+{
+    static double walk = 22.0;
+    *ts = 1000LL * i + (host_rand(rng) % 10 == 0 ? 10 : 0);
+    walk += (uniform(rng) - 0.5) * 0.05;
+    return roundf((float)walk * 10) / 10;
+}
+
+// 空闲堆，1Hz，64字节粒度的波动，每50秒一次大块分配
+static float gen_free_heap(int i, int64_t *ts, uint32_t *rng)
+{
+    *ts = 1000LL * i;
+    return (float)(180000 - (host_rand(rng) % 8) * 64 - (i % 50 == 0 ? 4096 : 0));
+}
+
+// 加速度，50Hz，正弦加噪声
+static float gen_accel(int i, int64_t *ts, uint32_t *rng)
+{
+    *ts = 20LL * i;
+    return 9.81f + 0.3f * sinf(i * 0.2f) + (float)(uniform(rng) - 0.5) * 0.02f;
+}
+
+// 不变的值，0.2Hz
+static float gen_const(int i, int64_t *ts, uint32_t *rng)
+{
+    *ts = 5000LL * i;
+    return 1.0f;
+}
+
+// 随机时间和数值（最差情况）
+static float gen_irregular(int i, int64_t *ts, uint32_t *rng)
+{
+    static int64_t t = 0;
+    t += 1 + host_rand(rng) % 100000;
+    *ts = t;
+    return (float)(host_rand(rng) % 100000) / 7.0f - 5000;
+}
+
+// 负的时间戳，间隔超出32位二阶差分，每个点都要开始新的负载
+static float gen_negative(int i, int64_t *ts, uint32_t *rng)
+{
+    *ts = -1000000000000LL * (i + 1) - host_rand(rng) % 1000;
+    return -(float)i;
+}
+
+typedef struct {
+    const char *name;
+    float (*gen)(int i, int64_t *ts, uint32_t *rng);
+    int points;
+    size_t max_bytes;           // README表格中的压缩后大小，0表示不检查
+} tsz_case_t;
+
+static const tsz_case_t cases[] = {
+    { "temperature", gen_temperature, 600, 584 },
+    { "free_heap", gen_free_heap, 600, 703 },
+    { "accel", gen_accel, 1500, 4922 },
+    { "const", gen_const, 300, 105 },
+    { "irregular", gen_irregular, 300, 2729 },
+    { "negative", gen_negative, 3, 0 },
+};
+
+static FILE *open_output(const char *name, int index, const char *mode)
+{
+    char path[512];
+    if (index < 0) {
+        snprintf(path, sizeof(path), "%s/%s.exp", out_dir, name);
+    } else {
+        snprintf(path, sizeof(path), "%s/%s_%03d.bin", out_dir, name, index);
+    }
+    FILE *f = fopen(path, mode);
+    if (!f) {
+        fprintf(stderr, "无法写入 %s\n", path);
+        exit(1);
+    }
+    return f;
+}
+
+/**
+ * @brief 结束当前负载，写入文件，返回长度
+ */
+static size_t emit(iot_tsz_writer_t *w, const char *name, int index)
+{
+    int len = iot_tsz_finish(w);
+    CHECK(len > IOT_TSZ_HEADER_LEN);
+    if (len < 0) {
+        return 0;
+    }
+    if (out_dir) {
+        FILE *f = open_output(name, index, "wb");
+        fwrite(payload, 1, len, f);
+        fclose(f);
+    }
+    return (size_t)len;
+}
+
+static void run_case(const tsz_case_t *c, uint32_t seed)
+{
+    uint32_t rng = seed;
+    FILE *exp = out_dir ? open_output(c->name, -1, "w") : NULL;
+    iot_tsz_writer_t w;
+    iot_tsz_init(&w, payload, sizeof(payload));
+    CHECK(iot_tsz_series_begin(&w, c->name));
+
+    size_t total = 0;
+    size_t json = 2;            // 数组的 "[]"
+    int payloads = 0;
+    for (int i = 0; i < c->points; i++) {
+        int64_t ts;
+        float v = c->gen(i, &ts, &rng);
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        if (exp) {
+            fprintf(exp, "%lld %08x\n", (long long)ts, bits);
+        }
+        char text[96];
+        json += snprintf(text, sizeof(text), "{\"timestamp\":%lld,\"%s\":%.7g}",
+                         (long long)ts, c->name, v) + 1;
+
+        if (!iot_tsz_append(&w, ts, v)) {
+            // 放不下：发出当前负载，新负载的第一个点必须成功
+            total += emit(&w, c->name, payloads++);
+            iot_tsz_init(&w, payload, sizeof(payload));
+            CHECK(iot_tsz_series_begin(&w, c->name));
+            CHECK(iot_tsz_append(&w, ts, v));
+        }
+    }
+    total += emit(&w, c->name, payloads++);
+    if (exp) {
+        fclose(exp);
+    }
+
+    printf("{\"test\":\"tsz\",\"data\":\"%s\",\"points\":%d,\"payloads\":%d,\"bytes\":%zu,"
+           "\"bytes_per_point\":%.2f,\"json_bytes\":%zu,\"ratio_json\":%.1f}\n",
+           c->name, c->points, payloads, total, (double)total / c->points, json,
+           (double)json / total);
+    if (c->max_bytes) {
+        CHECK(total <= c->max_bytes * 102 / 100);
+    }
+}
+
+static void test_api(void)
+{
+    iot_tsz_writer_t w;
+    uint8_t buf[64];
+
+    // 空负载只有头部，没有点的序列不写入
+    iot_tsz_init(&w, buf, sizeof(buf));
+    CHECK(iot_tsz_finish(&w) == IOT_TSZ_HEADER_LEN);
+    CHECK(buf[0] == 'T' && buf[1] == 'Z' && buf[2] == IOT_TSZ_VERSION);
+    iot_tsz_init(&w, buf, sizeof(buf));
+    CHECK(iot_tsz_series_begin(&w, "empty"));
+    CHECK(iot_tsz_finish(&w) == IOT_TSZ_HEADER_LEN);
+
+    // 没有打开的序列时不能追加
+    iot_tsz_init(&w, buf, sizeof(buf));
+    CHECK(!iot_tsz_append(&w, 0, 1.0f));
+
+    // 名称无效
+    char long_name[300];
+    memset(long_name, 'a', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    iot_tsz_init(&w, buf, sizeof(buf));
+    CHECK(!iot_tsz_series_begin(&w, long_name));
+    CHECK(iot_tsz_finish(&w) < 0);
+
+    // 缓冲区满时追加失败，已写入的点不受影响，之后的负载仍然完整
+    iot_tsz_init(&w, buf, sizeof(buf));
+    CHECK(iot_tsz_series_begin(&w, "x"));
+    int n = 0;
+    uint32_t rng = 1;
+    while (iot_tsz_append(&w, n * 1000LL, (float)host_rand(&rng))) {
+        n++;
+    }
+    CHECK(n > 1);
+    CHECK(iot_tsz_count(&w) == n);
+    int len = iot_tsz_finish(&w);
+    CHECK(len > 0 && len <= (int)sizeof(buf));
+
+    // 每个序列最多 IOT_TSZ_MAX_POINTS 个点
+    static uint8_t big[IOT_TSZ_MAX_POINTS / 4 + 256];     // 不变的点每点2位
+    iot_tsz_init(&w, big, sizeof(big));
+    CHECK(iot_tsz_series_begin(&w, "max"));
+    int appended = 0;
+    for (int i = 0; i < IOT_TSZ_MAX_POINTS; i++) {
+        appended += iot_tsz_append(&w, i * 1000LL, 1.0f);
+    }
+    CHECK(appended == IOT_TSZ_MAX_POINTS);
+    CHECK(!iot_tsz_append(&w, IOT_TSZ_MAX_POINTS * 1000LL, 1.0f));
+    CHECK(iot_tsz_finish(&w) > 0);
+}
+
+int main(int argc, char **argv)
+{
+    out_dir = argc > 1 ? argv[1] : NULL;
+    test_api();
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        run_case(&cases[i], (uint32_t)i + 1);
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,216 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - 采样窗口聚合测试
+ *
+ * 与排序后按最近秩取的精确百分位比较。样本数不超过 IOT_WINDOW_EXACT_MAX 时必须相等；
+ * 超过后P²的误差按秩衡量（估计值在样本中的位置与p的差），检查 iot_window.h 中
+ * 给出的误差上限。每种分布、每个样本数区间输出一行JSON记录实测的最大秩误差。
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include "host_test.h"
+#include "iot_window.h"
+
+#define MAX_SAMPLES     20000
+
+static float samples[MAX_SAMPLES];
+static float sorted[MAX_SAMPLES];
+static uint32_t sample_index;
+
+static int cmp_float(const void *a, const void *b)
+{
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return x < y ? -1 : x > y;
+}
+
+static float gen_uniform(uint32_t *rng)
+{
+    return (host_rand(rng) >> 8) / 16777216.0f * 100;
+}
+
+static float gen_normal(uint32_t *rng)
+{
+    float s = 0;
+    for (int i = 0; i < 12; i++) {
+        s += (host_rand(rng) >> 8) / 16777216.0f;
+    }
+    return 25 + (s - 6) * 2;
+}
+
+static float gen_exponential(uint32_t *rng)
+{
+    return -50 * logf(((host_rand(rng) >> 8) + 1) / 16777217.0f);
+}
+
+// 20~21之间的读数，每100个样本中恰好1个1000以上的异常值
+static float gen_outlier(uint32_t *rng)
+{
+    float x = gen_uniform(rng);
+    return sample_index % 100 == 99 ? 1000 + x : 20 + x / 100;
+}
+
+typedef struct {
+    const char *name;
+    float (*gen)(uint32_t *rng);
+} dist_t;
+
+static const dist_t dists[] = {
+    { "uniform", gen_uniform },
+    { "normal", gen_normal },
+    { "exponential", gen_exponential },
+    { "outlier_1pct", gen_outlier },
+};
+
+/**
+ * @brief 生成n个样本加入窗口，并把样本排序到sorted
+ */
+static void fill(iot_window_t *w, const dist_t *d, uint32_t n, uint32_t seed)
+{
+    uint32_t rng = seed;
+    iot_window_reset(w);
+    for (sample_index = 0; sample_index < n; sample_index++) {
+        samples[sample_index] = d->gen(&rng);
+        iot_window_add(w, samples[sample_index]);
+    }
+    memcpy(sorted, samples, n * sizeof(float));
+    qsort(sorted, n, sizeof(float), cmp_float);
+}
+
+static float nearest_rank(uint32_t n, int p)
+{
+    uint32_t rank = (p * n + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+/**
+ * @brief 估计值的秩误差：p落在 [小于est的比例, 不大于est的比例] 之外的距离
+ */
+static float rank_error(uint32_t n, float est, int p)
+{
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        lo += sorted[i] < est;
+        hi += sorted[i] <= est;
+    }
+    float t = p / 100.0f;
+    if (t < (float)lo / n) {
+        return (float)lo / n - t;
+    }
+    if (t > (float)hi / n) {
+        return t - (float)hi / n;
+    }
+    return 0;
+}
+
+static void test_exact(void)
+{
+    iot_window_result_t res;
+    iot_window_t w;
+    iot_window_reset(&w);
+    CHECK(!iot_window_get(&w, &res));
+
+    // 不超过 IOT_WINDOW_EXACT_MAX 个样本以及切换到P²的第一个样本，百分位都是精确值
+    for (size_t d = 0; d < sizeof(dists) / sizeof(dists[0]); d++) {
+        for (uint32_t n = 1; n <= IOT_WINDOW_EXACT_MAX + 1; n++) {
+            fill(&w, &dists[d], n, 1000 + n);
+            CHECK(iot_window_get(&w, &res));
+            CHECK(res.count == n);
+            CHECK(res.min == sorted[0] && res.max == sorted[n - 1]);
+            for (int i = 0; i < IOT_WINDOW_PERCENTILES; i++) {
+                float expect = nearest_rank(n, iot_window_percentiles[i]);
+                if (res.pct[i] != expect) {
+                    fprintf(stderr, "%s n=%u p%u: %g，应为%g\n", dists[d].name, n,
+                            iot_window_percentiles[i], res.pct[i], expect);
+                    host_test_failures++;
+                }
+            }
+        }
+    }
+
+    // NaN被忽略
+    iot_window_reset(&w);
+    iot_window_add(&w, NAN);
+    iot_window_add(&w, 3);
+    CHECK(iot_window_get(&w, &res) && res.count == 1 && res.pct[0] == 3);
+}
+
+// 样本数区间和 iot_window.h 中给出的秩误差上限
+static const struct {
+    uint32_t from;
+    uint32_t to;
+    float bound;
+} bands[] = {
+    { IOT_WINDOW_EXACT_MAX + 1, 100, 0.25f },
+    { 100, 500, 0.10f },
+    { 500, 2000, 0.04f },
+    { 2000, MAX_SAMPLES, 0.01f },
+};
+
+static void test_p2_bounds(void)
+{
+    iot_window_t w;
+    iot_window_result_t res;
+
+    // 平滑分布
+    for (size_t d = 0; d < 3; d++) {
+        for (size_t b = 0; b < sizeof(bands) / sizeof(bands[0]); b++) {
+            float worst[IOT_WINDOW_PERCENTILES] = { 0 };
+            uint32_t step = (bands[b].to - bands[b].from) / 12 + 1;
+            for (uint32_t n = bands[b].from; n < bands[b].to; n += step) {
+                for (uint32_t seed = 1; seed <= 12; seed++) {
+                    fill(&w, &dists[d], n, seed * 7919);
+                    iot_window_get(&w, &res);
+                    for (int i = 0; i < IOT_WINDOW_PERCENTILES; i++) {
+                        float err = rank_error(n, res.pct[i], iot_window_percentiles[i]);
+                        worst[i] = fmaxf(worst[i], err);
+                    }
+                }
+            }
+            printf("{\"test\":\"window_p2\",\"dist\":\"%s\",\"n_from\":%u,\"n_to\":%u,"
+                   "\"rank_err_p50\":%.3f,\"rank_err_p90\":%.3f,\"rank_err_p99\":%.3f}\n",
+                   dists[d].name, bands[b].from, bands[b].to, worst[0], worst[1], worst[2]);
+            for (int i = 0; i < IOT_WINDOW_PERCENTILES; i++) {
+                CHECK(worst[i] <= bands[b].bound);
+            }
+        }
+    }
+}
+
+static void test_outliers(void)
+{
+    iot_window_t w;
+    iot_window_result_t res;
+    const dist_t *d = &dists[3];
+
+    // 少于100个样本时p99的最近秩就是最大值
+    fill(&w, d, 99, 1);
+    iot_window_get(&w, &res);
+    CHECK(res.pct[2] == res.max);
+
+    // 恰好1%异常值时，p99落在正常读数和异常值之间的空档：最近秩是正常读数的最大值，
+    // P²给出空档中的插值，秩误差仍然很小；p50/p90的数值误差在2%以内
+    for (uint32_t n = 100; n <= MAX_SAMPLES; n *= 2) {
+        fill(&w, d, n, n);
+        iot_window_get(&w, &res);
+        float exact_p99 = nearest_rank(n, 99);
+        float outlier_min = sorted[n - n / 100];
+        CHECK(fabsf(res.pct[0] - nearest_rank(n, 50)) <= 0.02f * nearest_rank(n, 50));
+        CHECK(fabsf(res.pct[1] - nearest_rank(n, 90)) <= 0.02f * nearest_rank(n, 90));
+        CHECK(res.pct[2] >= 20 && res.pct[2] <= outlier_min);
+        CHECK(rank_error(n, res.pct[2], 99) <= 0.05f);
+        printf("{\"test\":\"window_outlier\",\"n\":%u,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,"
+               "\"exact_p99\":%.2f}\n", n, res.pct[0], res.pct[1], res.pct[2], exact_p99);
+    }
+}
+
+int main(void)
+{
+    test_exact();
+    test_p2_bounds();
+    test_outliers();
+    return TEST_RESULT();
+}
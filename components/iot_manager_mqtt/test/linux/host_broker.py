@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author: xingnian j_xingnian@163.com
+@Date: 2025-11-10
+@Description: IoT管理组件 - 测试用的最小MQTT 3.1.1服务器和订阅端
+
+没有安装mosquitto时由 run_host_test.py 使用，作为独立进程运行，可以被杀掉再重启。
+只实现测试需要的部分：QoS0/1发布（QoS2降为1）、通配符订阅、遗嘱、心跳；不保存会话和保留消息。
+QoS1消息先转发给订阅端再回PUBACK，与mosquitto一样不限制订阅端的在途消息数。
+
+用法:
+  host_broker.py serve --port 18830
+  host_broker.py sub --port 18830 -t <topic> [-q 1]   输出"SUBACK"后每行一条消息负载
+"""
+
+import argparse
+import asyncio
+import struct
+import sys
+
+CONNECT, CONNACK, PUBLISH, PUBACK = 1, 2, 3, 4
+SUBSCRIBE, SUBACK, UNSUBSCRIBE, UNSUBACK = 8, 9, 10, 11
+PINGREQ, PINGRESP, DISCONNECT = 12, 13, 14
+
+
+async def read_packet(reader):
+    """读取一个报文，返回 (首字节, 报文体)"""
+    first = (await reader.readexactly(1))[0]
+    length, shift = 0, 0
+    while True:
+        b = (await reader.readexactly(1))[0]
+        length |= (b & 0x7f) << shift
+        shift += 7
+        if not b & 0x80:
+            break
+    return first, await reader.readexactly(length)
+
+
+def packet(first, body=b''):
+    out = bytearray([first])
+    n = len(body)
+    while True:
+        b = n % 128
+        n //= 128
+        out.append(b | (0x80 if n else 0))
+        if not n:
+            break
+    return bytes(out) + body
+
+
+def mqtt_str(data, pos):
+    n = struct.unpack_from('>H', data, pos)[0]
+    return data[pos + 2:pos + 2 + n], pos + 2 + n
+
+
+def enc_str(s):
+    return struct.pack('>H', len(s)) + s
+
+
+def topic_matches(filt, topic):
+    f, t = filt.split('/'), topic.split('/')
+    for i, part in enumerate(f):
+        if part == '#':
+            return True
+        if i >= len(t) or (part != '+' and part != t[i]):
+            return False
+    return len(f) == len(t)
+
+
+class Session:
+    def __init__(self, broker, writer):
+        self.broker = broker
+        self.writer = writer
+        self.subs = {}          # 主题过滤器 -> QoS
+        self.next_id = 0
+        self.will = None
+
+    def send(self, data):
+        if not self.writer.is_closing():
+            self.writer.write(data)
+
+    def deliver(self, topic, payload, qos):
+        qos = min(qos, max((q for f, q in self.subs.items() if topic_matches(f, topic)),
+                           default=-1))
+        if qos < 0:
+            return
+        body = enc_str(topic.encode())
+        if qos:
+            self.next_id = self.next_id % 65535 + 1
+            body += struct.pack('>H', self.next_id)
+        self.send(packet((PUBLISH << 4) | (qos << 1), body + payload))
+
+
+class Broker:
+    def __init__(self):
+        self.sessions = set()
+
+    def publish(self, topic, payload, qos):
+        for s in list(self.sessions):
+            s.deliver(topic, payload, qos)
+
+    async def handle(self, reader, writer):
+        session = Session(self, writer)
+        clean = False
+        try:
+            first, body = await read_packet(reader)
+            if first >> 4 != CONNECT:
+                return
+            flags = body[7]
+            keepalive = struct.unpack_from('>H', body, 8)[0]
+            _, pos = mqtt_str(body, 10)             # 客户端标识
+            if flags & 0x04:
+                topic, pos = mqtt_str(body, pos)
+                msg, pos = mqtt_str(body, pos)
+                session.will = (topic.decode(), msg, min((flags >> 3) & 3, 1))
+            self.sessions.add(session)
+            session.send(packet(CONNACK << 4, b'\x00\x00'))
+            timeout = keepalive * 1.5 if keepalive else None
+            while True:
+                first, body = await asyncio.wait_for(read_packet(reader), timeout)
+                kind = first >> 4
+                if kind == PUBLISH:
+                    qos = min((first >> 1) & 3, 1)
+                    topic, pos = mqtt_str(body, 0)
+                    if (first >> 1) & 3:
+                        msg_id = body[pos:pos + 2]
+                        pos += 2
+                    self.publish(topic.decode(), body[pos:], qos)
+                    if (first >> 1) & 3:
+                        session.send(packet(PUBACK << 4, msg_id))
+                elif kind == SUBSCRIBE:
+                    msg_id, pos, granted = body[:2], 2, bytearray()
+                    while pos < len(body):
+                        filt, pos = mqtt_str(body, pos)
+                        qos = min(body[pos], 1)
+                        pos += 1
+                        session.subs[filt.decode()] = qos
+                        granted.append(qos)
+                    session.send(packet((SUBACK << 4), msg_id + bytes(granted)))
+                elif kind == UNSUBSCRIBE:
+                    pos = 2
+                    while pos < len(body):
+                        filt, pos = mqtt_str(body, pos)
+                        session.subs.pop(filt.decode(), None)
+                    session.send(packet(UNSUBACK << 4, body[:2]))
+                elif kind == PINGREQ:
+                    session.send(packet(PINGRESP << 4))
+                elif kind == DISCONNECT:
+                    clean = True
+                    return
+                await writer.drain()
+        except (asyncio.IncompleteReadError, asyncio.TimeoutError, ConnectionError, IndexError,
+                struct.error):
+            pass
+        finally:
+            self.sessions.discard(session)
+            if session.will and not clean:
+                self.publish(*session.will)
+            writer.close()
+
+
+async def serve(args):
+    broker = Broker()
+    server = await asyncio.start_server(broker.handle, '127.0.0.1', args.port)
+    async with server:
+        await server.serve_forever()
+
+
+async def subscribe(args):
+    reader, writer = await asyncio.open_connection('127.0.0.1', args.port)
+    writer.write(packet(CONNECT << 4, enc_str(b'MQTT') + b'\x04\x02\x00\x3c' + enc_str(b'sub')))
+    writer.write(packet((SUBSCRIBE << 4) | 2, b'\x00\x01' + enc_str(args.t.encode()) +
+                        bytes([args.q])))
+    out = sys.stdout.buffer
+    while True:
+        first, body = await read_packet(reader)
+        kind = first >> 4
+        if kind == SUBACK:
+            out.write(b'SUBACK\n')
+        elif kind == PUBLISH:
+            _, pos = mqtt_str(body, 0)
+            if (first >> 1) & 3:
+                writer.write(packet(PUBACK << 4, body[pos:pos + 2]))
+                pos += 2
+            out.write(body[pos:] + b'\n')
+        out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('mode', choices=['serve', 'sub'])
+    parser.add_argument('--port', type=int, default=18830)
+    parser.add_argument('-t', help='sub: topic filter')
+    parser.add_argument('-q', type=int, default=1, help='sub: QoS')
+    args = parser.parse_args()
+    try:
+        asyncio.run(serve(args) if args.mode == 'serve' else subscribe(args))
+    except (KeyboardInterrupt, asyncio.IncompleteReadError, ConnectionError, BrokenPipeError):
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,339 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: IoT管理组件 - Linux主机测试程序
+ *
+ * 在ESP-IDF的linux目标上运行iot_manager，连接本机mosquitto（sdkconfig.defaults中的
+ * IOT_BROKER_URL）。由 run_host_test.py 启动，环境变量 IOT_HOST_MODE 选择场景，
+ * 结果以一行JSON写到标准输出，退出码0表示通过。
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "iot_manager.h"
+#include "iot_reconnect.h"
+
+/**
+ * @brief 读取整数环境变量
+ */
+static long env_long(const char *name, long def)
+{
+    const char *v = getenv(name);
+    return v ? atol(v) : def;
+}
+
+/**
+ * @brief 等待MQTT连接
+ *
+ * @return true 已连接
+ */
+static bool wait_connected(int timeout_ms)
+{
+    for (int t = 0; t < timeout_ms; t += 50) {
+        if (iot_manager_is_connected()) {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    return false;
+}
+
+/**
+ * @brief 离线缓存场景
+ *
+ * 按固定间隔发布 {"seq":N}，期间脚本杀掉并重启mosquitto。断线期间的消息
+ * 进入离线缓存，重连后按顺序补发；订阅端检查序号连续、有序。
+ */
+static int run_offline(void)
+{
+    long count = env_long("IOT_HOST_COUNT", 300);
+    long interval_ms = env_long("IOT_HOST_INTERVAL_MS", 50);
+
+    if (!wait_connected(10000)) {
+        printf("{\"test\":\"offline\",\"error\":\"connect timeout\"}\n");
+        return 1;
+    }
+    printf("connected\n");
+    fflush(stdout);
+
+    long rejected = 0;
+    uint32_t max_buffered = 0;
+    for (long seq = 0; seq < count; seq++) {
+        char msg[32];
+        snprintf(msg, sizeof(msg), "{\"seq\":%ld}", seq);
+        if (iot_manager_report_properties(msg) < 0) {
+            rejected++;
+        }
+        uint32_t buffered = iot_manager_get_offline_count();
+        if (buffered > max_buffered) {
+            max_buffered = buffered;
+        }
+        vTaskDelay(pdMS_TO_TICKS(interval_ms));
+    }
+
+    // 等待重连并补发完
+    int64_t deadline_us = esp_timer_get_time() + 60 * 1000000LL;
+    while (esp_timer_get_time() < deadline_us &&
+           (!iot_manager_is_connected() || iot_manager_get_offline_count() > 0)) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    // 留出时间收QoS1确认
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    iot_manager_stats_t stats;
+    iot_manager_get_stats(&stats);
+    uint32_t left = iot_manager_get_offline_count();
+    printf("{\"test\":\"offline\",\"sent\":%ld,\"rejected\":%ld,\"max_buffered\":%lu,"
+           "\"left\":%lu,\"dropped\":%lu}\n",
+           count, rejected, (unsigned long)max_buffered, (unsigned long)left,
+           (unsigned long)stats.dropped);
+    return (rejected == 0 && left == 0 && stats.dropped == 0) ? 0 : 1;
+}
+
+/* ==================== 发布基准 ==================== */
+
+#define BENCH_TOPIC     "bench/host-test"
+
+// 确认延迟直方图各桶的上界（与 iot_manager.h 中 IOT_STATS_LATENCY_BUCKETS 的说明一致）
+static const uint32_t latency_bounds_ms[IOT_STATS_LATENCY_BUCKETS - 1] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000,
+};
+
+static long bench_payload;
+static int bench_qos;
+static atomic_long bench_next_seq;
+static long bench_count;
+static atomic_long bench_queue_full;
+static atomic_int bench_producers_done;
+static atomic_long heap_peak;
+static atomic_bool heap_sampling;
+
+/**
+ * @brief 当前堆占用（字节），不支持时返回-1
+ *
+ * 只统计主分配区，bench开始时用 M_ARENA_MAX 让所有线程都在主分配区分配。
+ */
+static long heap_in_use(void)
+{
+#ifdef __GLIBC__
+    return (long)mallinfo2().uordblks;
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief 每毫秒采样一次堆占用，记录峰值
+ */
+static void heap_sampler_task(void *arg)
+{
+    while (heap_sampling) {
+        long used = heap_in_use();
+        long peak = atomic_load(&heap_peak);
+        while (used > peak && !atomic_compare_exchange_weak(&heap_peak, &peak, used)) {
+        }
+        vTaskDelay(1);
+    }
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 发布任务：按全局序号发布 {"seq":N,"p":"xx…"}，填充到bench_payload字节
+ *
+ * 发送队列满时让出CPU后重试（发布接口不阻塞），记录重试次数。
+ */
+static void producer_task(void *arg)
+{
+    char *msg = arg;
+    for (;;) {
+        long seq = atomic_fetch_add(&bench_next_seq, 1);
+        if (seq >= bench_count) {
+            break;
+        }
+        int len = snprintf(msg, bench_payload + 1, "{\"seq\":%ld,\"p\":\"", seq);
+        if (len + 2 <= bench_payload) {
+            memset(msg + len, 'x', bench_payload - len - 2);
+            memcpy(msg + bench_payload - 2, "\"}", 2);
+            len = bench_payload;
+        } else if (len > bench_payload) {
+            len = bench_payload;            // 太短时只有截断的序号
+        }
+        while (iot_manager_publish(BENCH_TOPIC, msg, len, bench_qos, 0) != 0) {
+            atomic_fetch_add(&bench_queue_full, 1);
+            vTaskDelay(1);
+        }
+    }
+    atomic_fetch_add(&bench_producers_done, 1);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 从直方图增量估计百分位（桶内线性插值），最后一桶取最大值
+ */
+static double latency_percentile(const uint32_t *hist, uint32_t total, double p, uint32_t max_ms)
+{
+    if (total == 0) {
+        return 0;
+    }
+    double rank = p * total;
+    uint32_t below = 0;
+    for (int i = 0; i < IOT_STATS_LATENCY_BUCKETS; i++) {
+        if (below + hist[i] >= rank && hist[i] > 0) {
+            if (i == IOT_STATS_LATENCY_BUCKETS - 1) {
+                return max_ms;
+            }
+            double lo = i ? latency_bounds_ms[i - 1] : 0;
+            double hi = latency_bounds_ms[i];
+            double v = lo + (hi - lo) * (rank - below) / hist[i];
+            return v < max_ms ? v : max_ms;
+        }
+        below += hist[i];
+    }
+    return max_ms;
+}
+
+/**
+ * @brief 发布吞吐量和延迟基准
+ *
+ * IOT_HOST_PRODUCERS个任务并发发布共IOT_HOST_COUNT条IOT_HOST_PAYLOAD字节的消息（QoS为
+ * IOT_HOST_QOS），直到全部发出（QoS1全部确认）。吞吐量和字节数取自组件的发布统计，
+ * 确认延迟取自统计中的直方图，堆峰值为运行期间堆占用的最大值减去开始前的值。
+ */
+static int run_bench(void)
+{
+    bench_payload = env_long("IOT_HOST_PAYLOAD", 256);
+    bench_qos = (int)env_long("IOT_HOST_QOS", 1);
+    bench_count = env_long("IOT_HOST_COUNT", 2000);
+    int producers = (int)env_long("IOT_HOST_PRODUCERS", 1);
+
+    if (!wait_connected(10000)) {
+        printf("{\"bench\":\"publish\",\"error\":\"connect timeout\"}\n");
+        return 1;
+    }
+    printf("connected\n");
+    fflush(stdout);
+
+    char *msgs[producers];
+    for (int i = 0; i < producers; i++) {
+        msgs[i] = malloc(bench_payload + 1);
+        if (!msgs[i]) {
+            return 1;
+        }
+    }
+    // 连接后的上线消息等发完再开始
+    vTaskDelay(pdMS_TO_TICKS(500));
+
+    iot_manager_stats_t before, after;
+    iot_manager_get_stats(&before);
+    long heap_base = heap_in_use();
+    atomic_store(&heap_peak, heap_base);
+    heap_sampling = true;
+    xTaskCreate(heap_sampler_task, "heap_sampler", 4096, NULL, 4, NULL);
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < producers; i++) {
+        xTaskCreate(producer_task, "producer", 4096, msgs[i], 5, NULL);
+    }
+
+    // 等待全部发出并确认。发送队列满时发布任务重试，dropped中的这部分消息之后仍会发出，
+    // 所以只按发出的条数判断
+    int64_t deadline_us = start_us + 120 * 1000000LL;
+    bool done = false;
+    while (!done && esp_timer_get_time() < deadline_us) {
+        vTaskDelay(1);
+        iot_manager_get_stats(&after);
+        done = atomic_load(&bench_producers_done) == producers &&
+               after.traffic[IOT_MSG_CLASS_CUSTOM].messages -
+               before.traffic[IOT_MSG_CLASS_CUSTOM].messages >= (uint32_t)bench_count &&
+               after.in_flight == 0;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    heap_sampling = false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    uint32_t messages = after.traffic[IOT_MSG_CLASS_CUSTOM].messages -
+                        before.traffic[IOT_MSG_CLASS_CUSTOM].messages;
+    uint64_t bytes = after.traffic[IOT_MSG_CLASS_CUSTOM].bytes -
+                     before.traffic[IOT_MSG_CLASS_CUSTOM].bytes;
+    uint32_t hist[IOT_STATS_LATENCY_BUCKETS];
+    uint32_t acked = 0;
+    for (int i = 0; i < IOT_STATS_LATENCY_BUCKETS; i++) {
+        hist[i] = after.ack_latency_hist[i] - before.ack_latency_hist[i];
+        acked += hist[i];
+    }
+    double sec = elapsed_us / 1e6;
+
+    printf("{\"bench\":\"publish\",\"payload\":%ld,\"qos\":%d,\"producers\":%d,\"count\":%ld,"
+           "\"messages\":%lu,\"dropped\":%lu,\"elapsed_ms\":%.1f,\"msgs_per_sec\":%.1f,"
+           "\"bytes_per_sec\":%.1f,\"acked\":%lu,\"ack_p50_ms\":%.1f,\"ack_p99_ms\":%.1f,"
+           "\"ack_avg_ms\":%.2f,\"ack_max_ms\":%lu,\"inflight_peak\":%u,\"queue_full\":%ld,"
+           "\"heap_peak_bytes\":%ld,\"done\":%s}\n",
+           bench_payload, bench_qos, producers, bench_count,
+           (unsigned long)messages, (unsigned long)(after.dropped - before.dropped),
+           elapsed_us / 1000.0, messages / sec, bytes / sec, (unsigned long)acked,
+           latency_percentile(hist, acked, 0.50, after.ack_latency_max_ms),
+           latency_percentile(hist, acked, 0.99, after.ack_latency_max_ms),
+           acked ? (double)(after.ack_latency_sum_ms - before.ack_latency_sum_ms) / acked : 0,
+           (unsigned long)after.ack_latency_max_ms, after.in_flight_peak,
+           atomic_load(&bench_queue_full),
+           heap_base < 0 ? -1 : atomic_load(&heap_peak) - heap_base, done ? "true" : "false");
+    for (int i = 0; i < producers; i++) {
+        free(msgs[i]);
+    }
+    return done && messages == (uint32_t)bench_count ? 0 : 1;
+}
+
+// 测试场景
+static const struct {
+    const char *name;
+    int (*run)(void);
+} modes[] = {
+    { "offline", run_offline },
+    { "bench", run_bench },
+};
+
+void app_main(void)
+{
+    const char *mode = getenv("IOT_HOST_MODE");
+    int (*run)(void) = NULL;
+    for (size_t i = 0; mode && i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strcmp(mode, modes[i].name) == 0) {
+            run = modes[i].run;
+        }
+    }
+    if (!run) {
+        fprintf(stderr, "未知的IOT_HOST_MODE: %s\n", mode ? mode : "(未设置)");
+        exit(2);
+    }
+
+#ifdef __GLIBC__
+    // 所有线程在主分配区分配，mallinfo2() 能统计到全部堆占用（bench的堆峰值）
+    mallopt(M_ARENA_MAX, 1);
+#endif
+    esp_event_loop_create_default();
+    // linux目标没有WiFi，网络始终可用
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+
+    iot_manager_config_t config = {
+        .device_id = "host-test",
+        .device_name = "host-test",
+        .device_type = "linux",
+    };
+    if (iot_manager_init(&config) != ESP_OK || iot_manager_start() != ESP_OK) {
+        fprintf(stderr, "iot_manager启动失败\n");
+        exit(2);
+    }
+
+    int rc = run();
+    fflush(stdout);
+    exit(rc);
+}
@@ -0,0 +1,353 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author: xingnian j_xingnian@163.com
+@Date: 2025-11-10
+@Description: IoT管理组件 - Linux主机测试驱动
+
+用法: run_host_test.py <场景> [--app build/iot_manager_host.elf]
+
+在本机端口18830启动mosquitto，运行 idf.py 构建的linux目标程序（host_main.c），或
+../host 的CMake构建中同一程序的主机版本（iot_manager_host），按场景操作服务器并检查
+订阅端收到的消息。结果以一行JSON输出，失败时退出码非0。
+没有安装mosquitto时使用 host_broker.py（最小MQTT服务器和订阅端），结果中broker字段注明。
+
+场景:
+  offline   发布期间杀掉mosquitto，停几秒后重启，检查断线期间的消息在重连后
+            按顺序补发，两段订阅拼起来序号从0开始连续、无缺失
+  bench     发布基准：对每种负载大小、QoS、发布任务数的组合各启动一次程序，
+            输出每秒消息数和字节数、确认延迟p50/p99、堆峰值，并核对订阅端收到的条数。
+            每个组合一行JSON，--out 指定时追加写入文件（带提交号，便于按提交绘图）
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import signal
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+PORT = 18830
+HERE = os.path.dirname(os.path.abspath(__file__))
+HOST_BROKER = os.path.join(HERE, 'host_broker.py')
+USE_MOSQUITTO = bool(shutil.which('mosquitto') and shutil.which('mosquitto_sub'))
+BROKER_NAME = 'mosquitto' if USE_MOSQUITTO else 'host_broker.py'
+PROPERTY_TOPIC = 'device/host-test/data'
+BENCH_TOPIC = 'bench/host-test'
+
+
+START = time.monotonic()
+
+
+def log(text):
+    """进度输出到标准错误，与被测程序的日志（IOT_HOST_LOG）交错在一起"""
+    print('[%9.3f] run_host_test: %s' % (time.monotonic() - START, text), file=sys.stderr,
+          flush=True)
+
+
+def sub_command(topic, qos):
+    """订阅命令：输出含SUBACK的一行后，每行一条消息"""
+    if USE_MOSQUITTO:
+        # -d 输出调试信息，用SUBACK判断订阅已生效
+        return ['mosquitto_sub', '-h', '127.0.0.1', '-p', str(PORT), '-t', topic,
+                '-q', str(qos), '-d']
+    return [sys.executable, HOST_BROKER, 'sub', '--port', str(PORT), '-t', topic, '-q', str(qos)]
+
+
+class Broker:
+    """本机MQTT服务器（mosquitto或host_broker.py）"""
+
+    def __init__(self, workdir, extra_conf=''):
+        self.conf = os.path.join(workdir, 'mosquitto.conf')
+        with open(self.conf, 'w') as f:
+            f.write('listener %d 127.0.0.1\nallow_anonymous true\n' % PORT)
+            f.write(extra_conf)
+        self.proc = None
+
+    def start(self):
+        cmd = (['mosquitto', '-c', self.conf] if USE_MOSQUITTO else
+               [sys.executable, HOST_BROKER, 'serve', '--port', str(PORT)])
+        self.proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        deadline = time.time() + 5
+        while time.time() < deadline:
+            try:
+                socket.create_connection(('127.0.0.1', PORT), timeout=0.2).close()
+                return
+            except OSError:
+                time.sleep(0.05)
+        raise RuntimeError('%s did not start' % BROKER_NAME)
+
+    def kill(self):
+        self.proc.send_signal(signal.SIGKILL)
+        self.proc.wait()
+
+
+class Subscriber:
+    """订阅端，收集JSON消息"""
+
+    def __init__(self, topic, qos=1):
+        self.messages = []
+        self.subscribed = threading.Event()
+        self.proc = subprocess.Popen(sub_command(topic, qos),
+                                     stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                                     text=True)
+        self.thread = threading.Thread(target=self._read, daemon=True)
+        self.thread.start()
+        if not self.subscribed.wait(5):
+            raise RuntimeError('subscriber did not subscribe')
+
+    def _read(self):
+        for line in self.proc.stdout:
+            line = line.strip()
+            if 'SUBACK' in line:
+                self.subscribed.set()
+            elif line.startswith('{'):
+                self.messages.append(json.loads(line))
+
+    def stop(self):
+        self.proc.terminate()
+        self.proc.wait()
+        self.thread.join(1)
+        return self.messages
+
+
+class App:
+    """被测程序，逐行读取标准输出"""
+
+    def __init__(self, path, mode, env=None):
+        full_env = dict(os.environ, IOT_HOST_MODE=mode, **(env or {}))
+        self.proc = subprocess.Popen([path], stdout=subprocess.PIPE, text=True, env=full_env)
+        self.lines = []
+        self.cond = threading.Condition()
+        threading.Thread(target=self._read, daemon=True).start()
+
+    def _read(self):
+        for line in self.proc.stdout:
+            with self.cond:
+                self.lines.append(line.strip())
+                self.cond.notify_all()
+
+    def wait_line(self, text, timeout):
+        with self.cond:
+            return self.cond.wait_for(lambda: text in self.lines, timeout)
+
+    def result(self, timeout):
+        """等待退出，返回最后一行JSON结果和退出码"""
+        self.proc.wait(timeout)
+        time.sleep(0.1)
+        for line in reversed(self.lines):
+            if line.startswith('{'):
+                return json.loads(line), self.proc.returncode
+        return None, self.proc.returncode
+
+
+def in_order(seqs):
+    """去掉QoS1重复投递后序号严格递增"""
+    out = []
+    for s in seqs:
+        if out and s == out[-1]:
+            continue
+        if out and s < out[-1]:
+            return None
+        out.append(s)
+    return out
+
+
+def run_offline(args, workdir):
+    count, outage_sec = 300, 3
+    broker = Broker(workdir)
+    broker.start()
+    log('%s started, subscriber on %s' % (BROKER_NAME, PROPERTY_TOPIC))
+    before = Subscriber(PROPERTY_TOPIC)
+    app = App(args.app, 'offline', {'IOT_HOST_COUNT': str(count), 'IOT_HOST_INTERVAL_MS': '50'})
+    try:
+        if not app.wait_line('connected', 15):
+            raise RuntimeError('app did not connect')
+        log('app connected, publishing %d messages every 50 ms' % count)
+        time.sleep(2)
+        broker.kill()
+        first = before.stop()
+        log('%s killed, subscriber got %d messages' % (BROKER_NAME, len(first)))
+        time.sleep(outage_sec)
+        # 重连退避至少为IOT_RECONNECT_BASE_MS的一半，订阅端先于设备连上
+        broker.start()
+        after = Subscriber(PROPERTY_TOPIC)
+        log('%s restarted after %d s, new subscriber ready' % (BROKER_NAME, outage_sec))
+        result, rc = app.result(120)
+        second = after.stop()
+        log('app exited with %s, second subscriber got %d messages' % (rc, len(second)))
+    finally:
+        if app.proc.poll() is None:
+            app.proc.kill()
+        if broker.proc.poll() is None:
+            broker.kill()
+
+    a = in_order([m['seq'] for m in first])
+    b = in_order([m['seq'] for m in second])
+    errors = []
+    if a is None or b is None:
+        errors.append('out of order')
+    else:
+        seen = sorted(set(a) | set(b))
+        if seen != list(range(count)):
+            missing = sorted(set(range(count)) - set(seen))
+            errors.append('missing %d: %s' % (len(missing), missing[:10]))
+        if not b:
+            errors.append('nothing received after restart')
+    if rc != 0:
+        errors.append('app exit code %s' % rc)
+
+    report = {
+        'test': 'offline',
+        'count': count,
+        'outage_sec': outage_sec,
+        'before_restart': len(first),
+        'after_restart': len(second),
+        'app': result,
+        'broker': BROKER_NAME,
+        'errors': errors,
+    }
+    print(json.dumps(report))
+    return not errors
+
+
+class SeqCounter:
+    """订阅端，统计收到的消息条数和不同序号数（负载可能被截断，不按JSON解析）"""
+
+    SEQ = re.compile(r'"seq":(\d+)')
+
+    def __init__(self, topic, qos=1):
+        self.received = 0
+        self.seqs = set()
+        self.subscribed = threading.Event()
+        self.proc = subprocess.Popen(sub_command(topic, qos),
+                                     stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                                     text=True, errors='replace')
+        self.thread = threading.Thread(target=self._read, daemon=True)
+        self.thread.start()
+        if not self.subscribed.wait(5):
+            raise RuntimeError('subscriber did not subscribe')
+
+    def _read(self):
+        for line in self.proc.stdout:
+            if 'SUBACK' in line:
+                self.subscribed.set()
+            elif line.startswith('{'):
+                self.received += 1
+                m = self.SEQ.match(line, 1)
+                if m:
+                    self.seqs.add(int(m.group(1)))
+
+    def delivered(self, by_seq):
+        """按序号去重后的条数；负载放不下序号时只能按收到的条数"""
+        return len(self.seqs) if by_seq else self.received
+
+    def wait(self, count, by_seq, timeout):
+        deadline = time.time() + timeout
+        while self.delivered(by_seq) < count and time.time() < deadline:
+            time.sleep(0.05)
+
+    def stop(self):
+        self.proc.terminate()
+        self.proc.wait()
+        self.thread.join(1)
+
+
+def git_commit():
+    """当前提交号，不在git仓库中时为None"""
+    try:
+        out = subprocess.run(['git', 'rev-parse', '--short', 'HEAD'], capture_output=True,
+                             text=True, cwd=HERE)
+        return out.stdout.strip() or None
+    except OSError:
+        return None
+
+
+def run_bench(args, workdir):
+    # 订阅端来不及接收时服务器不丢弃QoS1消息
+    broker = Broker(workdir, 'max_queued_messages 0\nmax_inflight_messages 0\n')
+    broker.start()
+    commit = git_commit()
+    ok = True
+    out = open(args.out, 'a') if args.out else None
+    try:
+        for size in args.sizes:
+            for qos in args.qos:
+                for producers in args.producers:
+                    sub = SeqCounter(BENCH_TOPIC)
+                    app = App(args.app, 'bench', {
+                        'IOT_HOST_PAYLOAD': str(size),
+                        'IOT_HOST_QOS': str(qos),
+                        'IOT_HOST_PRODUCERS': str(producers),
+                        'IOT_HOST_COUNT': str(args.count),
+                    })
+                    by_seq = size >= 24
+                    try:
+                        result, rc = app.result(180)
+                        sub.wait(args.count, by_seq, 5)
+                    finally:
+                        if app.proc.poll() is None:
+                            app.proc.kill()
+                        sub.stop()
+
+                    errors = []
+                    if rc != 0 or not result:
+                        errors.append('app exit code %s' % rc)
+                    # QoS1保证送达；QoS0在本机回环上通常也不丢，只记录不判失败
+                    if qos >= 1 and sub.delivered(by_seq) < args.count:
+                        errors.append('subscriber got %d of %d' % (sub.delivered(by_seq), args.count))
+                    report = dict(result or {'bench': 'publish', 'payload': size, 'qos': qos,
+                                             'producers': producers})
+                    report.update({'received': sub.received, 'broker': BROKER_NAME,
+                                   'commit': commit, 'errors': errors})
+                    line = json.dumps(report)
+                    print(line, flush=True)
+                    if out:
+                        out.write(line + '\n')
+                    ok = ok and not errors
+    finally:
+        if out:
+            out.close()
+        if broker.proc.poll() is None:
+            broker.kill()
+    return ok
+
+
+SCENARIOS = {
+    'offline': run_offline,
+    'bench': run_bench,
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('scenario', choices=sorted(SCENARIOS))
+    parser.add_argument('--app', default=os.path.join(HERE, 'build', 'iot_manager_host.elf'))
+    ints = lambda text: [int(v) for v in text.split(',')]
+    parser.add_argument('--sizes', type=ints, default=[32, 256, 1024, 4096],
+                        help='bench: payload sizes in bytes, comma separated')
+    parser.add_argument('--qos', type=ints, default=[0, 1], help='bench: QoS levels')
+    parser.add_argument('--producers', type=ints, default=[1, 4],
+                        help='bench: numbers of publishing tasks')
+    parser.add_argument('--count', type=int, default=2000, help='bench: messages per run')
+    parser.add_argument('--out', help='bench: append JSON lines to this file')
+    args = parser.parse_args()
+
+    if not os.path.exists(args.app):
+        sys.exit('%s not found, run idf.py --preview set-target linux && idf.py build, '
+                 'or build iot_manager_host in ../host' % args.app)
+
+    with tempfile.TemporaryDirectory() as workdir:
+        ok = SCENARIOS[args.scenario](args, workdir)
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -4,11 +4,16 @@
  * @Description: 应用管理器实现
  */
 
+#include <stdio.h>
 #include "app_manager.h"
+#include "app_sampler.h"
 #include "iot_manager.h"
+#include "iot_payload.h"
+#include "iot_json_writer.h"
+#include "http_server.h"
+#include "nvs_cache.h"
 #include "esp_log.h"
 #include "esp_timer.h"
-#include "cJSON.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_system.h"
@@ -23,10 +28,17 @@ static const char *TAG = "app_manager";
 // 数据上报间隔（秒）
 #define REPORT_INTERVAL_SEC 30
 
+// 启用离线缓存时断线期间照常采样，重连后由iot_manager补发
+#if CONFIG_IOT_OFFLINE_QUEUE_ENABLE
+#define REPORT_WHEN_OFFLINE 1
+#else
+#define REPORT_WHEN_OFFLINE 0
+#endif
+
 /**
  * @brief MQTT数据接收回调
  * 
- * 处理从后台服务器接收到的命令
+ * 已注册的命令由iot_manager在命令工作任务中执行，这里只收到其余消息
  */
 static void app_mqtt_data_callback(const char *topic, int topic_len,
                                    const char *data, int data_len)
@@ -36,69 +48,123 @@ static void app_mqtt_data_callback(const char *topic, int topic_len,
     ESP_LOGI(TAG, "主题: %.*s", topic_len, topic);
     ESP_LOGI(TAG, "数据: %.*s", data_len, data);
     ESP_LOGI(TAG, "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
+}
+
+/**
+ * @brief 命令: 立即上报状态
+ */
+static int cmd_get_status(const iot_command_t *cmd, char *message, size_t message_size)
+{
+    ESP_LOGI(TAG, "✅ 执行: 获取状态");
     
-    // 检查是否是命令主题（使用静态缓冲区）
-    static char expected_topic[128];
-    snprintf(expected_topic, sizeof(expected_topic), "device/%s/command", APP_DEVICE_ID);
+    // 构建状态（JSON或CBOR，由menuconfig中的Payload Encoding决定）
+    char status[160];
+    iot_payload_writer_t w;
+    iot_payload_init(&w, status, sizeof(status));
+    iot_payload_object_begin(&w);
+    iot_payload_kv_str(&w, "device_id", APP_DEVICE_ID);
+    iot_payload_kv_str(&w, "status", "online");
+    iot_payload_kv_int(&w, "uptime", esp_timer_get_time() / 1000000);
+    iot_payload_kv_uint(&w, "free_heap", esp_get_free_heap_size());
+    iot_payload_object_end(&w);
     
-    if (strncmp(topic, expected_topic, topic_len) == 0) {
-        // 复制数据用于解析
-        char *data_copy = strndup(data, data_len);
-        if (!data_copy) {
-            ESP_LOGE(TAG, "内存分配失败");
-            return;
-        }
-        
-        // 解析JSON命令
-        cJSON *root = cJSON_Parse(data_copy);
-        if (root) {
-            cJSON *cmd = cJSON_GetObjectItem(root, "command");
-            cJSON *params __attribute__((unused)) = cJSON_GetObjectItem(root, "params");
-            
-            if (cmd && cJSON_IsString(cmd)) {
-                const char *command = cmd->valuestring;
-                ESP_LOGI(TAG, "📋 执行命令: %s", command);
-                
-                // 处理不同的命令
-                if (strcmp(command, "get_status") == 0) {
-                    // 立即上报状态
-                    ESP_LOGI(TAG, "✅ 执行: 获取状态");
-                    
-                    // 构建状态JSON
-                    cJSON *status = cJSON_CreateObject();
-                    cJSON_AddStringToObject(status, "device_id", APP_DEVICE_ID);
-                    cJSON_AddStringToObject(status, "status", "online");
-                    cJSON_AddNumberToObject(status, "uptime", esp_timer_get_time() / 1000000);
-                    cJSON_AddNumberToObject(status, "free_heap", esp_get_free_heap_size());
-                    
-                    char *status_str = cJSON_PrintUnformatted(status);
-                    if (status_str) {
-                        iot_manager_report_status(status_str);
-                        free(status_str);
-                    }
-                    cJSON_Delete(status);
-                    
-                } else if (strcmp(command, "restart") == 0) {
-                    ESP_LOGW(TAG, "⚠️  收到重启命令，3秒后重启...");
-                    vTaskDelay(pdMS_TO_TICKS(3000));
-                    esp_restart();
-                    
-                } else if (strcmp(command, "test") == 0) {
-                    ESP_LOGI(TAG, "✅ 执行: 测试命令");
-                    // 测试响应
-                    
-                } else {
-                    ESP_LOGW(TAG, "⚠️  未知命令: %s", command);
-                }
-            }
-            
-            cJSON_Delete(root);
-        } else {
-            ESP_LOGE(TAG, "JSON解析失败");
+    int len = iot_payload_finish(&w);
+    if (len < 0 || iot_manager_report(IOT_MSG_CLASS_STATUS, status, len,
+                                      IOT_PAYLOAD_REPORT_FLAGS) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static void restart_timer_cb(void *arg)
+{
+    // 限频中的运行状态（WiFi连接统计等）重启前写入flash
+    esp_err_t err = nvs_cache_flush();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "重启前写入NVS失败: %s", esp_err_to_name(err));
+    }
+    esp_restart();
+}
+
+/**
+ * @brief 命令: 重启设备
+ * 
+ * 延时由定时器完成，先回复命令结果再重启
+ */
+static int cmd_restart(const iot_command_t *cmd, char *message, size_t message_size)
+{
+    static esp_timer_handle_t restart_timer = NULL;
+    
+    if (!restart_timer) {
+        const esp_timer_create_args_t args = {
+            .callback = restart_timer_cb,
+            .name = "app_restart",
+        };
+        if (esp_timer_create(&args, &restart_timer) != ESP_OK) {
+            return -1;
         }
-        
-        free(data_copy);
     }
+    
+    ESP_LOGW(TAG, "⚠️  收到重启命令，3秒后重启...");
+    esp_timer_start_once(restart_timer, 3000 * 1000);
+    snprintf(message, message_size, "restart in 3s");
+    return 0;
+}
+
+/**
+ * @brief 命令: 测试
+ */
+static int cmd_test(const iot_command_t *cmd, char *message, size_t message_size)
+{
+    ESP_LOGI(TAG, "✅ 执行: 测试命令, 参数: %.*s", cmd->params_len,
+             cmd->params ? cmd->params : "");
+    return 0;
+}
+
+/**
+ * @brief 命令: 立即上报全部属性（完整快照）
+ */
+static int cmd_get_properties(const iot_command_t *cmd, char *message, size_t message_size)
+{
+    int count = iot_manager_property_report(true);
+    if (count < 0) {
+        return -1;
+    }
+    snprintf(message, message_size, "%d properties", count);
+    return 0;
+}
+
+/**
+ * @brief 命令: 立即上报发布统计（事件主题）
+ */
+static int cmd_get_stats(const iot_command_t *cmd, char *message, size_t message_size)
+{
+    iot_manager_stats_t stats;
+    iot_manager_get_stats(&stats);
+    snprintf(message, message_size, "in_flight=%u dropped=%lu", stats.in_flight,
+             (unsigned long)stats.dropped);
+    return iot_manager_report_stats() == 0 ? 0 : -1;
+}
+
+/**
+ * @brief 命令: 立即上报健康数据（任务栈剩余和内存，事件主题）
+ */
+static int cmd_get_health(const iot_command_t *cmd, char *message, size_t message_size)
+{
+    return iot_manager_report_health() == 0 ? 0 : -1;
+}
+
+/**
+ * @brief 注册后台命令
+ */
+static void app_register_commands(void)
+{
+    iot_manager_register_command("get_status", cmd_get_status, 0);
+    iot_manager_register_command("get_properties", cmd_get_properties, 0);
+    iot_manager_register_command("get_stats", cmd_get_stats, 0);
+    iot_manager_register_command("get_health", cmd_get_health, 0);
+    iot_manager_register_command("restart", cmd_restart, 0);
+    iot_manager_register_command("test", cmd_test, 0);
 }
 
 /**
@@ -106,6 +172,12 @@ static void app_mqtt_data_callback(const char *topic, int topic_len,
  */
 void app_on_wifi_connected(void)
 {
+    // WiFi重连时MQTT客户端会自动重连，无需重新初始化（否则会丢失离线缓存）
+    if (iot_manager_get_client()) {
+        ESP_LOGI(TAG, "WiFi已重新连接，IoT管理器已在运行");
+        return;
+    }
+    
     ESP_LOGI(TAG, "WiFi已连接，启动IoT管理器...");
     
     // 配置IoT管理器
@@ -138,48 +210,84 @@ void app_on_wifi_connected(void)
 
 /**
  * @brief 数据上报任务
+ *
+ * 每REPORT_INTERVAL_SEC为一个窗口：窗口内取走采样任务的样本做聚合，
+ * 窗口结束时上报汇总和属性
  */
 static void report_task(void *pvParameters)
 {
     int report_count = 0;
+    const TickType_t window = pdMS_TO_TICKS(REPORT_INTERVAL_SEC * 1000);
+    // 启动后立即上报一次属性，之后每个窗口结束时上报
+    TickType_t window_start = xTaskGetTickCount() - window;
+    
+    // 属性只在变化达到死区时上报，每IOT_SHADOW_FULL_EVERY个周期发送一次完整快照
+    int prop_uptime = iot_manager_property_define("uptime", IOT_PROP_INT, 3600, 0);
+    int prop_heap = iot_manager_property_define("free_heap", IOT_PROP_INT, 4096, 0);
+    
+    // 这里可以添加你的传感器属性
+    // int prop_temp = iot_manager_property_define("temperature", IOT_PROP_FLOAT, 0.5, 0);
+    // int prop_humi = iot_manager_property_define("humidity", IOT_PROP_FLOAT, 0, 5);
     
     ESP_LOGI(TAG, "数据上报任务已启动");
     
+    // 采样状态只在本任务中访问，由本任务启动采样
+    esp_err_t ret = app_sampler_start(xTaskGetCurrentTaskHandle());
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "采样任务启动失败: %s", esp_err_to_name(ret));
+    }
+    
     while (1) {
+        // 等到窗口结束，采样缓冲区过半时提前醒来取走样本
+        TickType_t elapsed = xTaskGetTickCount() - window_start;
+        if (elapsed < window) {
+            ulTaskNotifyTake(pdTRUE, window - elapsed);
+            app_sampler_drain();
+            continue;
+        }
+        window_start += window;
+        
+        int64_t uptime = esp_timer_get_time() / 1000000;
+        uint32_t free_heap = esp_get_free_heap_size();
+        
+        // 最新采样推送给配置网页（与MQTT连接状态无关）
+        char telemetry[96];
+        iot_json_writer_t jw;
+        iot_json_init(&jw, telemetry, sizeof(telemetry));
+        iot_json_object_begin(&jw);
+        iot_json_kv_int(&jw, "uptime", uptime);
+        iot_json_kv_uint(&jw, "free_heap", free_heap);
+        iot_json_object_end(&jw);
+        int telemetry_len = iot_json_finish(&jw);
+        if (telemetry_len > 0) {
+            http_server_push_telemetry(telemetry, telemetry_len);
+        }
+        
         // 等待MQTT连接
-        if (iot_manager_is_connected()) {
-            // 构建设备数据JSON
-            cJSON *data = cJSON_CreateObject();
-            if (data) {
-                cJSON_AddStringToObject(data, "device_id", APP_DEVICE_ID);
-                cJSON_AddNumberToObject(data, "timestamp", esp_timer_get_time() / 1000);
-                cJSON_AddNumberToObject(data, "uptime", esp_timer_get_time() / 1000000);
-                cJSON_AddNumberToObject(data, "free_heap", esp_get_free_heap_size());
-                cJSON_AddNumberToObject(data, "report_count", report_count++);
-                
-                // 这里可以添加你的传感器数据
-                // cJSON_AddNumberToObject(data, "temperature", get_temperature());
-                // cJSON_AddNumberToObject(data, "humidity", get_humidity());
-                
-                char *data_str = cJSON_PrintUnformatted(data);
-                if (data_str) {
-                    int msg_id = iot_manager_report_properties(data_str);
-                    if (msg_id >= 0) {
-                        ESP_LOGI(TAG, "📤 数据上报成功 #%d (msg_id=%d)", report_count, msg_id);
-                    } else {
-                        ESP_LOGW(TAG, "数据上报失败");
-                    }
-                    free(data_str);
-                }
-                
-                cJSON_Delete(data);
+        bool online = iot_manager_is_connected() || REPORT_WHEN_OFFLINE;
+        int samples = app_sampler_report(REPORT_INTERVAL_SEC, online);
+        if (samples < 0) {
+            ESP_LOGW(TAG, "窗口汇总上报失败");
+        }
+        
+        if (online) {
+            iot_manager_property_set_int(prop_uptime, uptime);
+            iot_manager_property_set_int(prop_heap, free_heap);
+            // iot_manager_property_set_float(prop_temp, get_temperature());
+            // iot_manager_property_set_float(prop_humi, get_humidity());
+            
+            // 变化的属性编码后进入批量缓冲，由iot_manager按大小/时间合并发送
+            int count = iot_manager_property_report(false);
+            if (count > 0) {
+                ESP_LOGI(TAG, "📤 数据上报成功 #%d (%d个属性)", ++report_count, count);
+            } else if (count == 0) {
+                ESP_LOGD(TAG, "属性无变化，本周期不上报");
+            } else {
+                ESP_LOGW(TAG, "数据上报失败");
             }
         } else {
             ESP_LOGD(TAG, "等待MQTT连接...");
         }
-        
-        // 等待下一次上报
-        vTaskDelay(pdMS_TO_TICKS(REPORT_INTERVAL_SEC * 1000));
     }
 }
 
@@ -188,8 +296,11 @@ static void report_task(void *pvParameters)
  */
 void app_start_report_task(void)
 {
-    // 增加栈大小到6KB，避免栈溢出
-    xTaskCreate(report_task, "report_task", 6144, NULL, 5, NULL);
+    // 栈大小6KB，实际余量见健康数据stack中的report_task（/api/health或get_health命令）
+    if (xTaskCreate(report_task, "report_task", 6144, NULL, 5, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "数据上报任务创建失败");
+        return;
+    }
     ESP_LOGI(TAG, "数据上报任务已创建（间隔: %d秒）", REPORT_INTERVAL_SEC);
 }
 
@@ -205,6 +316,8 @@ esp_err_t app_manager_init(void)
     ESP_LOGI(TAG, "  设备类型: %s", APP_DEVICE_TYPE);
     ESP_LOGI(TAG, "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
     
+    app_register_commands();
+    
     return ESP_OK;
 }
 
@@ -0,0 +1,258 @@
+/*
+ * @Author: xingnian
+ * @Date: 2025-11-10
+ * @Description: 传感器采样实现
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "app_sampler.h"
+#include "iot_manager.h"
+#include "iot_payload.h"
+#include "iot_spsc_ring.h"
+#include "iot_window.h"
+#include "iot_tsz.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+
+static const char *TAG = "app_sampler";
+
+typedef float (*sample_read_t)(void);
+
+/**
+ * @brief 采样通道
+ */
+typedef struct {
+    const char *name;                   ///< 上报中的字段名
+    sample_read_t read;                 ///< 读取函数，在采样任务中调用
+} sample_channel_t;
+
+/**
+ * @brief 环形缓冲区中的样本
+ */
+typedef struct {
+    int64_t ts_ms;                      ///< 采样时间（启动后毫秒）
+    uint32_t channel;
+    float value;
+} sample_t;
+
+// 读取空闲堆（示例通道）
+static float read_free_heap(void)
+{
+    return (float)esp_get_free_heap_size();
+}
+
+// 采样通道，在这里添加传感器
+static const sample_channel_t channels[] = {
+    { "free_heap", read_free_heap },
+    // { "temperature", read_temperature },
+};
+
+#define CHANNEL_COUNT       (sizeof(channels) / sizeof(channels[0]))
+
+// 汇总负载缓冲区大小（在consumer任务栈上）
+#define SAMPLER_MSG_SIZE    (64 + CHANNEL_COUNT * 160)
+
+static iot_spsc_ring_t ring;
+static TaskHandle_t consumer_task = NULL;
+static TaskHandle_t sampler_task_handle = NULL;
+
+// 缓冲区满丢弃的样本数（采样任务写，consumer读取后清零）
+static atomic_uint dropped = 0;
+
+// 当前窗口，只在consumer任务中访问
+static iot_window_t windows[CHANNEL_COUNT];
+
+#if CONFIG_APP_SAMPLE_RAW
+// 每个通道的原始样本压缩序列，只在consumer任务中访问
+static uint8_t raw_buf[CHANNEL_COUNT][CONFIG_APP_SAMPLE_RAW_BUF_SIZE];
+static iot_tsz_writer_t raw[CHANNEL_COUNT];
+
+/**
+ * @brief 发出通道的压缩序列并开始新的序列
+ *
+ * @return int 0成功，上报失败返回-1
+ */
+static int raw_flush(uint32_t ch, bool publish)
+{
+    int ret = 0;
+    if (publish && iot_tsz_count(&raw[ch]) > 0) {
+        int len = iot_tsz_finish(&raw[ch]);
+        if (len < 0 ||
+            iot_manager_report(IOT_MSG_CLASS_PROPERTY, raw_buf[ch], len, IOT_REPORT_FLAG_TSZ) < 0) {
+            ret = -1;
+        }
+    }
+    iot_tsz_init(&raw[ch], raw_buf[ch], sizeof(raw_buf[ch]));
+    iot_tsz_series_begin(&raw[ch], channels[ch].name);
+    return ret;
+}
+
+/**
+ * @brief 样本加入通道的压缩序列，缓冲区满时先发出
+ */
+static void raw_add(const sample_t *s)
+{
+    if (iot_tsz_append(&raw[s->channel], s->ts_ms, s->value)) {
+        return;
+    }
+    if (raw_flush(s->channel, true) < 0) {
+        ESP_LOGW(TAG, "原始样本上报失败: %s", channels[s->channel].name);
+    }
+    iot_tsz_append(&raw[s->channel], s->ts_ms, s->value);
+}
+#endif
+
+/**
+ * @brief 采样任务
+ */
+static void sampler_task(void *pvParameters)
+{
+    TickType_t period = pdMS_TO_TICKS(CONFIG_APP_SAMPLE_INTERVAL_MS);
+    if (period == 0) {
+        period = 1;
+    }
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1) {
+        for (uint32_t i = 0; i < CHANNEL_COUNT; i++) {
+            sample_t s = {
+                .ts_ms = esp_timer_get_time() / 1000,
+                .channel = i,
+                .value = channels[i].read(),
+            };
+            if (!iot_spsc_push(&ring, &s)) {
+                atomic_fetch_add(&dropped, 1);
+            }
+        }
+
+        // 缓冲区过半时让consumer提前取走，避免窗口较长时溢出
+        if (iot_spsc_count(&ring) >= iot_spsc_capacity(&ring) / 2) {
+            xTaskNotifyGive(consumer_task);
+        }
+
+        xTaskDelayUntil(&last_wake, period);
+    }
+}
+
+esp_err_t app_sampler_start(TaskHandle_t consumer)
+{
+    if (sampler_task_handle) {
+        return ESP_OK;
+    }
+    if (!consumer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 容量向上取整为2的幂
+    uint32_t capacity = 2;
+    while (capacity < CONFIG_APP_SAMPLE_RING_LEN) {
+        capacity <<= 1;
+    }
+    void *mem = malloc(iot_spsc_mem_size(capacity, sizeof(sample_t)));
+    if (!mem) {
+        return ESP_ERR_NO_MEM;
+    }
+    iot_spsc_init(&ring, mem, capacity, sizeof(sample_t));
+    for (uint32_t i = 0; i < CHANNEL_COUNT; i++) {
+        iot_window_reset(&windows[i]);
+#if CONFIG_APP_SAMPLE_RAW
+        raw_flush(i, false);
+#endif
+    }
+    consumer_task = consumer;
+
+    // 优先级高于上报任务，采样时刻不受上报和网络影响
+    if (xTaskCreate(sampler_task, "sampler", 3072, NULL, 6, &sampler_task_handle) != pdPASS) {
+        free(mem);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "采样任务已创建（%d个通道，间隔%dms，缓冲%lu个样本）",
+             (int)CHANNEL_COUNT, CONFIG_APP_SAMPLE_INTERVAL_MS, (unsigned long)capacity);
+    return ESP_OK;
+}
+
+void app_sampler_drain(void)
+{
+    sample_t s;
+    while (iot_spsc_pop(&ring, &s)) {
+        if (s.channel < CHANNEL_COUNT) {
+            iot_window_add(&windows[s.channel], s.value);
+#if CONFIG_APP_SAMPLE_RAW
+            raw_add(&s);
+#endif
+        }
+    }
+}
+
+int app_sampler_report(uint32_t window_sec, bool publish)
+{
+    app_sampler_drain();
+
+    uint32_t lost = atomic_exchange(&dropped, 0);
+    if (lost) {
+        ESP_LOGW(TAG, "采样缓冲区已满，丢弃%lu个样本", (unsigned long)lost);
+    }
+
+    char buf[SAMPLER_MSG_SIZE];
+    iot_payload_writer_t w;
+    iot_payload_init(&w, buf, sizeof(buf));
+    iot_payload_object_begin(&w);
+    iot_payload_kv_int(&w, "timestamp", esp_timer_get_time() / 1000);
+    iot_payload_kv_uint(&w, "window", window_sec);
+    if (lost) {
+        iot_payload_kv_uint(&w, "dropped", lost);
+    }
+
+    int total = 0;
+    for (uint32_t i = 0; i < CHANNEL_COUNT; i++) {
+        iot_window_result_t r;
+        if (!iot_window_get(&windows[i], &r)) {
+            continue;
+        }
+        total += r.count;
+        iot_payload_key(&w, channels[i].name);
+        iot_payload_object_begin(&w);
+        iot_payload_kv_uint(&w, "n", r.count);
+        iot_payload_kv_float(&w, "min", r.min);
+        iot_payload_kv_float(&w, "max", r.max);
+        iot_payload_kv_float(&w, "mean", r.mean);
+        for (int p = 0; p < IOT_WINDOW_PERCENTILES; p++) {
+            char key[8];
+            snprintf(key, sizeof(key), "p%u", iot_window_percentiles[p]);
+            iot_payload_kv_float(&w, key, r.pct[p]);
+        }
+        iot_payload_object_end(&w);
+        iot_window_reset(&windows[i]);
+    }
+    iot_payload_object_end(&w);
+
+#if CONFIG_APP_SAMPLE_RAW
+    // 窗口内剩余的原始样本随汇总一起发出
+    bool raw_failed = false;
+    for (uint32_t i = 0; i < CHANNEL_COUNT; i++) {
+        if (raw_flush(i, publish) < 0) {
+            raw_failed = true;
+        }
+    }
+    if (raw_failed) {
+        ESP_LOGW(TAG, "原始样本上报失败");
+    }
+#endif
+
+    if (!publish || total == 0) {
+        return total;
+    }
+
+    int len = iot_payload_finish(&w);
+    if (len < 0) {
+        ESP_LOGE(TAG, "窗口汇总超过%d字节", (int)SAMPLER_MSG_SIZE);
+        return -1;
+    }
+    if (iot_manager_report(IOT_MSG_CLASS_PROPERTY, buf, len, IOT_PAYLOAD_REPORT_FLAGS) < 0) {
+        return -1;
+    }
+    return total;
+}
@@ -0,0 +1,43 @@
+/*
+ * @Author: xingnian
+ * @Date: 2025-11-10
+ * @Description: 传感器采样 - 按固定频率采样，按上报窗口聚合
+ *
+ * 采样任务按 APP_SAMPLE_INTERVAL_MS 读取各通道，把样本写入无锁环形缓冲区，
+ * 不等待网络；上报任务取出样本累加到每个通道的窗口中（最小、最大、平均、个数、p50/p90/p99），
+ * 每个上报窗口发送一次汇总。采样频率和上报间隔互不影响。
+ * 开启 APP_SAMPLE_RAW 时还把原始样本按通道压缩为时间序列（iot_tsz.h）一起上报。
+ */
+
+#ifndef APP_SAMPLER_H
+#define APP_SAMPLER_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * @brief 启动采样任务（在consumer任务中调用）
+ *
+ * @param consumer 取样本的任务（调用 app_sampler_drain() 的任务），
+ *                 缓冲区过半时通过任务通知（xTaskNotifyGive）唤醒它
+ * @return esp_err_t
+ */
+esp_err_t app_sampler_start(TaskHandle_t consumer);
+
+/**
+ * @brief 取出已采集的样本并累加到当前窗口（只能在consumer任务中调用）
+ */
+void app_sampler_drain(void);
+
+/**
+ * @brief 结束当前窗口：上报各通道的汇总并开始新窗口（只能在consumer任务中调用）
+ *
+ * @param window_sec 窗口长度，写入上报内容
+ * @param publish false时只清空窗口（例如MQTT未连接）
+ * @return int 窗口内的样本总数，上报失败返回-1
+ */
+int app_sampler_report(uint32_t window_sec, bool publish);
+
+#endif // APP_SAMPLER_H
@@ -9,168 +9,257 @@
 #include <esp_log.h>
 #include <esp_spiffs.h>
 #include <esp_system.h>
+#include <stdatomic.h>
 #include <sys/param.h>
+#include "freertos/FreeRTOS.h"
 #include "esp_netif.h"
 #include "esp_http_server.h"
+#include "esp_timer.h"
 #include "cJSON.h"
+#include "iot_manager.h"
+#include "iot_boot.h"
+#include "iot_health.h"
+#include "iot_arena.h"
+#include "iot_json_writer.h"
 #include "http_server.h"
-#include <sys/stat.h>
-#include "nvs_flash.h"
+#include "web_assets.h"
+#include "wifi_manager.h"
 #include "lwip/ip4_addr.h"
 
 static const char *TAG = "http_server";
 static httpd_handle_t server = NULL;
 
-// 处理根路径请求 - 返回index.html
-static esp_err_t root_get_handler(httpd_req_t *req)
+#define _STR(x) #x
+#define STR(x) _STR(x)
+#define ASSET_CACHE_CONTROL "public, max-age=" STR(CONFIG_WEB_ASSET_MAX_AGE)
+
+#define SPIFFS_BASE_PATH    "/spiffs"
+#define SPIFFS_CHUNK_SIZE   1024    // 在httpd任务栈上
+
+#define STATUS_MSG_SIZE     384     // 设备状态JSON（包括遥测数据）最大长度
+#define BOOT_MSG_SIZE       (96 + IOT_BOOT_MAX_STAGES * 56)  // 启动阶段JSON最大长度
+#define TELEMETRY_MAX_LEN   192
+
+// 最近一次遥测数据（JSON对象），由应用层更新
+static char telemetry_json[TELEMETRY_MAX_LEN];
+static size_t telemetry_len = 0;
+static portMUX_TYPE telemetry_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// 按路径查找网页资源（资源表按path排序）
+static const web_asset_t *web_asset_find(const char *path, size_t len)
 {
-    char filepath[FILE_PATH_MAX];
-    FILE *fd = NULL;
-    struct stat file_stat;
-    
-    // 构建完整的文件路径
-    strlcpy(filepath, "/spiffs/index.html", sizeof(filepath));
-    
-    // 获取文件信息
-    if (stat(filepath, &file_stat) == -1) {
-        ESP_LOGE(TAG, "Failed to stat file : %s", filepath);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read file");
+    size_t lo = 0, hi = web_asset_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const char *p = web_assets[mid].path;
+        int cmp = strncmp(p, path, len);
+        if (cmp == 0) {
+            if (p[len] == '\0') {
+                return &web_assets[mid];
+            }
+            cmp = 1;    // p比path长
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+// SPIFFS挂载状态（在httpd任务中访问；启动时挂载则在HTTP服务器启动之前写入）
+static bool spiffs_mounted = false;
+
+// 挂载SPIFFS，已挂载时直接返回
+esp_err_t http_server_mount_storage(void)
+{
+    if (spiffs_mounted) {
+        return ESP_OK;
+    }
+
+    int64_t start = esp_timer_get_time();
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = SPIFFS_BASE_PATH,
+        .partition_label = NULL,
+        .max_files = 5,   // 最大打开文件数
+        .format_if_mount_failed = false
+    };
+    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPIFFS挂载失败 (%s)", esp_err_to_name(ret));
+        return ret;
+    }
+    spiffs_mounted = true;
+    iot_boot_mark("spiffs");    // 只有在启动完成前挂载才计入
+    ESP_LOGI(TAG, "SPIFFS已挂载，耗时%lldms", (esp_timer_get_time() - start) / 1000);
+    return ESP_OK;
+}
+
+// 发送SPIFFS中的文件（资源表以外的文件）
+static esp_err_t spiffs_send_file(httpd_req_t *req, const char *uri, size_t len)
+{
+    char filepath[sizeof(SPIFFS_BASE_PATH) + CONFIG_HTTPD_MAX_URI_LEN];
+    if (strstr(uri, "..") || len >= sizeof(filepath) - sizeof(SPIFFS_BASE_PATH)) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
         return ESP_FAIL;
     }
-    
-    fd = fopen(filepath, "r");
-    if (!fd) {
-        ESP_LOGE(TAG, "Failed to read file : %s", filepath);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read file");
+    if (http_server_mount_storage() != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Storage unavailable");
         return ESP_FAIL;
     }
-    
-    // 设置Content-Type
-    httpd_resp_set_type(req, "text/html");
-    
-    // 发送文件内容
-    char *chunk = malloc(CHUNK_SIZE);
-    if (chunk == NULL) {
-        fclose(fd);
-        ESP_LOGE(TAG, "Failed to allocate memory for chunk");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to allocate memory");
+    snprintf(filepath, sizeof(filepath), "%s%.*s", SPIFFS_BASE_PATH, (int)len, uri);
+
+    FILE *fd = fopen(filepath, "r");
+    if (!fd) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
         return ESP_FAIL;
     }
-    
+
+    const char *ext = strrchr(filepath, '.');
+    httpd_resp_set_type(req, !ext ? "application/octet-stream" :
+                             strcmp(ext, ".html") == 0 ? "text/html" :
+                             strcmp(ext, ".css") == 0 ? "text/css" :
+                             strcmp(ext, ".js") == 0 ? "application/javascript" :
+                             strcmp(ext, ".json") == 0 ? "application/json" :
+                             "application/octet-stream");
+
+    char chunk[SPIFFS_CHUNK_SIZE];
     size_t chunksize;
     do {
-        chunksize = fread(chunk, 1, CHUNK_SIZE, fd);
-        if (chunksize > 0) {
-            if (httpd_resp_send_chunk(req, chunk, chunksize) != ESP_OK) {
-                free(chunk);
-                fclose(fd);
-                ESP_LOGE(TAG, "File sending failed!");
-                httpd_resp_sendstr_chunk(req, NULL);
-                httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to send file");
-                return ESP_FAIL;
-            }
+        chunksize = fread(chunk, 1, sizeof(chunk), fd);
+        if (chunksize > 0 && httpd_resp_send_chunk(req, chunk, chunksize) != ESP_OK) {
+            fclose(fd);
+            ESP_LOGE(TAG, "File sending failed!");
+            httpd_resp_sendstr_chunk(req, NULL);
+            return ESP_FAIL;
         }
     } while (chunksize != 0);
-    
-    free(chunk);
+
     fclose(fd);
-    httpd_resp_send_chunk(req, NULL, 0);
-    return ESP_OK;
+    return httpd_resp_send_chunk(req, NULL, 0);
 }
 
-// 处理WiFi扫描请求
-static esp_err_t scan_get_handler(httpd_req_t *req)
+/**
+ * @brief If-None-Match是否匹配资源的ETag
+ *
+ * 值为 "*" 或逗号分隔的 [W/]"..." 列表。按弱比较：忽略W/前缀，引号内的内容逐字节相同才匹配，
+ * 不能用子串查找（"abc" 不应匹配 "xabc"）。格式错误的项跳过。
+ *
+ * @param etag 资源的ETag（带引号）
+ */
+static bool if_none_match(const char *header, const char *etag)
 {
-    ESP_LOGI(TAG, "收到WiFi扫描请求: %s", req->uri);
-    
-    // 检查WiFi状态
-    wifi_mode_t mode;
-    esp_wifi_get_mode(&mode);
-    if (mode & WIFI_MODE_STA) {
-        // 检查是否正在连接
-        wifi_ap_record_t ap_info;
-        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-            esp_wifi_disconnect();
-            vTaskDelay(pdMS_TO_TICKS(500)); // 等待断开完成
+    size_t etag_len = strlen(etag);
+    const char *p = header;
+    for (;;) {
+        p += strspn(p, " \t,");
+        if (*p == '\0') {
+            return false;
         }
-    }
-    
-    ESP_LOGI(TAG, "清除之前的扫描结果");
-    esp_wifi_scan_stop();  // 停止可能正在进行的扫描
-    vTaskDelay(pdMS_TO_TICKS(100)); // 等待扫描停止
-    
-    ESP_LOGI(TAG, "开始WiFi扫描...");
-    // 配置扫描参数
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = true,
-        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
-        .scan_time = {
-            .active = {
-                .min = 100,
-                .max = 300
+        if (*p == '*') {
+            return true;
+        }
+        if (strncmp(p, "W/", 2) == 0) {
+            p += 2;
+        }
+        if (*p == '"') {
+            const char *end = strchr(p + 1, '"');
+            if (!end) {
+                return false;
+            }
+            if ((size_t)(end + 1 - p) == etag_len && memcmp(p, etag, etag_len) == 0) {
+                return true;
             }
+            p = end + 1;
         }
-    };
-    
-    // 开始扫描
-    esp_err_t err = esp_wifi_scan_start(&scan_config, true);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "WiFi扫描失败: %s", esp_err_to_name(err));
-        char err_msg[128];
-        snprintf(err_msg, sizeof(err_msg), "{\"status\":\"error\",\"message\":\"Scan failed: %s\"}", esp_err_to_name(err));
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, err_msg, strlen(err_msg));
-        return ESP_OK;
+        p += strcspn(p, ",");
     }
+}
 
-    // 获取扫描结果
-    uint16_t ap_count = 0;
-    esp_wifi_scan_get_ap_num(&ap_count);
-    
-    if (ap_count == 0) {
-        const char *response = "{\"status\":\"success\",\"networks\":[]}";
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, response, strlen(response));
-        return ESP_OK;
+// 处理静态资源请求 - 直接发送flash中的gzip数据
+static esp_err_t asset_get_handler(httpd_req_t *req)
+{
+    // 去掉查询参数，根路径返回index.html
+    const char *uri = req->uri;
+    size_t len = strcspn(uri, "?#");
+    if (len == 1 && uri[0] == '/') {
+        uri = "/index.html";
+        len = strlen(uri);
     }
 
-    wifi_ap_record_t *ap_records = malloc(sizeof(wifi_ap_record_t) * ap_count);
-    if (ap_records == NULL) {
-        ESP_LOGE(TAG, "内存分配失败");
-        const char *response = "{\"status\":\"error\",\"message\":\"Memory allocation failed\"}";
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, response, strlen(response));
-        return ESP_OK;
+    const web_asset_t *asset = web_asset_find(uri, len);
+    if (!asset) {
+        return spiffs_send_file(req, uri, len);
+    }
+
+    bool is_html = strcmp(asset->type, "text/html") == 0;
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    if (is_html) {
+        // 页面每次校验，固件更新后立即生效
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    } else {
+        httpd_resp_set_hdr(req, "Cache-Control", ASSET_CACHE_CONTROL);
+    }
+
+    // 内容未变化，只回304；列表超过缓冲区时取值失败，按不匹配返回完整内容
+    char etag[128];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", etag, sizeof(etag)) == ESP_OK &&
+        if_none_match(etag, asset->etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
     }
 
-    esp_wifi_scan_get_ap_records(&ap_count, ap_records);
-    ESP_LOGI(TAG, "找到 %d 个WiFi网络", ap_count);
+    httpd_resp_set_type(req, asset->type);
+    if (asset->gzip) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    }
+    return httpd_resp_send(req, (const char *)asset->data, asset->len);
+}
+
+// 扫描结果缓冲区（httpd单任务处理请求）
+static wifi_scan_result_t scan_results[CONFIG_WIFI_SCAN_CACHE_SIZE];
+
+// 处理WiFi扫描请求：立即返回后台扫描缓存，不断开STA
+static esp_err_t scan_get_handler(httpd_req_t *req)
+{
+    int32_t age_ms;
+    bool scanning;
+
+    wifi_scan_request();
+    size_t count = wifi_scan_get_results(scan_results, CONFIG_WIFI_SCAN_CACHE_SIZE,
+                                         &age_ms, &scanning);
+    ESP_LOGI(TAG, "WiFi扫描请求: 缓存%d个网络, %ldms前更新%s", (int)count, (long)age_ms,
+             scanning ? ", 正在扫描" : "");
 
     // 创建JSON响应
     cJSON *root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "status", "success");
+    cJSON_AddNumberToObject(root, "age_ms", age_ms);
+    cJSON_AddBoolToObject(root, "scanning", scanning);
     cJSON *networks = cJSON_AddArrayToObject(root, "networks");
 
-    for (int i = 0; i < ap_count; i++) {
+    for (size_t i = 0; i < count; i++) {
         cJSON *ap = cJSON_CreateObject();
-        cJSON_AddStringToObject(ap, "ssid", (char *)ap_records[i].ssid);
-        cJSON_AddNumberToObject(ap, "rssi", ap_records[i].rssi);
-        cJSON_AddNumberToObject(ap, "authmode", ap_records[i].authmode);
+        cJSON_AddStringToObject(ap, "ssid", scan_results[i].ssid);
+        cJSON_AddNumberToObject(ap, "rssi", scan_results[i].rssi);
+        cJSON_AddNumberToObject(ap, "authmode", scan_results[i].authmode);
+        cJSON_AddNumberToObject(ap, "channel", scan_results[i].channel);
         cJSON_AddItemToArray(networks, ap);
     }
 
     char *response = cJSON_PrintUnformatted(root);
-    ESP_LOGI(TAG, "WiFi扫描完成，发送响应");
-    
+    cJSON_Delete(root);
+    if (response == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
+        return ESP_FAIL;
+    }
+
     httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
     httpd_resp_sendstr(req, response);
-
-    free(response);
-    free(ap_records);
-    cJSON_Delete(root);
+    cJSON_free(response);
     return ESP_OK;
 }
 
@@ -208,34 +297,18 @@ static esp_err_t configure_post_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
-    // 配置WiFi连接
-    wifi_config_t wifi_config = {0};
-    strlcpy((char *)wifi_config.sta.ssid, ssid->valuestring, sizeof(wifi_config.sta.ssid));
-    if (password && cJSON_IsString(password)) {
-        strlcpy((char *)wifi_config.sta.password, password->valuestring, sizeof(wifi_config.sta.password));
-    }
-    
-    // 保存WiFi配置到NVS
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
-    if (err == ESP_OK) {
-        err = nvs_set_blob(nvs_handle, "sta_config", &wifi_config, sizeof(wifi_config_t));
-        if (err == ESP_OK) {
-            err = nvs_commit(nvs_handle);
-        }
-        nvs_close(nvs_handle);
+    // 保存到WiFi配置列表并立即连接（只传SSID时使用已保存的密码）
+    esp_err_t err = wifi_profile_connect(ssid->valuestring,
+                                         cJSON_IsString(password) ? password->valuestring : NULL);
+    if (err == ESP_ERR_INVALID_ARG) {
+        cJSON_Delete(root);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid SSID or password");
+        return ESP_FAIL;
     }
-    
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "保存WiFi配置失败: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "WiFi配置已保存到NVS");
     }
     
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_connect());
-    
     cJSON_Delete(root);
     
     const char *response = "{\"status\":\"success\",\"message\":\"WiFi配置已提交，正在连接...\"}";
@@ -245,62 +318,287 @@ static esp_err_t configure_post_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
-// 获取WiFi连接状态
-static esp_err_t wifi_status_get_handler(httpd_req_t *req)
+// 生成设备状态JSON，/api/status和状态推送共用
+static int build_status_json(char *buf, size_t cap)
 {
+    char telemetry[TELEMETRY_MAX_LEN];
+    size_t tlen;
+
+    portENTER_CRITICAL(&telemetry_mux);
+    tlen = telemetry_len;
+    memcpy(telemetry, telemetry_json, tlen);
+    portEXIT_CRITICAL(&telemetry_mux);
+
+    iot_json_writer_t w;
+    iot_json_init(&w, buf, cap);
+    iot_json_object_begin(&w);
+
     wifi_ap_record_t ap_info;
-    char *response = NULL;
-    cJSON *root = cJSON_CreateObject();
-    
     if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        cJSON_AddStringToObject(root, "status", "connected");
-        cJSON_AddStringToObject(root, "ssid", (char *)ap_info.ssid);
-        cJSON_AddNumberToObject(root, "rssi", ap_info.rssi);
-        char bssid_str[18];
-        sprintf(bssid_str, "%02X:%02X:%02X:%02X:%02X:%02X",
-                ap_info.bssid[0], ap_info.bssid[1], ap_info.bssid[2],
-                ap_info.bssid[3], ap_info.bssid[4], ap_info.bssid[5]);
-        cJSON_AddStringToObject(root, "bssid", bssid_str);
-        
-        // 获取并添加IP地址
-        wifi_mode_t mode;
-        esp_wifi_get_mode(&mode);
-        if (mode & WIFI_MODE_STA) {
-            esp_netif_ip_info_t ip_info;
-            esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
-            if (netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK) {
-                char ip_str[16];
-                snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&ip_info.ip));
-                cJSON_AddStringToObject(root, "ip", ip_str);
-                ESP_LOGI(TAG, "当前IP地址: %s", ip_str);
-            } else {
-                ESP_LOGE(TAG, "获取IP地址失败");
-            }
+        char str[18];
+        iot_json_kv_str(&w, "status", "connected");
+        iot_json_kv_str(&w, "ssid", (const char *)ap_info.ssid);
+        iot_json_kv_int(&w, "rssi", ap_info.rssi);
+        snprintf(str, sizeof(str), "%02X:%02X:%02X:%02X:%02X:%02X",
+                 ap_info.bssid[0], ap_info.bssid[1], ap_info.bssid[2],
+                 ap_info.bssid[3], ap_info.bssid[4], ap_info.bssid[5]);
+        iot_json_kv_str(&w, "bssid", str);
+
+        esp_netif_ip_info_t ip_info;
+        esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+        if (netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK) {
+            snprintf(str, sizeof(str), IPSTR, IP2STR(&ip_info.ip));
+            iot_json_kv_str(&w, "ip", str);
         }
     } else {
-        cJSON_AddStringToObject(root, "status", "disconnected");
+        iot_json_kv_str(&w, "status", "disconnected");
     }
-    
-    response = cJSON_PrintUnformatted(root);
+    iot_json_kv_bool(&w, "mqtt", iot_manager_is_connected());
+    if (tlen > 0) {
+        iot_json_key(&w, "telemetry");
+        iot_json_raw(&w, telemetry, tlen);
+    }
+
+    iot_json_object_end(&w);
+    return iot_json_finish(&w);
+}
+
+// 获取WiFi连接状态
+static esp_err_t wifi_status_get_handler(httpd_req_t *req)
+{
+    char response[STATUS_MSG_SIZE];
+    int len = build_status_json(response, sizeof(response));
+    if (len < 0) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Status too long");
+        return ESP_FAIL;
+    }
+
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
-    
-    free(response);
-    cJSON_Delete(root);
-    return ESP_OK;
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, response, len);
+}
+
+// 获取启动阶段耗时
+static esp_err_t boot_get_handler(httpd_req_t *req)
+{
+    iot_boot_stage_t stages[IOT_BOOT_MAX_STAGES];
+    size_t count = iot_boot_get(stages, IOT_BOOT_MAX_STAGES);
+
+    char response[BOOT_MSG_SIZE];
+    iot_json_writer_t w;
+    iot_json_init(&w, response, sizeof(response));
+    iot_json_object_begin(&w);
+    iot_json_kv_str(&w, "fw", iot_boot_firmware_version());
+    iot_json_kv_bool(&w, "complete", iot_boot_is_complete());
+    iot_json_key(&w, "stages");
+    iot_json_array_begin(&w);
+    uint32_t prev = 0;
+    for (size_t i = 0; i < count; i++) {
+        iot_json_object_begin(&w);
+        iot_json_kv_str(&w, "name", stages[i].name);
+        iot_json_kv_uint(&w, "ms", stages[i].ms);
+        iot_json_kv_uint(&w, "delta", stages[i].ms - prev);
+        iot_json_object_end(&w);
+        prev = stages[i].ms;
+    }
+    iot_json_array_end(&w);
+    iot_json_object_end(&w);
+
+    int len = iot_json_finish(&w);
+    if (len < 0) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Boot profile too long");
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, response, len);
+}
+
+// 获取运行健康数据（任务栈剩余、内存碎片）
+static esp_err_t health_get_handler(httpd_req_t *req)
+{
+    // 只在httpd任务中使用，不占用httpd栈
+    static char response[IOT_HEALTH_MSG_SIZE];
+    int len = iot_health_to_json(response, sizeof(response));
+    if (len < 0) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Health data too long");
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, response, len);
+}
+
+#if CONFIG_HTTPD_WS_SUPPORT
+/* ==================== 状态推送（WebSocket） ==================== */
+
+/*
+ * 网页连接 /api/ws 后不再轮询。WiFi、IP和MQTT事件以及应用层更新遥测数据时，
+ * 通过httpd_queue_work在httpd任务中生成一次状态JSON，发给所有WebSocket客户端；
+ * 内容和上次推送相同时不发送。没有事件时不占用CPU。
+ */
+
+// 已有广播在httpd工作队列中，后续事件合并到这一次
+static atomic_bool push_pending = false;
+
+// 上次广播的内容（只在httpd任务中访问）
+static char push_msg[STATUS_MSG_SIZE];
+static int push_len = 0;
+
+// 发送状态，arg为客户端fd，-1表示广播（httpd任务中调用）
+static void status_push_work(void *arg)
+{
+    int target = (int)(intptr_t)arg;
+    int fds[CONFIG_LWIP_MAX_SOCKETS];
+    size_t count = 0;
+
+    if (!server) {
+        return;
+    }
+    if (target >= 0) {
+        fds[count++] = target;
+    } else {
+        atomic_store(&push_pending, false);
+        int clients[CONFIG_LWIP_MAX_SOCKETS];
+        size_t n = CONFIG_LWIP_MAX_SOCKETS;
+        if (httpd_get_client_list(server, &n, clients) != ESP_OK) {
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (httpd_ws_get_fd_info(server, clients[i]) == HTTPD_WS_CLIENT_WEBSOCKET) {
+                fds[count++] = clients[i];
+            }
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    char msg[STATUS_MSG_SIZE];
+    int len = build_status_json(msg, sizeof(msg));
+    if (len < 0) {
+        ESP_LOGE(TAG, "状态消息超过%d字节", STATUS_MSG_SIZE);
+        return;
+    }
+    if (target < 0) {
+        if (len == push_len && memcmp(msg, push_msg, len) == 0) {
+            return;
+        }
+        memcpy(push_msg, msg, len);
+        push_len = len;
+    }
+
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)msg,
+        .len = len,
+    };
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t err = httpd_ws_send_frame_async(server, fds[i], &frame);
+        if (err != ESP_OK) {
+            ESP_LOGD(TAG, "状态推送失败, fd=%d: %s", fds[i], esp_err_to_name(err));
+        }
+    }
+}
+
+// 请求一次广播
+static void status_push_request(void)
+{
+    if (server && !atomic_exchange(&push_pending, true)) {
+        if (httpd_queue_work(server, status_push_work, (void *)(intptr_t)-1) != ESP_OK) {
+            atomic_store(&push_pending, false);
+        }
+    }
+}
+
+// WiFi、IP和MQTT状态变化
+static void status_event_handler(void *arg, esp_event_base_t event_base,
+                                 int32_t event_id, void *event_data)
+{
+    status_push_request();
+}
+
+// 状态推送WebSocket
+static esp_err_t status_ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        // 握手完成，先发送一次当前状态
+        int fd = httpd_req_to_sockfd(req);
+        ESP_LOGI(TAG, "状态推送客户端已连接, fd=%d", fd);
+        httpd_queue_work(server, status_push_work, (void *)(intptr_t)fd);
+        return ESP_OK;
+    }
+
+    // 客户端不需要发送数据，收到的帧读出后丢弃（PING/CLOSE由httpd处理）
+    uint8_t buf[32];
+    httpd_ws_frame_t frame = { 0 };
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (frame.len > sizeof(buf)) {
+        return ESP_FAIL;
+    }
+    if (frame.len > 0) {
+        frame.payload = buf;
+        ret = httpd_ws_recv_frame(req, &frame, frame.len);
+    }
+    return ret;
+}
+
+static void status_push_register(void)
+{
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, status_event_handler, NULL);
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, status_event_handler, NULL);
+    esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, status_event_handler, NULL);
+    esp_event_handler_register(IP_EVENT, IP_EVENT_STA_LOST_IP, status_event_handler, NULL);
+    esp_event_handler_register(IOT_MANAGER_EVENT, ESP_EVENT_ANY_ID, status_event_handler, NULL);
+}
+
+static void status_push_unregister(void)
+{
+    esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, status_event_handler);
+    esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, status_event_handler);
+    esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, status_event_handler);
+    esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_LOST_IP, status_event_handler);
+    esp_event_handler_unregister(IOT_MANAGER_EVENT, ESP_EVENT_ANY_ID, status_event_handler);
+}
+#endif // CONFIG_HTTPD_WS_SUPPORT
+
+// 更新遥测数据
+void http_server_push_telemetry(const char *json, size_t len)
+{
+    if (!json || len >= TELEMETRY_MAX_LEN) {
+        ESP_LOGW(TAG, "遥测数据过长(%d字节)，未更新", (int)len);
+        return;
+    }
+    portENTER_CRITICAL(&telemetry_mux);
+    memcpy(telemetry_json, json, len);
+    telemetry_len = len;
+    portEXIT_CRITICAL(&telemetry_mux);
+
+#if CONFIG_HTTPD_WS_SUPPORT
+    status_push_request();
+#endif
 }
 
 // 获取已保存的WiFi列表
 static esp_err_t saved_wifi_get_handler(httpd_req_t *req)
 {
-    wifi_config_t wifi_config;
+    wifi_profile_info_t list[CONFIG_WIFI_PROFILE_MAX];
+    size_t count = wifi_profile_list(list, CONFIG_WIFI_PROFILE_MAX);
     cJSON *root = cJSON_CreateArray();
     char *response = NULL;
 
-    esp_err_t err = esp_wifi_get_config(ESP_IF_WIFI_STA, &wifi_config);
-    if (err == ESP_OK && strlen((char*)wifi_config.sta.ssid) > 0) {
+    for (size_t i = 0; i < count; i++) {
         cJSON *wifi = cJSON_CreateObject();
-        cJSON_AddStringToObject(wifi, "ssid", (char*)wifi_config.sta.ssid);
+        cJSON_AddStringToObject(wifi, "ssid", list[i].ssid);
+        cJSON_AddNumberToObject(wifi, "rssi", list[i].rssi);
+        cJSON_AddNumberToObject(wifi, "channel", list[i].channel);
+        cJSON_AddNumberToObject(wifi, "success", list[i].success);
+        cJSON_AddNumberToObject(wifi, "failure", list[i].failure);
+        cJSON_AddBoolToObject(wifi, "connected", list[i].connected);
         cJSON_AddItemToArray(root, wifi);
     }
 
@@ -308,7 +606,7 @@ static esp_err_t saved_wifi_get_handler(httpd_req_t *req)
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, response);
 
-    free(response);
+    cJSON_free(response);
     cJSON_Delete(root);
     return ESP_OK;
 }
@@ -336,85 +634,104 @@ static esp_err_t delete_wifi_post_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    wifi_config_t wifi_config;
-    if (esp_wifi_get_config(ESP_IF_WIFI_STA, &wifi_config) == ESP_OK) {
-        if (strcmp((char*)wifi_config.sta.ssid, ssid->valuestring) == 0) {
-            // 先断开WiFi连接
-            esp_wifi_disconnect();
-            vTaskDelay(pdMS_TO_TICKS(1000));  // 等待断开连接
-            
-            // 清除运行时的WiFi配置
-            memset(&wifi_config, 0, sizeof(wifi_config_t));
-            esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
-            
-            // 清除自定义NVS中的WiFi配置
-            nvs_handle_t nvs_handle;
-            esp_err_t err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
-            if (err == ESP_OK) {
-                err = nvs_erase_all(nvs_handle);
-                if (err == ESP_OK) {
-                    err = nvs_commit(nvs_handle);
-                    ESP_LOGI(TAG, "已清除自定义NVS中的WiFi配置");
-                }
-                nvs_close(nvs_handle);
-            }
-            
-            // 清除连接失败计数
-            err = nvs_open("wifi_state", NVS_READWRITE, &nvs_handle);
-            if (err == ESP_OK) {
-                nvs_set_u8(nvs_handle, "connection_failed", 0);
-                nvs_commit(nvs_handle);
-                nvs_close(nvs_handle);
-            }
-            
-            // 停止并重启WiFi以确保配置被完全清除
-            esp_wifi_stop();
-            vTaskDelay(pdMS_TO_TICKS(500));
-            esp_wifi_start();
-            
-            ESP_LOGI(TAG, "WiFi配置已完全删除");
-        }
+    // 正在使用的配置被删除时会断开并尝试其他配置
+    esp_err_t err = wifi_profile_delete(ssid->valuestring);
+    cJSON_Delete(root);
+    if (err == ESP_ERR_NOT_FOUND) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "WiFi not saved");
+        return ESP_FAIL;
     }
 
-    cJSON_Delete(root);
     httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
     return ESP_OK;
 }
 
+#if CONFIG_WEB_JSON_ARENA_SIZE > 0
+// cJSON使用的arena：只在httpd任务中进入，每个请求结束时整体释放
+static uint8_t json_arena_buf[CONFIG_WEB_JSON_ARENA_SIZE];
+static iot_arena_t json_arena;
+static bool json_arena_ready = false;
+static size_t json_arena_logged_peak = 0;
+#endif
+
+// 安装cJSON内存钩子（只执行一次）
+static void json_arena_init(void)
+{
+#if CONFIG_WEB_JSON_ARENA_SIZE > 0
+    if (json_arena_ready) {
+        return;
+    }
+    json_arena_ready = iot_arena_init(&json_arena, json_arena_buf, sizeof(json_arena_buf));
+    if (json_arena_ready) {
+        cJSON_Hooks hooks = {
+            .malloc_fn = iot_arena_hook_malloc,
+            .free_fn = iot_arena_hook_free,
+        };
+        cJSON_InitHooks(&hooks);
+    }
+#endif
+}
+
+// 在JSON arena中执行处理函数（user_ctx为实际的处理函数），请求中的cJSON分配不进入通用堆
+static esp_err_t json_arena_handler(httpd_req_t *req)
+{
+    esp_err_t (*handler)(httpd_req_t *) = req->user_ctx;
+#if CONFIG_WEB_JSON_ARENA_SIZE > 0
+    if (!json_arena_ready) {
+        return handler(req);
+    }
+    iot_arena_enter(&json_arena);
+    esp_err_t ret = handler(req);
+    iot_arena_leave(&json_arena);
+
+    iot_arena_stats_t stats;
+    iot_arena_get_stats(&json_arena, &stats);
+    if (stats.peak > json_arena_logged_peak) {
+        json_arena_logged_peak = stats.peak;
+        ESP_LOGI(TAG, "JSON arena峰值 %u/%u字节，回退到堆%lu次", (unsigned)stats.peak,
+                 (unsigned)stats.cap, (unsigned long)stats.overflows);
+    }
+    return ret;
+#else
+    return handler(req);
+#endif
+}
+
 // URI处理结构
-static const httpd_uri_t root = {
-    .uri       = "/",
+// 静态资源匹配所有其他GET请求，必须最后注册
+static const httpd_uri_t assets = {
+    .uri       = "/*",
     .method    = HTTP_GET,
-    .handler   = root_get_handler,
+    .handler   = asset_get_handler,
     .user_ctx  = NULL
 };
 
 static const httpd_uri_t scan = {
     .uri       = "/scan",
     .method    = HTTP_GET,
-    .handler   = scan_get_handler,
-    .user_ctx  = NULL
+    .handler   = json_arena_handler,
+    .user_ctx  = scan_get_handler
 };
 
 static const httpd_uri_t api_scan = {
     .uri       = "/api/scan",
     .method    = HTTP_GET,
-    .handler   = scan_get_handler,
-    .user_ctx  = NULL
+    .handler   = json_arena_handler,
+    .user_ctx  = scan_get_handler
 };
 
 static const httpd_uri_t configure_old = {
     .uri       = "/configure",
     .method    = HTTP_POST,
-    .handler   = configure_post_handler,
-    .user_ctx  = NULL
+    .handler   = json_arena_handler,
+    .user_ctx  = configure_post_handler
 };
 
 static const httpd_uri_t configure = {
     .uri       = "/api/connect",
     .method    = HTTP_POST,
-    .handler   = configure_post_handler,
-    .user_ctx  = NULL
+    .handler   = json_arena_handler,
+    .user_ctx  = configure_post_handler
 };
 
 static const httpd_uri_t wifi_status = {
@@ -424,47 +741,71 @@ static const httpd_uri_t wifi_status = {
     .user_ctx  = NULL
 };
 
+#if CONFIG_HTTPD_WS_SUPPORT
+static const httpd_uri_t status_ws = {
+    .uri          = "/api/ws",
+    .method       = HTTP_GET,
+    .handler      = status_ws_handler,
+    .user_ctx     = NULL,
+    .is_websocket = true
+};
+#endif
+
+static const httpd_uri_t boot_profile = {
+    .uri       = "/api/boot",
+    .method    = HTTP_GET,
+    .handler   = boot_get_handler,
+    .user_ctx  = NULL
+};
+
+static const httpd_uri_t health = {
+    .uri       = "/api/health",
+    .method    = HTTP_GET,
+    .handler   = health_get_handler,
+    .user_ctx  = NULL
+};
+
 static const httpd_uri_t saved_wifi = {
     .uri       = "/api/saved",
     .method    = HTTP_GET,
-    .handler   = saved_wifi_get_handler,
-    .user_ctx  = NULL
+    .handler   = json_arena_handler,
+    .user_ctx  = saved_wifi_get_handler
 };
 
 static const httpd_uri_t delete_wifi = {
     .uri       = "/api/delete",
     .method    = HTTP_POST,
-    .handler   = delete_wifi_post_handler,
-    .user_ctx  = NULL
+    .handler   = json_arena_handler,
+    .user_ctx  = delete_wifi_post_handler
 };
 
 // 启动Web服务器
 esp_err_t start_webserver(void)
 {
-    // 初始化NVS
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
-    }
-    ESP_ERROR_CHECK(ret);
-
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.lru_purge_enable = true;
-    config.max_uri_handlers = 9;
+    config.max_uri_handlers = 12;
     config.server_port = 8080;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+    json_arena_init();
     ESP_LOGI(TAG, "Starting server on port: '%d'", config.server_port);
     
     if (httpd_start(&server, &config) == ESP_OK) {
         ESP_LOGI(TAG, "Registering URI handlers");
-        httpd_register_uri_handler(server, &root);
         httpd_register_uri_handler(server, &scan);        // 旧的扫描路径
         httpd_register_uri_handler(server, &api_scan);    // 新的API扫描路径
         httpd_register_uri_handler(server, &configure_old); // 旧的配置路径
         httpd_register_uri_handler(server, &configure);     // 新的API配置路径
         httpd_register_uri_handler(server, &wifi_status);
+        httpd_register_uri_handler(server, &boot_profile);  // 启动阶段耗时
+        httpd_register_uri_handler(server, &health);        // 任务栈和内存
+#if CONFIG_HTTPD_WS_SUPPORT
+        httpd_register_uri_handler(server, &status_ws);   // 状态推送
+        status_push_register();
+#endif
         httpd_register_uri_handler(server, &saved_wifi);
         httpd_register_uri_handler(server, &delete_wifi);
+        httpd_register_uri_handler(server, &assets);      // 静态资源（包括 /）
         return ESP_OK;
     }
     
@@ -476,6 +817,9 @@ esp_err_t start_webserver(void)
 esp_err_t stop_webserver(void)
 {
     if (server) {
+#if CONFIG_HTTPD_WS_SUPPORT
+        status_push_unregister();
+#endif
         httpd_stop(server);
         server = NULL;
     }
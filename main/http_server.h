@@ -7,15 +7,20 @@
 #ifndef _HTTP_SERVER_H_
 #define _HTTP_SERVER_H_
 
+#include <stddef.h>
 #include "esp_err.h"
 
-#define FILE_PATH_MAX (128 + 128)
-#define CHUNK_SIZE    (4096)
-
-// 启动Web服务器
+// 启动Web服务器，调用前需要初始化esp_netif和默认事件循环
 esp_err_t start_webserver(void);
 
 // 停止Web服务器
 esp_err_t stop_webserver(void);
 
+// 挂载SPIFFS（已挂载时直接返回）；默认在首次请求资源表以外的文件时挂载，
+// CONFIG_WEB_SPIFFS_MOUNT_AT_BOOT 时由启动阶段在HTTP服务器启动之前调用
+esp_err_t http_server_mount_storage(void);
+
+// 更新网页显示的遥测数据（JSON对象，小于192字节），并推送给已连接 /api/ws 的页面
+void http_server_push_telemetry(const char *json, size_t len);
+
 #endif /* _HTTP_SERVER_H_ */
\ No newline at end of file
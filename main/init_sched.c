@@ -0,0 +1,125 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 启动阶段调度器实现
+ *
+ * 每个阶段一个任务（不绑定核心），等待依赖阶段的完成位后执行，完成后置位并删除任务；
+ * 调用者等待所有完成位。依赖只能指向前面的阶段，因此不会形成环。
+ * CONFIG_INIT_SCHED_SEQUENTIAL 时按表中顺序在调用者任务中依次执行，用于对比启动耗时。
+ */
+
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "iot_boot.h"
+#include "init_sched.h"
+
+static const char *TAG = "init_sched";
+
+#define INIT_STAGE_STACK_DEFAULT    4096
+
+// 当前执行的阶段表（同一时间只有一次执行）
+static const init_stage_t *run_stages;
+static esp_err_t run_results[INIT_SCHED_MAX_STAGES];
+static atomic_uint run_failed;              // 失败或被跳过的阶段
+#if !CONFIG_INIT_SCHED_SEQUENTIAL
+static EventGroupHandle_t run_done;         // 已结束的阶段
+#endif
+
+// 执行一个阶段（依赖的阶段已结束），记录结果
+static void run_stage(int i)
+{
+    const init_stage_t *stage = &run_stages[i];
+
+    esp_err_t ret;
+    if (atomic_load(&run_failed) & stage->deps) {
+        ESP_LOGW(TAG, "跳过 %s：依赖的阶段失败", stage->name);
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        int64_t start = esp_timer_get_time();
+        ret = stage->fn();
+        if (ret == ESP_OK) {
+            iot_boot_mark(stage->name);
+            ESP_LOGI(TAG, "%s 完成，用时%lldms (core %d)", stage->name,
+                     (esp_timer_get_time() - start) / 1000, xPortGetCoreID());
+        } else {
+            ESP_LOGE(TAG, "%s 失败: %s", stage->name, esp_err_to_name(ret));
+        }
+    }
+
+    run_results[i] = ret;
+    if (ret != ESP_OK) {
+        atomic_fetch_or(&run_failed, INIT_DEP(i));
+    }
+}
+
+#if !CONFIG_INIT_SCHED_SEQUENTIAL
+// 阶段任务
+static void init_stage_task(void *arg)
+{
+    int i = (int)(intptr_t)arg;
+    const init_stage_t *stage = &run_stages[i];
+
+    if (stage->deps) {
+        xEventGroupWaitBits(run_done, stage->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    run_stage(i);
+    xEventGroupSetBits(run_done, INIT_DEP(i));
+    vTaskDelete(NULL);
+}
+#endif
+
+esp_err_t init_sched_run(const init_stage_t *stages, size_t count)
+{
+    if (!stages || count == 0 || count > INIT_SCHED_MAX_STAGES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!stages[i].fn || (stages[i].deps & ~(INIT_DEP(i) - 1))) {
+            ESP_LOGE(TAG, "阶段 %s 无效：只能依赖排在前面的阶段", stages[i].name);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    run_stages = stages;
+    atomic_store(&run_failed, 0);
+
+#if CONFIG_INIT_SCHED_SEQUENTIAL
+    // 按表中顺序在调用者任务中依次执行（依赖只指向前面的阶段，顺序总是满足依赖）
+    for (size_t i = 0; i < count; i++) {
+        run_stage(i);
+    }
+#else
+    run_done = xEventGroupCreate();
+    if (!run_done) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    UBaseType_t prio = uxTaskPriorityGet(NULL);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t stack = stages[i].stack_size ? stages[i].stack_size : INIT_STAGE_STACK_DEFAULT;
+        if (xTaskCreate(init_stage_task, stages[i].name, stack, (void *)(intptr_t)i,
+                        prio, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "创建 %s 任务失败", stages[i].name);
+            run_results[i] = ESP_ERR_NO_MEM;
+            atomic_fetch_or(&run_failed, INIT_DEP(i));
+            xEventGroupSetBits(run_done, INIT_DEP(i));
+        }
+    }
+
+    uint32_t all = INIT_DEP(count) - 1;
+    xEventGroupWaitBits(run_done, all, pdFALSE, pdTRUE, portMAX_DELAY);
+    vEventGroupDelete(run_done);
+    run_done = NULL;
+#endif
+
+    for (size_t i = 0; i < count; i++) {
+        if (run_results[i] != ESP_OK) {
+            return run_results[i];
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,33 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 启动阶段调度器头文件
+ */
+
+#ifndef _INIT_SCHED_H_
+#define _INIT_SCHED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// 最多阶段数
+#define INIT_SCHED_MAX_STAGES   16
+
+// 依赖第i个阶段
+#define INIT_DEP(i)             (1u << (i))
+
+// 启动阶段：依赖的阶段全部成功后在独立任务中执行，没有依赖关系的阶段在两个核上并行
+typedef struct {
+    const char *name;           // 阶段名（字符串常量，同时作为启动计时的阶段名）
+    esp_err_t (*fn)(void);
+    uint32_t deps;              // 依赖的阶段，INIT_DEP()组合，只能依赖排在前面的阶段
+    uint32_t stack_size;        // 任务栈大小，0表示默认值（依次执行时不使用）
+} init_stage_t;
+
+// 执行全部阶段并等待完成；依赖的阶段失败时跳过本阶段
+// CONFIG_INIT_SCHED_SEQUENTIAL 时在调用者任务中按表中顺序依次执行
+// 返回第一个失败阶段的错误码
+esp_err_t init_sched_run(const init_stage_t *stages, size_t count);
+
+#endif /* _INIT_SCHED_H_ */
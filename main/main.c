@@ -12,83 +12,98 @@
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
-#include "esp_spiffs.h"
+#include "esp_timer.h"
+#include "esp_netif.h"
+#include "esp_event.h"
 #include "wifi_manager.h"
 #include "http_server.h"
 #include "app/app_manager.h"
+#include "init_sched.h"
+#include "nvs_cache.h"
 
 static const char *TAG = "main";
 
-// 初始化SPIFFS
-static esp_err_t init_spiffs(void)
+// 初始化NVS和写缓存
+static esp_err_t nvs_init_stage(void)
 {
-    ESP_LOGI(TAG, "Initializing SPIFFS");
-
-    esp_vfs_spiffs_conf_t conf = {
-        .base_path = "/spiffs",
-        .partition_label = NULL,
-        .max_files = 5,   // 最大打开文件数
-        .format_if_mount_failed = false
-    };
-
-    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
     if (ret != ESP_OK) {
-        if (ret == ESP_FAIL) {
-            ESP_LOGE(TAG, "Failed to mount or format filesystem");
-        } else if (ret == ESP_ERR_NOT_FOUND) {
-            ESP_LOGE(TAG, "Failed to find SPIFFS partition");
-        } else {
-            ESP_LOGE(TAG, "Failed to initialize SPIFFS (%s)", esp_err_to_name(ret));
-        }
         return ret;
     }
+    return nvs_cache_init();
+}
 
-    size_t total = 0, used = 0;
-    ret = esp_spiffs_info(NULL, &total, &used);
+// 初始化TCP/IP堆栈和默认事件循环（WiFi和HTTP服务器共用）
+static esp_err_t netif_init_stage(void)
+{
+    esp_err_t ret = esp_netif_init();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to get SPIFFS partition information (%s)", esp_err_to_name(ret));
         return ret;
     }
+    return esp_event_loop_create_default();
+}
 
-    ESP_LOGI(TAG, "Partition size: total: %d, used: %d", total, used);
-    return ESP_OK;
+// 初始化应用管理器并设置WiFi连接成功回调
+static esp_err_t app_init_stage(void)
+{
+    esp_err_t ret = app_manager_init();
+    if (ret == ESP_OK) {
+        wifi_set_connected_callback(app_on_wifi_connected);
+    }
+    return ret;
 }
 
+enum {
+    STAGE_NVS,
+    STAGE_NETIF,
+    STAGE_APP,
+#if CONFIG_WEB_SPIFFS_MOUNT_AT_BOOT
+    STAGE_SPIFFS,
+#endif
+    STAGE_WIFI,
+    STAGE_HTTPD,
+};
+
+#if CONFIG_WEB_SPIFFS_MOUNT_AT_BOOT
+#define WIFI_SPIFFS_DEP     INIT_DEP(STAGE_SPIFFS)
+#else
+#define WIFI_SPIFFS_DEP     0
+#endif
+
+// 启动阶段：WiFi等待NVS、网络和应用层；HTTP服务器的处理函数使用wifi_init_softap()中创建的
+// 配置/扫描锁，须在WiFi初始化之后启动，与后台连接AP并行
+// 网页资源已编译进固件，SPIFFS在首次请求资源表以外的文件时才挂载，不在启动路径上；
+// CONFIG_WEB_SPIFFS_MOUNT_AT_BOOT 时恢复为启动时挂载，用于对比启动耗时
+// 相互独立、可以并行的只有 nvs、netif、app_init（和启动时挂载的spiffs）；
+// CONFIG_INIT_SCHED_SEQUENTIAL 时依次执行，用于对比并行对获取IP时间的影响
+static const init_stage_t boot_stages[] = {
+    [STAGE_NVS]   = { "nvs",       nvs_init_stage,    0 },
+    [STAGE_NETIF] = { "netif",     netif_init_stage,  0 },
+    [STAGE_APP]   = { "app_init",  app_init_stage,    0 },
+#if CONFIG_WEB_SPIFFS_MOUNT_AT_BOOT
+    [STAGE_SPIFFS] = { "spiffs",   http_server_mount_storage, 0 },
+#endif
+    [STAGE_WIFI]  = { "wifi_init", wifi_init_softap,
+                      INIT_DEP(STAGE_NVS) | INIT_DEP(STAGE_NETIF) | INIT_DEP(STAGE_APP) |
+                      WIFI_SPIFFS_DEP },
+    [STAGE_HTTPD] = { "httpd",     start_webserver,   INIT_DEP(STAGE_NETIF) | INIT_DEP(STAGE_WIFI) },
+};
+
 void app_main(void)
 {    
     ESP_LOGI(TAG, "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
     ESP_LOGI(TAG, "  ESP32 IoT设备管理系统");
     ESP_LOGI(TAG, "  Author: 星年");
     ESP_LOGI(TAG, "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-    
-    // 初始化NVS
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
-    }
-    ESP_ERROR_CHECK(ret);
-    ESP_LOGI(TAG, "✅ NVS初始化完成");
-
-    // 初始化SPIFFS
-    ESP_ERROR_CHECK(init_spiffs());
-    ESP_LOGI(TAG, "✅ SPIFFS初始化完成");
-
-    // 初始化应用管理器
-    ESP_ERROR_CHECK(app_manager_init());
-    
-    // 设置WiFi连接成功回调
-    wifi_set_connected_callback(app_on_wifi_connected);
-    
-    // 初始化并启动WiFi AP
-    ESP_LOGI(TAG, "启动WiFi (AP+STA模式)");
-    ESP_ERROR_CHECK(wifi_init_softap());
 
-    // 启动HTTP服务器
-    ESP_ERROR_CHECK(start_webserver());
+    ESP_ERROR_CHECK(init_sched_run(boot_stages, sizeof(boot_stages) / sizeof(boot_stages[0])));
     
     ESP_LOGI(TAG, "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-    ESP_LOGI(TAG, "  系统初始化完成");
+    ESP_LOGI(TAG, "  系统初始化完成 (启动后%lldms)", esp_timer_get_time() / 1000);
     ESP_LOGI(TAG, "  Web配置: http://192.168.4.1:8080");
     ESP_LOGI(TAG, "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-}
\ No newline at end of file
+}
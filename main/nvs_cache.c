@@ -0,0 +1,301 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: NVS写缓存实现
+ *
+ * 每个缓存项在RAM中保存一份当前值，启动时从NVS读取一次。写入只更新RAM并通知后台任务，
+ * 后台任务按类别等待一段时间后把所有修改过的项写入flash并提交：用户配置很快写入，
+ * 运行状态限制提交频率，期间的多次修改合并为一次写入。重启前由调用者执行 nvs_cache_flush()
+ * （不在esp_restart()的关机回调中写flash：那时其他任务可能正持有cache_lock）。
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "nvs_cache.h"
+
+static const char *TAG = "nvs_cache";
+
+#define NVS_CACHE_TASK_STACK    3072
+#define NVS_CACHE_TASK_PRIO     (tskIDLE_PRIORITY + 1)
+
+typedef struct {
+    char ns[NVS_NS_NAME_MAX_SIZE];
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    uint8_t *data;
+    size_t len;                 // 当前长度，0表示不存在
+    size_t max_size;
+    bool dirty;                 // 有未写入flash的修改
+} cache_item_t;
+
+static cache_item_t items[NVS_CACHE_MAX_ITEMS];
+static int item_count = 0;
+static size_t item_max_size = 0;
+
+static SemaphoreHandle_t cache_lock = NULL;     // 保护缓存内容，持有期间只做内存拷贝
+static SemaphoreHandle_t flush_lock = NULL;     // 同一时间只有一次flash写入
+static TaskHandle_t cache_task = NULL;
+
+static int64_t config_dirty_us = 0;     // 最早未提交的配置修改时间，0表示没有
+static int64_t state_dirty_us = 0;      // 最早未提交的状态修改时间，0表示没有
+static int64_t last_commit_us = 0;
+static uint32_t pending_writes = 0;     // 自上次提交以来合并的写入次数
+
+// 写入一项并提交（不持有cache_lock）
+static esp_err_t item_write(const cache_item_t *item, const void *data, size_t len)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(item->ns, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (len > 0) {
+        err = nvs_set_blob(nvs_handle, item->key, data, len);
+    } else {
+        err = nvs_erase_key(nvs_handle, item->key);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    return err;
+}
+
+// 把所有修改过的项写入flash
+static esp_err_t flush_dirty(void)
+{
+    xSemaphoreTake(flush_lock, portMAX_DELAY);
+
+    xSemaphoreTake(cache_lock, portMAX_DELAY);
+    uint32_t writes = pending_writes;
+    pending_writes = 0;
+    config_dirty_us = 0;
+    state_dirty_us = 0;
+    xSemaphoreGive(cache_lock);
+
+    uint8_t *buf = NULL;
+    esp_err_t result = ESP_OK;
+    int written = 0;
+    for (int i = 0; i < item_count; i++) {
+        cache_item_t *item = &items[i];
+
+        xSemaphoreTake(cache_lock, portMAX_DELAY);
+        if (!item->dirty) {
+            xSemaphoreGive(cache_lock);
+            continue;
+        }
+        if (!buf && item_max_size > 0) {
+            buf = malloc(item_max_size);
+            if (!buf) {
+                xSemaphoreGive(cache_lock);
+                result = ESP_ERR_NO_MEM;
+                break;
+            }
+        }
+        size_t len = item->len;
+        memcpy(buf, item->data, len);
+        item->dirty = false;
+        xSemaphoreGive(cache_lock);
+
+        esp_err_t err = item_write(item, buf, len);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "写入 %s/%s 失败: %s", item->ns, item->key, esp_err_to_name(err));
+            xSemaphoreTake(cache_lock, portMAX_DELAY);
+            item->dirty = true;
+            xSemaphoreGive(cache_lock);
+            result = err;
+        } else {
+            written++;
+        }
+    }
+    free(buf);
+
+    xSemaphoreTake(cache_lock, portMAX_DELAY);
+    last_commit_us = esp_timer_get_time();
+    if (result != ESP_OK && state_dirty_us == 0) {
+        // 失败的项按状态类别稍后重试
+        state_dirty_us = last_commit_us;
+    }
+    xSemaphoreGive(cache_lock);
+    xSemaphoreGive(flush_lock);
+
+    if (written > 0) {
+        ESP_LOGD(TAG, "提交%d项（合并%lu次写入）", written, (unsigned long)writes);
+    }
+    return result;
+}
+
+// 下次需要提交的时间，没有修改时返回-1
+static int64_t next_commit_us(void)
+{
+    int64_t due = -1;
+    xSemaphoreTake(cache_lock, portMAX_DELAY);
+    if (config_dirty_us) {
+        due = config_dirty_us + CONFIG_NVS_CACHE_CONFIG_DELAY_MS * 1000LL;
+    }
+    if (state_dirty_us) {
+        int64_t state_due = MAX(state_dirty_us + CONFIG_NVS_CACHE_CONFIG_DELAY_MS * 1000LL,
+                                last_commit_us + CONFIG_NVS_CACHE_STATE_INTERVAL_SEC * 1000000LL);
+        due = due < 0 ? state_due : MIN(due, state_due);
+    }
+    xSemaphoreGive(cache_lock);
+    return due;
+}
+
+// 后台提交任务
+static void nvs_cache_task(void *arg)
+{
+    TickType_t wait = portMAX_DELAY;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        int64_t due = next_commit_us();
+        if (due < 0) {
+            wait = portMAX_DELAY;
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        if (due > now) {
+            wait = MAX(pdMS_TO_TICKS((due - now + 999) / 1000), 1);
+            continue;
+        }
+        flush_dirty();
+        wait = 0;
+    }
+}
+
+esp_err_t nvs_cache_init(void)
+{
+    if (cache_task) {
+        return ESP_OK;
+    }
+
+    cache_lock = xSemaphoreCreateMutex();
+    flush_lock = xSemaphoreCreateMutex();
+    if (!cache_lock || !flush_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(nvs_cache_task, "nvs_cache", NVS_CACHE_TASK_STACK, NULL,
+                    NVS_CACHE_TASK_PRIO, &cache_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+int nvs_cache_open_blob(const char *ns, const char *key, size_t max_size)
+{
+    if (!cache_lock || !ns || !key || max_size == 0 ||
+        strlen(ns) >= NVS_NS_NAME_MAX_SIZE || strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return -1;
+    }
+
+    uint8_t *data = malloc(max_size);
+    if (!data) {
+        return -1;
+    }
+
+    // 读取当前值（不存在或超过max_size时视为不存在）；flash读取不持有cache_lock，
+    // 同一项被并发打开时多读一次，插入前在锁内重新查找
+    size_t len = 0;
+    nvs_handle_t nvs_handle;
+    if (nvs_open(ns, NVS_READONLY, &nvs_handle) == ESP_OK) {
+        len = max_size;
+        if (nvs_get_blob(nvs_handle, key, data, &len) != ESP_OK) {
+            len = 0;
+        }
+        nvs_close(nvs_handle);
+    }
+
+    // 查找和插入在同一次加锁内完成，不会产生重复项
+    xSemaphoreTake(cache_lock, portMAX_DELAY);
+    for (int i = 0; i < item_count; i++) {
+        if (strcmp(items[i].ns, ns) == 0 && strcmp(items[i].key, key) == 0) {
+            xSemaphoreGive(cache_lock);
+            free(data);
+            return i;
+        }
+    }
+    if (item_count >= NVS_CACHE_MAX_ITEMS) {
+        xSemaphoreGive(cache_lock);
+        free(data);
+        ESP_LOGE(TAG, "缓存项已满，无法打开 %s/%s", ns, key);
+        return -1;
+    }
+    int item = item_count;
+    cache_item_t *p = &items[item];
+    strlcpy(p->ns, ns, sizeof(p->ns));
+    strlcpy(p->key, key, sizeof(p->key));
+    p->data = data;
+    p->len = len;
+    p->max_size = max_size;
+    p->dirty = false;
+    item_max_size = MAX(item_max_size, max_size);
+    item_count++;
+    xSemaphoreGive(cache_lock);
+    return item;
+}
+
+size_t nvs_cache_get_blob(int item, void *buf, size_t size)
+{
+    if (item < 0 || item >= item_count || !buf) {
+        return 0;
+    }
+    xSemaphoreTake(cache_lock, portMAX_DELAY);
+    size_t len = MIN(items[item].len, size);
+    memcpy(buf, items[item].data, len);
+    xSemaphoreGive(cache_lock);
+    return len;
+}
+
+esp_err_t nvs_cache_set_blob(int item, const void *data, size_t len, nvs_cache_class_t cls)
+{
+    if (item < 0 || item >= item_count || (len > 0 && !data)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    cache_item_t *p = &items[item];
+    if (len > p->max_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    xSemaphoreTake(cache_lock, portMAX_DELAY);
+    if (len == p->len && (len == 0 || memcmp(p->data, data, len) == 0)) {
+        // 内容没有变化
+        xSemaphoreGive(cache_lock);
+        return ESP_OK;
+    }
+    if (len > 0) {
+        memcpy(p->data, data, len);
+    }
+    p->len = len;
+    p->dirty = true;
+    pending_writes++;
+    int64_t now = esp_timer_get_time();
+    if (cls == NVS_CACHE_CONFIG) {
+        if (!config_dirty_us) {
+            config_dirty_us = now;
+        }
+    } else if (!state_dirty_us) {
+        state_dirty_us = now;
+    }
+    xSemaphoreGive(cache_lock);
+
+    xTaskNotifyGive(cache_task);
+    return ESP_OK;
+}
+
+esp_err_t nvs_cache_flush(void)
+{
+    if (!cache_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return flush_dirty();
+}
@@ -0,0 +1,38 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: NVS写缓存头文件
+ */
+
+#ifndef _NVS_CACHE_H_
+#define _NVS_CACHE_H_
+
+#include <stddef.h>
+#include "esp_err.h"
+
+// 最多缓存项数
+#define NVS_CACHE_MAX_ITEMS     8
+
+// 写入类别，决定多久后提交到flash
+typedef enum {
+    NVS_CACHE_STATE = 0,        // 运行状态：最多每NVS_CACHE_STATE_INTERVAL_SEC提交一次
+    NVS_CACHE_CONFIG,           // 用户配置：NVS_CACHE_CONFIG_DELAY_MS后提交
+} nvs_cache_class_t;
+
+// 初始化（NVS初始化之后调用），创建后台提交任务
+esp_err_t nvs_cache_init(void);
+
+// 打开一个blob缓存项，读取NVS中的当前值（只在此时读一次），返回项编号，失败返回-1
+int nvs_cache_open_blob(const char *ns, const char *key, size_t max_size);
+
+// 读取缓存的值，返回长度（不存在时为0）
+size_t nvs_cache_get_blob(int item, void *buf, size_t size);
+
+// 更新缓存的值并安排后台提交，立即返回；len为0时删除
+// 不会阻塞在flash操作上，可在事件循环中调用
+esp_err_t nvs_cache_set_blob(int item, const void *data, size_t len, nvs_cache_class_t cls);
+
+// 立即提交所有未写入的修改（重启前调用，否则最多丢失一个状态提交间隔的修改）
+esp_err_t nvs_cache_flush(void);
+
+#endif /* _NVS_CACHE_H_ */
@@ -0,0 +1,258 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的模拟HTTP服务器实现
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include "esp_spiffs.h"
+#include "mock_httpd.h"
+
+#define MAX_HANDLERS    16
+#define MAX_WORK        16
+#define MAX_CLIENTS     8
+
+typedef struct {
+    httpd_work_fn_t fn;
+    void *arg;
+} work_t;
+
+typedef struct {
+    int fd;
+    bool websocket;
+} client_t;
+
+// 工作队列可能在事件循环线程中加入，由lock保护；其余状态只在测试线程中访问
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static work_t work[MAX_WORK];
+static int work_head;
+static int work_count;
+static int queue_failures;
+
+static int server_handle;
+static const httpd_uri_t *handlers[MAX_HANDLERS];
+static int handler_count;
+static client_t clients[MAX_CLIENTS];
+static int client_count;
+static mock_httpd_frame_t frames[MOCK_HTTPD_MAX_FRAMES];
+static int frame_count;
+
+/* ==================== 测试接口 ==================== */
+
+void mock_httpd_add_client(int fd, bool websocket)
+{
+    if (client_count < MAX_CLIENTS) {
+        clients[client_count].fd = fd;
+        clients[client_count].websocket = websocket;
+        client_count++;
+    }
+}
+
+esp_err_t mock_httpd_get(const char *uri, int fd)
+{
+    for (int i = 0; i < handler_count; i++) {
+        if (handlers[i]->method == HTTP_GET && strcmp(handlers[i]->uri, uri) == 0) {
+            httpd_req_t req = {
+                .handle = &server_handle,
+                .method = HTTP_GET,
+                .aux = (void *)(intptr_t)fd,
+                .user_ctx = handlers[i]->user_ctx,
+            };
+            strncpy(req.uri, uri, sizeof(req.uri) - 1);
+            return handlers[i]->handler(&req);
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+void mock_httpd_fail_queue(int count)
+{
+    pthread_mutex_lock(&lock);
+    queue_failures = count;
+    pthread_mutex_unlock(&lock);
+}
+
+int mock_httpd_queued(void)
+{
+    pthread_mutex_lock(&lock);
+    int n = work_count;
+    pthread_mutex_unlock(&lock);
+    return n;
+}
+
+int mock_httpd_run_work(void)
+{
+    int done = 0;
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        if (work_count == 0) {
+            pthread_mutex_unlock(&lock);
+            return done;
+        }
+        work_t w = work[work_head];
+        work_head = (work_head + 1) % MAX_WORK;
+        work_count--;
+        pthread_mutex_unlock(&lock);
+        w.fn(w.arg);
+        done++;
+    }
+}
+
+int mock_httpd_frame_count(void)
+{
+    return frame_count;
+}
+
+const mock_httpd_frame_t *mock_httpd_frame(int i)
+{
+    return (i >= 0 && i < frame_count) ? &frames[i] : NULL;
+}
+
+/* ==================== esp_http_server接口 ==================== */
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    handler_count = 0;
+    *handle = &server_handle;
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    if (handler_count >= MAX_HANDLERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    handlers[handler_count++] = uri_handler;
+    return ESP_OK;
+}
+
+bool httpd_uri_match_wildcard(const char *reference_uri, const char *uri_to_match,
+                              size_t match_upto)
+{
+    return false;
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t fn, void *arg)
+{
+    esp_err_t ret = ESP_OK;
+    pthread_mutex_lock(&lock);
+    if (queue_failures > 0) {
+        queue_failures--;
+        ret = ESP_FAIL;
+    } else if (work_count == MAX_WORK) {
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        work[(work_head + work_count) % MAX_WORK] = (work_t){ fn, arg };
+        work_count++;
+    }
+    pthread_mutex_unlock(&lock);
+    return ret;
+}
+
+esp_err_t httpd_get_client_list(httpd_handle_t handle, size_t *fds, int *client_fds)
+{
+    size_t n = 0;
+    for (int i = 0; i < client_count && n < *fds; i++) {
+        client_fds[n++] = clients[i].fd;
+    }
+    *fds = n;
+    return ESP_OK;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r)
+{
+    return (int)(intptr_t)r->aux;
+}
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd)
+{
+    for (int i = 0; i < client_count; i++) {
+        if (clients[i].fd == fd) {
+            return clients[i].websocket ? HTTPD_WS_CLIENT_WEBSOCKET : HTTPD_WS_CLIENT_HTTP;
+        }
+    }
+    return HTTPD_WS_CLIENT_INVALID;
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame)
+{
+    if (frame_count >= MOCK_HTTPD_MAX_FRAMES || frame->len > MOCK_HTTPD_FRAME_MAX) {
+        return ESP_FAIL;
+    }
+    mock_httpd_frame_t *f = &frames[frame_count++];
+    f->fd = fd;
+    f->len = frame->len;
+    memcpy(f->data, frame->payload, frame->len);
+    f->data[frame->len] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len)
+{
+    pkt->len = 0;
+    return ESP_OK;
+}
+
+// 以下接口只有API处理函数使用，不在测试范围内
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    return -1;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val,
+                                      size_t val_size)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t *conf)
+{
+    return ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,67 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的模拟HTTP服务器
+ *
+ * 实现 stubs/esp_http_server.h 的接口但不监听端口：注册的URI处理函数记录下来，
+ * httpd_queue_work() 的工作项排队，由测试调用 mock_httpd_run_work() 在调用线程中执行
+ * （相当于httpd任务处理完手头的请求），WebSocket帧记录下来供测试检查。
+ */
+
+#ifndef _MOCK_HTTPD_H_
+#define _MOCK_HTTPD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_http_server.h"
+
+#define MOCK_HTTPD_MAX_FRAMES   64
+#define MOCK_HTTPD_FRAME_MAX    512
+
+// 一个发出的WebSocket帧
+typedef struct {
+    int fd;
+    char data[MOCK_HTTPD_FRAME_MAX + 1];   // 负载（补'\0'）
+    size_t len;
+} mock_httpd_frame_t;
+
+/**
+ * @brief 加入一个客户端连接
+ *
+ * @param websocket true为已完成握手的WebSocket连接，false为普通HTTP连接
+ */
+void mock_httpd_add_client(int fd, bool websocket);
+
+/**
+ * @brief 以GET请求调用uri的处理函数（WebSocket握手完成）
+ */
+esp_err_t mock_httpd_get(const char *uri, int fd);
+
+/**
+ * @brief 之后count次httpd_queue_work()返回失败
+ */
+void mock_httpd_fail_queue(int count);
+
+/**
+ * @brief 排队中的工作项数
+ */
+int mock_httpd_queued(void);
+
+/**
+ * @brief 按顺序执行排队的工作项（包括执行期间新加入的）
+ *
+ * @return int 执行的工作项数
+ */
+int mock_httpd_run_work(void);
+
+/**
+ * @brief 已发送的WebSocket帧数
+ */
+int mock_httpd_frame_count(void);
+
+/**
+ * @brief 取第i个帧（从0开始），不存在时返回NULL
+ */
+const mock_httpd_frame_t *mock_httpd_frame(int i);
+
+#endif /* _MOCK_HTTPD_H_ */
@@ -0,0 +1,198 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的模拟NVS实现
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "nvs_flash.h"
+#include "mock_nvs.h"
+
+#define NVS_MAX_ENTRIES     16
+#define NVS_MAX_VALUE       1024
+#define NVS_MAX_HANDLES     8
+
+typedef struct {
+    char ns[16];
+    char key[16];
+    uint8_t value[NVS_MAX_VALUE];
+    size_t len;                 // 0表示空闲
+} nvs_entry_t;
+
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static nvs_entry_t nvs_local[NVS_MAX_ENTRIES];
+static nvs_entry_t *nvs_store = nvs_local;
+static const char *nvs_handles[NVS_MAX_HANDLES];    // 句柄对应的命名空间，NULL表示空闲
+static mock_nvs_stats_t nvs_stats;
+static int fail_count = 0;
+static esp_err_t fail_err = ESP_OK;
+
+static nvs_entry_t *nvs_find(const char *ns, const char *key, bool create)
+{
+    nvs_entry_t *free_entry = NULL;
+    for (size_t i = 0; i < NVS_MAX_ENTRIES; i++) {
+        nvs_entry_t *e = &nvs_store[i];
+        if (e->len && strcmp(e->ns, ns) == 0 && strcmp(e->key, key) == 0) {
+            return e;
+        }
+        if (!e->len && !free_entry) {
+            free_entry = e;
+        }
+    }
+    if (create && free_entry) {
+        strlcpy(free_entry->ns, ns, sizeof(free_entry->ns));
+        strlcpy(free_entry->key, key, sizeof(free_entry->key));
+        return free_entry;
+    }
+    return NULL;
+}
+
+static void nvs_store_locked(const char *ns, const char *key, const void *data, size_t len)
+{
+    nvs_entry_t *e = nvs_find(ns, key, true);
+    if (!e || len == 0 || len > NVS_MAX_VALUE) {
+        fprintf(stderr, "模拟NVS写入失败: %s/%s\n", ns, key);
+        abort();
+    }
+    memcpy(e->value, data, len);
+    e->len = len;
+}
+
+void mock_nvs_share(void)
+{
+    void *mem = mmap(NULL, sizeof(nvs_local), PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    pthread_mutex_lock(&nvs_lock);
+    memcpy(mem, nvs_local, sizeof(nvs_local));
+    nvs_store = mem;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+void mock_nvs_write(const char *ns, const char *key, const void *data, size_t len)
+{
+    pthread_mutex_lock(&nvs_lock);
+    nvs_store_locked(ns, key, data, len);
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+size_t mock_nvs_read(const char *ns, const char *key, void *data, size_t size)
+{
+    pthread_mutex_lock(&nvs_lock);
+    nvs_entry_t *e = nvs_find(ns, key, false);
+    size_t len = 0;
+    if (e) {
+        memcpy(data, e->value, e->len < size ? e->len : size);
+        len = e->len;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return len;
+}
+
+void mock_nvs_fail_sets(int count, esp_err_t err)
+{
+    pthread_mutex_lock(&nvs_lock);
+    fail_count = count;
+    fail_err = err;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+void mock_nvs_get_stats(mock_nvs_stats_t *stats)
+{
+    pthread_mutex_lock(&nvs_lock);
+    *stats = nvs_stats;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out_handle)
+{
+    esp_err_t err = ESP_ERR_NO_MEM;
+    pthread_mutex_lock(&nvs_lock);
+    for (nvs_handle_t h = 0; h < NVS_MAX_HANDLES; h++) {
+        if (!nvs_handles[h]) {
+            nvs_handles[h] = ns;
+            nvs_stats.open_handles++;
+            *out_handle = h;
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&nvs_lock);
+    nvs_stats.reads++;
+    nvs_entry_t *e = nvs_find(nvs_handles[handle], key, false);
+    if (!e) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out_value && *length < e->len) {
+        err = ESP_ERR_INVALID_SIZE;
+    } else {
+        if (out_value) {
+            memcpy(out_value, e->value, e->len);
+        }
+        *length = e->len;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&nvs_lock);
+    if (fail_count > 0) {
+        fail_count--;
+        err = fail_err;
+    } else {
+        nvs_store_locked(nvs_handles[handle], key, value, length);
+        nvs_stats.sets++;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&nvs_lock);
+    nvs_stats.erases++;
+    nvs_entry_t *e = nvs_find(nvs_handles[handle], key, false);
+    if (!e) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else {
+        e->len = 0;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    nvs_stats.commits++;
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    if (handle < NVS_MAX_HANDLES && nvs_handles[handle]) {
+        nvs_handles[handle] = NULL;
+        nvs_stats.open_handles--;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+}
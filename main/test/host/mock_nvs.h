@@ -0,0 +1,54 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的模拟NVS
+ *
+ * 实现 nvs_flash.h 替身中的blob接口，内容保存在内存中，记录读写和提交次数。
+ * 接口可以在多个线程中并发调用（nvs_cache的后台任务和测试线程）。
+ * mock_nvs_share() 之后内容放在共享内存中，在fork的子进程之间保留（模拟重启）。
+ */
+
+#ifndef _MOCK_NVS_H_
+#define _MOCK_NVS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// NVS操作计数
+typedef struct {
+    uint32_t reads;             // nvs_get_blob() 次数
+    uint32_t sets;              // 成功的nvs_set_blob() 次数
+    uint32_t erases;            // nvs_erase_key() 次数（含键不存在）
+    uint32_t commits;           // nvs_commit() 次数
+    uint32_t open_handles;      // 当前打开的句柄数
+} mock_nvs_stats_t;
+
+/**
+ * @brief 把NVS内容放到进程间共享的内存中，之后fork的子进程写入的内容对其他子进程可见
+ *
+ * 在fork之前调用一次。子进程依次运行，不同时访问。
+ */
+void mock_nvs_share(void);
+
+/**
+ * @brief 直接写入NVS（准备已有的数据），不计入统计
+ */
+void mock_nvs_write(const char *ns, const char *key, const void *data, size_t len);
+
+/**
+ * @brief 读取NVS中的项，返回长度，不存在返回0
+ */
+size_t mock_nvs_read(const char *ns, const char *key, void *data, size_t size);
+
+/**
+ * @brief 之后的count次nvs_set_blob()返回err（模拟flash写入失败）
+ */
+void mock_nvs_fail_sets(int count, esp_err_t err);
+
+/**
+ * @brief 获取操作计数
+ */
+void mock_nvs_get_stats(mock_nvs_stats_t *stats);
+
+#endif /* _MOCK_NVS_H_ */
@@ -0,0 +1,650 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的模拟WiFi驱动实现
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mock_wifi.h"
+#include "nvs_flash.h"
+
+#define MAX_EVENTS          32
+#define MAX_TIMERS          8
+#define MAX_TASKS           2
+#define EVENT_DATA_SIZE     64
+
+const esp_event_base_t WIFI_EVENT = "WIFI_EVENT";
+const esp_event_base_t IP_EVENT = "IP_EVENT";
+
+static int64_t now_us = 0;
+static uint32_t next_seq = 0;           // 同一时间的事件和定时器按先后顺序处理
+
+/* ==================== 日志和C库 ==================== */
+
+void host_log(char level, const char *tag, const char *format, ...)
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        enabled = getenv("IOT_HOST_LOG") != NULL;
+    }
+    if (!enabled) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, format);
+    fprintf(stderr, "[%9.3f] %c %s: ", now_us / 1e6, level, tag);
+    vfprintf(stderr, format, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+const char *esp_err_to_name(esp_err_t err)
+{
+    switch (err) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_WIFI_CONN: return "ESP_ERR_WIFI_CONN";
+    case ESP_ERR_WIFI_STATE: return "ESP_ERR_WIFI_STATE";
+    case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+    default: return "ESP_FAIL";
+    }
+}
+
+uint32_t esp_random(void)
+{
+    // 固定种子，退避抖动每次运行相同
+    static uint32_t state = 0x2545f491;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+#if !HAVE_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+/* ==================== 事件循环和定时器 ==================== */
+
+typedef struct {
+    bool used;
+    int64_t due_us;
+    uint32_t seq;
+    uint32_t gen;                       // 连接代数，驱动重新连接或断开后旧的连接事件作废
+    esp_event_base_t base;
+    int32_t id;
+    uint8_t data[EVENT_DATA_SIZE];
+} mock_event_t;
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    bool armed;
+    int64_t due_us;
+    uint32_t seq;
+};
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void *arg;
+} mock_handler_t;
+
+static mock_event_t events[MAX_EVENTS];
+static struct esp_timer timers[MAX_TIMERS];
+static size_t timer_count = 0;
+static mock_handler_t handlers[4];
+static size_t handler_count = 0;
+
+static void post_event(esp_event_base_t base, int32_t id, const void *data, size_t len,
+                       int64_t delay_ms, uint32_t gen)
+{
+    for (size_t i = 0; i < MAX_EVENTS; i++) {
+        if (!events[i].used) {
+            events[i] = (mock_event_t) {
+                .used = true,
+                .due_us = now_us + delay_ms * 1000,
+                .seq = next_seq++,
+                .gen = gen,
+                .base = base,
+                .id = id,
+            };
+            if (data) {
+                memcpy(events[i].data, data, len);
+            }
+            return;
+        }
+    }
+    fprintf(stderr, "模拟事件队列已满\n");
+    abort();
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id,
+                                              esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance)
+{
+    if (handler_count >= sizeof(handlers) / sizeof(handlers[0])) {
+        return ESP_ERR_NO_MEM;
+    }
+    handlers[handler_count++] = (mock_handler_t) { base, id, handler, arg };
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    if (timer_count >= MAX_TIMERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_timer_handle_t t = &timers[timer_count++];
+    t->callback = args->callback;
+    t->arg = args->arg;
+    *out_handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    // 与ESP-IDF相同：已经启动的定时器不能再次启动
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->due_us = now_us + (int64_t)timeout_us;
+    timer->seq = next_seq++;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return now_us;
+}
+
+int64_t mock_now_us(void)
+{
+    return now_us;
+}
+
+/* ==================== 任务 ==================== */
+
+/*
+ * 任务（nvs_cache的后台任务）在自己的线程中运行，但和调用mock_run()的线程交替执行，
+ * 同一时间只有一个线程在运行。任务在ulTaskNotifyTake()中等待时登记唤醒时间，
+ * mock_run()和事件、定时器一起按时间顺序处理：收到通知或等待超时时切换到任务，
+ * 直到它再次等待。
+ */
+
+typedef struct {
+    TaskFunction_t fn;
+    void *arg;
+    pthread_t thread;
+    uint32_t notify;                    // 通知计数
+    bool waiting;                       // 在ulTaskNotifyTake()中等待
+    bool running;
+    int64_t wake_us;                    // 等待结束的时间，INT64_MAX表示一直等待
+    uint32_t seq;
+} mock_task_t;
+
+static mock_task_t tasks[MAX_TASKS];
+static size_t task_count = 0;
+static pthread_mutex_t task_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t task_cond = PTHREAD_COND_INITIALIZER;
+
+static void *task_entry(void *arg)
+{
+    mock_task_t *t = arg;
+    pthread_mutex_lock(&task_lock);
+    while (!t->running) {
+        pthread_cond_wait(&task_cond, &task_lock);
+    }
+    pthread_mutex_unlock(&task_lock);
+    t->fn(t->arg);
+    fprintf(stderr, "模拟任务不能返回\n");
+    abort();
+}
+
+// 切换到任务，等它再次等待后返回
+static void task_switch(mock_task_t *t)
+{
+    pthread_mutex_lock(&task_lock);
+    t->waiting = false;
+    t->running = true;
+    pthread_cond_broadcast(&task_cond);
+    while (t->running) {
+        pthread_cond_wait(&task_cond, &task_lock);
+    }
+    pthread_mutex_unlock(&task_lock);
+}
+
+static mock_task_t *task_find(pthread_t thread)
+{
+    for (size_t i = 0; i < task_count; i++) {
+        if (pthread_equal(tasks[i].thread, thread)) {
+            return &tasks[i];
+        }
+    }
+    fprintf(stderr, "不是模拟任务\n");
+    abort();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out_handle)
+{
+    if (task_count >= MAX_TASKS) {
+        return pdFAIL;
+    }
+    // 下一次mock_run()时开始运行
+    mock_task_t *t = &tasks[task_count];
+    *t = (mock_task_t) {
+        .fn = fn,
+        .arg = arg,
+        .waiting = true,
+        .wake_us = now_us,
+        .seq = next_seq++,
+    };
+    if (pthread_create(&t->thread, NULL, task_entry, t) != 0) {
+        return pdFAIL;
+    }
+    pthread_detach(t->thread);
+    task_count++;
+    if (out_handle) {
+        *out_handle = (TaskHandle_t)(uintptr_t)t->thread;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    if (action != eIncrement) {
+        fprintf(stderr, "模拟任务只支持xTaskNotifyGive()\n");
+        abort();
+    }
+    mock_task_t *t = task_find((pthread_t)(uintptr_t)task);
+    pthread_mutex_lock(&task_lock);
+    t->notify++;
+    if (t->waiting && t->wake_us > now_us) {
+        t->wake_us = now_us;
+        t->seq = next_seq++;
+    }
+    pthread_mutex_unlock(&task_lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    mock_task_t *t = task_find(pthread_self());
+    pthread_mutex_lock(&task_lock);
+    if (t->notify == 0 && ticks > 0) {
+        t->waiting = true;
+        t->wake_us = ticks == portMAX_DELAY ? INT64_MAX : now_us + (int64_t)ticks * 1000;
+        t->seq = next_seq++;
+        t->running = false;
+        pthread_cond_broadcast(&task_cond);
+        while (!t->running) {
+            pthread_cond_wait(&task_cond, &task_lock);
+        }
+    }
+    uint32_t value = t->notify;
+    t->notify = clear_on_exit ? 0 : (value > 0 ? value - 1 : 0);
+    pthread_mutex_unlock(&task_lock);
+    return value;
+}
+
+/* ==================== 按时间顺序运行 ==================== */
+
+static void dispatch_event(mock_event_t *ev);
+
+bool mock_run(int64_t until_us, bool (*stop)(void))
+{
+    for (;;) {
+        if (stop && stop()) {
+            return true;
+        }
+        // 找最早的一项，时间相同时按先后顺序
+        mock_event_t *ev = NULL;
+        esp_timer_handle_t timer = NULL;
+        int64_t due = INT64_MAX;
+        uint32_t seq = 0;
+        for (size_t i = 0; i < MAX_EVENTS; i++) {
+            if (events[i].used && (events[i].due_us < due ||
+                                   (events[i].due_us == due && events[i].seq < seq))) {
+                ev = &events[i];
+                due = ev->due_us;
+                seq = ev->seq;
+            }
+        }
+        for (size_t i = 0; i < timer_count; i++) {
+            if (timers[i].armed && (timers[i].due_us < due ||
+                                    (timers[i].due_us == due && timers[i].seq < seq))) {
+                timer = &timers[i];
+                ev = NULL;
+                due = timer->due_us;
+                seq = timer->seq;
+            }
+        }
+        mock_task_t *task = NULL;
+        for (size_t i = 0; i < task_count; i++) {
+            if (tasks[i].waiting && tasks[i].wake_us != INT64_MAX &&
+                (tasks[i].wake_us < due || (tasks[i].wake_us == due && tasks[i].seq < seq))) {
+                task = &tasks[i];
+                ev = NULL;
+                timer = NULL;
+                due = task->wake_us;
+                seq = task->seq;
+            }
+        }
+        if ((!ev && !timer && !task) || due > until_us) {
+            now_us = until_us;
+            return false;
+        }
+
+        now_us = due;
+        if (task) {
+            task_switch(task);
+        } else if (timer) {
+            timer->armed = false;
+            timer->callback(timer->arg);
+        } else {
+            mock_event_t copy = *ev;
+            ev->used = false;
+            dispatch_event(&copy);
+        }
+    }
+}
+
+/* ==================== 驱动 ==================== */
+
+typedef enum {
+    STA_IDLE = 0,
+    STA_CONNECTING,
+    STA_CONNECTED,
+} sta_state_t;
+
+static mock_ap_t aps[MOCK_MAX_APS];
+static size_t ap_count = 0;
+static mock_wifi_stats_t stats;
+static wifi_sta_config_t sta_config;
+static sta_state_t sta_state = STA_IDLE;
+static uint32_t sta_gen = 0;
+static const mock_ap_t *sta_target = NULL;   // 正在连接的AP
+static bool started = false;
+static bool scanning = false;
+static wifi_ap_record_t scan_results[MOCK_MAX_APS];
+static uint16_t scan_result_count = 0;
+
+mock_ap_t *mock_wifi_add_ap(const char *ssid, const char *password, uint8_t id,
+                            uint8_t channel, int8_t rssi)
+{
+    if (ap_count >= MOCK_MAX_APS) {
+        return NULL;
+    }
+    mock_ap_t *ap = &aps[ap_count++];
+    memset(ap, 0, sizeof(*ap));
+    strlcpy(ap->ssid, ssid, sizeof(ap->ssid));
+    strlcpy(ap->password, password, sizeof(ap->password));
+    ap->bssid[0] = 0x02;
+    ap->bssid[5] = id;
+    ap->channel = channel;
+    ap->rssi = rssi;
+    ap->on = true;
+    return ap;
+}
+
+const mock_wifi_stats_t *mock_wifi_stats(void)
+{
+    return &stats;
+}
+
+static void post_disconnected(uint8_t reason, int64_t delay_ms)
+{
+    wifi_event_sta_disconnected_t ev = { .reason = reason };
+    post_event(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &ev, sizeof(ev), delay_ms, sta_gen);
+}
+
+void mock_wifi_link_lost(void)
+{
+    if (sta_state != STA_CONNECTED) {
+        return;
+    }
+    sta_gen++;
+    sta_state = STA_IDLE;
+    stats.ap = NULL;
+    post_disconnected(WIFI_REASON_BEACON_TIMEOUT, 0);
+}
+
+static void dispatch_event(mock_event_t *ev)
+{
+    if (ev->base == WIFI_EVENT && (ev->id == WIFI_EVENT_STA_CONNECTED ||
+                                   ev->id == WIFI_EVENT_STA_DISCONNECTED)) {
+        if (ev->gen != sta_gen) {
+            return;                     // 之后又调用了连接或断开
+        }
+        if (ev->id == WIFI_EVENT_STA_CONNECTED) {
+            sta_state = STA_CONNECTED;
+            stats.ap = sta_target;
+        } else {
+            sta_state = STA_IDLE;
+            stats.ap = NULL;
+        }
+    } else if (ev->base == IP_EVENT && ev->id == IP_EVENT_STA_GOT_IP) {
+        if (ev->gen != sta_gen || sta_state != STA_CONNECTED) {
+            return;
+        }
+        stats.got_ip++;
+        stats.got_ip_us = now_us;
+    } else if (ev->base == WIFI_EVENT && ev->id == WIFI_EVENT_SCAN_DONE) {
+        scanning = false;
+        stats.scanning = false;
+    }
+
+    for (size_t i = 0; i < handler_count; i++) {
+        if (handlers[i].base == ev->base &&
+            (handlers[i].id == ESP_EVENT_ANY_ID || handlers[i].id == ev->id)) {
+            handlers[i].handler(handlers[i].arg, ev->base, ev->id, ev->data);
+        }
+    }
+}
+
+esp_netif_t *esp_netif_create_default_wifi_ap(void)
+{
+    return (esp_netif_t *)&aps[0];
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+    return (esp_netif_t *)&aps[1];
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    if (interface == WIFI_IF_STA) {
+        sta_config = conf->sta;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    if (started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    started = true;
+    post_event(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0, 0, 0);
+    return ESP_OK;
+}
+
+static bool ap_matches(const mock_ap_t *ap, uint8_t channel)
+{
+    return ap->on && ap->channel == channel &&
+           strncmp(ap->ssid, (const char *)sta_config.ssid, sizeof(sta_config.ssid)) == 0 &&
+           (!sta_config.bssid_set || memcmp(ap->bssid, sta_config.bssid, 6) == 0);
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    if (!started) {
+        return ESP_ERR_WIFI_STATE;
+    }
+    if (sta_state != STA_IDLE) {
+        stats.connect_errors++;
+        return ESP_ERR_WIFI_CONN;
+    }
+    if (scanning) {
+        // 与驱动相同：扫描进行中不能开始连接
+        stats.scan_busy_errors++;
+        return ESP_ERR_WIFI_STATE;
+    }
+    if (stats.connects < MOCK_MAX_CONNECTS) {
+        stats.connect_us[stats.connects] = now_us;
+    }
+    stats.connects++;
+    stats.fast_connects += sta_config.bssid_set && sta_config.channel != 0;
+    sta_gen++;
+    sta_state = STA_CONNECTING;
+
+    // 扫描：指定信道时只扫该信道；否则快速扫描在第一个有匹配AP的信道停止，全信道扫描扫完全部信道
+    uint8_t first = sta_config.channel ? sta_config.channel : 1;
+    uint8_t last = sta_config.channel ? sta_config.channel : MOCK_CHANNELS;
+    const mock_ap_t *best = NULL;
+    uint32_t scanned = 0;
+    for (uint8_t ch = first; ch <= last; ch++) {
+        scanned++;
+        for (size_t i = 0; i < ap_count; i++) {
+            if (ap_matches(&aps[i], ch) && (!best || aps[i].rssi > best->rssi)) {
+                best = &aps[i];
+            }
+        }
+        if (best && sta_config.scan_method == WIFI_FAST_SCAN) {
+            break;
+        }
+    }
+    stats.channels_scanned += scanned;
+    int64_t t = scanned * MOCK_SCAN_CHANNEL_MS;
+
+    sta_target = best;
+    if (!best) {
+        post_disconnected(WIFI_REASON_NO_AP_FOUND, t);
+    } else if (strncmp(best->password, (const char *)sta_config.password,
+                       sizeof(sta_config.password)) != 0) {
+        post_disconnected(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT,
+                          t + MOCK_AUTH_ASSOC_MS + MOCK_HANDSHAKE_TIMEOUT_MS);
+    } else {
+        t += MOCK_AUTH_ASSOC_MS + MOCK_HANDSHAKE_MS;
+        post_event(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, NULL, 0, t, sta_gen);
+        ip_event_got_ip_t ip = { .ip_info.ip.addr = 0x6401a8c0 };   // 192.168.1.100
+        post_event(IP_EVENT, IP_EVENT_STA_GOT_IP, &ip, sizeof(ip), t + MOCK_DHCP_MS, sta_gen);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    if (sta_state == STA_IDLE) {
+        return ESP_OK;
+    }
+    // 放弃正在进行的连接，断开事件随后到达
+    sta_gen++;
+    sta_state = STA_IDLE;
+    stats.ap = NULL;
+    post_disconnected(WIFI_REASON_ASSOC_LEAVE, 1);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block)
+{
+    // 正在连接或正在扫描时驱动拒绝扫描
+    if (!started || sta_state == STA_CONNECTING || scanning) {
+        return ESP_ERR_WIFI_STATE;
+    }
+    scanning = true;
+    stats.scanning = true;
+    scan_result_count = 0;
+    for (uint8_t ch = 1; ch <= MOCK_CHANNELS; ch++) {
+        if (config->channel && config->channel != ch) {
+            continue;
+        }
+        stats.bg_scan_channels++;
+        for (size_t i = 0; i < ap_count; i++) {
+            if (aps[i].on && aps[i].channel == ch) {
+                wifi_ap_record_t *rec = &scan_results[scan_result_count++];
+                memset(rec, 0, sizeof(*rec));
+                memcpy(rec->bssid, aps[i].bssid, 6);
+                strlcpy((char *)rec->ssid, aps[i].ssid, sizeof(rec->ssid));
+                rec->primary = ch;
+                rec->rssi = aps[i].rssi;
+                rec->authmode = aps[i].password[0] ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+            }
+        }
+    }
+    uint32_t dwell = config->scan_time.active.max ? config->scan_time.active.max : MOCK_SCAN_CHANNEL_MS;
+    post_event(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, NULL, 0, dwell, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records)
+{
+    uint16_t n = *number < scan_result_count ? *number : scan_result_count;
+    memcpy(ap_records, scan_results, n * sizeof(wifi_ap_record_t));
+    *number = n;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_country(wifi_country_t *country)
+{
+    *country = (wifi_country_t) { .cc = "CN", .schan = 1, .nchan = MOCK_CHANNELS };
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+    if (sta_state != STA_CONNECTED || !stats.ap) {
+        return ESP_ERR_WIFI_CONN;
+    }
+    memset(ap_info, 0, sizeof(*ap_info));
+    memcpy(ap_info->bssid, stats.ap->bssid, 6);
+    strlcpy((char *)ap_info->ssid, stats.ap->ssid, sizeof(ap_info->ssid));
+    ap_info->primary = stats.ap->channel;
+    ap_info->rssi = stats.ap->rssi;
+    return ESP_OK;
+}
@@ -0,0 +1,83 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的模拟WiFi驱动
+ *
+ * 实现组件主机测试 stubs/ 中esp_wifi、esp_event、esp_timer和FreeRTOS任务通知的接口，让应用的
+ * wifi_manager.c、nvs_cache.c 不经修改在开发机上运行（NVS由 mock_nvs.c 模拟）。所有事件、定时器
+ * 和任务按虚拟时钟的时间顺序在调用 mock_run() 的线程中处理，结果可重复。
+ *
+ * 驱动按下面的时间模型产生事件（数值取ESP32的典型值，只用于比较不同连接方式的相对耗时）：
+ * 连接时先扫描（指定信道时只扫该信道，否则按scan_method扫描），找到AP后认证、关联、四次握手，
+ * 再经过DHCP得到IP；没有找到AP时扫描结束即断开（NO_AP_FOUND），密码错误时四次握手超时后断开。
+ */
+
+#ifndef MOCK_WIFI_H
+#define MOCK_WIFI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_wifi.h"
+
+#define MOCK_CHANNELS               13      // 信道1~13
+#define MOCK_SCAN_CHANNEL_MS        120     // 连接前每个信道的主动扫描时间（ESP-IDF默认）
+#define MOCK_AUTH_ASSOC_MS          30      // 认证和关联
+#define MOCK_HANDSHAKE_MS           40      // WPA2四次握手
+#define MOCK_HANDSHAKE_TIMEOUT_MS   3000    // 密码错误时四次握手超时
+#define MOCK_DHCP_MS                250     // DHCP获取地址
+#define MOCK_MAX_APS                8
+#define MOCK_MAX_CONNECTS           64      // 记录时间的连接次数
+
+// 模拟的AP
+typedef struct {
+    char ssid[33];
+    char password[65];
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    bool on;                        // 是否在范围内
+} mock_ap_t;
+
+// 驱动统计
+typedef struct {
+    uint32_t connects;              // esp_wifi_connect() 次数
+    uint32_t fast_connects;         // 其中指定了BSSID和信道的次数
+    uint32_t connect_errors;        // 正在连接或已连接时又调用esp_wifi_connect()的次数
+    uint32_t scan_busy_errors;      // 扫描进行中调用esp_wifi_connect()被拒绝的次数
+    uint32_t channels_scanned;      // 连接前扫描的信道数（累计）
+    uint32_t bg_scan_channels;      // 后台扫描的信道数（累计）
+    uint32_t got_ip;                // 获取IP的次数
+    int64_t got_ip_us;              // 最后一次获取IP的时间
+    int64_t connect_us[MOCK_MAX_CONNECTS];  // 每次esp_wifi_connect()的时间
+    bool scanning;                  // 后台扫描进行中
+    const mock_ap_t *ap;            // 当前连接的AP，未连接为NULL
+} mock_wifi_stats_t;
+
+/**
+ * @brief 添加AP，bssid取 02:00:00:00:00:<id>
+ */
+mock_ap_t *mock_wifi_add_ap(const char *ssid, const char *password, uint8_t id,
+                            uint8_t channel, int8_t rssi);
+
+/**
+ * @brief 当前连接的AP信号丢失（信标超时），立即产生断开事件
+ */
+void mock_wifi_link_lost(void);
+
+const mock_wifi_stats_t *mock_wifi_stats(void);
+
+/**
+ * @brief 虚拟时钟的当前时间（微秒），每个进程从0开始
+ */
+int64_t mock_now_us(void);
+
+/**
+ * @brief 按时间顺序处理事件和定时器
+ *
+ * @param until_us 最多运行到这个时间
+ * @param stop 每处理一项后检查，返回true时停止；可以为NULL
+ * @return stop返回true时为true，到达until_us时为false
+ */
+bool mock_run(int64_t until_us, bool (*stop)(void));
+
+#endif // MOCK_WIFI_H
@@ -0,0 +1,58 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的cJSON.h替身
+ *
+ * 主机上没有cJSON，http_server.c 中使用cJSON的API处理函数不在测试范围内，
+ * 这里只提供声明和空实现（创建失败、解析失败），让文件原样编译。
+ */
+
+#ifndef HOST_STUB_CJSON_H
+#define HOST_STUB_CJSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct cJSON {
+    char *valuestring;
+} cJSON;
+
+typedef struct {
+    void *(*malloc_fn)(size_t size);
+    void (*free_fn)(void *ptr);
+} cJSON_Hooks;
+
+static inline void cJSON_InitHooks(cJSON_Hooks *hooks) { (void)hooks; }
+static inline cJSON *cJSON_Parse(const char *value) { (void)value; return NULL; }
+static inline cJSON *cJSON_CreateObject(void) { return NULL; }
+static inline cJSON *cJSON_CreateArray(void) { return NULL; }
+static inline void cJSON_Delete(cJSON *item) { (void)item; }
+static inline void cJSON_free(void *object) { (void)object; }
+static inline char *cJSON_PrintUnformatted(const cJSON *item) { (void)item; return NULL; }
+static inline cJSON *cJSON_GetObjectItem(const cJSON *object, const char *name)
+{
+    (void)object; (void)name; return NULL;
+}
+static inline bool cJSON_IsString(const cJSON *item) { (void)item; return false; }
+static inline bool cJSON_AddItemToArray(cJSON *array, cJSON *item)
+{
+    (void)array; (void)item; return false;
+}
+static inline cJSON *cJSON_AddArrayToObject(cJSON *object, const char *name)
+{
+    (void)object; (void)name; return NULL;
+}
+static inline cJSON *cJSON_AddBoolToObject(cJSON *object, const char *name, bool b)
+{
+    (void)object; (void)name; (void)b; return NULL;
+}
+static inline cJSON *cJSON_AddNumberToObject(cJSON *object, const char *name, double n)
+{
+    (void)object; (void)name; (void)n; return NULL;
+}
+static inline cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *s)
+{
+    (void)object; (void)name; (void)s; return NULL;
+}
+
+#endif // HOST_STUB_CJSON_H
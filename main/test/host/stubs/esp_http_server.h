@@ -0,0 +1,109 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的esp_http_server.h替身
+ *
+ * 只包含 http_server.c 用到的类型和接口，取值与ESP-IDF相同，由 mock_httpd.c 实现。
+ */
+
+#ifndef HOST_STUB_ESP_HTTP_SERVER_H
+#define HOST_STUB_ESP_HTTP_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include "esp_err.h"
+
+typedef void *httpd_handle_t;
+
+typedef enum {
+    HTTP_GET = 1,
+    HTTP_POST = 3,
+} httpd_method_t;
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int method;
+    char uri[CONFIG_HTTPD_MAX_URI_LEN + 1];
+    size_t content_len;
+    void *aux;
+    void *user_ctx;
+} httpd_req_t;
+
+typedef struct httpd_uri {
+    const char *uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t *r);
+    void *user_ctx;
+    bool is_websocket;
+} httpd_uri_t;
+
+typedef bool (*httpd_uri_match_func_t)(const char *reference_uri, const char *uri_to_match,
+                                       size_t match_upto);
+
+typedef struct {
+    uint16_t server_port;
+    uint16_t max_uri_handlers;
+    bool lru_purge_enable;
+    httpd_uri_match_func_t uri_match_fn;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() { .server_port = 80, .max_uri_handlers = 8 }
+
+typedef enum {
+    HTTPD_400_BAD_REQUEST = 400,
+    HTTPD_404_NOT_FOUND = 404,
+    HTTPD_500_INTERNAL_SERVER_ERROR = 500,
+} httpd_err_code_t;
+
+typedef enum {
+    HTTPD_WS_TYPE_CONTINUE = 0x0,
+    HTTPD_WS_TYPE_TEXT = 0x1,
+    HTTPD_WS_TYPE_BINARY = 0x2,
+    HTTPD_WS_TYPE_CLOSE = 0x8,
+    HTTPD_WS_TYPE_PING = 0x9,
+    HTTPD_WS_TYPE_PONG = 0xA,
+} httpd_ws_type_t;
+
+typedef struct {
+    bool final;
+    bool fragmented;
+    httpd_ws_type_t type;
+    uint8_t *payload;
+    size_t len;
+} httpd_ws_frame_t;
+
+typedef enum {
+    HTTPD_WS_CLIENT_INVALID = 0x0,
+    HTTPD_WS_CLIENT_HTTP = 0x1,
+    HTTPD_WS_CLIENT_WEBSOCKET = 0x2,
+} httpd_ws_client_info_t;
+
+typedef void (*httpd_work_fn_t)(void *arg);
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_stop(httpd_handle_t handle);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler);
+bool httpd_uri_match_wildcard(const char *reference_uri, const char *uri_to_match,
+                              size_t match_upto);
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg);
+esp_err_t httpd_get_client_list(httpd_handle_t handle, size_t *fds, int *client_fds);
+int httpd_req_to_sockfd(httpd_req_t *r);
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len);
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val,
+                                      size_t val_size);
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg);
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd);
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len);
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame);
+
+#endif // HOST_STUB_ESP_HTTP_SERVER_H
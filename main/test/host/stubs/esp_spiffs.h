@@ -0,0 +1,23 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的esp_spiffs.h替身（由 mock_httpd.c 实现，挂载总是失败）
+ */
+
+#ifndef HOST_STUB_ESP_SPIFFS_H
+#define HOST_STUB_ESP_SPIFFS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct {
+    const char *base_path;
+    const char *partition_label;
+    size_t max_files;
+    bool format_if_mount_failed;
+} esp_vfs_spiffs_conf_t;
+
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t *conf);
+
+#endif // HOST_STUB_ESP_SPIFFS_H
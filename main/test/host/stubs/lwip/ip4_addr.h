@@ -0,0 +1,12 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 主机测试用的lwip/ip4_addr.h替身（IPSTR、IP2STR在esp_netif.h替身中）
+ */
+
+#ifndef HOST_STUB_LWIP_IP4_ADDR_H
+#define HOST_STUB_LWIP_IP4_ADDR_H
+
+#include "esp_netif.h"
+
+#endif // HOST_STUB_LWIP_IP4_ADDR_H
@@ -0,0 +1,240 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: NVS写缓存主机测试
+ *
+ * nvs_cache.c 原样编译，运行在 host_rtos.c（线程实现的FreeRTOS，真实时间）和模拟NVS上。
+ * CMakeLists.txt中配置提交延迟为100ms、状态提交间隔为1秒。检查：
+ * - 连续的配置修改合并为一次写入，在第一次修改约100ms后提交，内容为最后一次的值
+ * - 内容没有变化的写入不提交
+ * - 运行状态距上次提交不足间隔时推迟到间隔结束，期间的多次修改合并为一次写入
+ * - 配置提交时一并写入未提交的状态
+ * - nvs_cache_flush() 立即写入，之后后台任务不再重复写入
+ * - 删除、写入失败后重试、参数检查，所有NVS句柄都被关闭
+ */
+
+#include <stdbool.h>
+#include "host_test.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "mock_nvs.h"
+#include "nvs_cache.h"
+
+#define NS              "app"
+#define POLL_MS         5
+
+static int cfg_item;
+static int state_item;
+
+static uint32_t commits(void)
+{
+    mock_nvs_stats_t st;
+    mock_nvs_get_stats(&st);
+    return st.commits;
+}
+
+static uint32_t sets(void)
+{
+    mock_nvs_stats_t st;
+    mock_nvs_get_stats(&st);
+    return st.sets;
+}
+
+static int64_t now_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+/**
+ * @brief 等待提交次数达到count
+ *
+ * @return int64_t 提交时的时间（ms），超时返回-1
+ */
+static int64_t wait_commits(uint32_t count, int timeout_ms)
+{
+    int64_t deadline = now_ms() + timeout_ms;
+    while (commits() < count) {
+        if (now_ms() >= deadline) {
+            return -1;
+        }
+        vTaskDelay(pdMS_TO_TICKS(POLL_MS));
+    }
+    return now_ms();
+}
+
+static bool nvs_equals(const char *key, const char *expect)
+{
+    char buf[64] = { 0 };
+    size_t len = mock_nvs_read(NS, key, buf, sizeof(buf) - 1);
+    return len == strlen(expect) && memcmp(buf, expect, len) == 0;
+}
+
+static void set_str(int item, const char *s, nvs_cache_class_t cls)
+{
+    CHECK(nvs_cache_set_blob(item, s, strlen(s), cls) == ESP_OK);
+}
+
+// 打开时读取NVS中已有的值；参数检查
+static void test_open(void)
+{
+    mock_nvs_write(NS, "state", "boot", 4);
+    CHECK(nvs_cache_init() == ESP_OK);
+    CHECK(nvs_cache_init() == ESP_OK);
+
+    cfg_item = nvs_cache_open_blob(NS, "cfg", 32);
+    state_item = nvs_cache_open_blob(NS, "state", 16);
+    CHECK(cfg_item >= 0 && state_item >= 0 && cfg_item != state_item);
+    CHECK(nvs_cache_open_blob(NS, "cfg", 32) == cfg_item);
+
+    char buf[16];
+    CHECK(nvs_cache_get_blob(cfg_item, buf, sizeof(buf)) == 0);
+    CHECK(nvs_cache_get_blob(state_item, buf, sizeof(buf)) == 4 && memcmp(buf, "boot", 4) == 0);
+    CHECK(nvs_cache_get_blob(state_item, buf, 2) == 2);
+
+    CHECK(nvs_cache_open_blob(NS, "0123456789abcdef", 8) == -1);   // 键名超过15字节
+    CHECK(nvs_cache_open_blob(NS, "zero", 0) == -1);
+    CHECK(nvs_cache_set_blob(-1, "x", 1, NVS_CACHE_CONFIG) == ESP_ERR_INVALID_ARG);
+    CHECK(nvs_cache_set_blob(cfg_item, NULL, 1, NVS_CACHE_CONFIG) == ESP_ERR_INVALID_ARG);
+    char big[33] = { 0 };
+    CHECK(nvs_cache_set_blob(cfg_item, big, sizeof(big), NVS_CACHE_CONFIG) == ESP_ERR_INVALID_SIZE);
+    CHECK(commits() == 0);
+}
+
+// 连续的配置修改合并为一次提交；返回提交的时间
+static int64_t test_config_coalesce(void)
+{
+    uint32_t c0 = commits();
+    uint32_t s0 = sets();
+    int64_t start = now_ms();
+    for (int i = 0; i < 5; i++) {
+        char v[8];
+        snprintf(v, sizeof(v), "v%d", i);
+        set_str(cfg_item, v, NVS_CACHE_CONFIG);
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    // 修改只在内存中，立即可读
+    char buf[8] = { 0 };
+    CHECK(nvs_cache_get_blob(cfg_item, buf, sizeof(buf) - 1) == 2 && strcmp(buf, "v4") == 0);
+    CHECK(commits() == c0);
+
+    int64_t at = wait_commits(c0 + 1, 1000);
+    CHECK(at >= 0);
+    int64_t delay = at - start;
+    CHECK(delay >= CONFIG_NVS_CACHE_CONFIG_DELAY_MS && delay < CONFIG_NVS_CACHE_CONFIG_DELAY_MS + 100);
+    CHECK(sets() == s0 + 1);
+    CHECK(nvs_equals("cfg", "v4"));
+    printf("{\"test\":\"nvs_cache_config\",\"writes\":5,\"commits\":%u,\"delay_ms\":%lld}\n",
+           commits() - c0, (long long)delay);
+
+    // 内容相同的写入不提交
+    set_str(cfg_item, "v4", NVS_CACHE_CONFIG);
+    CHECK(wait_commits(c0 + 2, CONFIG_NVS_CACHE_CONFIG_DELAY_MS * 2) < 0);
+    return at;
+}
+
+// 距上次提交不足间隔时，状态修改推迟到间隔结束再一次写入
+static void test_state_rate_limit(int64_t last_commit_ms)
+{
+    uint32_t c0 = commits();
+    uint32_t s0 = sets();
+    for (int i = 0; i < 10; i++) {
+        char v[8];
+        snprintf(v, sizeof(v), "s%d", i);
+        set_str(state_item, v, NVS_CACHE_STATE);
+        vTaskDelay(pdMS_TO_TICKS(30));
+    }
+    int64_t at = wait_commits(c0 + 1, 2000);
+    CHECK(at >= 0);
+    int64_t since_last = at - last_commit_ms;
+    // last_commit_ms是轮询观察到的时间，最多比实际提交晚POLL_MS
+    CHECK(since_last >= CONFIG_NVS_CACHE_STATE_INTERVAL_SEC * 1000 - POLL_MS - 1);
+    CHECK(since_last < CONFIG_NVS_CACHE_STATE_INTERVAL_SEC * 1000 + 150);
+    CHECK(sets() == s0 + 1);
+    CHECK(nvs_equals("state", "s9"));
+    printf("{\"test\":\"nvs_cache_state\",\"writes\":10,\"commits\":%u,\"since_last_commit_ms\":%lld}\n",
+           commits() - c0, (long long)since_last);
+}
+
+// 配置提交时一并写入未提交的状态，之后不再单独提交状态
+static void test_config_carries_state(void)
+{
+    uint32_t c0 = commits();
+    uint32_t s0 = sets();
+    set_str(state_item, "carried", NVS_CACHE_STATE);
+    vTaskDelay(pdMS_TO_TICKS(20));
+    set_str(cfg_item, "c1", NVS_CACHE_CONFIG);
+    CHECK(wait_commits(c0 + 2, 500) >= 0);
+    CHECK(sets() == s0 + 2);
+    CHECK(nvs_equals("state", "carried") && nvs_equals("cfg", "c1"));
+    CHECK(wait_commits(c0 + 3, CONFIG_NVS_CACHE_STATE_INTERVAL_SEC * 1000 + 200) < 0);
+}
+
+// 显式刷新立即写入（重启前），后台任务不再重复写入
+static void test_flush(void)
+{
+    uint32_t c0 = commits();
+    set_str(state_item, "flushed", NVS_CACHE_STATE);
+    CHECK(nvs_cache_flush() == ESP_OK);
+    CHECK(commits() == c0 + 1);
+    CHECK(nvs_equals("state", "flushed"));
+    CHECK(nvs_cache_flush() == ESP_OK);
+    CHECK(commits() == c0 + 1);
+    CHECK(wait_commits(c0 + 2, CONFIG_NVS_CACHE_STATE_INTERVAL_SEC * 1000 + 200) < 0);
+}
+
+// 长度为0时删除
+static void test_delete(void)
+{
+    mock_nvs_stats_t before, after;
+    mock_nvs_get_stats(&before);
+    CHECK(nvs_cache_set_blob(cfg_item, NULL, 0, NVS_CACHE_CONFIG) == ESP_OK);
+    CHECK(wait_commits(before.commits + 1, 500) >= 0);
+    mock_nvs_get_stats(&after);
+    CHECK(after.erases == before.erases + 1);
+    char buf[8];
+    CHECK(mock_nvs_read(NS, "cfg", buf, sizeof(buf)) == 0);
+    CHECK(nvs_cache_get_blob(cfg_item, buf, sizeof(buf)) == 0);
+}
+
+// 写入失败的项保留，之后重试
+static void test_write_failure(void)
+{
+    // 显式刷新返回错误，再次刷新时写入
+    mock_nvs_fail_sets(1, ESP_FAIL);
+    set_str(cfg_item, "f1", NVS_CACHE_CONFIG);
+    CHECK(nvs_cache_flush() == ESP_FAIL);
+    CHECK(!nvs_equals("cfg", "f1"));
+    CHECK(nvs_cache_flush() == ESP_OK);
+    CHECK(nvs_equals("cfg", "f1"));
+
+    // 后台提交失败后按状态类别在间隔结束时重试
+    uint32_t s0 = sets();
+    mock_nvs_fail_sets(1, ESP_FAIL);
+    set_str(cfg_item, "f2", NVS_CACHE_CONFIG);
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_NVS_CACHE_CONFIG_DELAY_MS + 100));
+    CHECK(sets() == s0);
+    CHECK(!nvs_equals("cfg", "f2"));
+    int64_t deadline = now_ms() + CONFIG_NVS_CACHE_STATE_INTERVAL_SEC * 1000 + 500;
+    while (sets() == s0 && now_ms() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(POLL_MS));
+    }
+    CHECK(sets() == s0 + 1);
+    CHECK(nvs_equals("cfg", "f2"));
+}
+
+int main(void)
+{
+    test_open();
+    int64_t last_commit = test_config_coalesce();
+    test_state_rate_limit(last_commit);
+    test_config_carries_state();
+    test_flush();
+    test_delete();
+    test_write_failure();
+
+    mock_nvs_stats_t st;
+    mock_nvs_get_stats(&st);
+    CHECK(st.open_handles == 0);
+    return TEST_RESULT();
+}
@@ -0,0 +1,281 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: WebSocket状态推送主机测试
+ *
+ * http_server.c 原样编译，运行在模拟HTTP服务器（mock_httpd.c）和 host_rtos.c 的事件循环上，
+ * WiFi和MQTT状态由本文件提供。httpd任务的工作队列由测试手动执行，检查：
+ * - 工作项执行之前的多次推送请求（遥测更新、WiFi/IP/MQTT事件）合并为一个工作项，发送执行时的最新状态
+ * - 广播只发给WebSocket客户端，内容和上次广播相同时不发送
+ * - 生成状态期间到来的请求另外排队，不会丢失
+ * - 加入工作队列失败后，之后的请求可以重新排队
+ * - 新连接的客户端总是收到一次当前状态
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "host_test.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "http_server.h"
+#include "iot_health.h"
+#include "iot_manager.h"
+#include "mock_httpd.h"
+#include "web_assets.h"
+#include "wifi_manager.h"
+
+#define WS_FD_A         10
+#define WS_FD_B         12
+#define HTTP_FD         11
+
+const esp_event_base_t WIFI_EVENT = "WIFI_EVENT";
+const esp_event_base_t IP_EVENT = "IP_EVENT";
+ESP_EVENT_DEFINE_BASE(IOT_MANAGER_EVENT);
+static const esp_event_base_t TEST_EVENT = "TEST_EVENT";
+
+/* ==================== 设备状态 ==================== */
+
+static bool sta_connected;
+static bool mqtt_connected;
+static atomic_int events_done;
+static const char *telemetry_during_build;  // 生成状态时更新一次遥测（模拟并发的更新）
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+    if (telemetry_during_build) {
+        const char *t = telemetry_during_build;
+        telemetry_during_build = NULL;
+        http_server_push_telemetry(t, strlen(t));
+    }
+    if (!sta_connected) {
+        return ESP_FAIL;
+    }
+    memset(ap_info, 0, sizeof(*ap_info));
+    strcpy((char *)ap_info->ssid, "TestAP");
+    ap_info->rssi = -50;
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key)
+{
+    return NULL;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info)
+{
+    return ESP_FAIL;
+}
+
+bool iot_manager_is_connected(void)
+{
+    return mqtt_connected;
+}
+
+// 以下接口只有API处理函数使用，不在测试范围内
+
+const web_asset_t web_assets[] = { { 0 } };
+const size_t web_asset_count = 0;
+
+int iot_health_to_json(char *buf, size_t size)
+{
+    return -1;
+}
+
+void wifi_scan_request(void)
+{
+}
+
+size_t wifi_scan_get_results(wifi_scan_result_t *results, size_t max,
+                             int32_t *age_ms, bool *scanning)
+{
+    return 0;
+}
+
+esp_err_t wifi_profile_connect(const char *ssid, const char *password)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t wifi_profile_delete(const char *ssid)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+size_t wifi_profile_list(wifi_profile_info_t *list, size_t max)
+{
+    return 0;
+}
+
+/* ==================== 测试 ==================== */
+
+static void test_event_done(void *arg, esp_event_base_t base, int32_t id, void *data)
+{
+    atomic_fetch_add(&events_done, 1);
+}
+
+// 投递事件，等事件循环处理完（之后投递的测试事件处理完时，前面的事件都已处理）
+static void post_events(esp_event_base_t base, const int32_t *ids, int count)
+{
+    int target = atomic_load(&events_done) + 1;
+    for (int i = 0; i < count; i++) {
+        CHECK(esp_event_post(base, ids[i], NULL, 0, 0) == ESP_OK);
+    }
+    CHECK(esp_event_post(TEST_EVENT, 0, NULL, 0, 0) == ESP_OK);
+    for (int i = 0; i < 1000 && atomic_load(&events_done) < target; i++) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    CHECK(atomic_load(&events_done) == target);
+}
+
+static void telemetry(const char *json)
+{
+    http_server_push_telemetry(json, strlen(json));
+}
+
+/**
+ * @brief 检查从第from个帧开始的一次广播：每个WebSocket客户端一帧，内容相同且包含expect
+ *
+ * 之后可能还有别的广播，总帧数由test_stop()检查
+ *
+ * @return int 下一个帧的下标
+ */
+static int expect_broadcast(int from, const char *expect)
+{
+    CHECK(mock_httpd_frame_count() >= from + 2);
+    const mock_httpd_frame_t *a = mock_httpd_frame(from);
+    const mock_httpd_frame_t *b = mock_httpd_frame(from + 1);
+    if (!a || !b) {
+        return mock_httpd_frame_count();
+    }
+    CHECK(a->fd == WS_FD_A && b->fd == WS_FD_B);
+    CHECK(strcmp(a->data, b->data) == 0);
+    CHECK(strstr(a->data, expect) != NULL);
+    if (!strstr(a->data, expect)) {
+        fprintf(stderr, "推送: %s\n预期包含: %s\n", a->data, expect);
+    }
+    return from + 2;
+}
+
+// 新连接的客户端收到一次当前状态，不受广播去重影响
+static int test_connect(void)
+{
+    CHECK(mock_httpd_get("/api/ws", WS_FD_A) == ESP_OK);
+    CHECK(mock_httpd_queued() == 1);
+    CHECK(mock_httpd_run_work() == 1);
+    CHECK(mock_httpd_frame_count() == 1);
+    CHECK(mock_httpd_frame(0) && mock_httpd_frame(0)->fd == WS_FD_A);
+    CHECK(mock_httpd_frame(0) && strcmp(mock_httpd_frame(0)->data,
+                                        "{\"status\":\"disconnected\",\"mqtt\":false}") == 0);
+
+    mock_httpd_add_client(WS_FD_B, true);
+    CHECK(mock_httpd_get("/api/ws", WS_FD_B) == ESP_OK);
+    CHECK(mock_httpd_run_work() == 1);
+    CHECK(mock_httpd_frame_count() == 2);
+    CHECK(mock_httpd_frame(1) && mock_httpd_frame(1)->fd == WS_FD_B);
+    return 2;
+}
+
+// 执行前的多次请求合并为一次广播，内容为执行时的最新状态
+static int test_coalesce(int frames)
+{
+    telemetry("{\"n\":1}");
+    telemetry("{\"n\":2}");
+    telemetry("{\"n\":3}");
+    CHECK(mock_httpd_queued() == 1);
+
+    static const int32_t ip_events[] = { IP_EVENT_STA_GOT_IP, IP_EVENT_STA_LOST_IP };
+    static const int32_t mqtt_events[] = { IOT_MANAGER_EVENT_CONNECTED };
+    post_events(IP_EVENT, ip_events, 2);
+    post_events(IOT_MANAGER_EVENT, mqtt_events, 1);
+    CHECK(mock_httpd_queued() == 1);
+
+    sta_connected = true;
+    mqtt_connected = true;
+    CHECK(mock_httpd_run_work() == 1);
+    frames = expect_broadcast(frames, "\"ssid\":\"TestAP\"");
+    CHECK(strstr(mock_httpd_frame(frames - 1)->data, "\"mqtt\":true,\"telemetry\":{\"n\":3}}"));
+
+    // 广播之后新的请求重新排队
+    static const int32_t wifi_events[] = { WIFI_EVENT_STA_DISCONNECTED };
+    sta_connected = false;
+    post_events(WIFI_EVENT, wifi_events, 1);
+    CHECK(mock_httpd_queued() == 1);
+    CHECK(mock_httpd_run_work() == 1);
+    return expect_broadcast(frames, "\"status\":\"disconnected\"");
+}
+
+// 内容和上次广播相同时不发送
+static int test_identical(int frames)
+{
+    telemetry("{\"n\":3}");
+    static const int32_t mqtt_events[] = { IOT_MANAGER_EVENT_CONNECTED };
+    post_events(IOT_MANAGER_EVENT, mqtt_events, 1);
+    CHECK(mock_httpd_queued() == 1);
+    CHECK(mock_httpd_run_work() == 1);
+    CHECK(mock_httpd_frame_count() == frames);
+
+    // 内容变回之前推送过的值也算变化（只和最近一次比较）
+    telemetry("{\"n\":4}");
+    CHECK(mock_httpd_run_work() == 1);
+    frames = expect_broadcast(frames, "{\"n\":4}");
+    telemetry("{\"n\":3}");
+    CHECK(mock_httpd_run_work() == 1);
+    return expect_broadcast(frames, "{\"n\":3}");
+}
+
+// 生成状态期间到来的请求另外排队
+static int test_request_during_build(int frames)
+{
+    telemetry_during_build = "{\"n\":6}";
+    telemetry("{\"n\":5}");
+    CHECK(mock_httpd_run_work() == 2);
+    CHECK(telemetry_during_build == NULL);
+    frames = expect_broadcast(frames, "{\"n\":5}");
+    return expect_broadcast(frames, "{\"n\":6}");
+}
+
+// 加入工作队列失败时清除等待标志
+static int test_queue_failure(int frames)
+{
+    mock_httpd_fail_queue(1);
+    telemetry("{\"n\":7}");
+    CHECK(mock_httpd_queued() == 0);
+    telemetry("{\"n\":8}");
+    CHECK(mock_httpd_queued() == 1);
+    CHECK(mock_httpd_run_work() == 1);
+    return expect_broadcast(frames, "{\"n\":8}");
+}
+
+// 停止后不再推送
+static void test_stop(int frames)
+{
+    CHECK(stop_webserver() == ESP_OK);
+    telemetry("{\"n\":9}");
+    static const int32_t ip_events[] = { IP_EVENT_STA_GOT_IP };
+    post_events(IP_EVENT, ip_events, 1);
+    CHECK(mock_httpd_queued() == 0);
+    CHECK(mock_httpd_run_work() == 0);
+    CHECK(mock_httpd_frame_count() == frames);
+}
+
+int main(void)
+{
+    CHECK(esp_event_loop_create_default() == ESP_OK);
+    CHECK(esp_event_handler_register(TEST_EVENT, ESP_EVENT_ANY_ID, test_event_done, NULL) == ESP_OK);
+    mock_httpd_add_client(WS_FD_A, true);
+    mock_httpd_add_client(HTTP_FD, false);
+    CHECK(start_webserver() == ESP_OK);
+
+    int frames = test_connect();
+    frames = test_coalesce(frames);
+    frames = test_identical(frames);
+    frames = test_request_during_build(frames);
+    frames = test_queue_failure(frames);
+    test_stop(frames);
+
+    printf("{\"test\":\"status_push\",\"frames\":%d}\n", mock_httpd_frame_count());
+    return TEST_RESULT();
+}
@@ -0,0 +1,385 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: WiFi连接策略主机测试（模拟驱动）
+ *
+ * 在模拟WiFi驱动（mock_wifi.h）上运行 wifi_manager.c，配置经 nvs_cache.c 写入模拟NVS，
+ * 启动阶段由 iot_boot.c 记录，都是原样编译；按虚拟时钟测量获取IP的用时。
+ * 每个场景在子进程中运行，相当于设备的一次启动，结束时像重启命令一样执行 nvs_cache_flush()；
+ * NVS放在共享内存中，上一次启动保存的配置（BSSID、信道、连接统计）对下一次启动可见。
+ *
+ *   first_boot  旧版单个sta_config转换为配置，全信道扫描连接（即改动之前每次重连的方式）
+ *   reboot      重启后用缓存的BSSID和信道快速连接
+ *   link_lost   连接中断后快速重连
+ *   scan_busy   后台扫描进行中时连接中断：驱动拒绝连接，退避后重试并连接上
+ *   ap_moved    AP换了信道：快速连接失败，同一配置全信道扫描后连接，并更新缓存的信道
+ *   add_profile 添加不在范围内的新配置：尝试失败后回到原来的网络
+ *   failover    常用的网络消失后依次尝试，连接到另一个配置
+ *   all_down    所有网络都不在：按退避间隔一轮一轮重试不放弃，网络恢复后连接
+ *
+ * 每个场景输出一行JSON，最后一行对比全信道扫描和快速连接的获取IP用时。
+ * 用时由 mock_wifi.h 中的时间模型决定，比较的是扫描信道数不同带来的差别。
+ */
+
+#include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "host_test.h"
+#include "iot_boot.h"
+#include "mock_nvs.h"
+#include "mock_wifi.h"
+#include "nvs_cache.h"
+#include "wifi_manager.h"
+
+#define WAIT_IP_US      (60 * 1000000LL)
+#define FULL_SCAN_MS    (MOCK_CHANNELS * MOCK_SCAN_CHANNEL_MS + MOCK_AUTH_ASSOC_MS + \
+                         MOCK_HANDSHAKE_MS + MOCK_DHCP_MS)
+#define FAST_MS         (MOCK_SCAN_CHANNEL_MS + MOCK_AUTH_ASSOC_MS + MOCK_HANDSHAKE_MS + MOCK_DHCP_MS)
+
+enum {
+    RESULT_FULL_SCAN = 0,
+    RESULT_FAST,
+    RESULT_MAX,
+};
+
+static int64_t *results;                // 子进程写入的获取IP用时（毫秒）
+static mock_ap_t *home;
+static mock_ap_t *home_repeater;
+static mock_ap_t *office;
+static uint32_t wait_ip;
+
+static bool got_ip(void)
+{
+    return mock_wifi_stats()->got_ip >= wait_ip;
+}
+
+static bool scanning(void)
+{
+    return mock_wifi_stats()->scanning;
+}
+
+static uint32_t nvs_commits(void)
+{
+    mock_nvs_stats_t st;
+    mock_nvs_get_stats(&st);
+    return st.commits;
+}
+
+/**
+ * @brief 运行到获取下一次IP，返回从现在起的用时（毫秒），超时返回-1
+ */
+static int64_t wait_for_ip(void)
+{
+    int64_t start = mock_now_us();
+    wait_ip = mock_wifi_stats()->got_ip + 1;
+    if (!mock_run(start + WAIT_IP_US, got_ip)) {
+        return -1;
+    }
+    return (mock_wifi_stats()->got_ip_us - start) / 1000;
+}
+
+/**
+ * @brief 添加AP：home（可指定信道）和同名的弱信号中继，office在信道6
+ */
+static void add_aps(uint8_t home_channel, bool office_on)
+{
+    home = mock_wifi_add_ap("home", "home-pass", 1, home_channel, -55);
+    home_repeater = mock_wifi_add_ap("home", "home-pass", 2, 1, -80);
+    office = mock_wifi_add_ap("office", "office-pass", 3, 6, -67);
+    office->on = office_on;
+}
+
+static void boot(void)
+{
+    ESP_ERROR_CHECK(nvs_cache_init());
+    ESP_ERROR_CHECK(wifi_init_softap());
+}
+
+/**
+ * @brief 查找已保存的配置，返回在连接优先顺序中的位置，没有返回-1
+ */
+static int find_profile(const char *ssid, wifi_profile_info_t *info)
+{
+    wifi_profile_info_t list[CONFIG_WIFI_PROFILE_MAX];
+    size_t n = wifi_profile_list(list, CONFIG_WIFI_PROFILE_MAX);
+    for (size_t i = 0; i < n; i++) {
+        if (strcmp(list[i].ssid, ssid) == 0) {
+            *info = list[i];
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 输出一次连接的结果，base为开始前的驱动统计
+ */
+static void report(const char *scenario, const mock_wifi_stats_t *base, int64_t ms)
+{
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    printf("{\"test\":\"wifi_connect\",\"scenario\":\"%s\",\"connects\":%u,\"fast_connects\":%u,"
+           "\"channels_scanned\":%u,\"ssid\":\"%s\",\"channel\":%u,\"time_to_ip_ms\":%lld}\n",
+           scenario, st->connects - base->connects, st->fast_connects - base->fast_connects,
+           st->channels_scanned - base->channels_scanned, st->ap ? st->ap->ssid : "",
+           st->ap ? st->ap->channel : 0, (long long)ms);
+}
+
+static void scenario_first_boot(void)
+{
+    mock_wifi_stats_t base = *mock_wifi_stats();
+    add_aps(11, false);
+    boot();
+    int64_t ms = wait_for_ip();
+    report("first_boot", &base, ms);
+
+    // 全信道扫描，连接信号最强的AP（不是信道1上的中继）
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    CHECK(ms == FULL_SCAN_MS);
+    CHECK(st->connects == 1 && st->fast_connects == 0 && st->channels_scanned == MOCK_CHANNELS);
+    CHECK(st->ap == home);
+
+    // 旧配置已转换并删除，记住了这次连接的信道
+    wifi_profile_info_t info;
+    CHECK(find_profile("home", &info) == 0);
+    CHECK(info.channel == 11 && info.success == 1 && info.failure == 0 && info.connected);
+    wifi_config_t legacy;
+    CHECK(mock_nvs_read("wifi_config", "sta_config", &legacy, sizeof(legacy)) == 0);
+    results[RESULT_FULL_SCAN] = ms;
+
+    // 启动阶段：关联AP，DHCP获取IP
+    iot_boot_stage_t stages[IOT_BOOT_MAX_STAGES];
+    size_t n = iot_boot_get(stages, IOT_BOOT_MAX_STAGES);
+    CHECK(n == 2 && strcmp(stages[0].name, "sta_assoc") == 0 && strcmp(stages[1].name, "dhcp") == 0);
+    CHECK(n == 2 && stages[1].ms == st->got_ip_us / 1000 && stages[1].ms - stages[0].ms == MOCK_DHCP_MS);
+
+    // 连接统计属于运行状态：转换旧配置时已提交过一次，到状态提交间隔结束才写入
+    uint32_t commits = nvs_commits();
+    mock_run(CONFIG_NVS_CACHE_STATE_INTERVAL_SEC * 1000000LL - 1, NULL);
+    CHECK(nvs_commits() == commits);
+    mock_run(CONFIG_NVS_CACHE_STATE_INTERVAL_SEC * 1000000LL + 1000000LL, NULL);
+    CHECK(nvs_commits() == commits + 1);
+}
+
+static void scenario_reboot(void)
+{
+    mock_wifi_stats_t base = *mock_wifi_stats();
+    add_aps(11, false);
+    boot();
+    int64_t ms = wait_for_ip();
+    report("reboot", &base, ms);
+
+    // 只在信道11上连接已知的AP
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    CHECK(ms == FAST_MS);
+    CHECK(st->connects == 1 && st->fast_connects == 1 && st->channels_scanned == 1);
+    CHECK(st->ap == home);
+    results[RESULT_FAST] = ms;
+}
+
+static void scenario_link_lost(void)
+{
+    add_aps(11, false);
+    boot();
+    CHECK(wait_for_ip() > 0);
+
+    // 后台扫描在连接后进行，不影响连接
+    mock_run(mock_now_us() + 30 * 1000000LL, NULL);
+    CHECK(mock_wifi_stats()->bg_scan_channels >= MOCK_CHANNELS);
+    CHECK(mock_wifi_stats()->ap == home);
+
+    mock_wifi_stats_t base = *mock_wifi_stats();
+    mock_wifi_link_lost();
+    int64_t ms = wait_for_ip();
+    report("link_lost", &base, ms);
+
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    CHECK(ms == FAST_MS);
+    CHECK(st->connects - base.connects == 1 && st->fast_connects - base.fast_connects == 1);
+    CHECK(st->ap == home);
+}
+
+static void scenario_scan_busy(void)
+{
+    add_aps(11, false);
+    boot();
+    CHECK(wait_for_ip() == FAST_MS);
+
+    // 后台扫描某个信道期间连接中断
+    CHECK(mock_run(mock_now_us() + 30 * 1000000LL, scanning));
+    mock_wifi_stats_t base = *mock_wifi_stats();
+    mock_wifi_link_lost();
+    int64_t ms = wait_for_ip();
+    report("scan_busy", &base, ms);
+
+    // 快速重连被驱动拒绝，不会有断开事件：不能停在连接中，按退避间隔重试
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    CHECK(st->scan_busy_errors - base.scan_busy_errors == 1);
+    CHECK(ms >= CONFIG_IOT_RECONNECT_BASE_MS / 2 && ms <= CONFIG_IOT_RECONNECT_BASE_MS + FAST_MS);
+    CHECK(st->connects - base.connects == 1 && st->fast_connects - base.fast_connects == 1);
+    CHECK(st->ap == home);
+}
+
+static void scenario_ap_moved(void)
+{
+    mock_wifi_stats_t base = *mock_wifi_stats();
+    add_aps(6, false);
+    boot();
+    int64_t ms = wait_for_ip();
+    report("ap_moved", &base, ms);
+
+    // 信道11上找不到，同一配置全信道扫描
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    CHECK(ms == MOCK_SCAN_CHANNEL_MS + FULL_SCAN_MS);
+    CHECK(st->connects == 2 && st->fast_connects == 1 && st->channels_scanned == 1 + MOCK_CHANNELS);
+    CHECK(st->ap == home);
+
+    // 换信道不算失败
+    wifi_profile_info_t info;
+    CHECK(find_profile("home", &info) == 0);
+    CHECK(info.channel == 6 && info.failure == 0);
+}
+
+static void scenario_add_profile(void)
+{
+    add_aps(6, false);
+    boot();
+    CHECK(wait_for_ip() == FAST_MS);
+
+    // 网页上添加一个不在范围内的网络
+    mock_wifi_stats_t base = *mock_wifi_stats();
+    CHECK(wifi_profile_connect("office", "office-pass") == ESP_OK);
+    int64_t ms = wait_for_ip();
+    report("add_profile", &base, ms);
+
+    // 先尝试新网络（全信道扫描），失败后快速连接回原来的网络
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    CHECK(ms > 0 && st->ap == home);
+    CHECK(st->connects - base.connects == 2 && st->fast_connects - base.fast_connects == 1);
+    CHECK(st->connect_errors == 0);
+
+    wifi_profile_info_t info;
+    CHECK(find_profile("office", &info) == 1);
+    CHECK(info.channel == 0 && info.success == 0 && info.failure == 1);
+    CHECK(find_profile("home", &info) == 0 && info.connected);
+
+    // 配置密码不能超长
+    char long_pass[80];
+    memset(long_pass, 'p', sizeof(long_pass) - 1);
+    long_pass[sizeof(long_pass) - 1] = '\0';
+    CHECK(wifi_profile_connect("office", long_pass) == ESP_ERR_INVALID_ARG);
+}
+
+static void scenario_failover(void)
+{
+    add_aps(6, true);
+    boot();
+    // 排名：home信号强、成功率高，优先于只失败过的office
+    CHECK(wait_for_ip() == FAST_MS);
+    CHECK(mock_wifi_stats()->ap == home);
+
+    // 后台扫描看到office后，它的信号强度在下一次排名时更新
+    mock_run(mock_now_us() + 30 * 1000000LL, NULL);
+
+    mock_wifi_stats_t base = *mock_wifi_stats();
+    home->on = false;
+    home_repeater->on = false;
+    mock_wifi_link_lost();
+    int64_t ms = wait_for_ip();
+    report("failover", &base, ms);
+
+    // home：快速连接失败（1个信道）、全信道扫描失败；office：从未连接成功过，全信道扫描
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    CHECK(st->ap == office);
+    CHECK(st->connects - base.connects == 3);
+    CHECK(st->channels_scanned - base.channels_scanned == 1 + 2 * MOCK_CHANNELS);
+
+    wifi_profile_info_t info;
+    CHECK(find_profile("office", &info) >= 0);
+    CHECK(info.channel == 6 && info.success == 1 && info.rssi == -67 && info.connected);
+    CHECK(find_profile("home", &info) >= 0 && info.failure == 1);
+}
+
+static void scenario_all_down(void)
+{
+    add_aps(6, true);
+    home->on = false;
+    home_repeater->on = false;
+    office->on = false;
+    boot();
+    wait_ip = 1;
+    CHECK(!mock_run(120 * 1000000LL, got_ip));
+
+    // 每轮4次连接：两个配置各快速连接一次、全信道扫描一次
+    const mock_wifi_stats_t *st = mock_wifi_stats();
+    uint32_t rounds = st->connects / 4;
+    CHECK(rounds >= 5);
+    CHECK(st->connect_errors == 0);
+
+    // 两轮之间的间隔（上一轮结束到下一轮开始）按退避增长，最后一轮在最后一分钟内：不会放弃
+    printf("{\"test\":\"wifi_connect\",\"scenario\":\"all_down\",\"rounds\":%u,\"round_gaps_ms\":[", rounds);
+    int64_t round_ms = 2 * MOCK_SCAN_CHANNEL_MS + 2 * MOCK_CHANNELS * MOCK_SCAN_CHANNEL_MS;
+    int64_t prev_gap = 0;
+    for (uint32_t r = 1; r < rounds && 4 * r < MOCK_MAX_CONNECTS; r++) {
+        int64_t gap = (st->connect_us[4 * r] - st->connect_us[4 * (r - 1)]) / 1000 - round_ms;
+        printf("%s%lld", r > 1 ? "," : "", (long long)gap);
+        CHECK(gap >= prev_gap / 2 && gap <= CONFIG_IOT_RECONNECT_MAX_MS);
+        prev_gap = gap;
+    }
+    CHECK(st->connect_us[(st->connects - 1) % MOCK_MAX_CONNECTS] > 60 * 1000000LL);
+
+    // 网络恢复后在一个退避间隔内连接上
+    office->on = true;
+    int64_t ms = wait_for_ip();
+    printf("],\"time_to_ip_ms\":%lld}\n", (long long)ms);
+    CHECK(ms > 0 && ms <= CONFIG_IOT_RECONNECT_MAX_MS + 2 * FULL_SCAN_MS);
+    CHECK(mock_wifi_stats()->ap == office);
+}
+
+/**
+ * @brief 在子进程中运行一个场景（一次启动），子进程的检查失败计入总结果
+ */
+static void run_boot(void (*scenario)(void))
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        scenario();
+        // 与重启命令相同，重启前写入缓存的修改
+        CHECK(nvs_cache_flush() == ESP_OK);
+        exit(TEST_RESULT());
+    }
+    int status = 0;
+    CHECK(pid > 0 && waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main(void)
+{
+    mock_nvs_share();
+    results = mmap(NULL, RESULT_MAX * sizeof(int64_t), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    CHECK(results != MAP_FAILED);
+
+    // 改动之前的固件保存的单个配置
+    wifi_config_t legacy = { 0 };
+    memcpy(legacy.sta.ssid, "home", 4);
+    memcpy(legacy.sta.password, "home-pass", 9);
+    mock_nvs_write("wifi_config", "sta_config", &legacy, sizeof(legacy));
+
+    run_boot(scenario_first_boot);
+    run_boot(scenario_reboot);
+    run_boot(scenario_link_lost);
+    run_boot(scenario_scan_busy);
+    run_boot(scenario_ap_moved);
+    run_boot(scenario_add_profile);
+    run_boot(scenario_failover);
+    run_boot(scenario_all_down);
+
+    printf("{\"test\":\"wifi_connect_summary\",\"full_scan_ms\":%lld,\"fast_connect_ms\":%lld,"
+           "\"speedup\":%.1f}\n", (long long)results[RESULT_FULL_SCAN],
+           (long long)results[RESULT_FAST],
+           results[RESULT_FAST] > 0 ? (double)results[RESULT_FULL_SCAN] / results[RESULT_FAST] : 0);
+    CHECK(results[RESULT_FAST] > 0 && results[RESULT_FAST] < results[RESULT_FULL_SCAN]);
+    return TEST_RESULT();
+}
@@ -0,0 +1,31 @@
+/*
+ * @Author: xingnian j_xingnian@163.com
+ * @Date: 2025-11-10
+ * @Description: 网页资源表
+ *
+ * 构建时由 tools/gen_web_assets.py 把 spiffs/ 下的网页资源gzip压缩，
+ * 生成 web_assets.c。数据为const数组，位于flash中通过cache直接映射读取，
+ * 发送时不需要文件系统、不拷贝到堆。
+ */
+
+#ifndef _WEB_ASSETS_H_
+#define _WEB_ASSETS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    const char *path;           // 请求路径，如 "/index.html"
+    const char *type;           // Content-Type
+    const uint8_t *data;        // 内容（gzip为true时已压缩）
+    size_t len;                 // 内容长度
+    const char *etag;           // 带引号的ETag，内容变化时改变
+    bool gzip;                  // 是否需要 Content-Encoding: gzip
+} web_asset_t;
+
+// 按path排序
+extern const web_asset_t web_assets[];
+extern const size_t web_asset_count;
+
+#endif /* _WEB_ASSETS_H_ */
@@ -1,13 +1,18 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_mac.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "lwip/err.h"
 #include "lwip/sys.h"
+#include "iot_boot.h"
+#include "iot_reconnect.h"
+#include "nvs_cache.h"
 #include "wifi_manager.h"
 // WiFi配置参数
 #define EXAMPLE_ESP_WIFI_SSID      CONFIG_ESP_WIFI_SSID        // WiFi名称
@@ -17,12 +22,648 @@
 
 static const char *TAG = "wifi_manager";  // 日志标签
 
-#define MAX_RETRY_COUNT 5
-static int s_retry_num = 0;
-
 // WiFi连接成功回调函数
 static wifi_connected_callback_t wifi_connected_cb = NULL;
 
+/* ==================== 后台扫描 ==================== */
+
+/*
+ * 扫描一次只扫一个信道（非阻塞），SCAN_DONE事件中合并结果后隔一段时间再扫下一个信道，
+ * 信道之间STA回到工作信道收发数据，不需要断开连接。结果按BSSID合并进缓存，
+ * 超过WIFI_SCAN_TTL_SEC未再扫到的条目删除。
+ */
+
+#define SCAN_DWELL_MS           60      // 每个信道的主动扫描时间
+#define SCAN_CHANNEL_GAP_MS     100     // 两个信道之间回到工作信道的时间
+#define SCAN_RETRY_MS           1000    // STA正在连接等无法扫描时的重试间隔
+#define SCAN_FIRST_DELAY_MS     3000    // 启动后首次扫描的延迟（避开STA自动连接）
+#define SCAN_RECORDS_PER_CHAN   16      // 单个信道最多取回的结果数
+
+typedef struct {
+    wifi_scan_result_t result;
+    int64_t seen_us;                    // 最后一次扫到的时间
+} scan_entry_t;
+
+static scan_entry_t scan_cache[CONFIG_WIFI_SCAN_CACHE_SIZE];
+static size_t scan_cache_count = 0;
+static int64_t scan_sweep_done_us = 0;  // 最近一轮扫描完成时间，0表示还没有完成过
+static bool scan_sweeping = false;
+static uint8_t scan_channel = 0;        // 正在扫描的信道
+static uint8_t scan_last_channel = 0;
+static SemaphoreHandle_t scan_lock = NULL;   // 保护扫描缓存和扫描状态
+static esp_timer_handle_t scan_timer = NULL;
+
+// SCAN_DONE事件中使用（事件任务栈较小）
+static wifi_ap_record_t scan_records[SCAN_RECORDS_PER_CHAN];
+
+// 扫描下一个信道（esp_timer任务中调用）
+static void scan_timer_cb(void *arg)
+{
+    // scan_channel由事件任务在scan_done()中修改
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    uint8_t channel = scan_channel;
+    xSemaphoreGive(scan_lock);
+
+    wifi_scan_config_t scan_config = {
+        .ssid = NULL,
+        .bssid = NULL,
+        .channel = channel,
+        .show_hidden = true,
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active.min = SCAN_DWELL_MS / 2,
+        .scan_time.active.max = SCAN_DWELL_MS,
+    };
+    esp_err_t err = esp_wifi_scan_start(&scan_config, false);
+    if (err != ESP_OK) {
+        // STA正在连接时驱动拒绝扫描，稍后重试
+        ESP_LOGD(TAG, "信道%d扫描暂不可用(%s)，稍后重试", channel, esp_err_to_name(err));
+        esp_timer_start_once(scan_timer, SCAN_RETRY_MS * 1000);
+    }
+}
+
+// 开始一轮扫描（持有scan_lock时调用）
+static void scan_sweep_start_locked(int64_t delay_us)
+{
+    wifi_country_t country;
+    uint8_t first = 1;
+    uint8_t count = 13;
+    if (esp_wifi_get_country(&country) == ESP_OK && country.nchan > 0) {
+        first = country.schan;
+        count = country.nchan;
+    }
+    scan_sweeping = true;
+    scan_channel = first;
+    scan_last_channel = first + count - 1;
+    esp_timer_start_once(scan_timer, delay_us);
+}
+
+// 扫描结果合并进缓存（持有scan_lock时调用）
+static void scan_merge_locked(const wifi_ap_record_t *rec, int64_t now)
+{
+    scan_entry_t *slot = NULL;
+    for (size_t i = 0; i < scan_cache_count; i++) {
+        if (memcmp(scan_cache[i].result.bssid, rec->bssid, sizeof(rec->bssid)) == 0) {
+            slot = &scan_cache[i];
+            break;
+        }
+    }
+    if (!slot && scan_cache_count < CONFIG_WIFI_SCAN_CACHE_SIZE) {
+        slot = &scan_cache[scan_cache_count++];
+    }
+    if (!slot) {
+        // 缓存已满，替换信号最弱的条目
+        slot = &scan_cache[0];
+        for (size_t i = 1; i < scan_cache_count; i++) {
+            if (scan_cache[i].result.rssi < slot->result.rssi) {
+                slot = &scan_cache[i];
+            }
+        }
+        if (slot->result.rssi >= rec->rssi) {
+            return;
+        }
+    }
+
+    strlcpy(slot->result.ssid, (const char *)rec->ssid, sizeof(slot->result.ssid));
+    memcpy(slot->result.bssid, rec->bssid, sizeof(slot->result.bssid));
+    slot->result.rssi = rec->rssi;
+    slot->result.channel = rec->primary;
+    slot->result.authmode = rec->authmode;
+    slot->seen_us = now;
+}
+
+// 删除过期条目（持有scan_lock时调用）
+static void scan_expire_locked(int64_t now)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < scan_cache_count; i++) {
+        if (now - scan_cache[i].seen_us < CONFIG_WIFI_SCAN_TTL_SEC * 1000000LL) {
+            scan_cache[n++] = scan_cache[i];
+        }
+    }
+    scan_cache_count = n;
+}
+
+// 一个信道扫描完成（事件任务中调用）
+static void scan_done(void)
+{
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    if (!scan_sweeping) {
+        // 不是后台扫描发起的扫描
+        xSemaphoreGive(scan_lock);
+        return;
+    }
+    uint16_t number = SCAN_RECORDS_PER_CHAN;
+    if (esp_wifi_scan_get_ap_records(&number, scan_records) != ESP_OK) {
+        number = 0;
+    }
+    int64_t now = esp_timer_get_time();
+    for (uint16_t i = 0; i < number; i++) {
+        scan_merge_locked(&scan_records[i], now);
+    }
+    if (scan_channel < scan_last_channel) {
+        scan_channel++;
+        esp_timer_start_once(scan_timer, SCAN_CHANNEL_GAP_MS * 1000);
+    } else {
+        scan_sweeping = false;
+        scan_sweep_done_us = now;
+        scan_expire_locked(now);
+    }
+    xSemaphoreGive(scan_lock);
+}
+
+// 请求后台扫描
+void wifi_scan_request(void)
+{
+    if (!scan_lock) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    if (!scan_sweeping && (scan_sweep_done_us == 0 ||
+                           now - scan_sweep_done_us >= CONFIG_WIFI_SCAN_REFRESH_SEC * 1000000LL)) {
+        scan_sweep_start_locked(0);
+    }
+    xSemaphoreGive(scan_lock);
+}
+
+// 读取扫描缓存
+size_t wifi_scan_get_results(wifi_scan_result_t *results, size_t max,
+                             int32_t *age_ms, bool *scanning)
+{
+    if (!scan_lock) {
+        if (age_ms) {
+            *age_ms = -1;
+        }
+        if (scanning) {
+            *scanning = false;
+        }
+        return 0;
+    }
+
+    int64_t now = esp_timer_get_time();
+    size_t n = 0;
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    for (size_t i = 0; i < scan_cache_count && n < max; i++) {
+        if (now - scan_cache[i].seen_us >= CONFIG_WIFI_SCAN_TTL_SEC * 1000000LL) {
+            continue;
+        }
+        results[n] = scan_cache[i].result;
+        results[n].age_ms = (uint32_t)((now - scan_cache[i].seen_us) / 1000);
+        n++;
+    }
+    if (age_ms) {
+        *age_ms = scan_sweep_done_us ? (int32_t)((now - scan_sweep_done_us) / 1000) : -1;
+    }
+    if (scanning) {
+        *scanning = scan_sweeping;
+    }
+    xSemaphoreGive(scan_lock);
+
+    // 按信号强度从强到弱排序（条数很少，插入排序）
+    for (size_t i = 1; i < n; i++) {
+        wifi_scan_result_t tmp = results[i];
+        size_t j = i;
+        while (j > 0 && results[j - 1].rssi < tmp.rssi) {
+            results[j] = results[j - 1];
+            j--;
+        }
+        results[j] = tmp;
+    }
+    return n;
+}
+
+// 在扫描缓存中查找某个SSID信号最强的AP，没有扫到返回false
+static bool scan_cache_find(const char *ssid, int8_t *rssi)
+{
+    bool found = false;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    for (size_t i = 0; i < scan_cache_count; i++) {
+        if (now - scan_cache[i].seen_us < CONFIG_WIFI_SCAN_TTL_SEC * 1000000LL &&
+            strcmp(scan_cache[i].result.ssid, ssid) == 0 &&
+            (!found || scan_cache[i].result.rssi > *rssi)) {
+            *rssi = scan_cache[i].result.rssi;
+            found = true;
+        }
+    }
+    xSemaphoreGive(scan_lock);
+    return found;
+}
+
+/* ==================== 多配置存储与快速连接 ==================== */
+
+/*
+ * 最多保存WIFI_PROFILE_MAX个网络，按“最后看到的信号强度 + 连接成功率加分”排序依次尝试。
+ * 每个配置记住上次连接成功的BSSID和信道，重连时直接在该信道上连接该AP，不做全信道扫描；
+ * 快速连接失败（AP换了信道等）时对同一配置再做一次全信道扫描连接，仍失败则尝试下一个配置。
+ * 一轮全部失败后按iot_reconnect的退避时间（指数增长、带随机抖动）开始下一轮，不会放弃。
+ */
+
+#define PROFILE_NVS_NAMESPACE   "wifi_config"
+#define PROFILE_NVS_KEY         "profiles"
+#define PROFILE_RATE_BONUS      20      // 成功率100%时的排名加分（dB）
+#define PROFILE_RSSI_UNKNOWN    (-100)
+
+// 保存在NVS中的配置（结构变化时需要修改PROFILE_NVS_KEY）
+typedef struct {
+    char ssid[33];
+    char password[65];
+    uint8_t bssid[6];           // 上次连接成功的AP
+    uint8_t channel;            // 上次连接成功的信道，0表示未知
+    int8_t rssi;                // 最后一次看到的信号强度
+    uint16_t success;           // 连接成功次数
+    uint16_t failure;           // 连接失败次数
+} wifi_profile_t;
+
+typedef enum {
+    CONNECT_IDLE = 0,           // 没有可用配置
+    CONNECT_CONNECTING,
+    CONNECT_WAITING,            // 一轮全部失败，等待退避定时器
+    CONNECT_CONNECTED,          // 已获取IP
+} connect_state_t;
+
+static wifi_profile_t profiles[CONFIG_WIFI_PROFILE_MAX];
+static size_t profile_count = 0;
+static SemaphoreHandle_t profile_lock = NULL;   // 保护配置和连接状态
+
+static connect_state_t connect_state = CONNECT_IDLE;
+static uint8_t connect_order[CONFIG_WIFI_PROFILE_MAX];  // 本轮尝试顺序
+static size_t connect_pos = 0;          // 本轮正在尝试第几个
+static bool connect_fast = false;       // 本次尝试使用缓存的BSSID和信道
+static int connect_restart = -2;        // 断开后重新开始一轮，值为优先尝试的配置（-1不指定，-2不重新开始）
+static int64_t connect_start_us = 0;
+static esp_timer_handle_t reconnect_timer = NULL;
+static int profile_item = -1;           // NVS写缓存中的配置项
+
+// 保存全部配置（持有profile_lock时调用）
+// 只更新写缓存，由后台任务写入flash：用户修改的配置很快写入，连接统计限制写入频率
+static esp_err_t profiles_save_locked(nvs_cache_class_t cls)
+{
+    esp_err_t err = nvs_cache_set_blob(profile_item, profiles, profile_count * sizeof(wifi_profile_t), cls);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "保存WiFi配置失败: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+// 从NVS读取配置，旧版本的单个sta_config转换为第一个配置
+static void profiles_load(void)
+{
+    profile_item = nvs_cache_open_blob(PROFILE_NVS_NAMESPACE, PROFILE_NVS_KEY, sizeof(profiles));
+    size_t size = nvs_cache_get_blob(profile_item, profiles, sizeof(profiles));
+    if (size > 0 && size % sizeof(wifi_profile_t) == 0) {
+        profile_count = size / sizeof(wifi_profile_t);
+    }
+
+    nvs_handle_t nvs_handle;
+    if (profile_count == 0 && nvs_open(PROFILE_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        wifi_config_t sta_config;
+        size = sizeof(sta_config);
+        if (nvs_get_blob(nvs_handle, "sta_config", &sta_config, &size) == ESP_OK &&
+            sta_config.sta.ssid[0] != '\0') {
+            memset(&profiles[0], 0, sizeof(profiles[0]));
+            memcpy(profiles[0].ssid, sta_config.sta.ssid,
+                   strnlen((const char *)sta_config.sta.ssid, sizeof(sta_config.sta.ssid)));
+            memcpy(profiles[0].password, sta_config.sta.password,
+                   strnlen((const char *)sta_config.sta.password, sizeof(sta_config.sta.password)));
+            profiles[0].rssi = PROFILE_RSSI_UNKNOWN;
+            profile_count = 1;
+            if (profiles_save_locked(NVS_CACHE_CONFIG) == ESP_OK &&
+                nvs_cache_flush() == ESP_OK) {
+                nvs_erase_key(nvs_handle, "sta_config");
+                nvs_commit(nvs_handle);
+            }
+            ESP_LOGI(TAG, "已转换旧版WiFi配置: %s", profiles[0].ssid);
+        }
+        nvs_close(nvs_handle);
+    }
+
+    for (size_t i = 0; i < profile_count; i++) {
+        profiles[i].ssid[sizeof(profiles[i].ssid) - 1] = '\0';
+        profiles[i].password[sizeof(profiles[i].password) - 1] = '\0';
+        ESP_LOGI(TAG, "已保存的WiFi: %s (信道%d, 成功%d/失败%d)", profiles[i].ssid,
+                 profiles[i].channel, profiles[i].success, profiles[i].failure);
+    }
+}
+
+static int profile_find_locked(const char *ssid)
+{
+    for (size_t i = 0; i < profile_count; i++) {
+        if (strcmp(profiles[i].ssid, ssid) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 排名分数：最后看到的信号强度，加上按成功率（拉普拉斯平滑）给的0~20dB
+static int profile_score(const wifi_profile_t *p)
+{
+    return p->rssi + PROFILE_RATE_BONUS * (p->success + 1) / (p->success + p->failure + 2);
+}
+
+// 用扫描缓存更新信号强度并排序（持有profile_lock时调用）
+static void profiles_rank_locked(uint8_t *order)
+{
+    for (size_t i = 0; i < profile_count; i++) {
+        int8_t rssi = PROFILE_RSSI_UNKNOWN;
+        if (scan_cache_find(profiles[i].ssid, &rssi)) {
+            profiles[i].rssi = rssi;
+        }
+        order[i] = i;
+    }
+    for (size_t i = 1; i < profile_count; i++) {
+        uint8_t tmp = order[i];
+        int score = profile_score(&profiles[tmp]);
+        size_t j = i;
+        while (j > 0 && profile_score(&profiles[order[j - 1]]) < score) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = tmp;
+    }
+}
+
+static void connect_attempt_locked(void);
+
+// 本轮结束，按退避时间等待下一轮（持有profile_lock时调用）
+static void connect_wait_locked(void)
+{
+    uint32_t delay_ms = iot_reconnect_next_delay_ms(IOT_LINK_WIFI);
+    ESP_LOGW(TAG, "%lums后重新连接WiFi", (unsigned long)delay_ms);
+    connect_state = CONNECT_WAITING;
+    esp_timer_start_once(reconnect_timer, (uint64_t)delay_ms * 1000);
+}
+
+// 开始一轮连接，preferred>=0时先尝试该配置（持有profile_lock时调用）
+static void connect_round_start_locked(int preferred)
+{
+    if (profile_count == 0) {
+        connect_state = CONNECT_IDLE;
+        return;
+    }
+    profiles_rank_locked(connect_order);
+    if (preferred >= 0) {
+        size_t i = 0;
+        while (connect_order[i] != preferred) {
+            i++;
+        }
+        memmove(&connect_order[1], &connect_order[0], i);
+        connect_order[0] = preferred;
+    }
+    connect_pos = 0;
+    connect_fast = profiles[connect_order[0]].channel != 0;
+    connect_start_us = esp_timer_get_time();
+    connect_attempt_locked();
+}
+
+// 连接本轮当前位置的配置（持有profile_lock时调用）
+static void connect_attempt_locked(void)
+{
+    const wifi_profile_t *p = &profiles[connect_order[connect_pos]];
+    wifi_config_t sta_config = { 0 };
+
+    // 32字节的SSID和64字节的PSK不以'\0'结尾
+    memcpy(sta_config.sta.ssid, p->ssid, strnlen(p->ssid, sizeof(sta_config.sta.ssid)));
+    memcpy(sta_config.sta.password, p->password, strnlen(p->password, sizeof(sta_config.sta.password)));
+    if (connect_fast) {
+        // 只在已知信道上连接已知AP
+        sta_config.sta.bssid_set = true;
+        memcpy(sta_config.sta.bssid, p->bssid, sizeof(sta_config.sta.bssid));
+        sta_config.sta.channel = p->channel;
+    } else {
+        // 扫描全部信道，连接信号最强的AP
+        sta_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        sta_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+
+    ESP_LOGI(TAG, "连接WiFi: %s (%s)", p->ssid,
+             connect_fast ? "快速连接" : "全信道扫描");
+    connect_state = CONNECT_CONNECTING;
+    esp_wifi_set_config(WIFI_IF_STA, &sta_config);
+    esp_err_t err = esp_wifi_connect();
+    if (err != ESP_OK) {
+        // 驱动拒绝连接（如后台扫描正在进行）时不会有断开事件，本轮到此结束，退避后重试
+        ESP_LOGW(TAG, "esp_wifi_connect失败: %s", esp_err_to_name(err));
+        connect_wait_locked();
+    }
+}
+
+// 本次尝试失败，继续下一个（持有profile_lock时调用）
+static void connect_next_locked(void)
+{
+    wifi_profile_t *p = &profiles[connect_order[connect_pos]];
+    if (connect_fast) {
+        // AP可能换了信道，同一配置再做一次全信道扫描
+        connect_fast = false;
+        connect_attempt_locked();
+        return;
+    }
+
+    if (p->failure < UINT16_MAX) {
+        p->failure++;
+    }
+    if (++connect_pos < profile_count) {
+        connect_fast = profiles[connect_order[connect_pos]].channel != 0;
+        connect_attempt_locked();
+        return;
+    }
+
+    // 本轮全部失败，退避后开始下一轮
+    ESP_LOGW(TAG, "所有WiFi配置连接失败");
+    profiles_save_locked(NVS_CACHE_STATE);
+    connect_wait_locked();
+}
+
+// 退避时间到，开始下一轮（esp_timer任务中调用）
+static void reconnect_timer_cb(void *arg)
+{
+    xSemaphoreTake(profile_lock, portMAX_DELAY);
+    if (connect_state == CONNECT_WAITING) {
+        connect_round_start_locked(-1);
+    }
+    xSemaphoreGive(profile_lock);
+}
+
+// 中断当前连接并重新开始一轮（持有profile_lock时调用）
+static void connect_restart_locked(int preferred)
+{
+    if (connect_state == CONNECT_IDLE || connect_state == CONNECT_WAITING) {
+        esp_timer_stop(reconnect_timer);
+        connect_round_start_locked(preferred);
+        return;
+    }
+    // 等断开事件到达后再开始，避免和正在进行的连接冲突
+    connect_restart = preferred;
+    esp_wifi_disconnect();
+}
+
+// STA断开（事件任务中调用）
+static void profile_on_disconnected(uint8_t reason)
+{
+    iot_reconnect_link_down(IOT_LINK_WIFI);
+
+    xSemaphoreTake(profile_lock, portMAX_DELAY);
+    if (connect_restart != -2) {
+        int preferred = connect_restart;
+        connect_restart = -2;
+        connect_round_start_locked(preferred < (int)profile_count ? preferred : -1);
+    } else if (connect_state == CONNECT_CONNECTED) {
+        // 连接中断，立即从当前配置的快速连接开始新一轮，之后的轮次才退避
+        ESP_LOGW(TAG, "WiFi连接中断，原因:%d", reason);
+        connect_round_start_locked(connect_order[connect_pos]);
+    } else if (connect_state == CONNECT_CONNECTING) {
+        ESP_LOGW(TAG, "WiFi连接失败，原因:%d", reason);
+        connect_next_locked();
+    }
+    xSemaphoreGive(profile_lock);
+}
+
+// STA获取到IP（事件任务中调用）
+static void profile_on_got_ip(void)
+{
+    wifi_ap_record_t ap_info;
+    bool have_ap = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK;
+
+    xSemaphoreTake(profile_lock, portMAX_DELAY);
+    if (connect_state == CONNECT_CONNECTING) {
+        wifi_profile_t *p = &profiles[connect_order[connect_pos]];
+        if (have_ap) {
+            memcpy(p->bssid, ap_info.bssid, sizeof(p->bssid));
+            p->channel = ap_info.primary;
+            p->rssi = ap_info.rssi;
+        }
+        if (p->success < UINT16_MAX) {
+            p->success++;
+        }
+        ESP_LOGI(TAG, "WiFi %s 连接用时%lldms（%s）", p->ssid,
+                 (long long)((esp_timer_get_time() - connect_start_us) / 1000),
+                 connect_fast ? "快速连接" : "全信道扫描");
+        profiles_save_locked(NVS_CACHE_STATE);
+    }
+    connect_state = CONNECT_CONNECTED;
+    xSemaphoreGive(profile_lock);
+
+    // 重置退避并通知MQTT重连
+    iot_reconnect_link_up(IOT_LINK_WIFI);
+}
+
+// 保存配置并立即连接
+esp_err_t wifi_profile_connect(const char *ssid, const char *password)
+{
+    if (!ssid || ssid[0] == '\0' || strlen(ssid) >= sizeof(profiles[0].ssid) ||
+        (password && strlen(password) >= sizeof(profiles[0].password))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(profile_lock, portMAX_DELAY);
+    int index = profile_find_locked(ssid);
+    if (index < 0) {
+        if (profile_count < CONFIG_WIFI_PROFILE_MAX) {
+            index = profile_count++;
+        } else {
+            // 已满，替换排名最后的配置
+            uint8_t order[CONFIG_WIFI_PROFILE_MAX];
+            profiles_rank_locked(order);
+            index = order[profile_count - 1];
+            ESP_LOGW(TAG, "WiFi配置已满，替换: %s", profiles[index].ssid);
+        }
+        memset(&profiles[index], 0, sizeof(profiles[index]));
+        strlcpy(profiles[index].ssid, ssid, sizeof(profiles[index].ssid));
+        profiles[index].rssi = PROFILE_RSSI_UNKNOWN;
+    }
+    if (password && strcmp(password, profiles[index].password) != 0) {
+        strlcpy(profiles[index].password, password, sizeof(profiles[index].password));
+        profiles[index].success = 0;
+        profiles[index].failure = 0;
+    }
+    esp_err_t err = profiles_save_locked(NVS_CACHE_CONFIG);
+    connect_restart_locked(index);
+    xSemaphoreGive(profile_lock);
+
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "WiFi配置已保存: %s", ssid);
+    }
+    return err;
+}
+
+// 删除配置
+esp_err_t wifi_profile_delete(const char *ssid)
+{
+    if (!ssid) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(profile_lock, portMAX_DELAY);
+    int index = profile_find_locked(ssid);
+    if (index < 0) {
+        xSemaphoreGive(profile_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    bool active = (connect_state == CONNECT_CONNECTING || connect_state == CONNECT_CONNECTED) &&
+                  connect_order[connect_pos] == index;
+    memmove(&profiles[index], &profiles[index + 1], (profile_count - index - 1) * sizeof(wifi_profile_t));
+    profile_count--;
+    esp_err_t err = profiles_save_locked(NVS_CACHE_CONFIG);
+
+    if (active) {
+        if (profile_count > 0) {
+            connect_restart_locked(-1);
+        } else {
+            connect_state = CONNECT_IDLE;
+            esp_timer_stop(reconnect_timer);
+            esp_wifi_disconnect();
+            wifi_config_t sta_config = { 0 };
+            esp_wifi_set_config(WIFI_IF_STA, &sta_config);
+        }
+    } else if (profile_count == 0) {
+        connect_state = CONNECT_IDLE;
+        esp_timer_stop(reconnect_timer);
+    } else if (connect_state != CONNECT_IDLE) {
+        // 从本轮顺序中去掉被删除的配置，后面配置的下标减一
+        size_t n = 0;
+        for (size_t i = 0; i <= profile_count; i++) {
+            if (connect_order[i] == index) {
+                if (i < connect_pos) {
+                    connect_pos--;
+                }
+                continue;
+            }
+            connect_order[n++] = connect_order[i] > index ? connect_order[i] - 1 : connect_order[i];
+        }
+    }
+    xSemaphoreGive(profile_lock);
+
+    ESP_LOGI(TAG, "WiFi配置已删除: %s", ssid);
+    return err;
+}
+
+// 列出配置（按排名）
+size_t wifi_profile_list(wifi_profile_info_t *list, size_t max)
+{
+    uint8_t order[CONFIG_WIFI_PROFILE_MAX];
+    size_t n = 0;
+
+    xSemaphoreTake(profile_lock, portMAX_DELAY);
+    profiles_rank_locked(order);
+    for (size_t i = 0; i < profile_count && n < max; i++) {
+        const wifi_profile_t *p = &profiles[order[i]];
+        wifi_profile_info_t *info = &list[n++];
+        strlcpy(info->ssid, p->ssid, sizeof(info->ssid));
+        info->rssi = p->rssi;
+        info->channel = p->channel;
+        info->success = p->success;
+        info->failure = p->failure;
+        info->connected = connect_state == CONNECT_CONNECTED &&
+                          connect_order[connect_pos] == order[i];
+    }
+    xSemaphoreGive(profile_lock);
+    return n;
+}
+
 // WiFi事件处理函数
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                     int32_t event_id, void* event_data)
@@ -41,45 +682,35 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                 break;
             case WIFI_EVENT_STA_START:
                 ESP_LOGI(TAG, "WIFI_EVENT_STA_START，尝试连接到AP...");
-                esp_wifi_connect();
+                xSemaphoreTake(profile_lock, portMAX_DELAY);
+                connect_round_start_locked(-1);
+                xSemaphoreGive(profile_lock);
+                // 预先扫描一轮，打开配网页面时即有结果
+                xSemaphoreTake(scan_lock, portMAX_DELAY);
+                if (!scan_sweeping) {
+                    scan_sweep_start_locked(SCAN_FIRST_DELAY_MS * 1000);
+                }
+                xSemaphoreGive(scan_lock);
+                break;
+            case WIFI_EVENT_SCAN_DONE:
+                scan_done();
                 break;
             case WIFI_EVENT_STA_CONNECTED:
                 ESP_LOGI(TAG, "WIFI_EVENT_STA_CONNECTED，已连接到AP");
-                s_retry_num = 0; // 重置重试计数
+                iot_boot_mark("sta_assoc");
                 break;
             case WIFI_EVENT_STA_DISCONNECTED:
                 wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
-                ESP_LOGW(TAG, "WiFi断开连接，原因:%d", event->reason);
-                if (s_retry_num < MAX_RETRY_COUNT) {
-                    ESP_LOGI(TAG, "重试连接到AP... (%d/%d)", s_retry_num + 1, MAX_RETRY_COUNT);
-                    esp_wifi_connect();
-                    s_retry_num++;
-                } else {
-                    ESP_LOGW(TAG, "WiFi连接失败，达到最大重试次数");
-                    // 保存当前状态到NVS
-                    nvs_handle_t nvs_handle;
-                    esp_err_t err = nvs_open("wifi_state", NVS_READWRITE, &nvs_handle);
-                    if (err == ESP_OK) {
-                        nvs_set_u8(nvs_handle, "connection_failed", 1);
-                        nvs_commit(nvs_handle);
-                        nvs_close(nvs_handle);
-                    }
-                }
+                // 依次尝试其他配置，全部失败时退避后重新开始一轮
+                profile_on_disconnected(event->reason);
                 break;
         }
     } else if (event_base == IP_EVENT) {
         if (event_id == IP_EVENT_STA_GOT_IP) {
             ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
             ESP_LOGI(TAG, "获取到IP地址:" IPSTR, IP2STR(&event->ip_info.ip));
-            s_retry_num = 0; // 重置重试计数
-            // 保存成功状态到NVS
-            nvs_handle_t nvs_handle;
-            esp_err_t err = nvs_open("wifi_state", NVS_READWRITE, &nvs_handle);
-            if (err == ESP_OK) {
-                nvs_set_u8(nvs_handle, "connection_failed", 0);
-                nvs_commit(nvs_handle);
-                nvs_close(nvs_handle);
-            }
+            iot_boot_mark("dhcp");
+            profile_on_got_ip();  // 记录BSSID和信道，重置退避
             // 调用WiFi连接成功回调
             if (wifi_connected_cb) {
                 wifi_connected_cb();
@@ -91,14 +722,30 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
 // 初始化WiFi软AP
 esp_err_t wifi_init_softap(void)
 {
-    ESP_ERROR_CHECK(esp_netif_init());  // 初始化底层TCP/IP堆栈
-    ESP_ERROR_CHECK(esp_event_loop_create_default());  // 创建默认事件循环
+    // TCP/IP堆栈和默认事件循环由调用者初始化（与HTTP服务器启动并行）
     esp_netif_create_default_wifi_ap();  // 创建默认WIFI AP
     esp_netif_create_default_wifi_sta(); // 创建默认WIFI STA
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();  // 使用默认WiFi初始化配置
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));  // 初始化WiFi
 
+    // 后台扫描定时器和WiFi配置（在注册事件处理函数前创建）
+    scan_lock = xSemaphoreCreateMutex();
+    profile_lock = xSemaphoreCreateMutex();
+    if (!scan_lock || !profile_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    const esp_timer_create_args_t scan_timer_args = {
+        .callback = scan_timer_cb,
+        .name = "wifi_scan",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&scan_timer_args, &scan_timer));
+    const esp_timer_create_args_t reconnect_timer_args = {
+        .callback = reconnect_timer_cb,
+        .name = "wifi_reconnect",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&reconnect_timer_args, &reconnect_timer));
+
     // 注册WiFi事件处理函数
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
                                                       ESP_EVENT_ANY_ID,
@@ -137,27 +784,8 @@ esp_err_t wifi_init_softap(void)
     // 设置AP配置
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_AP, &wifi_config));
 
-    // 尝试从NVS读取保存的WiFi配置
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("wifi_config", NVS_READONLY, &nvs_handle);
-    if (err == ESP_OK) {
-        wifi_config_t sta_config;
-        size_t size = sizeof(wifi_config_t);
-        err = nvs_get_blob(nvs_handle, "sta_config", &sta_config, &size);
-        if (err == ESP_OK) {
-            // 检查是否之前连接失败
-            uint8_t connection_failed = 0;
-            nvs_get_u8(nvs_handle, "connection_failed", &connection_failed);
-            
-            if (!connection_failed) {
-                ESP_LOGI(TAG, "找到已保存的WiFi配置，SSID: %s", sta_config.sta.ssid);
-                ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &sta_config));
-            } else {
-                ESP_LOGW(TAG, "上次WiFi连接失败，跳过自动连接");
-            }
-        }
-        nvs_close(nvs_handle);
-    }
+    // 读取保存的WiFi配置，STA启动后按排名依次连接
+    profiles_load();
 
     // 启动WiFi
     ESP_ERROR_CHECK(esp_wifi_start());
@@ -167,73 +795,6 @@ esp_err_t wifi_init_softap(void)
     return ESP_OK;
 }
 
-#define DEFAULT_SCAN_LIST_SIZE 10  // 默认扫描列表大小
-
-// 扫描周围WiFi网络
-esp_err_t wifi_scan_networks(wifi_ap_record_t **ap_records, uint16_t *ap_count)
-{
-    esp_err_t ret;
-    uint16_t number = DEFAULT_SCAN_LIST_SIZE;
-
-    // 分配内存用于存储扫描结果
-    *ap_records = malloc(DEFAULT_SCAN_LIST_SIZE * sizeof(wifi_ap_record_t));
-    if (*ap_records == NULL) {
-        ESP_LOGE(TAG, "为扫描结果分配内存失败");
-        return ESP_ERR_NO_MEM;
-    }
-
-    // 配置扫描参数
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = false,
-        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
-        .scan_time.active.min = 120,
-        .scan_time.active.max = 150,
-    };
-
-    // 开始扫描
-    ret = esp_wifi_scan_start(&scan_config, true);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "开始扫描失败");
-        free(*ap_records);
-        *ap_records = NULL;
-        return ret;
-    }
-
-    // 获取扫描结果
-    ret = esp_wifi_scan_get_ap_records(&number, *ap_records);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "获取扫描结果失败");
-        free(*ap_records);
-        *ap_records = NULL;
-        return ret;
-    }
-
-    // 获取找到的AP数量
-    ret = esp_wifi_scan_get_ap_num(ap_count);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "获取扫描到的AP数量失败");
-        free(*ap_records);
-        *ap_records = NULL;
-        return ret;
-    }
-
-    // 限制AP数量不超过默认扫描列表大小
-    if (*ap_count > DEFAULT_SCAN_LIST_SIZE) {
-        *ap_count = DEFAULT_SCAN_LIST_SIZE;
-    }
-
-    // 打印扫描结果
-    ESP_LOGI(TAG, "发现 %d 个接入点:", *ap_count);
-    for (int i = 0; i < *ap_count; i++) {
-        ESP_LOGI(TAG, "SSID: %s, 信号强度: %d", (*ap_records)[i].ssid, (*ap_records)[i].rssi);
-    }
-
-    return ESP_OK;
-}
-
 // 设置WiFi连接成功回调函数
 void wifi_set_connected_callback(wifi_connected_callback_t callback)
 {
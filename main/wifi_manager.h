@@ -1,17 +1,54 @@
 #ifndef WIFI_MANAGER_H
 #define WIFI_MANAGER_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include "esp_wifi.h"
 #include "esp_event.h"
 
 // WiFi连接成功回调函数类型
 typedef void (*wifi_connected_callback_t)(void);
 
-// WiFi初始化函数
+// WiFi初始化函数，调用前需要初始化NVS、esp_netif和默认事件循环
 esp_err_t wifi_init_softap(void);
 
-// WiFi扫描函数
-esp_err_t wifi_scan_networks(wifi_ap_record_t **ap_records, uint16_t *ap_count);
+// 扫描缓存中的一个AP
+typedef struct {
+    char ssid[33];
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    uint32_t age_ms;            // 距最后一次扫到的时间
+} wifi_scan_result_t;
+
+// 请求后台扫描：没有扫描在进行且缓存超过WIFI_SCAN_REFRESH_SEC时开始新一轮，立即返回
+void wifi_scan_request(void);
+
+// 读取扫描缓存（按信号强度排序），返回条数
+// age_ms: 距最近一轮扫描完成的时间，还没有完成过时为-1；scanning: 是否正在扫描
+size_t wifi_scan_get_results(wifi_scan_result_t *results, size_t max,
+                             int32_t *age_ms, bool *scanning);
+
+// 已保存的WiFi配置（不含密码）
+typedef struct {
+    char ssid[33];
+    int8_t rssi;                // 最后一次看到的信号强度
+    uint8_t channel;            // 上次连接成功的信道，0表示还没有连接成功过
+    uint16_t success;           // 连接成功次数
+    uint16_t failure;           // 连接失败次数
+    bool connected;             // 当前已连接
+} wifi_profile_info_t;
+
+// 保存WiFi配置并立即连接；password为NULL时使用已保存的密码（未保存过则按开放网络）
+// 配置已满时替换排名最后的配置
+esp_err_t wifi_profile_connect(const char *ssid, const char *password);
+
+// 删除WiFi配置，正在使用时断开并尝试其他配置
+esp_err_t wifi_profile_delete(const char *ssid);
+
+// 列出已保存的WiFi配置（按连接优先顺序），返回条数
+size_t wifi_profile_list(wifi_profile_info_t *list, size_t max);
 
 // 设置WiFi连接成功回调函数
 void wifi_set_connected_callback(wifi_connected_callback_t callback);
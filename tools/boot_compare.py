@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author: xingnian j_xingnian@163.com
+@Date: 2025-11-10
+@Description: 对比两组启动阶段记录（GET /api/boot）
+
+用法: boot_compare.py <A.jsonl> [B.jsonl]
+
+每个文件每行一次启动的 /api/boot 响应，例如每次复位后执行
+    curl -s http://192.168.4.1:8080/api/boot >> lazy.jsonl
+只给一个文件时输出各阶段的统计；给两个文件时另外输出中位数之差（B - A）。
+各阶段的时间是启动后的毫秒数，启动到获取IP看 dhcp 一行。
+"""
+
+import json
+import statistics
+import sys
+
+
+def load(path):
+    """读取文件，返回 {阶段名: [ms, ...]} 和启动次数，阶段按第一次出现的顺序排列"""
+    stages = {}
+    boots = 0
+    with open(path, encoding='utf-8') as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            boots += 1
+            for stage in json.loads(line)['stages']:
+                stages.setdefault(stage['name'], []).append(stage['ms'])
+    return stages, boots
+
+
+def summary(values):
+    return '%4d %7.0f %7d %7d' % (len(values), statistics.median(values), min(values), max(values))
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+
+    runs = [load(path) for path in sys.argv[1:]]
+    for path, (_, boots) in zip(sys.argv[1:], runs):
+        print('%s: %d次启动' % (path, boots))
+
+    names = list(runs[0][0])
+    if len(runs) == 2:
+        names += [name for name in runs[1][0] if name not in runs[0][0]]
+
+    header = '%-14s %4s %7s %7s %7s' % ('阶段', 'n', '中位数', '最小', '最大')
+    if len(runs) == 2:
+        header += '   | %4s %7s %7s %7s | %7s' % ('n', '中位数', '最小', '最大', 'B-A')
+    print(header)
+    for name in names:
+        cols = []
+        medians = []
+        for stages, _ in runs:
+            values = stages.get(name)
+            cols.append(summary(values) if values else '%4d %7s %7s %7s' % (0, '-', '-', '-'))
+            medians.append(statistics.median(values) if values else None)
+        line = '%-14s %s' % (name, '   | '.join(cols))
+        if len(runs) == 2:
+            diff = '%+7.0f' % (medians[1] - medians[0]) if None not in medians else '%7s' % '-'
+            line += ' | ' + diff
+        print(line)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author: xingnian j_xingnian@163.com
+@Date: 2025-11-10
+@Description: 构建时把网页资源gzip压缩并生成资源表（web_assets.c）
+
+用法: gen_web_assets.py <资源目录> <输出.c>
+
+每个文件生成一个const数组（位于flash，运行时通过cache直接映射读取），
+资源表按路径排序以便二分查找。ETag取压缩前内容的SHA-256前16位，
+内容不变时ETag不变，浏览器可用If-None-Match得到304。
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+MIME_TYPES = {
+    '.html': 'text/html',
+    '.htm': 'text/html',
+    '.css': 'text/css',
+    '.js': 'application/javascript',
+    '.json': 'application/json',
+    '.svg': 'image/svg+xml',
+    '.png': 'image/png',
+    '.jpg': 'image/jpeg',
+    '.jpeg': 'image/jpeg',
+    '.gif': 'image/gif',
+    '.ico': 'image/x-icon',
+    '.txt': 'text/plain',
+    '.woff2': 'font/woff2',
+}
+
+# 已压缩格式再gzip收益很小，原样存放
+NO_GZIP = {'.png', '.jpg', '.jpeg', '.gif', '.woff2'}
+
+
+def c_ident(index, path):
+    return 'asset_%d_' % index + ''.join(c if c.isalnum() else '_' for c in path.strip('/'))
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ' '.join('0x%02x,' % b for b in data[i:i + 16]))
+    return '\n'.join(lines)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    root, out_path = sys.argv[1], sys.argv[2]
+
+    assets = []
+    for dirpath, _, files in os.walk(root):
+        for name in files:
+            full = os.path.join(dirpath, name)
+            path = '/' + os.path.relpath(full, root).replace(os.sep, '/')
+            ext = os.path.splitext(name)[1].lower()
+            with open(full, 'rb') as f:
+                raw = f.read()
+            data = raw
+            compressed = False
+            if ext not in NO_GZIP:
+                # mtime=0保证相同输入生成相同输出
+                packed = gzip.compress(raw, compresslevel=9, mtime=0)
+                if len(packed) < len(raw):
+                    data = packed
+                    compressed = True
+            etag = '"%s"' % hashlib.sha256(raw).hexdigest()[:16]
+            assets.append((path, MIME_TYPES.get(ext, 'application/octet-stream'),
+                           data, compressed, etag, len(raw)))
+    assets.sort(key=lambda a: a[0])
+
+    out = ['// 由 tools/gen_web_assets.py 生成，请勿手动修改',
+           '#include "web_assets.h"', '']
+    for i, (path, _, data, compressed, _, raw_len) in enumerate(assets):
+        out.append('// %s: %d -> %d 字节%s' % (path, raw_len, len(data),
+                                            '（gzip）' if compressed else ''))
+        out.append('static const uint8_t %s[%d] = {' % (c_ident(i, path), len(data)))
+        out.append(c_bytes(data))
+        out.append('};')
+        out.append('')
+    out.append('const web_asset_t web_assets[] = {')
+    for i, (path, mime, data, compressed, etag, _) in enumerate(assets):
+        out.append('    { "%s", "%s", %s, %d, "%s", %s },' % (
+            path, mime, c_ident(i, path), len(data), etag.replace('"', '\\"'),
+            'true' if compressed else 'false'))
+    out.append('};')
+    out.append('')
+    out.append('const size_t web_asset_count = %d;' % len(assets))
+    out.append('')
+
+    text = '\n'.join(out)
+    # 内容不变时不改写文件，避免触发重新编译
+    if os.path.exists(out_path):
+        with open(out_path, 'r', encoding='utf-8') as f:
+            if f.read() == text:
+                return
+    with open(out_path, 'w', encoding='utf-8') as f:
+        f.write(text)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author: xingnian j_xingnian@163.com
+@Date: 2025-11-10
+@Description: 时间序列压缩负载（iot_tsz）参考解码器
+
+用法: tsz_decode.py [负载文件 ...]      不指定文件时从标准输入读取
+
+输出JSON: {"序列名": [[时间戳ms, 数值], ...], ...}
+后台可以直接导入本文件使用 decode(payload)。格式说明见
+components/iot_manager_mqtt/iot_tsz.h。
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = b'TZ'
+VERSION = 1
+
+
+class BitReader:
+    """从字节串最高位开始按位读取"""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def bits(self, n):
+        v = 0
+        for _ in range(n):
+            byte = self.data[self.pos >> 3]
+            v = (v << 1) | ((byte >> (7 - (self.pos & 7))) & 1)
+            self.pos += 1
+        return v
+
+    def signed(self, n):
+        v = self.bits(n)
+        return v - (1 << n) if v & (1 << (n - 1)) else v
+
+
+# 时间戳二阶差分的前缀：(前缀位数, 前缀值, 数据位数)
+DOD_BUCKETS = ((2, 0x2, 7), (3, 0x6, 9), (4, 0xe, 12), (4, 0xf, 32))
+
+
+def read_dod(r):
+    if r.bits(1) == 0:
+        return 0
+    prefix, width = 1, 1
+    for length, value, bits in DOD_BUCKETS:
+        while width < length:
+            prefix = (prefix << 1) | r.bits(1)
+            width += 1
+        if prefix == value:
+            return r.signed(bits)
+    raise ValueError('invalid timestamp prefix')
+
+
+def as_float(bits):
+    return struct.unpack('<f', struct.pack('<I', bits))[0]
+
+
+def decode_series(data, count):
+    r = BitReader(data)
+    ts = r.signed(64)
+    value = r.bits(32)
+    points = [[ts, as_float(value)]]
+    delta = 0
+    lead = trail = None
+    for _ in range(count - 1):
+        delta += read_dod(r)
+        ts += delta
+        if r.bits(1):
+            if r.bits(1):
+                lead = r.bits(5)
+                trail = 32 - lead - (r.bits(5) + 1)
+            elif lead is None:
+                raise ValueError('value window used before it was set')
+            value ^= r.bits(32 - lead - trail) << trail
+        points.append([ts, as_float(value)])
+    return points
+
+
+def decode(payload):
+    """解码一个负载，返回 {序列名: [[时间戳ms, 数值], ...]}"""
+    payload = bytes(payload)
+    if payload[:2] != MAGIC:
+        raise ValueError('not a tsz payload')
+    if payload[2] != VERSION:
+        raise ValueError('unsupported tsz version %d' % payload[2])
+
+    series = {}
+    pos = 3
+    while pos < len(payload):
+        name_len = payload[pos]
+        name = payload[pos + 1:pos + 1 + name_len].decode('utf-8')
+        pos += 1 + name_len
+        count, size = struct.unpack_from('<HH', payload, pos)
+        pos += 4
+        if pos + size > len(payload):
+            raise ValueError('truncated series %s' % name)
+        series.setdefault(name, []).extend(decode_series(payload[pos:pos + size], count))
+        pos += size
+    return series
+
+
+def main():
+    if len(sys.argv) > 1:
+        payloads = []
+        for path in sys.argv[1:]:
+            with open(path, 'rb') as f:
+                payloads.append(f.read())
+    else:
+        payloads = [sys.stdin.buffer.read()]
+
+    result = {}
+    for payload in payloads:
+        for name, points in decode(payload).items():
+            result.setdefault(name, []).extend(points)
+    json.dump(result, sys.stdout)
+    sys.stdout.write('\n')
+
+
+if __name__ == '__main__':
+    main()